@@ -37,6 +37,8 @@
 #include <Safir/Dob/Typesystem/ChannelId.h>
 #include <Safir/Dob/Typesystem/Defs.h>
 #include <Safir/Dob/Typesystem/EntityId.h>
+#include <utility>
+#include <vector>
 
 #ifndef SAFIR_NO_BOOST
 #include <Safir/Dob/EntityIterator.h>
@@ -697,6 +699,35 @@ namespace Dob
                         const Dob::Typesystem::InstanceId& instanceId,
                         const Dob::Typesystem::HandlerId&  handlerId) const;
 
+        /**
+         * Merge the changed members of a number of entities straight into the pool (the given handler
+         * must be the owner of all of them).
+         *
+         * The result is the same as calling SetChanges() for each of the entities in turn, but the
+         * whole batch is passed to the DOB in one call, which is considerably cheaper than one call
+         * per instance when many instances are updated at a time. Subscribers that subscribe to
+         * many of the instances are notified once for the batch instead of once per instance.
+         *
+         * The instances are set in the order they have in the batch, so an instance that occurs more
+         * than once gets the changes of all its entries merged in that order. If one of them cannot be
+         * set the exception for that instance is thrown, in which case the instances before it in the
+         * batch have been set and the ones after it have not.
+         *
+         * SetChangesBatch can not be used to set the injected instance from within an OnInjected callback,
+         * use SetChanges() for that.
+         *
+         * @param [in] entities Entities to create or update, each with its instance id.
+         * @param [in] handlerId Handler id.
+         *
+         * @throws Safir::Dob::AccessDeniedException An instance is owned by another handler.
+         * @throws Safir::Dob::GhostExistsException There is a ghost instance that hasn't been injected.
+         * @throws Safir::Dob::LowMemoryException Not enough shared memory available to complete this operation.
+         * @throws Safir::Dob::Typesystem::SoftwareViolationException The injected instance is in the batch
+         *                                                           when called from an OnInjected callback.
+         */
+        void SetChangesBatch(const std::vector<std::pair<Dob::EntityPtr, Dob::Typesystem::InstanceId> >& entities,
+                             const Dob::Typesystem::HandlerId&  handlerId) const;
+
         /**
          * Allows an entity handler to create or update an entity.
          *
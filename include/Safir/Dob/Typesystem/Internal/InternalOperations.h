@@ -68,6 +68,15 @@ namespace Internal
      */
     DOTS_CPP_API std::string ToJson(const char * const blob);
 
+    /**
+     * Convert a raw blob to UTF8 JSON and append it to a string.
+     * Reusing the same string for many conversions, and clearing it in between,
+     * avoids memory allocations when serializing a stream of objects.
+     * @param blob The blob to convert.
+     * @param json8 The UTF8 JSON is appended to this string.
+     */
+    DOTS_CPP_API void ToJson(const char * const blob, std::string& json8);
+
     /**
      * Deserialize an UTF8 JSON serialization.
      *
@@ -383,7 +383,8 @@ extern "C"
     //                              if it was too small it holds the size that was needed
     //                              (so resultSize > bufSize ==> try again with bigger buffer)
     // Returns:     -
-    // Comments:    Serializes a blob to a json string.
+    // Comments:    Serializes a blob to a json string. The json is written straight into jsonDest,
+    //              if resultSize > bufSize the contents of jsonDest are undefined.
     DOTS_KERNEL_API void DotsC_BlobToJson(char * const jsonDest,
                                           const char * const blobSource,
                                           const DotsC_Int32 bufSize,
@@ -90,7 +90,9 @@ namespace ToolSupport
         static DotsC_TypeId GetTypeId(const char* blob) {return Internal::Blob::GetTypeId(blob);}
 
         /**
-         * @brief Constructor - Creates a reader object that unpacks the blob and makes it possible to read its content.
+         * @brief Constructor - Creates a reader object that makes it possible to read the content of the blob.
+         * Blobs created by the BlobWriter class are read in place, so the blob must outlive the reader, and
+         * strings and binaries read from the reader point into the blob.
          * @param rep [in] - A type repository to use when interpreting the blob content.
          * @param blob [in] - A valid blob like the one created by BlobWriter class.
          */
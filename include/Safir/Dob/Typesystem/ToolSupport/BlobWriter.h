@@ -99,6 +99,8 @@ namespace ToolSupport
             ,m_valueIndex(-1)
             ,m_blob(Internal::BlobUtils::BlobAccess::GetBlob<BlobReader<RepositoryT, Traits> >(reader))
         {
+            //the reader may read its blob in place, and the writer must not depend on that blob
+            m_blob.MakeWritable();
         }
 
         BlobWriter(const BlobWriter&) = delete;
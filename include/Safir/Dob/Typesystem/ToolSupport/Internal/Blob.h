@@ -42,7 +42,17 @@ namespace Internal
     class AnyObject; //forward declaration of protoBuf type
 
     /**
-     * Wrapper around a protobub AnyObject. No checks made here that a type is correct according to dou-files
+     * Blob content with members, values and change flags. No checks made here that a type is correct according to dou-files
+     *
+     * Blobs are serialized in a flat format with offset tables, which is read in place: a Blob created
+     * from a raw flat blob just refers to the raw blob and finds any member value and change flag in
+     * constant time without unpacking or allocating anything. The raw blob must outlive such a Blob,
+     * and pointers to strings and binaries returned by it point into the raw blob.
+     *
+     * A Blob that is modified, or that is created from a raw blob in the older protobuf format, holds
+     * its content in a protobuf AnyObject. The protobuf format is only read, for compatibility with
+     * persisted data, it is never written. The AnyObject is allocated in a protobuf arena that is reused
+     * by the thread that created the Blob once the Blob and all copies of it are destroyed.
      */
     class DOTS_INTERNAL_API Blob
     {
@@ -53,9 +63,16 @@ namespace Internal
         //create new empty blob of specific type and initiates all members with null and unchanged
         Blob(std::int64_t typeId, int numberOfMembers);
 
-        //create blob object by deserialize a raw blob
+        //create blob object by deserialize a raw blob. A flat raw blob is read in place, see above.
         Blob(const char* blob);
 
+        //check if a raw blob is in the flat format, as opposed to the protobuf format
+        static bool IsFlat(const char* blob);
+
+        //unpack a blob that is read in place, so that it can be modified and no longer refers to the raw blob.
+        //Done automatically by all methods that modify the blob.
+        void MakeWritable();
+
         //calculate the blob size
         std::int32_t CalculateBlobSize();
 
@@ -148,6 +165,7 @@ namespace Internal
 
         std::int32_t m_blobSize;
         std::int64_t m_typeId;
+        const char* m_flat; //the raw blob if it is read in place, otherwise NULL and the content is in m_object
 
 #ifdef _MSC_VER
 #pragma warning (push)
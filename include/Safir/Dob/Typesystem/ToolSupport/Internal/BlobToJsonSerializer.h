@@ -33,13 +33,16 @@
 #include <vector>
 #include <sstream>
 #include <stdexcept>
-#include <boost/algorithm/string/replace.hpp>
+#include <limits>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
 #include <Safir/Dob/Typesystem/ToolSupport/TypeRepository.h>
+#include <Safir/Dob/Typesystem/ToolSupport/TypeUtilities.h>
 #include <Safir/Dob/Typesystem/ToolSupport/BlobReader.h>
 #include <Safir/Dob/Typesystem/ToolSupport/Internal/SerializationUtils.h>
 
-#define SAFIR_JSON_QUOTE(x) "\""<<x<<"\""
-
 namespace Safir
 {
 namespace Dob
@@ -50,6 +53,66 @@ namespace ToolSupport
 {
 namespace Internal
 {
+    /**
+     * Output for BlobToJsonSerializer that writes into a fixed caller-provided buffer. Whatever does not fit
+     * is counted but not written, so after serializing, size() is the number of characters the JSON needs and
+     * the caller can grow its buffer and serialize again if size() is larger than the capacity.
+     */
+    class JsonBufferWriter
+    {
+    public:
+        JsonBufferWriter(char* buf, size_t capacity)
+            :m_buf(buf)
+            ,m_capacity(capacity)
+            ,m_size(0)
+        {
+        }
+
+        JsonBufferWriter& operator+=(const char c)
+        {
+            if (m_size < m_capacity)
+            {
+                m_buf[m_size]=c;
+            }
+            ++m_size;
+            return *this;
+        }
+
+        JsonBufferWriter& operator+=(const char* str)
+        {
+            return append(str, str + strlen(str));
+        }
+
+        JsonBufferWriter& append(const char* first, const char* last)
+        {
+            const size_t len=static_cast<size_t>(last - first);
+            if (m_size < m_capacity)
+            {
+                memcpy(m_buf + m_size, first, std::min(len, m_capacity - m_size));
+            }
+            m_size+=len;
+            return *this;
+        }
+
+        /** Number of characters written, including the ones that did not fit. */
+        size_t size() const {return m_size;}
+
+        /** True if everything written fit in the buffer. */
+        bool fits() const {return m_size <= m_capacity;}
+
+    private:
+        char* const m_buf;
+        const size_t m_capacity;
+        size_t m_size;
+    };
+
+    /**
+     * Serializes a blob to JSON. The JSON is appended directly to a caller-provided string, so a caller that
+     * keeps its string between calls, and clears it rather than throwing it away, will after the first few
+     * objects serialize without any memory allocations at all. It can also write straight into a fixed buffer
+     * through a JsonBufferWriter. Numbers are formatted without going through
+     * iostreams, i.e. without locale lookups and temporary strings.
+     */
     template <class RepT, class Traits=Safir::Dob::Typesystem::ToolSupport::TypeRepositoryTraits<RepT> >
     class BlobToJsonSerializer
     {
@@ -68,30 +131,169 @@ namespace Internal
         BlobToJsonSerializer(const BlobToJsonSerializer&) = delete;
         BlobToJsonSerializer& operator=(const BlobToJsonSerializer&) = delete;
 
+        /** Appends the JSON of the blob to json. */
+        void operator()(const char* blob, std::string& json) const
+        {
+            SerializeMembers(blob, json);
+        }
+
+        /** Writes the JSON of the blob to writer, see JsonBufferWriter. */
+        void operator()(const char* blob, JsonBufferWriter& writer) const
+        {
+            SerializeMembers(blob, writer);
+        }
+
         void operator()(const char* blob, std::ostream& os) const
         {
-            SerializeMembers(blob, os);
+            std::string json;
+            SerializeMembers(blob, json);
+            os.write(json.data(), static_cast<std::streamsize>(json.size()));
         }
 
     private:
         const RepositoryType* m_repository;
 
-        inline void WriteMemberName(const char* name, std::ostream& os) const
+        template <class Out>
+        static void WriteMemberName(const char* name, Out& json)
         {
-            os<<"\""<<name<<"\":";
+            json+='"';
+            json+=name;
+            json+="\":";
         }
 
-        void SerializeMembers(const char* blob, std::ostream& os) const
+        template <class Out>
+        static void WriteQuoted(const char* val, Out& json)
         {
-            static const std::string nullString="null";
+            json+='"';
+            json+=val;
+            json+='"';
+        }
+
+        template <class T, class Out>
+        static void WriteInteger(const T val, Out& json)
+        {
+            typedef typename std::make_unsigned<T>::type UnsignedType;
+            char buf[24];
+            char* const end=buf+sizeof(buf);
+            char* first=end;
+            UnsignedType u=val<0 ? static_cast<UnsignedType>(0-static_cast<UnsignedType>(val)) : static_cast<UnsignedType>(val);
+            do
+            {
+                *--first=static_cast<char>('0'+u%10);
+                u/=10;
+            }
+            while (u!=0);
 
-            os<<"{";
+            if (val<0)
+            {
+                *--first='-';
+            }
+            json.append(first, end);
+        }
+
+        //Same result as classic_string_cast, i.e. digits10 significant digits and '.' as decimal point.
+        template <class T, class Out>
+        static void WriteFloat(const T val, Out& json)
+        {
+            char buf[40];
+            const int len=snprintf(buf, sizeof(buf), "%.*g", std::numeric_limits<T>::digits10, static_cast<double>(val));
+            for (int i=0; i<len; ++i)
+            {
+                json+=buf[i]==',' ? '.' : buf[i];
+            }
+        }
+
+        //Same result as SerializationUtils::ToBase64 without line breaks.
+        template <class Out>
+        static void WriteBase64(const char* data, const size_t size, Out& json)
+        {
+            static const char* const chars="ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            const unsigned char* bin=reinterpret_cast<const unsigned char*>(data);
+
+            json+='"';
+            size_t i=0;
+            for (; i+2<size; i+=3)
+            {
+                const unsigned int triple=(bin[i]<<16) | (bin[i+1]<<8) | bin[i+2];
+                json+=chars[(triple>>18) & 0x3f];
+                json+=chars[(triple>>12) & 0x3f];
+                json+=chars[(triple>>6) & 0x3f];
+                json+=chars[triple & 0x3f];
+            }
+
+            if (i<size)
+            {
+                const unsigned int triple=(bin[i]<<16) | (i+1<size ? bin[i+1]<<8 : 0);
+                json+=chars[(triple>>18) & 0x3f];
+                json+=chars[(triple>>12) & 0x3f];
+                json+=i+1<size ? chars[(triple>>6) & 0x3f] : '=';
+                json+='=';
+            }
+            json+='"';
+        }
+
+        template <class Out>
+        static void WriteString(const char* val, Out& json)
+        {
+            static const char* const hex="0123456789abcdef";
+
+            json+='"';
+            const char* unescaped=val;
+            const char* p=val;
+            for (; *p!='\0'; ++p)
+            {
+                const unsigned char c=static_cast<unsigned char>(*p);
+                if (c>=0x20 && c!='"' && c!='\\')
+                {
+                    continue;
+                }
+
+                json.append(unescaped, p);
+                unescaped=p+1;
+                switch (c)
+                {
+                case '"': json+="\\\""; break;
+                case '\\': json+="\\\\"; break;
+                case '\n': json+="\\n"; break;
+                case '\r': json+="\\r"; break;
+                case '\t': json+="\\t"; break;
+                default:
+                    json+="\\u00";
+                    json+=hex[c>>4];
+                    json+=hex[c & 0xf];
+                    break;
+                }
+            }
+            json.append(unescaped, p);
+            json+='"';
+        }
+
+        template <class Out>
+        void WriteTypeId(const DotsC_TypeId typeId, Out& json) const
+        {
+            const char* typeName=TypeUtilities::GetTypeName(m_repository, typeId);
+            if (typeName!=nullptr)
+            {
+                WriteQuoted(typeName, json);
+            }
+            else
+            {
+                json+='"';
+                WriteInteger(typeId, json);
+                json+='"';
+            }
+        }
+
+        template <class Out>
+        void SerializeMembers(const char* blob, Out& json) const
+        {
+            json+='{';
 
             const ClassDescriptionType* cd=GetClass(blob);
             BlobReader<RepositoryType> reader(m_repository, blob);
 
-            WriteMemberName("_DouType", os);
-            os<<SAFIR_JSON_QUOTE(cd->GetName());
+            WriteMemberName("_DouType", json);
+            WriteQuoted(cd->GetName(), json);
 
             for (DotsC_MemberIndex memberIx=0; memberIx<cd->GetNumberOfMembers(); ++memberIx)
             {
@@ -105,19 +307,16 @@ namespace Internal
                         reader.ReadStatus(memberIx, 0, isNull, isChanged);
                         if (!isNull)
                         {
-                            os<<",";
-                            WriteMemberName(md->GetName(), os);
-                            SerializeMember(reader, md, memberIx, 0, os);
+                            json+=',';
+                            WriteMemberName(md->GetName(), json);
+                            SerializeMember(reader, md, memberIx, 0, json);
                         }
                     }
                     break;
                 case ArrayCollectionType:
                     {
-                        std::ostringstream arrayValues;
-                        arrayValues<<",";
-                        WriteMemberName(md->GetName(), arrayValues);
-                        arrayValues<<"[";
-                        bool nonNullValueInserted=false;
+                        //the array element is only added if there are non-null values, and nulls are only
+                        //inserted when a value exists after them, to avoid lots of null at the end of an array
                         int accumulatedNulls=0;
                         bool hasInsertedValues=false;
                         for (DotsC_Int32 arrIx=0; arrIx<md->GetArraySize(); ++arrIx)
@@ -126,33 +325,35 @@ namespace Internal
                             reader.ReadStatus(memberIx, arrIx, isNull, isChanged);
                             if (isNull)
                             {
-                                //we wait to insert null until we know we have to because an value exists after.
-                                //This way we avoid lots of null at the end of an array
                                 ++accumulatedNulls;
                             }
                             else
                             {
                                 if (hasInsertedValues)
                                 {
-                                    arrayValues<<",";
+                                    json+=',';
+                                }
+                                else
+                                {
+                                    json+=',';
+                                    WriteMemberName(md->GetName(), json);
+                                    json+='[';
                                 }
 
                                 for (int nullCount=0; nullCount<accumulatedNulls; ++nullCount)
                                 {
-                                    arrayValues<<"null,";
+                                    json+="null,";
                                 }
                                 accumulatedNulls=0;
-                                nonNullValueInserted=true;
 
-                                SerializeMember(reader, md, memberIx, arrIx, arrayValues);
+                                SerializeMember(reader, md, memberIx, arrIx, json);
                                 hasInsertedValues=true;
                             }
                         }
-                        arrayValues<<"]";
 
-                        if (nonNullValueInserted) //only add array element if there are non-null values
+                        if (hasInsertedValues)
                         {
-                            os<<arrayValues.str();
+                            json+=']';
                         }
                     }
                     break;
@@ -161,20 +362,20 @@ namespace Internal
                         int numberOfValues=reader.NumberOfValues(memberIx);
                         if (numberOfValues>0)
                         {
-                            os<<",";
-                            WriteMemberName(md->GetName(), os);
-                            os<<"[";
+                            json+=',';
+                            WriteMemberName(md->GetName(), json);
+                            json+='[';
 
                             for (DotsC_Int32 valueIndex=0; valueIndex<numberOfValues; ++valueIndex)
                             {
                                 if (valueIndex>0)
                                 {
-                                    os<<",";
+                                    json+=',';
                                 }
-                                SerializeMember(reader, md, memberIx, valueIndex, os);
+                                SerializeMember(reader, md, memberIx, valueIndex, json);
                             }
 
-                            os<<"]";
+                            json+=']';
                         }
                     }
                     break;
@@ -183,109 +384,102 @@ namespace Internal
                         int numberOfValues=reader.NumberOfValues(memberIx);
                         if (numberOfValues>0)
                         {
-                            os<<",";
-                            WriteMemberName(md->GetName(), os);
-                            os<<"[";
+                            json+=',';
+                            WriteMemberName(md->GetName(), json);
+                            json+='[';
 
                             for (DotsC_Int32 valueIndex=0; valueIndex<numberOfValues; ++valueIndex)
                             {
                                 if (valueIndex>0)
                                 {
-                                    os<<",";
+                                    json+=',';
                                 }
-                                os<<"{";
-                                WriteMemberName("key", os);
-                                SerializeKey(reader, md, memberIx, valueIndex, os);
-                                os<<",";
-                                WriteMemberName("value", os);
-                                if (!SerializeMember(reader, md, memberIx, valueIndex, os))
-                                    os<<"null";
-                                os<<"}";
+                                json+='{';
+                                WriteMemberName("key", json);
+                                SerializeKey(reader, md, memberIx, valueIndex, json);
+                                json+=',';
+                                WriteMemberName("value", json);
+                                if (!SerializeMember(reader, md, memberIx, valueIndex, json))
+                                    json+="null";
+                                json+='}';
                             }
 
-                            os<<"]";
+                            json+=']';
                         }
                     }
                     break;
                 }
             }
 
-            os<<"}";
-        }
-
-        void WriteString(const std::string& val, std::ostream& os) const
-        {
-            std::string str=val;
-            std::string repl=std::string("\\")+std::string("\"");
-            boost::replace_all(str, "\"", repl);
-            boost::replace_all(str, "\n", "\\n");
-            os<<SAFIR_JSON_QUOTE(str);
+            json+='}';
         }
 
-        void WriteHash(const std::pair<DotsC_Int64, const char*>& val, std::ostream& os) const
+        template <class Out>
+        static void WriteHash(const std::pair<DotsC_Int64, const char*>& val, Out& json)
         {
             if (val.second)
             {
-                os<<SAFIR_JSON_QUOTE(val.second);
+                WriteString(val.second, json);
             }
             else
             {
-                os<<val.first;
+                WriteInteger(val.first, json);
             }
         }
 
-        void WriteEntityId(const std::pair<DotsC_EntityId, const char*>& val, std::ostream& os) const
+        template <class Out>
+        void WriteEntityId(const std::pair<DotsC_EntityId, const char*>& val, Out& json) const
         {
-            os<<"{";
-            WriteMemberName("name", os);
-            os << SAFIR_JSON_QUOTE(SerializationUtils::TypeIdToString(m_repository, val.first.typeId));
-            os<<",";
-            WriteMemberName("instanceId", os);
+            json+='{';
+            WriteMemberName("name", json);
+            WriteTypeId(val.first.typeId, json);
+            json+=',';
+            WriteMemberName("instanceId", json);
             if (val.second)
             {
-                os<<SAFIR_JSON_QUOTE(val.second);
+                WriteString(val.second, json);
             }
             else
             {
-                os<<val.first.instanceId;
+                WriteInteger(val.first.instanceId, json);
             }
-            os<<"}";
+            json+='}';
         }
 
+        template <class Out>
         void SerializeKey(const BlobReader<RepositoryType>& reader,
                           const MemberDescriptionType* md,
                           DotsC_MemberIndex memberIndex,
                           DotsC_Int32 valueIndex,
-                          std::ostream& os) const
+                          Out& json) const
         {
             switch(md->GetKeyType())
             {
             case Int32MemberType:
                 {
-                    os<<reader.template ReadKey<DotsC_Int32>(memberIndex, valueIndex);
+                    WriteInteger(reader.template ReadKey<DotsC_Int32>(memberIndex, valueIndex), json);
                 }
                 break;
             case Int64MemberType:
                 {
-                    os<<reader.template ReadKey<DotsC_Int64>(memberIndex, valueIndex);
+                    WriteInteger(reader.template ReadKey<DotsC_Int64>(memberIndex, valueIndex), json);
                 }
                 break;
             case EnumerationMemberType:
                 {
                     const char* enumVal=m_repository->GetEnum(md->GetKeyTypeId())->GetValueName(reader.template ReadKey<DotsC_EnumerationValue>(memberIndex, valueIndex));
-                    os<<SAFIR_JSON_QUOTE(enumVal);
+                    WriteQuoted(enumVal, json);
                 }
                 break;
             case EntityIdMemberType:
                 {
                     std::pair<DotsC_EntityId, const char*> eid=reader.template ReadKey< std::pair<DotsC_EntityId, const char*> >(memberIndex, valueIndex);
-                    WriteEntityId(eid, os);
+                    WriteEntityId(eid, json);
                 }
                 break;
             case TypeIdMemberType:
                 {
-                    DotsC_TypeId typeId = reader.template ReadKey<DotsC_TypeId>(memberIndex, valueIndex);
-                    os << SAFIR_JSON_QUOTE(SerializationUtils::TypeIdToString(m_repository, typeId));
+                    WriteTypeId(reader.template ReadKey<DotsC_TypeId>(memberIndex, valueIndex), json);
                 }
                 break;
             case InstanceIdMemberType:
@@ -293,13 +487,13 @@ namespace Internal
             case HandlerIdMemberType:
                 {
                     std::pair<DotsC_Int64, const char*> hash=reader.template ReadKey< std::pair<DotsC_Int64, const char*> >(memberIndex, valueIndex);
-                    WriteHash(hash, os);
+                    WriteHash(hash, json);
                 }
                 break;
 
             case StringMemberType:
                 {
-                    WriteString(reader.template ReadKey<const char*>(memberIndex, valueIndex), os);
+                    WriteString(reader.template ReadKey<const char*>(memberIndex, valueIndex), json);
                 }
                 break;
 
@@ -309,11 +503,12 @@ namespace Internal
             }
         }
 
+        template <class Out>
         bool SerializeMember(const BlobReader<RepositoryType>& reader,
                              const MemberDescriptionType* md,
                              DotsC_MemberIndex memberIndex,
                              DotsC_Int32 arrayIndex,
-                             std::ostream& os) const
+                             Out& json) const
         {
             bool isNull=true;
             bool isChanged=false;
@@ -326,7 +521,7 @@ namespace Internal
                     reader.ReadValue(memberIndex, arrayIndex, val, isNull, isChanged);
                     if (!isNull)
                     {
-                        os<<(val ? "true" : "false");
+                        json+=(val ? "true" : "false");
                         return true;
                     }
                 }
@@ -339,7 +534,7 @@ namespace Internal
                     if (!isNull)
                     {
                         const char* enumVal=m_repository->GetEnum(md->GetTypeId())->GetValueName(val);
-                        os<<SAFIR_JSON_QUOTE(enumVal);
+                        WriteQuoted(enumVal, json);
                         return true;
                     }
                 }
@@ -351,7 +546,7 @@ namespace Internal
                     reader.ReadValue(memberIndex, arrayIndex, val, isNull, isChanged);
                     if (!isNull)
                     {
-                        os<<val;
+                        WriteInteger(val, json);
                         return true;
                     }
                 }
@@ -363,7 +558,7 @@ namespace Internal
                     reader.ReadValue(memberIndex, arrayIndex, val, isNull, isChanged);
                     if (!isNull)
                     {
-                        os<<val;
+                        WriteInteger(val, json);
                         return true;
                     }
                 }
@@ -375,7 +570,7 @@ namespace Internal
                     reader.ReadValue(memberIndex, arrayIndex, val, isNull, isChanged);
                     if (!isNull)
                     {
-                        os << SAFIR_JSON_QUOTE(SerializationUtils::TypeIdToString(m_repository, val));
+                        WriteTypeId(val, json);
                         return true;
                     }
                 }
@@ -389,7 +584,7 @@ namespace Internal
                     reader.ReadValue(memberIndex, arrayIndex, val, isNull, isChanged);
                     if (!isNull)
                     {
-                        WriteHash(val, os);
+                        WriteHash(val, json);
                         return true;
                     }
                 }
@@ -401,7 +596,7 @@ namespace Internal
                     reader.ReadValue(memberIndex, arrayIndex, val, isNull, isChanged);
                     if (!isNull)
                     {
-                        WriteEntityId(val, os);
+                        WriteEntityId(val, json);
                         return true;
                     }
                 }
@@ -413,7 +608,7 @@ namespace Internal
                     reader.ReadValue(memberIndex, arrayIndex, val, isNull, isChanged);
                     if (!isNull)
                     {
-                        WriteString(val, os);
+                        WriteString(val, json);
                         return true;
                     }
                 }
@@ -425,7 +620,7 @@ namespace Internal
                     reader.ReadValue(memberIndex, arrayIndex, val, isNull, isChanged);
                     if (!isNull)
                     {
-                        SerializeMembers(val.first, os);
+                        SerializeMembers(val.first, json);
                         return true;
                     }
                 }
@@ -437,8 +632,7 @@ namespace Internal
                     reader.ReadValue(memberIndex, arrayIndex, val, isNull, isChanged);
                     if (!isNull)
                     {
-                        std::string bin(val.first, static_cast<size_t>(val.second));
-                        os<<SAFIR_JSON_QUOTE(SerializationUtils::ToBase64(bin,false));
+                        WriteBase64(val.first, static_cast<size_t>(val.second), json);
                         return true;
                     }
                 }
@@ -470,7 +664,7 @@ namespace Internal
                     reader.ReadValue(memberIndex, arrayIndex, val, isNull, isChanged);
                     if (!isNull)
                     {
-                        os<<classic_string_cast<std::string>(val);
+                        WriteFloat(val, json);
                         return true;
                     }
                 }
@@ -502,7 +696,7 @@ namespace Internal
                     reader.ReadValue(memberIndex, arrayIndex, val, isNull, isChanged);
                     if (!isNull)
                     {
-                        os<<classic_string_cast<std::string>(val);
+                        WriteFloat(val, json);
                         return true;
                     }
                 }
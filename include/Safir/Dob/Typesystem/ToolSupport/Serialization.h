@@ -123,6 +123,39 @@ namespace ToolSupport
         (Internal::BlobToJsonSerializer<RepositoryT>(repository))(blob, json);
     }
 
+    /**
+     * Serializes binary representation of an object to json, appending the result to a string.
+     * A string that is reused for many conversions (cleared in between) makes the conversion
+     * free from memory allocations once the string has grown large enough.
+     *
+     * @param repository [in] - Type repository containing needed type information.
+     * @param blob [in] - Binary data to be converted.
+     * @param json [in,out] - The json result of the conversion is appended to this string.
+     * @throws Safir::Dob::Typesystem::Parser:ParseError if binary can't be serialized to json.
+     */
+    template <class RepositoryT>
+    void BinaryToJson(const RepositoryT* repository, const char* blob, std::string& json)
+    {
+        (Internal::BlobToJsonSerializer<RepositoryT>(repository))(blob, json);
+    }
+
+    /**
+     * Serializes binary representation of an object to json, writing the result into a fixed buffer.
+     * No null termination is written. If writer.size() is larger than the capacity of the buffer the
+     * contents of the buffer are undefined and the conversion must be redone with a buffer of at
+     * least writer.size() characters.
+     *
+     * @param repository [in] - Type repository containing needed type information.
+     * @param blob [in] - Binary data to be converted.
+     * @param writer [in,out] - Writer for the buffer that the json result is written to.
+     * @throws Safir::Dob::Typesystem::Parser:ParseError if binary can't be serialized to json.
+     */
+    template <class RepositoryT>
+    void BinaryToJson(const RepositoryT* repository, const char* blob, Internal::JsonBufferWriter& writer)
+    {
+        (Internal::BlobToJsonSerializer<RepositoryT>(repository))(blob, writer);
+    }
+
     /**
      * Converts a json representation of an object to binary form.
      *
@@ -91,6 +91,19 @@ namespace
         }
         return false;
     }
+
+    Com::ReceiveStrands GetReceiveStrands(const Control::Config& conf)
+    {
+        switch (conf.GetThisNodeType().receiveStrands)
+        {
+        case Safir::Dob::ReceiveStrands::PerSocket:
+            return Com::ReceiveStrands::PerSocket;
+        case Safir::Dob::ReceiveStrands::PerNodeType:
+            return Com::ReceiveStrands::PerNodeType;
+        default:
+            return Com::ReceiveStrands::Single;
+        }
+    }
 }
 
 ControlApp::ControlApp(boost::asio::io_context&         io,
@@ -197,7 +210,10 @@ void ControlApp::Start()
                                                         nt.maxLostHeartbeats,
                                                         nt.slidingWindowSize,
                                                         nt.ackRequestThreshold,
-                                                        nt.retryTimeout));
+                                                        nt.retryTimeout,
+                                                        nt.sendQueueSize,
+                                                        nt.adaptiveSlidingWindow,
+                                                        nt.coalesceMessages));
 
         // system picture stuff
         std::vector<std::chrono::steady_clock::duration> retryTimeouts;
@@ -224,7 +240,8 @@ void ControlApp::Start()
                                                  addresses.first,
                                                  addresses.second,
                                                  commNodeTypes,
-                                                 m_conf.fragmentSize));
+                                                 m_conf.fragmentSize,
+                                                 GetReceiveStrands(m_conf)));
 
     if (!m_conf.thisNodeParam.seeds.empty())
     {
@@ -116,7 +116,10 @@ int main(int /*argc*/, char * /*argv*/[])
                                                          nt->maxLostHeartbeats,
                                                          nt->slidingWindowSize,
                                                          nt->ackRequestThreshold,
-                                                         nt->retryTimeout));
+                                                         nt->retryTimeout,
+                                                         nt->sendQueueSize,
+                                                         nt->adaptiveSlidingWindow,
+                                                         nt->coalesceMessages));
 
         std::vector<std::chrono::steady_clock::duration> retryTimeouts;
         for (auto rt = nt->retryTimeout.cbegin(); rt != nt->retryTimeout.cend(); ++rt)
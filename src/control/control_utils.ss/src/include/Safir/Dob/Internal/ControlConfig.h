@@ -28,6 +28,7 @@
 #include <set>
 #include <Safir/Utilities/Internal/Id.h>
 #include <Safir/Dob/NodeParameters.h>
+#include <Safir/Dob/ReceiveStrands.h>
 #include <Safir/Dob/ThisNodeParameters.h>
 #include <Safir/Dob/Typesystem/Utilities.h>
 #include <boost/chrono.hpp>
@@ -53,7 +54,11 @@ namespace Control
                  const std::vector<int>& retryTimeout_,
                  const bool requiredForStart_,
                  const bool isLightNode_,
-                 const bool keepStateWhileDetached_)
+                 const bool keepStateWhileDetached_,
+                 const int sendQueueSize_ = 0,
+                 const bool adaptiveSlidingWindow_ = false,
+                 const bool coalesceMessages_ = false,
+                 const Safir::Dob::ReceiveStrands::Enumeration receiveStrands_ = Safir::Dob::ReceiveStrands::Single)
 
             : name(name_),
               id(LlufId_Generate64(name_.c_str())),
@@ -66,7 +71,11 @@ namespace Control
               retryTimeout(retryTimeout_),
               requiredForStart(requiredForStart_),
               isLightNode(isLightNode_),
-              keepStateWhileDetached(keepStateWhileDetached_)
+              keepStateWhileDetached(keepStateWhileDetached_),
+              sendQueueSize(sendQueueSize_),
+              adaptiveSlidingWindow(adaptiveSlidingWindow_),
+              coalesceMessages(coalesceMessages_),
+              receiveStrands(receiveStrands_)
         {}
 
         const std::string name;
@@ -81,6 +90,10 @@ namespace Control
         const bool requiredForStart;
         const bool isLightNode;
         const bool keepStateWhileDetached;
+        const int sendQueueSize; //0 means use the default
+        const bool adaptiveSlidingWindow;
+        const bool coalesceMessages;
+        const Safir::Dob::ReceiveStrands::Enumeration receiveStrands;
     };
 
     struct ThisNode
@@ -210,10 +223,10 @@ namespace Control
                     throw std::logic_error("Parameter error: "
                                            "Node type " + nodeTypeName + ": SlidingWindowsSize is mandatory and must be greater than 0");
                 }
-                if (nt->SlidingWindowsSize()>20)
+                if (nt->SlidingWindowsSize()>256)
                 {
                     throw std::logic_error("Parameter error: "
-                                           "Node type " + nodeTypeName + ": SlidingWindowsSize must not exceed 20.");
+                                           "Node type " + nodeTypeName + ": SlidingWindowsSize must not exceed 256.");
                 }
 
                 auto slidingWindowsSize = nt->SlidingWindowsSize();
@@ -250,6 +263,23 @@ namespace Control
                     retryTimeout.push_back(static_cast<int>(nt->RetryTimeout()[index] * 1000));
                 }
 
+                // SendQueueSize
+                if (!nt->SendQueueSize().IsNull() && nt->SendQueueSize() <= 0)
+                {
+                    throw std::logic_error("Parameter error: "
+                                           "Node type " + nodeTypeName + ": SendQueueSize must be greater than 0");
+                }
+                auto sendQueueSize = nt->SendQueueSize().IsNull() ? 0 : nt->SendQueueSize().GetVal();
+
+                // AdaptiveSlidingWindow
+                auto adaptiveSlidingWindow = !nt->AdaptiveSlidingWindow().IsNull() && nt->AdaptiveSlidingWindow();
+
+                // CoalesceMessages
+                auto coalesceMessages = !nt->CoalesceMessages().IsNull() && nt->CoalesceMessages();
+
+                // ReceiveStrands
+                auto receiveStrands = nt->ReceiveStrands().IsNull() ? Safir::Dob::ReceiveStrands::Single : nt->ReceiveStrands().GetVal();
+
                 // RequiredForStart
                 auto requiredForStart = !nt->RequiredForStart().IsNull() && nt->RequiredForStart();
 
@@ -289,7 +319,11 @@ namespace Control
                                                   retryTimeout,
                                                   requiredForStart,
                                                   isLightNode,
-                                                  keepStateWhileDetached));
+                                                  keepStateWhileDetached,
+                                                  sendQueueSize,
+                                                  adaptiveSlidingWindow,
+                                                  coalesceMessages,
+                                                  receiveStrands));
 
             }
 
@@ -0,0 +1,274 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#ifdef _MSC_VER
+#pragma warning (push)
+#  pragma warning (disable: 4244)
+#  pragma warning (disable: 4245)
+#  pragma warning (disable: 4127)
+#endif
+
+#include <boost/crc.hpp>
+
+#ifdef _MSC_VER
+#  pragma warning (pop)
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#  include <intrin.h>
+#  include <nmmintrin.h>
+#  define COM_CRC32C_SSE42
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#  include <nmmintrin.h>
+#  define COM_CRC32C_SSE42
+#elif defined(__ARM_FEATURE_CRC32)
+#  include <arm_acle.h>
+#  define COM_CRC32C_ARMV8
+#endif
+
+namespace Safir
+{
+namespace Dob
+{
+namespace Internal
+{
+namespace Com
+{
+    /**
+     * CRC32C (Castagnoli) as used by iSCSI and SCTP. Uses the SSE4.2 crc32 instruction when the cpu has it,
+     * the ARMv8 crc32c instructions if the compiler targets them, otherwise a slicing-by-8 table implementation.
+     */
+    class Crc32c
+    {
+    public:
+        static uint32_t Calculate(const void* data, size_t size)
+        {
+            return Update(0, data, size);
+        }
+
+        //Continue a checksum calculation, crc is the value returned for the preceding data.
+        static uint32_t Update(uint32_t crc, const void* data, size_t size)
+        {
+            return Instance().m_update(crc, static_cast<const unsigned char*>(data), size);
+        }
+
+        static bool IsHardwareAccelerated()
+        {
+            return Instance().m_update!=&Software;
+        }
+
+#ifndef SAFIR_TEST
+    private:
+#endif
+        typedef uint32_t (*UpdateFunction)(uint32_t, const unsigned char*, size_t);
+
+        UpdateFunction m_update;
+        uint32_t m_table[8][256];
+
+        Crc32c()
+            :m_update(&Software)
+        {
+            const uint32_t poly=0x82F63B78; //reversed Castagnoli polynomial
+            for (uint32_t i=0; i<256; ++i)
+            {
+                uint32_t crc=i;
+                for (int bit=0; bit<8; ++bit)
+                {
+                    crc=(crc & 1) ? (crc>>1)^poly : crc>>1;
+                }
+                m_table[0][i]=crc;
+            }
+            for (uint32_t i=0; i<256; ++i)
+            {
+                for (int t=1; t<8; ++t)
+                {
+                    m_table[t][i]=(m_table[t-1][i]>>8) ^ m_table[0][m_table[t-1][i] & 0xff];
+                }
+            }
+
+            if (HasSse42())
+            {
+#ifdef COM_CRC32C_SSE42
+                m_update=&Sse42;
+#endif
+            }
+#ifdef COM_CRC32C_ARMV8
+            m_update=&Armv8;
+#endif
+        }
+
+        static const Crc32c& Instance()
+        {
+            static const Crc32c instance;
+            return instance;
+        }
+
+        static uint32_t Software(uint32_t crc, const unsigned char* p, size_t size)
+        {
+            const auto& t=Instance().m_table;
+            crc=~crc;
+            while (size>=8)
+            {
+                uint32_t lo;
+                uint32_t hi;
+                memcpy(&lo, p, 4);
+                memcpy(&hi, p+4, 4);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__==__ORDER_BIG_ENDIAN__)
+                lo=__builtin_bswap32(lo);
+                hi=__builtin_bswap32(hi);
+#endif
+                lo^=crc;
+                crc=t[7][lo & 0xff] ^ t[6][(lo>>8) & 0xff] ^ t[5][(lo>>16) & 0xff] ^ t[4][lo>>24] ^
+                    t[3][hi & 0xff] ^ t[2][(hi>>8) & 0xff] ^ t[1][(hi>>16) & 0xff] ^ t[0][hi>>24];
+                p+=8;
+                size-=8;
+            }
+            while (size-->0)
+            {
+                crc=(crc>>8) ^ t[0][(crc ^ *p++) & 0xff];
+            }
+            return ~crc;
+        }
+
+        static bool HasSse42()
+        {
+#if defined(COM_CRC32C_SSE42) && defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            return (info[2] & (1<<20))!=0;
+#elif defined(COM_CRC32C_SSE42)
+            return __builtin_cpu_supports("sse4.2")!=0;
+#else
+            return false;
+#endif
+        }
+
+#ifdef COM_CRC32C_SSE42
+#if defined(__GNUC__) || defined(__clang__)
+        __attribute__((target("sse4.2")))
+#endif
+        static uint32_t Sse42(uint32_t crc, const unsigned char* p, size_t size)
+        {
+            crc=~crc;
+#if defined(__x86_64__) || defined(_M_X64)
+            uint64_t crc64=crc;
+            while (size>=8)
+            {
+                uint64_t v;
+                memcpy(&v, p, 8);
+                crc64=_mm_crc32_u64(crc64, v);
+                p+=8;
+                size-=8;
+            }
+            crc=static_cast<uint32_t>(crc64);
+#endif
+            while (size>=4)
+            {
+                uint32_t v;
+                memcpy(&v, p, 4);
+                crc=_mm_crc32_u32(crc, v);
+                p+=4;
+                size-=4;
+            }
+            while (size-->0)
+            {
+                crc=_mm_crc32_u8(crc, *p++);
+            }
+            return ~crc;
+        }
+#endif
+
+#ifdef COM_CRC32C_ARMV8
+        static uint32_t Armv8(uint32_t crc, const unsigned char* p, size_t size)
+        {
+            crc=~crc;
+            while (size>=8)
+            {
+                uint64_t v;
+                memcpy(&v, p, 8);
+                crc=__crc32cd(crc, v);
+                p+=8;
+                size-=8;
+            }
+            while (size-->0)
+            {
+                crc=__crc32cb(crc, *p++);
+            }
+            return ~crc;
+        }
+#endif
+    };
+
+    /**
+     * Checksum that is added last in every datagram. Older versions only know the standard CRC32, so CRC32C
+     * is only used towards node types where all nodes have announced that they support it.
+     */
+    class Checksum
+    {
+    public:
+        explicit Checksum(bool crc32c) :m_crc32c(crc32c), m_crc(), m_value(0) {}
+
+        void Process(const void* data, size_t size)
+        {
+            if (m_crc32c)
+            {
+                m_value=Crc32c::Update(m_value, data, size);
+            }
+            else
+            {
+                m_crc.process_bytes(data, size);
+            }
+        }
+
+        uint32_t Value() const
+        {
+            return m_crc32c ? m_value : m_crc.checksum();
+        }
+
+        //Check the checksum at the end of a received datagram. Both kinds are accepted, CRC32C is tried first since it is much cheaper.
+        static bool IsValid(const char* buf, size_t size)
+        {
+            uint32_t checksum;
+            memcpy(&checksum, buf+size-sizeof(uint32_t), sizeof(uint32_t));
+            if (Crc32c::Calculate(buf, size-sizeof(uint32_t))==checksum)
+            {
+                return true;
+            }
+            boost::crc_32_type crc;
+            crc.process_bytes(static_cast<const void*>(buf), size-sizeof(uint32_t));
+            return checksum==crc.checksum();
+        }
+
+    private:
+        bool m_crc32c;
+        boost::crc_32_type m_crc;
+        uint32_t m_value;
+    };
+}
+}
+}
+}
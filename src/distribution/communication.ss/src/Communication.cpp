@@ -62,7 +62,8 @@ namespace
                                             const std::string& controlAddress,
                                             const std::string& dataAddress,
                                             const std::vector<NodeTypeDefinition>& nodeTypes,
-                                            int fragmentSize)
+                                            int fragmentSize,
+                                            ReceiveStrands receiveStrands)
     {
         Parameters::NetworkEnabled = true;
         Parameters::LogPrefix = isControlInstance ? "COMc["+std::to_string(nodeId)+"]: " : "COMd["+std::to_string(nodeId)+"]: ";
@@ -92,6 +93,11 @@ namespace
             {
                 throw std::invalid_argument("Safir.Communication: NodeType '"+nt->name+"' has id=0. NodeTypeId 0 is reserved and can't be assigned to an specific nodeType.");
             }
+            if (nt->slidingWindowSize<=0 || static_cast<size_t>(nt->slidingWindowSize)>Parameters::MaxSlidingWindowSize)
+            {
+                throw std::invalid_argument("Safir.Communication: NodeType '"+nt->name+"' has slidingWindowSize="+std::to_string(nt->slidingWindowSize)+
+                                            ". Allowed range is 1 to "+std::to_string(Parameters::MaxSlidingWindowSize)+".");
+            }
 
             const std::string& mc=isControlInstance ? nt->controlMulticastAddress : nt->dataMulticastAddress;
             bool useMulticast=(thisNodeIsMulticastEnabled && !mc.empty());
@@ -110,12 +116,15 @@ namespace
                                                          nt->ackRequestThreshold,
                                                          fragmentSize,
                                                          nt->isLightNode,
-                                                         nt->retryTimeout));
+                                                         nt->retryTimeout,
+                                                         nt->sendQueueSize>0 ? static_cast<size_t>(nt->sendQueueSize) : Parameters::SendQueueSize,
+                                                         nt->adaptiveSlidingWindow,
+                                                         nt->coalesceMessages));
             nodeTypeMap.insert(NodeTypeMap::value_type(nt->id, ptr));
         }
 
         //create impl object
-        return std::unique_ptr<CommunicationImpl>(new CommunicationImpl(ioContext, nodeName, nodeId, nodeTypeId, controlAddress, dataAddress, isControlInstance, nodeTypeMap, fragmentSize));
+        return std::unique_ptr<CommunicationImpl>(new CommunicationImpl(ioContext, nodeName, nodeId, nodeTypeId, controlAddress, dataAddress, isControlInstance, nodeTypeMap, fragmentSize, receiveStrands));
     }
 }
 
@@ -141,8 +150,9 @@ namespace
                                  const ResolvedAddress& controlAddress,
                                  const ResolvedAddress& dataAddress,
                                  const std::vector<NodeTypeDefinition>& nodeTypes,
-                                 int fragmentSize)
-        :m_impl(Init(true, ioContext, nodeName, nodeId, nodeTypeId, controlAddress.Address(), dataAddress.Address(), nodeTypes, fragmentSize))
+                                 int fragmentSize,
+                                 ReceiveStrands receiveStrands)
+        :m_impl(Init(true, ioContext, nodeName, nodeId, nodeTypeId, controlAddress.Address(), dataAddress.Address(), nodeTypes, fragmentSize, receiveStrands))
     {
     }
 
@@ -154,8 +164,9 @@ namespace
                                  int64_t nodeTypeId,
                                  const ResolvedAddress& dataAddress,
                                  const std::vector<NodeTypeDefinition>& nodeTypes,
-                                 int fragmentSize)
-        :m_impl(Init(false, ioContext, nodeName, nodeId, nodeTypeId, "", dataAddress.Address(), nodeTypes, fragmentSize))
+                                 int fragmentSize,
+                                 ReceiveStrands receiveStrands)
+        :m_impl(Init(false, ioContext, nodeName, nodeId, nodeTypeId, "", dataAddress.Address(), nodeTypes, fragmentSize, receiveStrands))
     {
     }
 
@@ -249,6 +260,11 @@ namespace
         return m_impl->NumberOfQueuedMessages(nodeTypeId);
     }
 
+    ReceiveStatistics Communication::GetReceiveStatistics() const
+    {
+        return m_impl->GetReceiveStatistics();
+    }
+
     const std::string& Communication::Name() const
     {
         return m_impl->Name();
@@ -28,6 +28,7 @@
 #include <Safir/Utilities/Internal/Id.h>
 #include <Safir/Utilities/Internal/LowLevelLogger.h>
 #include <Safir/Utilities/Internal/Expansion.h>
+#include <Safir/Utilities/Internal/SharedCharArray.h>
 #include "Parameters.h"
 #include "Message.h"
 
@@ -68,7 +69,8 @@ namespace
                                          const std::string& dataAddress,
                                          bool isControlInstance,
                                          const NodeTypeMap& nodeTypes,
-                                         int fragmentSize)
+                                         int fragmentSize,
+                                         ReceiveStrands receiveStrands)
         :m_logPrefix(Parameters::LogPrefix)
         ,m_running(false)
         ,m_ioContext(ioContext)
@@ -77,13 +79,17 @@ namespace
         ,m_protocol(Resolver::Protocol(m_me.unicastAddress))
         ,m_isControlInstance(isControlInstance)
         ,m_nodeTypes(nodeTypes)
+        ,m_receiveStrands(receiveStrands)
         ,m_onNewNode()
-        ,m_gotRecvFrom()
         ,m_discoverer(m_ioContext, m_me, fragmentSize, LightNodeTypes(nodeTypes), [this](const Node& n){OnNewNode(n);})
-        ,m_deliveryHandler(ioContext, m_me.nodeId, m_protocol, m_nodeTypes[nodeTypeId]->SlidingWindowSize())
+        ,m_deliverStrand(ioContext)
+        ,m_partitions()
+        ,m_nodeTypePartitions()
+        ,m_nodePartitions()
         ,m_reader(m_receiveStrand, m_me.unicastAddress, m_nodeTypes[nodeTypeId]->MulticastAddress(),
-                  [this](const char* d, size_t s, const bool mc){return OnRecv(d,s,mc);},
-                  [this](){return m_deliveryHandler.NumberOfUndeliveredMessages()<Parameters::MaxNumberOfUndelivered;})
+                  [this](const Safir::Utilities::Internal::SharedCharArray& d, size_t s, const bool mc){return OnRecv(d,s,mc);},
+                  [this](){return IsReceiverReady();},
+                  receiveStrands!=ReceiveStrands::Single)
     {        
         auto safirInstance = Safir::Utilities::Internal::Expansion::GetSafirInstance();
 
@@ -101,8 +107,31 @@ namespace
         lllog(1)<<m_logPrefix.c_str()<<L"    data address:    "<<m_me.dataAddress.c_str()<<std::endl;
         lllog(1)<<m_logPrefix.c_str()<<L"    control address: "<<m_me.controlAddress.c_str()<<std::endl;
         lllog(1)<<m_logPrefix.c_str()<<L"    multicast:       "<<myNodeType->MulticastAddress().c_str()<<std::endl;
+        lllog(1)<<m_logPrefix.c_str()<<L"    receive strands: "<<(receiveStrands==ReceiveStrands::Single ? L"single" :
+                                                                   receiveStrands==ReceiveStrands::PerSocket ? L"per socket" : L"per node type")<<std::endl;
         lllog(1)<<m_logPrefix.c_str()<<L"-------------------------------------------------"<<std::endl;
 
+        m_pendingReceived=0;
+
+        //Single and PerSocket handle all received data in the receive strand. PerNodeType gets one partition with a strand
+        //of its own for every node type.
+        const int slidingWindowSize=myNodeType->SlidingWindowSize();
+        for (const auto& nt : m_nodeTypes)
+        {
+            if (m_partitions.empty() || receiveStrands==ReceiveStrands::PerNodeType)
+            {
+                m_partitions.push_back(std::make_unique<ReceivePartition>(m_partitions.empty() ? m_receiveStrand : boost::asio::io_context::strand(ioContext),
+                                                                          ioContext, m_me.nodeId, m_protocol, slidingWindowSize, m_deliverStrand));
+            }
+            m_nodeTypePartitions[nt.first]=m_partitions.back().get();
+        }
+
+        for (auto& partition : m_partitions)
+        {
+            //when the application has caught up, continue reading immediately instead of waiting for the reader watchdog
+            partition->deliveryHandler.SetReceiverReadyCallback([this]{m_reader.ResumeReceive();});
+        }
+
         auto sessionId = getenv("SAFIR_COM_NETWORK_SIMULATION");
         if (sessionId != nullptr && strlen(sessionId) > 0)
         {
@@ -126,11 +155,27 @@ namespace
 
     void CommunicationImpl::SetGotReceiveFromCallback(const GotReceiveFrom& callback)
     {
-        boost::asio::dispatch(m_receiveStrand, [this, callback]
+        GotReceiveFrom sequentialCallback=callback;
+        if (m_partitions.size()>1)
         {
-            m_gotRecvFrom=callback;
-            m_deliveryHandler.SetGotRecvCallback(callback);
-        });
+            //the partitions run concurrently, but the callback must never be called concurrently
+            auto mutex=std::make_shared<std::mutex>();
+            sequentialCallback=[callback, mutex](int64_t fromNodeId, bool isMulticast, bool isDuplicate)
+            {
+                std::lock_guard<std::mutex> lck(*mutex);
+                callback(fromNodeId, isMulticast, isDuplicate);
+            };
+        }
+
+        for (auto& partition : m_partitions)
+        {
+            auto p=partition.get();
+            boost::asio::dispatch(p->strand, [p, sequentialCallback]
+            {
+                p->gotRecvFrom=sequentialCallback;
+                p->deliveryHandler.SetGotRecvCallback(sequentialCallback);
+            });
+        }
     }
 
     void CommunicationImpl::SetRetransmitToCallback(const RetransmitTo& callback)
@@ -143,10 +188,14 @@ namespace
 
     void CommunicationImpl::SetDataReceiver(const ReceiveData& callback, int64_t dataTypeIdentifier, const Allocator& allocator, const DeAllocator& deallocator)
     {
-        boost::asio::post(m_receiveStrand, [this, callback, dataTypeIdentifier, allocator, deallocator]
+        for (auto& partition : m_partitions)
         {
-            m_deliveryHandler.SetReceiver(callback, dataTypeIdentifier, allocator, deallocator);
-        });
+            auto p=partition.get();
+            boost::asio::post(p->strand, [p, callback, dataTypeIdentifier, allocator, deallocator]
+            {
+                p->deliveryHandler.SetReceiver(callback, dataTypeIdentifier, allocator, deallocator);
+            });
+        }
     }
 
     void CommunicationImpl::SetQueueNotFullCallback(const QueueNotFull& callback, int64_t nodeTypeId)
@@ -179,7 +228,11 @@ namespace
         }
 
         lllog(1)<<m_logPrefix.c_str()<<L"Start "<<m_me.name.c_str()<<std::endl;
-        boost::asio::post(m_receiveStrand, [this]{m_deliveryHandler.Start();});
+        for (auto& partition : m_partitions)
+        {
+            auto p=partition.get();
+            boost::asio::post(p->strand, [p]{p->deliveryHandler.Start();});
+        }
         m_reader.Start();
         for (auto vt = m_nodeTypes.cbegin(); vt != m_nodeTypes.cend(); ++vt)
         {
@@ -206,7 +259,16 @@ namespace
         {
             m_debugServer->Stop();
         }
-        boost::asio::post(m_receiveStrand, [this] {m_deliveryHandler.Stop(); });
+        for (auto& partition : m_partitions)
+        {
+            auto p=partition.get();
+            boost::asio::post(p->strand, [p]
+            {
+                p->deliveryHandler.Stop();
+                p->nackTimer.cancel();
+                p->nackTimerActive=false;
+            });
+        }
         m_reader.Stop();
 
         for (auto vt = m_nodeTypes.cbegin(); vt != m_nodeTypes.cend(); ++vt)
@@ -229,11 +291,20 @@ namespace
             return;
         }
         lllog(1) << m_logPrefix.c_str() << L"Reset " << m_me.name.c_str() << std::endl;
-        boost::asio::post(m_receiveStrand, [this]
+        {
+            std::lock_guard<std::mutex> lck(m_nodePartitionsMutex);
+            m_nodePartitions.clear(); //all nodes are removed from the delivery handlers below
+        }
+
+        for (auto& partition : m_partitions)
+        {
+            auto p=partition.get();
+            boost::asio::post(p->strand, [p]
             {
-                m_deliveryHandler.Stop();
-                m_deliveryHandler.Start();
+                p->deliveryHandler.Stop();
+                p->deliveryHandler.Start();
             });
+        }
 
         for (auto vt = m_nodeTypes.cbegin(); vt != m_nodeTypes.cend(); ++vt)
         {
@@ -266,7 +337,7 @@ namespace
     void CommunicationImpl::IncludeNodeInternal(int64_t id)
     {
         //There is no way for us at this point to know which nodeType the node belongs to without entering the
-        //m_receiveStrand, and that is not an option here. We must be sure to post the includeNode right now to
+        //receive strand, and that is not an option here. We must be sure to post the includeNode right now to
         //ensure it is handled before any forthcoming Sends. Since includeNode in DataSender will ignore any calls
         //when the node does not exist, we call includeNode on all nodeTypes knowing it will only have effect on
         //the one where the node exists.
@@ -279,17 +350,19 @@ namespace
 
         //We do post (not dispatch) here to be sure the AddNode job will be executed before IncludeNode. Otherwize we
         //risk losing a node.
-        boost::asio::post(m_receiveStrand, [this, id]{m_deliveryHandler.IncludeNode(id);});
+        auto& partition=PartitionOfNode(id);
+        boost::asio::post(partition.strand, [&partition, id]{partition.deliveryHandler.IncludeNode(id);});
     }
 
     void CommunicationImpl::ExcludeNode(int64_t id)
     {
         lllog(6)<<m_logPrefix.c_str()<<L"ExcludeNode "<<id<<std::endl;
 
-        boost::asio::post(m_receiveStrand, [this, id]
+        auto& partition=PartitionOfNode(id);
+        boost::asio::post(partition.strand, [this, &partition, id]
         {
             lllog(6)<<m_logPrefix.c_str()<<L"Execute ExcludeNode id="<<id<<std::endl;
-            auto node=m_deliveryHandler.GetNode(id);
+            auto node=partition.deliveryHandler.GetNode(id);
 
             if (node==nullptr)
             {
@@ -301,7 +374,12 @@ namespace
             nodeType.GetAckedDataSender().RemoveNode(id);
             nodeType.GetUnackedDataSender().RemoveNode(id);
             nodeType.GetHeartbeatSender().RemoveNode(id);
-            m_deliveryHandler.RemoveNode(id);
+            nodeType.NodeRemoved(id);
+            partition.deliveryHandler.RemoveNode(id);
+            {
+                std::lock_guard<std::mutex> lck(m_nodePartitionsMutex);
+                m_nodePartitions.erase(id);
+            }
             if (m_isControlInstance)
             {
                 m_discoverer.ExcludeNode(id);
@@ -384,10 +462,17 @@ namespace
         lllog(6)<<m_logPrefix.c_str()<<L"New node '"<<node.name.c_str()<<L"' ["<<node.nodeId<<L"]"<<std::endl;
 
         auto& nodeType=GetNodeType(node.nodeTypeId);
+        nodeType.NodeAdded(node.nodeId); //before the senders know about the node, so that it will never get a checksum it does not understand
         nodeType.GetAckedDataSender().AddNode(node.nodeId, node.unicastAddress);
         nodeType.GetUnackedDataSender().AddNode(node.nodeId, node.unicastAddress);
         nodeType.GetHeartbeatSender().AddNode(node.nodeId, node.unicastAddress);
-        boost::asio::post(m_receiveStrand, [this, node]{m_deliveryHandler.AddNode(node);});
+        auto& partition=PartitionOfNodeType(node.nodeTypeId);
+        boost::asio::post(partition.strand, [&partition, node]{partition.deliveryHandler.AddNode(node);});
+        {
+            //from now on, everything received from the node is handled in its partition
+            std::lock_guard<std::mutex> lck(m_nodePartitionsMutex);
+            m_nodePartitions[node.nodeId]=&partition;
+        }
 
         //callback to host application
         m_onNewNode(node.name,
@@ -399,9 +484,10 @@ namespace
     }
 
     //returns true if it is ok to call OnRecv again, false if flooded with received messages
-    bool CommunicationImpl::OnRecv(const char* data, size_t size, bool multicast)
+    bool CommunicationImpl::OnRecv(const Safir::Utilities::Internal::SharedCharArray& buffer, size_t size, bool multicast)
     {
-        //Always called from receiveStrand
+        //Called from the receive strand, or from the strand of the socket when there are several receive strands
+        const char* data=buffer.get();
 
         if (size<CommonHeaderSize)
         {
@@ -422,14 +508,48 @@ namespace
             return true; //Message sent from myself
         }
 
+        if (m_receiveStrands==ReceiveStrands::Single)
+        {
+            HandleReceived(*m_partitions.front(), data, size, multicast);
+            return IsReceiverReady();
+        }
+
+        //Keep the receive buffer and handle the data in the strand of the partition, the reader will not reuse a buffer that
+        //we still hold. Control data comes from nodes that we might not know yet and always goes to the partition of our own node type.
+        auto& partition=commonHeader->dataType==ControlDataType ? PartitionOfNodeType(m_me.nodeTypeId) : PartitionOfNode(commonHeader->senderId);
+        ++m_pendingReceived;
+        boost::asio::post(partition.strand, [this, &partition, buffer, size, multicast]
+        {
+            HandleReceived(partition, buffer.get(), size, multicast);
+            if (m_pendingReceived-- == Parameters::MaxPendingReceivedDatagrams)
+            {
+                m_reader.ResumeReceive(); //we just went below the limit, wake up the reader if it is waiting for us
+            }
+        });
+
+        return IsReceiverReady();
+    }
+
+    void CommunicationImpl::HandleReceived(ReceivePartition& partition, const char* data, size_t size, bool multicast)
+    {
+        //Always called from the strand of the partition
+        const CommonHeader* commonHeader=reinterpret_cast<const CommonHeader*>(data);
+        auto& deliveryHandler=partition.deliveryHandler;
+
         switch (commonHeader->dataType)
         {
         case HeartbeatType:
         {
-            const Node* senderNode=m_deliveryHandler.GetNode(commonHeader->senderId);
+            const Node* senderNode=deliveryHandler.GetNode(commonHeader->senderId);
+            if (senderNode!=nullptr)
+            {
+                //older versions only send the commonHeader
+                const uint8_t features=size>=sizeof(Heartbeat) ? reinterpret_cast<const Heartbeat*>(data)->features : 0;
+                GetNodeType(senderNode->nodeTypeId).SetNodeFeatures(commonHeader->senderId, features);
+            }
             if (senderNode!=nullptr && senderNode->systemNode)
             {
-                m_gotRecvFrom(commonHeader->senderId, multicast, false);
+                partition.gotRecvFrom(commonHeader->senderId, multicast, false);
                 lllog(9)<<m_logPrefix.c_str()<<L"Heartbeat from "<<commonHeader->senderId<<std::endl;
             }
         }
@@ -437,12 +557,19 @@ namespace
 
         case AckType:
         {
-            const Node* senderNode=m_deliveryHandler.GetNode(commonHeader->senderId);
+            if (size<AckHeaderSize)
+            {
+                lllog(4)<<m_logPrefix.c_str()<<L"Received corrupt Ack"<<std::endl;
+                return; //corrupt message
+            }
+            const Node* senderNode=deliveryHandler.GetNode(commonHeader->senderId);
             if (senderNode!=nullptr && senderNode->systemNode)
             {
-                m_gotRecvFrom(commonHeader->senderId, multicast, false);
-                const Ack* ack=reinterpret_cast<const Ack*>(data);
-                GetNodeType(senderNode->nodeTypeId).GetAckedDataSender().HandleAck(*ack);
+                partition.gotRecvFrom(commonHeader->senderId, multicast, false);
+                //acks have variable size, entries in missing that were not received are left as unused ('#')
+                Ack ack(0, 0, 0, 0);
+                memcpy(static_cast<void*>(&ack), data, std::min(size, sizeof(Ack)));
+                GetNodeType(senderNode->nodeTypeId).GetAckedDataSender().HandleAck(ack);
             }
         }
         break;
@@ -452,10 +579,10 @@ namespace
             if (size<MessageHeaderSize)
             {
                 lllog(4)<<m_logPrefix.c_str()<<L"Received corrupt AckRequest"<<std::endl;
-                return true; //corrupt message, return true means it is ok to receive another message
+                return; //corrupt message
             }
             const MessageHeader* ackReq=reinterpret_cast<const MessageHeader*>(data);
-            m_deliveryHandler.ReceivedAckRequest(ackReq, multicast);
+            deliveryHandler.ReceivedAckRequest(ackReq, multicast);
         }
         break;
 
@@ -464,7 +591,7 @@ namespace
             if (size<MessageHeaderSize)
             {
                 lllog(4)<<m_logPrefix.c_str()<<L"Received corrupt ControlData"<<std::endl;
-                return true; //corrupt message, return true means it is ok to receive another message
+                return; //corrupt message
             }
             const MessageHeader* msgHeader=reinterpret_cast<const MessageHeader*>(data);
             const char* payload=data+MessageHeaderSize;
@@ -478,16 +605,84 @@ namespace
             if (size<MessageHeaderSize)
             {
                 lllog(4)<<m_logPrefix.c_str()<<L"Received corrupt ApplicationData"<<std::endl;
-                return true; //corrupt message, return true means it is ok to receive another message
+                return; //corrupt message
             }
             const MessageHeader* msgHeader=reinterpret_cast<const MessageHeader*>(data);
             const char* payload=data+MessageHeaderSize;
-            m_deliveryHandler.ReceivedApplicationData(msgHeader, payload, multicast);
+            deliveryHandler.ReceivedApplicationData(msgHeader, payload, multicast);
+            if (!partition.nackTimerActive && deliveryHandler.HasMissingMessages())
+            {
+                StartNackTimer(partition);
+            }
         }
         break;
         }
+    }
+
+    bool CommunicationImpl::IsReceiverReady() const
+    {
+        //Every DeliveryHandler wakes up the reader when it goes below the limit, so the reader must wait until all of them are below
+        for (const auto& partition : m_partitions)
+        {
+            if (partition->deliveryHandler.NumberOfUndeliveredMessages()>=Parameters::MaxNumberOfUndelivered)
+            {
+                return false;
+            }
+        }
+        return m_pendingReceived<Parameters::MaxPendingReceivedDatagrams;
+    }
+
+    CommunicationImpl::ReceivePartition& CommunicationImpl::PartitionOfNode(int64_t nodeId) const
+    {
+        if (m_partitions.size()==1)
+        {
+            return *m_partitions.front();
+        }
 
-        return m_deliveryHandler.NumberOfUndeliveredMessages()<Parameters::MaxNumberOfUndelivered;
+        {
+            std::lock_guard<std::mutex> lck(m_nodePartitionsMutex);
+            auto it=m_nodePartitions.find(nodeId);
+            if (it!=m_nodePartitions.end())
+            {
+                return *it->second;
+            }
+        }
+        return PartitionOfNodeType(m_me.nodeTypeId); //unknown node, its data will be thrown away
+    }
+
+    CommunicationImpl::ReceivePartition& CommunicationImpl::PartitionOfNodeType(int64_t nodeTypeId) const
+    {
+        auto it=m_nodeTypePartitions.find(nodeTypeId);
+        if (it==m_nodeTypePartitions.end())
+        {
+            throw std::logic_error(std::string("COM: PartitionOfNodeType Invalid, nodeTypeId: ")+boost::lexical_cast<std::string>(nodeTypeId));
+        }
+        return *it->second;
+    }
+
+
+    void CommunicationImpl::StartNackTimer(ReceivePartition& partition)
+    {
+        //Always called from the strand of the partition
+        partition.nackTimerActive=true;
+        partition.nackTimer.expires_after(std::chrono::milliseconds(Parameters::NackInterval));
+        partition.nackTimer.async_wait(boost::asio::bind_executor(partition.strand, [this, &partition](const boost::system::error_code& error)
+        {
+            if (error==boost::asio::error::operation_aborted)
+            {
+                return;
+            }
+
+            partition.deliveryHandler.SendNacks();
+            if (partition.deliveryHandler.HasMissingMessages())
+            {
+                StartNackTimer(partition);
+            }
+            else
+            {
+                partition.nackTimerActive=false;
+            }
+        }));
     }
 
     //Received internal Communication msg that shall not be immediately passed to application, i.e discover, nodeInfo etc.
@@ -24,6 +24,9 @@
 #pragma once
 
 #include <set>
+#include <map>
+#include <unordered_map>
+#include <mutex>
 #include <memory>
 #include <functional>
 #include "NodeType.h"
@@ -69,7 +72,8 @@ namespace Com
                           const std::string& dataAddress,
                           bool isControlInstance,
                           const NodeTypeMap& nodeTypes,
-                          int fragmentSize);
+                          int fragmentSize,
+                          ReceiveStrands receiveStrands);
 
         virtual ~CommunicationImpl();
 
@@ -102,14 +106,39 @@ namespace Com
                   int64_t dataTypeIdentifier,
                   bool deliveryGuarantee);
 
-        size_t SendQueueCapacity(int64_t /*nodeTypeId*/) const {return Parameters::SendQueueSize;}
+        size_t SendQueueCapacity(int64_t nodeTypeId) const {return GetNodeType(nodeTypeId).GetAckedDataSender().SendQueueCapacity();}
         size_t NumberOfQueuedMessages(int64_t nodeTypeId) const;
+        ReceiveStatistics GetReceiveStatistics() const {return m_reader.GetStatistics();}
         const std::string& Name() const {return m_me.name;}
         int64_t Id() const {return m_me.nodeId;}
         std::string ControlAddress() const {return m_me.controlAddress;}
         std::string DataAddress() const {return m_me.dataAddress;}
 
     private:
+        //Received data from the nodes of one or more node types is handled in the strand of a partition, which has
+        //a DeliveryHandler of its own. Partitions share the deliver strand, so the application is never called concurrently.
+        struct ReceivePartition
+        {
+            ReceivePartition(const boost::asio::io_context::strand& strand_,
+                             boost::asio::io_context& ioContext,
+                             int64_t myNodeId,
+                             int protocol,
+                             int slidingWindowSize,
+                             const boost::asio::io_context::strand& deliverStrand)
+                :strand(strand_)
+                ,deliveryHandler(ioContext, myNodeId, protocol, slidingWindowSize, deliverStrand)
+                ,nackTimer(ioContext)
+                ,nackTimerActive(false)
+            {
+            }
+
+            boost::asio::io_context::strand strand;
+            DeliveryHandler deliveryHandler;
+            boost::asio::steady_timer nackTimer; //runs in strand while the DeliveryHandler has missing messages
+            bool nackTimerActive;
+            GotReceiveFrom gotRecvFrom;
+        };
+
         std::string m_logPrefix;
         std::atomic<bool> m_running;
         boost::asio::io_context& m_ioContext;
@@ -119,19 +148,29 @@ namespace Com
         bool m_isControlInstance;
         NodeTypeMap m_nodeTypes;
 
+        const ReceiveStrands m_receiveStrands;
+
         //Callbacks
         NewNode m_onNewNode;
-        GotReceiveFrom m_gotRecvFrom;
 
         //main components of communication
         Discoverer m_discoverer;
-        DeliveryHandler m_deliveryHandler;
+        boost::asio::io_context::strand m_deliverStrand;
+        std::vector<std::unique_ptr<ReceivePartition>> m_partitions;
+        std::map<int64_t, ReceivePartition*> m_nodeTypePartitions; //nodeTypeId -> partition, not modified after construction
+        mutable std::mutex m_nodePartitionsMutex;
+        std::unordered_map<int64_t, ReceivePartition*> m_nodePartitions; //nodeId -> partition
+        std::atomic<unsigned int> m_pendingReceived; //datagrams posted to a partition strand but not yet handled
         DataReceiver m_reader;
 
         std::unique_ptr<DebugCommandServer> m_debugServer;
 
         //returns true if it is ok to call OnRecv again, false if flooded with received messages
-        bool OnRecv(const char* data, size_t size, bool multicast);
+        bool OnRecv(const Safir::Utilities::Internal::SharedCharArray& buffer, size_t size, bool multicast);
+        void HandleReceived(ReceivePartition& partition, const char* data, size_t size, bool multicast);
+        bool IsReceiverReady() const;
+        ReceivePartition& PartitionOfNode(int64_t nodeId) const;
+        ReceivePartition& PartitionOfNodeType(int64_t nodeTypeId) const;
         void OnNewNode(const Node& node);
 
         //Received internal Communication msg that is not directly passed to application, i.e discover, nodeInfo etc.
@@ -139,6 +178,9 @@ namespace Com
 
         void IncludeNodeInternal(int64_t nodeId);
 
+        //Let the DeliveryHandler report missing messages every Parameters::NackInterval as long as there are any.
+        void StartNackTimer(ReceivePartition& partition);
+
         NodeType& GetNodeType(int64_t nodeTypeId)
         {
             auto findIt = m_nodeTypes.find(nodeTypeId);
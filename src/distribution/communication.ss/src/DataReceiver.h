@@ -24,12 +24,18 @@
 #pragma once
 
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <vector>
 #include <functional>
 #include <boost/chrono.hpp>
 #include <Safir/Utilities/Internal/LowLevelLogger.h>
 #include <Safir/Utilities/Internal/SystemLog.h>
+#include <Safir/Utilities/Internal/SharedCharArray.h>
+#include <Safir/Dob/Internal/Communication.h>
 #include "Parameters.h"
 #include "Message.h"
+#include "Checksum.h"
 #include "Node.h"
 #include "Resolver.h"
 
@@ -45,6 +51,12 @@
 #pragma warning (pop)
 #endif
 
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <errno.h>
+#endif
+
 namespace Safir
 {
 namespace Dob
@@ -53,11 +65,127 @@ namespace Internal
 {
 namespace Com
 {
+    /**
+     * Pool of receive buffers of Parameters::ReceiveBufferSize bytes each. A buffer that is handed out by Get goes back
+     * to the pool when the last reference to it is released, which may happen in any thread. The pool is kept alive
+     * by the buffers that are handed out.
+     */
+    class ReceiveBufferPool : public std::enable_shared_from_this<ReceiveBufferPool>
+    {
+    public:
+        ReceiveBufferPool() {}
+
+        ReceiveBufferPool(const ReceiveBufferPool&) = delete;
+        const ReceiveBufferPool& operator=(const ReceiveBufferPool&) = delete;
+
+        ~ReceiveBufferPool()
+        {
+            for (auto buf : m_free)
+            {
+                delete[] buf;
+            }
+        }
+
+        Safir::Utilities::Internal::SharedCharArray Get()
+        {
+            char* buf=nullptr;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_free.empty())
+                {
+                    buf=m_free.back();
+                    m_free.pop_back();
+                }
+            }
+
+            if (buf==nullptr)
+            {
+                buf=new char[Parameters::ReceiveBufferSize];
+            }
+
+            auto self=shared_from_this();
+            return Safir::Utilities::Internal::SharedCharArray(buf, [self](char* released){self->Put(released);});
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::vector<char*> m_free;
+
+        void Put(char* buf)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_free.push_back(buf);
+        }
+    };
+
+    /**
+     * Buffers for the datagrams that are read from one socket in one wakeup. Datagram i is stored at Data(i) and
+     * its size is sizes[i]. On Linux up to Parameters::ReceiveBatchSize datagrams are read with one recvmmsg call,
+     * on other platforms the capacity is one.
+     * The buffers are reference counted so that onRecv can keep a datagram without copying it. Buffers that are
+     * still referenced when the next read is started are replaced by RenewBuffers.
+     */
+    struct ReceiveBatch
+    {
+        explicit ReceiveBatch(size_t capacity)
+            :pool(std::make_shared<ReceiveBufferPool>())
+            ,buffers(capacity)
+            ,sizes(capacity, 0)
+            ,count(0)
+            ,next(0)
+            ,socketDrops(0)
+            ,waiting(false)
+        {
+            for (auto& buf : buffers)
+            {
+                buf=pool->Get();
+            }
+        }
+
+        ReceiveBatch(const ReceiveBatch&) = delete;
+        const ReceiveBatch& operator=(const ReceiveBatch&) = delete;
+
+        size_t Capacity() const {return sizes.size();}
+        char* Data(size_t index) {return buffers[index].get();}
+        const Safir::Utilities::Internal::SharedCharArray& Buffer(size_t index) const {return buffers[index];}
+
+        //Give every buffer that is still referenced from outside the batch a fresh replacement, so that the next read
+        //does not overwrite data that has been handed over.
+        void RenewBuffers()
+        {
+            for (auto& buf : buffers)
+            {
+                if (buf.use_count()>1)
+                {
+                    buf=pool->Get();
+                }
+            }
+        }
+
+        std::shared_ptr<ReceiveBufferPool> pool;
+        std::vector<Safir::Utilities::Internal::SharedCharArray> buffers;
+        std::vector<size_t> sizes;
+        size_t count; //number of datagrams in the batch
+        size_t next; //next datagram to be handed over to onRecv
+        uint32_t socketDrops; //number of datagrams dropped by the socket since it was opened, if reported by the platform
+        std::atomic<bool> waiting; //true while the receiver is not ready and the rest of the batch is waiting to be handed over
+
+#ifdef __linux__
+        std::vector<struct mmsghdr> msgs;
+        std::vector<struct iovec> iovecs;
+        std::vector<char> control;
+#endif
+    };
+
     /**
      * The DataReceiver class is responsible for receiving data on both unicast and multicast.
      * All received messages are passed to onRecv-callback. DataReceiver is unaware of sequenceNumbers and fragments.
+     * The datagram passed to onRecv starts at buffer.get(). The callback may keep a reference to the buffer, it will
+     * not be overwritten by later reads.
      * If callback onRecv is returning false it means that there is maximum number of messages waiting to be retrieved
      * by the application and in that case DataReceiver will sleep until callback isReceiverReady is returning true again.
+     * With strandPerSocket the unicast and multicast sockets are read, checked and handed over to onRecv in strands of
+     * their own, i.e. onRecv may be called concurrently for the two sockets. Otherwise everything runs in receiveStrand.
      */
     template <class ReaderType>
     class DataReceiverType : private ReaderType
@@ -66,16 +194,29 @@ namespace Com
         DataReceiverType(boost::asio::io_context::strand& receiveStrand,
                          const std::string& unicastAddress,
                          const std::string& multicastAddress,
-                         const std::function<bool(const char*, size_t, bool multicast)>& onRecv,
-                         const std::function<bool(void)>& isReceiverIsReady)
+                         const std::function<bool(const Safir::Utilities::Internal::SharedCharArray& buffer, size_t size, bool multicast)>& onRecv,
+                         const std::function<bool(void)>& isReceiverIsReady,
+                         bool strandPerSocket=false)
             :m_strand(receiveStrand)
-            ,m_timer(m_strand.context(), std::chrono::milliseconds(10))
+            ,m_unicastStrand(strandPerSocket ? boost::asio::io_context::strand(receiveStrand.context()) : receiveStrand)
+            ,m_multicastStrand(strandPerSocket ? boost::asio::io_context::strand(receiveStrand.context()) : receiveStrand)
+            ,m_timer(m_strand.context())
             ,m_checkMcTimer(m_strand.context())
             ,m_onRecv(onRecv)
             ,m_isReceiverReady(isReceiverIsReady)
             ,m_running(false)
             ,m_logPrefix(Parameters::LogPrefix + "DataReceiver - ")
+            ,m_unicastBatch(Parameters::ReceiveBatchSize)
+            ,m_multicastBatch(Parameters::ReceiveBatchSize)
         {
+            m_running=false;
+            m_runCount=0;
+            m_receivedDatagrams=0;
+            m_receiveWakeups=0;
+            m_badCrc=0;
+            m_unicastDrops=0;
+            m_multicastDrops=0;
+
             m_unicastEndpoint = Resolver::StringToEndpoint(unicastAddress);
             if (!multicastAddress.empty())
             {
@@ -100,39 +241,10 @@ namespace Com
             boost::asio::post(m_strand, [this]
             {
                 m_running=true;
-
-                m_socket.reset(new boost::asio::ip::udp::socket(m_strand.context()));
-                m_socket->open(m_unicastEndpoint.protocol());
-                m_socket->set_option(boost::asio::ip::udp::socket::reuse_address(true));
-                m_socket->bind(m_unicastEndpoint);
-                m_socket->set_option(boost::asio::socket_base::receive_buffer_size(Parameters::SocketBufferSize));
-                AsyncReceive(m_bufferUnicast, m_socket.get());
-
+                boost::asio::post(m_unicastStrand, [this]{OpenUnicast();});
                 if (!m_multicastEndpoint.address().is_unspecified())
                 {
-                    m_multicastSocket.reset(new boost::asio::ip::udp::socket(m_strand.context()));
-                    m_multicastSocket->open(m_multicastEndpoint.protocol());
-                    m_multicastSocket->set_option(boost::asio::ip::udp::socket::reuse_address(true));
-                    m_multicastSocket->set_option(boost::asio::ip::multicast::enable_loopback(true));
-
-                    //to join mcGroup with specific interface, the address must be a IPv4. Bug report https://svn.boost.org/trac/boost/ticket/3247
-                    m_multicastSocket->bind(boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::any(), m_multicastEndpoint.port())); //bind to all interfaces and the multicast port
-
-                    boost::system::error_code ec;
-                    m_multicastSocket->set_option(boost::asio::socket_base::receive_buffer_size(Parameters::SocketBufferSize), ec);
-                    m_multicastSocket->set_option(boost::asio::ip::multicast::join_group(m_multicastEndpoint.address().to_v4(), m_unicastEndpoint.address().to_v4()), ec); //join group on specific interface
-                    if (ec)
-                    {
-                        lllog(7)<<m_logPrefix.c_str()<<L"Failed to join multicast group. Will try again in a while."<<std::endl;
-                    }
-                    else
-                    {
-                        AsyncReceive(m_bufferMulticast, m_multicastSocket.get());
-                    }
-
-                    m_lastMcRecv = std::chrono::steady_clock::now();
-                    m_checkMcTimer.expires_after(std::chrono::milliseconds(Parameters::SendPingThreshold * 2));
-                    m_checkMcTimer.async_wait(boost::asio::bind_executor(m_strand, [this](const boost::system::error_code&){CheckMulticast();}));
+                    boost::asio::post(m_multicastStrand, [this]{OpenMulticast();});
                 }
             });
         }
@@ -143,50 +255,149 @@ namespace Com
             {
                 m_running=false;
                 m_timer.cancel();
-                m_checkMcTimer.cancel();
                 ++m_runCount;
-
-                if (m_socket && m_socket->is_open())
-                {
-                    m_socket->cancel();
-                    m_socket->close();
-                    m_socket.reset();
-                }
-                if (m_multicastSocket && m_multicastSocket->is_open())
-                {
-                    m_multicastSocket->cancel();
-                    m_multicastSocket->close();
-                    m_multicastSocket.reset();
-                }
+                boost::asio::post(m_unicastStrand, [this]{CloseUnicast();});
+                boost::asio::post(m_multicastStrand, [this]{CloseMulticast();});
             });
         }
 
+        //Tell the DataReceiver that the receiver has become ready for more data. If reading has been paused due to
+        //a receiver that was not ready it is resumed immediately. Can be called from any thread.
+        void ResumeReceive()
+        {
+            boost::asio::post(m_unicastStrand, [this]{ResumeWaiting(m_unicastBatch);});
+            boost::asio::post(m_multicastStrand, [this]{ResumeWaiting(m_multicastBatch);});
+        }
+
+        //Can be called from any thread
+        ReceiveStatistics GetStatistics() const
+        {
+            ReceiveStatistics stat;
+            stat.receivedDatagrams=m_receivedDatagrams;
+            stat.receiveWakeups=m_receiveWakeups;
+            stat.badCrc=m_badCrc;
+            stat.droppedDatagrams=m_unicastDrops+m_multicastDrops;
+            return stat;
+        }
+
 #ifndef SAFIR_TEST
     private:
 #endif
-        boost::asio::io_context::strand& m_strand;
+        boost::asio::io_context::strand& m_strand;          //start, stop and the watchdog
+        boost::asio::io_context::strand m_unicastStrand;    //everything that has to do with the unicast socket
+        boost::asio::io_context::strand m_multicastStrand;  //everything that has to do with the multicast socket
         boost::asio::steady_timer m_timer;
         boost::asio::steady_timer m_checkMcTimer;
-        std::function<bool(const char*, size_t, bool multicast)> m_onRecv;
+        std::function<bool(const Safir::Utilities::Internal::SharedCharArray& buffer, size_t size, bool multicast)> m_onRecv;
         std::function<bool(void)> m_isReceiverReady;
         std::unique_ptr<boost::asio::ip::udp::socket> m_socket;
         std::unique_ptr<boost::asio::ip::udp::socket> m_multicastSocket;
         boost::asio::ip::udp::endpoint m_unicastEndpoint;
         boost::asio::ip::udp::endpoint m_multicastEndpoint;
-        bool m_running;
+        std::atomic<bool> m_running;
         std::string m_logPrefix;
 
-        unsigned int m_runCount = 0;
+        std::atomic<unsigned int> m_runCount;
         std::chrono::time_point<std::chrono::steady_clock> m_lastMcRecv;
-        char m_bufferUnicast[Parameters::ReceiveBufferSize];
-        char m_bufferMulticast[Parameters::ReceiveBufferSize];
+        ReceiveBatch m_unicastBatch;
+        ReceiveBatch m_multicastBatch;
+
+        std::atomic<uint64_t> m_receivedDatagrams;
+        std::atomic<uint64_t> m_receiveWakeups;
+        std::atomic<uint64_t> m_badCrc;
+        std::atomic<uint32_t> m_unicastDrops;
+        std::atomic<uint32_t> m_multicastDrops;
+
+        void OpenUnicast()
+        {
+            m_socket.reset(new boost::asio::ip::udp::socket(m_strand.context()));
+            m_socket->open(m_unicastEndpoint.protocol());
+            m_socket->set_option(boost::asio::ip::udp::socket::reuse_address(true));
+            m_socket->bind(m_unicastEndpoint);
+            m_socket->set_option(boost::asio::socket_base::receive_buffer_size(Parameters::SocketBufferSize));
+            EnableDropCounter(m_socket.get());
+            ResetBatch(m_unicastBatch);
+            AsyncReceive(m_unicastBatch, m_socket.get());
+        }
+
+        void OpenMulticast()
+        {
+            m_multicastSocket.reset(new boost::asio::ip::udp::socket(m_strand.context()));
+            m_multicastSocket->open(m_multicastEndpoint.protocol());
+            m_multicastSocket->set_option(boost::asio::ip::udp::socket::reuse_address(true));
+            m_multicastSocket->set_option(boost::asio::ip::multicast::enable_loopback(true));
+
+            //to join mcGroup with specific interface, the address must be a IPv4. Bug report https://svn.boost.org/trac/boost/ticket/3247
+            m_multicastSocket->bind(boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::any(), m_multicastEndpoint.port())); //bind to all interfaces and the multicast port
+
+            boost::system::error_code ec;
+            m_multicastSocket->set_option(boost::asio::socket_base::receive_buffer_size(Parameters::SocketBufferSize), ec);
+            EnableDropCounter(m_multicastSocket.get());
+            ResetBatch(m_multicastBatch);
+            m_multicastSocket->set_option(boost::asio::ip::multicast::join_group(m_multicastEndpoint.address().to_v4(), m_unicastEndpoint.address().to_v4()), ec); //join group on specific interface
+            if (ec)
+            {
+                lllog(7)<<m_logPrefix.c_str()<<L"Failed to join multicast group. Will try again in a while."<<std::endl;
+            }
+            else
+            {
+                AsyncReceive(m_multicastBatch, m_multicastSocket.get());
+            }
+
+            m_lastMcRecv = std::chrono::steady_clock::now();
+            m_checkMcTimer.expires_after(std::chrono::milliseconds(Parameters::SendPingThreshold * 2));
+            m_checkMcTimer.async_wait(boost::asio::bind_executor(m_multicastStrand, [this](const boost::system::error_code&){CheckMulticast();}));
+        }
+
+        void CloseUnicast()
+        {
+            if (m_socket && m_socket->is_open())
+            {
+                m_socket->cancel();
+                m_socket->close();
+                m_socket.reset();
+            }
+        }
+
+        void CloseMulticast()
+        {
+            m_checkMcTimer.cancel();
+            if (m_multicastSocket && m_multicastSocket->is_open())
+            {
+                m_multicastSocket->cancel();
+                m_multicastSocket->close();
+                m_multicastSocket.reset();
+            }
+        }
+
+        static void ResetBatch(ReceiveBatch& batch)
+        {
+            batch.count=0;
+            batch.next=0;
+            batch.socketDrops=0;
+            batch.waiting=false;
+        }
 
-        void AsyncReceive(char* buf, boost::asio::ip::udp::socket* socket)
+        void EnableDropCounter(boost::asio::ip::udp::socket* socket)
         {
-            ReaderType::AsyncReceive(buf,
-                                     Parameters::ReceiveBufferSize,
-                                     socket,
-                                     [this, buf, socket](const boost::system::error_code& error, size_t bytesRecv)
+#ifdef __linux__
+            //ask the kernel to report the number of datagrams dropped by the socket together with received data
+            const int on=1;
+            if (::setsockopt(socket->native_handle(), SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on))!=0)
+            {
+                lllog(7)<<m_logPrefix.c_str()<<L"Failed to enable SO_RXQ_OVFL, dropped datagrams will not be counted."<<std::endl;
+            }
+#else
+            (void)socket;
+#endif
+        }
+
+        void AsyncReceive(ReceiveBatch& batch, boost::asio::ip::udp::socket* socket)
+        {
+            batch.RenewBuffers();
+            ReaderType::AsyncReceiveMultiple(batch,
+                                             socket,
+                                             [this, &batch, socket](const boost::system::error_code& error, size_t count)
             {
                 //if an error occured, log the error and stop
                 if (error == boost::asio::error::operation_aborted)
@@ -210,12 +421,12 @@ namespace Com
                     return;
                 }
 
-                auto runCount = m_runCount; // make copy
-                boost::asio::post(m_strand, [this, runCount, bytesRecv, buf, socket]
+                unsigned int runCount = m_runCount; // make copy
+                boost::asio::post(StrandOf(batch), [this, runCount, count, &batch, socket]
                 {
                     if (runCount == m_runCount)
                     {
-                        HandleReceive(bytesRecv, buf, socket);
+                        HandleReceive(count, batch, socket);
                     }
                     else
                     {
@@ -229,13 +440,10 @@ namespace Com
 
         bool ValidCrc(const char* buf, size_t size)
         {
-            boost::crc_32_type crc;
-            crc.process_bytes(static_cast<const void*>(buf), size-sizeof(uint32_t));
-            uint32_t checksum=*reinterpret_cast<const uint32_t*>(buf+size-sizeof(uint32_t));
-            return checksum==crc.checksum();
+            return Checksum::IsValid(buf, size);
         }
 
-        void HandleReceive(size_t bytesRecv, char* buf, boost::asio::ip::udp::socket* socket)
+        void HandleReceive(size_t count, ReceiveBatch& batch, boost::asio::ip::udp::socket* socket)
         {
             //if we have got at stop-order just return and dont start a new read
             if (!m_running)
@@ -243,13 +451,59 @@ namespace Com
                 return;
             }
 
+            batch.count=count;
+            batch.next=0;
+            ++m_receiveWakeups;
+            m_receivedDatagrams+=count;
+            if (socket == m_multicastSocket.get())
+            {
+                m_multicastDrops=batch.socketDrops;
+            }
+            else
+            {
+                m_unicastDrops=batch.socketDrops;
+            }
+
+            HandleBatch(batch, socket);
+        }
+
+        //Hand over the datagrams in the batch to onRecv until the batch is empty or the receiver is not ready
+        //for more data. Then start a new read or wait for the receiver.
+        void HandleBatch(ReceiveBatch& batch, boost::asio::ip::udp::socket* socket)
+        {
+            bool receiverReady=true;
+
+            while (receiverReady && batch.next<batch.count)
+            {
+                const size_t index=batch.next++;
+                receiverReady=HandleDatagram(batch.sizes[index], batch.Buffer(index), socket);
+            }
+
+            if (receiverReady)
+            {
+                //receiver is keeping up with our pace, continue to read incoming messages
+                AsyncReceive(batch, socket);
+            }
+            else
+            {
+                // we must wait until the receiver is ready before delivering more messages
+                lllog(7)<<m_logPrefix.c_str()<<L"Reader has to wait for application to handle delivered messages"<<std::endl;
+                batch.waiting=true;
+                StartWatchdog();
+            }
+        }
+
+        //Returns true if receiver is ready to handle more data
+        bool HandleDatagram(size_t bytesRecv, const Safir::Utilities::Internal::SharedCharArray& buffer, boost::asio::ip::udp::socket* socket)
+        {
+            const char* buf=buffer.get();
             bool receiverReady=true;
 
             if (!Parameters::NetworkEnabled)
             {
                 //ignore the packet
             }
-            else if (ValidCrc(buf, bytesRecv))
+            else if (bytesRecv>sizeof(uint32_t) && ValidCrc(buf, bytesRecv))
             {
                 const bool multicast = socket == m_multicastSocket.get();
                 if (multicast)
@@ -261,13 +515,14 @@ namespace Com
                 {
                     lllog(9)<<m_logPrefix.c_str()<<L"received unicast"<<std::endl;
                 }
-                    
+
                 //received message with correct checksum
-                receiverReady=m_onRecv(buf, bytesRecv-sizeof(uint32_t), multicast); //Remove the crc from size. Will return true if it is ready to handle a new message immediately
+                receiverReady=m_onRecv(buffer, bytesRecv-sizeof(uint32_t), multicast); //Remove the crc from size. Will return true if it is ready to handle a new message immediately
             }
             else
             {
                 //received message with invalid checksum. Throw away the message and then continue as normal.
+                ++m_badCrc;
                 std::ostringstream os;
                 os<<m_logPrefix.c_str()<<"Received message with bad CRC, size="<<bytesRecv<<". Throw away and continue."<<std::endl;
                 if (bytesRecv>CommonHeaderSize)
@@ -279,42 +534,57 @@ namespace Com
                 receiverReady=m_isReceiverReady(); //explicitly ask if receiver is ready to handle incoming data
             }
 
-            if (receiverReady)
-            {
-                //receiver is keeping up with our pace, continue to read incoming messages
-                AsyncReceive(buf, socket);
-            }
-            else
-            {
-                // we must wait for a while before delivering more messages
-                lllog(7)<<m_logPrefix.c_str()<<L"Reader has to wait for application to handle delivered messages"<<std::endl;
-                SetWakeUpTimer(buf, socket);
-            }
+            return receiverReady;
+        }
+
+        boost::asio::ip::udp::socket* SocketOf(const ReceiveBatch& batch) const
+        {
+            return &batch==&m_unicastBatch ? m_socket.get() : m_multicastSocket.get();
         }
 
-        void SetWakeUpTimer(char* buf, boost::asio::ip::udp::socket* socket)
+        boost::asio::io_context::strand& StrandOf(const ReceiveBatch& batch)
         {
-            m_timer.expires_after(std::chrono::milliseconds(10));
-            m_timer.async_wait(boost::asio::bind_executor(m_strand, [this,buf,socket](const boost::system::error_code& error){WakeUpAfterSleep(error, buf, socket);}));
+            return &batch==&m_unicastBatch ? m_unicastStrand : m_multicastStrand;
         }
 
-        void WakeUpAfterSleep(const boost::system::error_code& /*error*/, char* buf, boost::asio::ip::udp::socket* socket)
+        //Continue with a batch that is waiting for the receiver, if the receiver has become ready. Called from the strand of the batch.
+        void ResumeWaiting(ReceiveBatch& batch)
         {
             if (!m_running)
             {
                 return;
             }
 
-            if (m_isReceiverReady())
+            if (batch.waiting && m_isReceiverReady())
             {
-                lllog(7)<<m_logPrefix.c_str()<<L"Reader wakes up from sleep and starts receiving again"<<std::endl;
-                AsyncReceive(buf, socket);
+                lllog(7)<<m_logPrefix.c_str()<<L"Receiver is ready, reader starts receiving again"<<std::endl;
+                batch.waiting=false;
+                HandleBatch(batch, SocketOf(batch)); //deliver what is left in the batch before reading again
             }
-            else
+        }
+
+        //The receiver is expected to call ResumeReceive when it is ready again. The watchdog is a safety net
+        //in case it does not, and then checks if the receiver is ready at a low pace.
+        void StartWatchdog()
+        {
+            boost::asio::post(m_strand, [this]
             {
-                lllog(7)<<m_logPrefix.c_str()<<L"Reader wakes up but must go back to sleep until application is ready"<<std::endl;
-                SetWakeUpTimer(buf, socket);
-            }
+                m_timer.expires_after(std::chrono::milliseconds(Parameters::ReceiverWatchdogInterval));
+                m_timer.async_wait(boost::asio::bind_executor(m_strand, [this](const boost::system::error_code& error)
+                {
+                    if (error || !m_running)
+                    {
+                        return; //cancelled by Stop or by a restarted watchdog
+                    }
+
+                    if (m_unicastBatch.waiting || m_multicastBatch.waiting)
+                    {
+                        lllog(7)<<m_logPrefix.c_str()<<L"Reader wakes up, continues if the application is ready"<<std::endl;
+                        ResumeReceive();
+                        StartWatchdog();
+                    }
+                }));
+            });
         }
 
         void CheckMulticast()
@@ -343,13 +613,13 @@ namespace Com
                         m_multicastSocket->set_option(boost::asio::ip::multicast::join_group(m_multicastEndpoint.address().to_v4(), m_unicastEndpoint.address().to_v4()), ec); //join group on specific interface
 
                         // start a new async_read
-                        boost::asio::post(m_strand, [this]{AsyncReceive(m_bufferMulticast, m_multicastSocket.get());});
+                        boost::asio::post(m_multicastStrand, [this]{AsyncReceive(m_multicastBatch, m_multicastSocket.get());});
                     }
                 }
             }
 
             m_checkMcTimer.expires_after(std::chrono::milliseconds(Parameters::SendPingThreshold));
-            m_checkMcTimer.async_wait(boost::asio::bind_executor(m_strand, [this](const boost::system::error_code&){CheckMulticast();}));
+            m_checkMcTimer.async_wait(boost::asio::bind_executor(m_multicastStrand, [this](const boost::system::error_code&){CheckMulticast();}));
         }
     };
 
@@ -372,8 +642,91 @@ namespace Com
             }
         }
 
+        //Read as many datagrams as are available, up to batch.Capacity(), and call completionHandler with the number of
+        //datagrams read. The datagrams are stored in batch.
+        void AsyncReceiveMultiple(ReceiveBatch& batch,
+                                  boost::asio::ip::udp::socket* socket,
+                                  const std::function< void(const boost::system::error_code&, size_t) >& completionHandler)
+        {
+#ifdef __linux__
+            if (Parameters::NetworkEnabled && batch.Capacity()>1)
+            {
+                socket->async_wait(boost::asio::socket_base::wait_read,
+                                   [this, &batch, socket, completionHandler](const boost::system::error_code& ec)
+                {
+                    if (ec)
+                    {
+                        completionHandler(ec, 0);
+                        return;
+                    }
+
+                    const int count=ReceiveAvailable(batch, socket);
+                    if (count>0)
+                    {
+                        completionHandler(boost::system::error_code(), static_cast<size_t>(count));
+                    }
+                    else if (count==0 || errno==EAGAIN || errno==EWOULDBLOCK || errno==EINTR)
+                    {
+                        AsyncReceiveMultiple(batch, socket, completionHandler); //spurious wakeup, wait again
+                    }
+                    else
+                    {
+                        completionHandler(boost::system::error_code(errno, boost::asio::error::get_system_category()), 0);
+                    }
+                });
+                return;
+            }
+#endif
+            AsyncReceive(batch.Data(0), Parameters::ReceiveBufferSize, socket,
+                         [&batch, completionHandler](const boost::system::error_code& ec, size_t size)
+            {
+                batch.sizes[0]=size;
+                completionHandler(ec, ec ? 0 : 1);
+            });
+        }
+
     private:
 
+#ifdef __linux__
+        //Non-blocking read of all available datagrams with one system call. Returns number of datagrams read or -1 with errno set.
+        int ReceiveAvailable(ReceiveBatch& batch, boost::asio::ip::udp::socket* socket)
+        {
+            const size_t capacity=batch.Capacity();
+            const size_t controlSize=CMSG_SPACE(sizeof(uint32_t));
+            batch.msgs.assign(capacity, mmsghdr());
+            batch.iovecs.resize(capacity);
+            batch.control.assign(capacity*controlSize, 0);
+
+            for (size_t i=0; i<capacity; ++i)
+            {
+                batch.iovecs[i].iov_base=batch.Data(i);
+                batch.iovecs[i].iov_len=Parameters::ReceiveBufferSize;
+                struct msghdr& hdr=batch.msgs[i].msg_hdr;
+                hdr.msg_iov=&batch.iovecs[i];
+                hdr.msg_iovlen=1;
+                hdr.msg_control=batch.control.data()+i*controlSize;
+                hdr.msg_controllen=controlSize;
+            }
+
+            const int count=::recvmmsg(socket->native_handle(), batch.msgs.data(), static_cast<unsigned int>(capacity), MSG_DONTWAIT, nullptr);
+            for (int i=0; i<count; ++i)
+            {
+                struct msghdr& hdr=batch.msgs[i].msg_hdr;
+                batch.sizes[i]=batch.msgs[i].msg_len;
+                for (struct cmsghdr* cmsg=CMSG_FIRSTHDR(&hdr); cmsg!=nullptr; cmsg=CMSG_NXTHDR(&hdr, cmsg))
+                {
+                    if (cmsg->cmsg_level==SOL_SOCKET && cmsg->cmsg_type==SO_RXQ_OVFL)
+                    {
+                        uint32_t drops=0;
+                        memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+                        batch.socketDrops=std::max(batch.socketDrops, drops);
+                    }
+                }
+            }
+            return count;
+        }
+#endif
+
         void SimulateSilence(char* buf,
                              size_t bufSize,
                              boost::asio::ip::udp::socket* socket,
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <map>
+#include <deque>
 #include <memory>
 #include <atomic>
 #include <functional>
@@ -31,6 +32,7 @@
 #include <Safir/Utilities/Internal/SystemLog.h>
 #include <Safir/Utilities/Internal/SharedCharArray.h>
 #include "Node.h"
+#include "FragmentPool.h"
 #include "MessageQueue.h"
 #include "Parameters.h"
 #include "Writer.h"
@@ -84,7 +86,10 @@ namespace Com
                         int slidingWindowSize,
                         int ackRequestThreshold,
                         const std::vector<int>& retryTimeout,
-                        int fragmentSize)
+                        int fragmentSize,
+                        size_t sendQueueSize=Parameters::SendQueueSize,
+                        bool adaptiveWindow=false,
+                        bool coalesceMessages=false)
             :WriterType(ioContext, ipVersion, localIf, multicastAddress)
             ,m_strand(ioContext)
             ,m_deliveryGuarantee(deliveryGuarantee)
@@ -92,19 +97,40 @@ namespace Com
             ,m_nodeId(nodeId)
             ,m_slidingWindowSize(static_cast<size_t>(slidingWindowSize))
             ,m_ackRequestThreshold(static_cast<size_t>(ackRequestThreshold))
-            ,m_sendQueue(Parameters::SendQueueSize)
+            ,m_adaptiveWindow(adaptiveWindow)
+            ,m_minWindowSize(std::min(std::max(m_ackRequestThreshold, static_cast<size_t>(1)), m_slidingWindowSize))
+            ,m_windowSize(adaptiveWindow ? m_minWindowSize : m_slidingWindowSize)
+            ,m_slowStartThreshold(m_slidingWindowSize)
+            ,m_ackedInWindow(0)
+            ,m_sendQueueCapacity(sendQueueSize)
+            ,m_fragmentPool(std::make_shared<FragmentPool>(sizeof(UserData)+FragmentPool::SharedCountSize, sendQueueSize))
+            ,m_sendQueue(sendQueueSize)
             ,m_running(false)
             ,m_retryTimeout(retryTimeout)
             ,m_fragmentDataSize(static_cast<size_t>(fragmentSize)-MessageHeaderSize)
             ,m_nodes()
+            ,m_slotNodeIds()
+            ,m_firstQueuePosition(0)
+            ,m_nextQueuePosition(0)
+            ,m_multiReceiverIndex()
             ,m_lastSentMultiReceiverSeqNo(0)
             ,m_lastAckRequestMultiReceiver(0)
             ,m_resendTimer(ioContext)
             ,m_pingTimer(ioContext)
             ,m_retransmitNotification()
             ,m_queueNotFullNotification()
-            ,m_queueNotFullNotificationLimit(Parameters::SendQueueSize/2)
+            ,m_queueNotFullNotificationLimit(sendQueueSize/2)
             ,m_sendAckRequestForMsgIndex()
+            ,m_coalesceMessages(coalesceMessages)
+            ,m_maxCoalescedSize(std::min(Parameters::MaxCoalescedMessageSize, m_fragmentDataSize/2))
+            ,m_coalescing()
+            ,m_coalescingBuffer(nullptr)
+            ,m_coalescingPosition(0)
+            ,m_handleSendQueuePosted(false)
+            ,m_rttBasedRetryTimeout(Parameters::RttBasedRetryTimeout)
+            ,m_maxRetryTimeout(std::chrono::milliseconds(*std::max_element(retryTimeout.begin(), retryTimeout.end())))
+            ,m_retryCheckInterval(std::chrono::milliseconds(*std::min_element(retryTimeout.begin(), retryTimeout.end()) / 2))
+            ,m_slotRetryTimeout()
             ,m_logPrefix(GenerateLogPrefix(deliveryGuarantee,nodeTypeId))
         {
             m_sendQueueSize=0;
@@ -130,6 +156,9 @@ namespace Com
                 lllog(5)<<m_logPrefix.c_str()<<"Start DataSender"<<std::endl;
                 m_lastSentMultiReceiverSeqNo = 0;
                 m_lastAckRequestMultiReceiver = 0;
+                m_windowSize = m_adaptiveWindow ? m_minWindowSize : m_slidingWindowSize;
+                m_slowStartThreshold = m_slidingWindowSize;
+                m_ackedInWindow = 0;
 
                 m_running=true;
                 //start retransmit timer
@@ -165,8 +194,11 @@ namespace Com
 
                 m_sendQueueSize=0;
                 m_notifyQueueNotFull=false;
-                m_sendQueue.clear_queue();
+                ClearQueue();
                 m_nodes.clear();
+                m_slotNodeIds.clear();
+                m_slotRetryTimeout.clear();
+                m_coalescing.reset();
                 m_sendAckRequestForMsgIndex.clear();
                 RemoveExcludedReceivers();
                 RemoveCompletedMessages();
@@ -186,7 +218,7 @@ namespace Com
             size_t restSize=size%m_fragmentDataSize;
             size_t totalNumberOfFragments=numberOfFullFragments+(restSize>0 ? 1 : 0);
 
-            if (++m_sendQueueSize<=Parameters::SendQueueSize)
+            if (++m_sendQueueSize<=m_sendQueueCapacity)
             {
                 //there is room for at least one fragment within the queue limit.
                 //then we step up the total amount, even if it will exceed the queue limit. Send queue will handle this case.
@@ -200,6 +232,33 @@ namespace Com
                 return m_deliveryGuarantee!=Acked; //return Acked->false, Unacked->true
             }
 
+            if (m_coalesceMessages && size+CoalescedHeaderSize<=m_maxCoalescedSize && !IsCommunicationDataType(dataTypeIdentifier))
+            {
+                //Small message that is copied into a shared datagram. Sending is deferred until the messages that are already
+                //posted to the strand have been added, so that a burst of small messages ends up in as few datagrams as possible.
+                boost::asio::post(m_strand, [this, toId, msg, size, dataTypeIdentifier]
+                {
+                    if (!m_running)
+                    {
+                        return;
+                    }
+
+                    uint8_t sendMethod;
+                    uint64_t* sequenceSerie=GetSequenceSerieIfExist(toId, sendMethod);
+                    if (sequenceSerie==nullptr)
+                    {
+                        --m_sendQueueSize;
+                        lllog(9)<<m_logPrefix.c_str()<<"Receiver does not exist. Message will not be sent."<<std::endl;
+                        return;
+                    }
+
+                    Coalesce(toId, sendMethod, *sequenceSerie, msg.get(), size, dataTypeIdentifier);
+                    PostHandleSendQueue();
+                });
+
+                return true;
+            }
+
             //The actual work where the data is inserted in the queue must be done inside the strand.
             boost::asio::post(m_strand, [this, toId, totalNumberOfFragments, numberOfFullFragments, msg, size, restSize, dataTypeIdentifier]
             {
@@ -222,7 +281,7 @@ namespace Com
                 {
                     ++(*sequenceSerie);
                     const char* fragment=msg.get()+frag*m_fragmentDataSize;
-                    UserDataPtr userData(new UserData(m_nodeId, toId, dataTypeIdentifier, msg, size, fragment, m_fragmentDataSize));
+                    UserDataPtr userData=NewUserData(m_nodeId, toId, dataTypeIdentifier, msg, size, fragment, m_fragmentDataSize);
                     userData->header.commonHeader.receiverId=toId;
                     userData->header.sendMethod=sendMethod;
                     userData->header.sequenceNumber=*sequenceSerie;
@@ -230,14 +289,14 @@ namespace Com
                     userData->header.numberOfFragments=static_cast<uint16_t>(totalNumberOfFragments);
                     userData->header.fragmentNumber=static_cast<uint16_t>(frag);
                     SetRequestAck(userData->header);
-                    m_sendQueue.enqueue(userData);
+                    Enqueue(userData);
                 }
 
                 if (restSize>0)
                 {
                     ++(*sequenceSerie);
                     const char* fragment=msg.get()+numberOfFullFragments*m_fragmentDataSize;
-                    UserDataPtr userData(new UserData(m_nodeId, toId, dataTypeIdentifier, msg, size, fragment, restSize));
+                    UserDataPtr userData=NewUserData(m_nodeId, toId, dataTypeIdentifier, msg, size, fragment, restSize);
                     userData->header.commonHeader.receiverId=toId;
                     userData->header.sendMethod=sendMethod;
                     userData->header.sequenceNumber=*sequenceSerie;
@@ -245,7 +304,7 @@ namespace Com
                     userData->header.numberOfFragments=static_cast<uint16_t>(totalNumberOfFragments);
                     userData->header.fragmentNumber=static_cast<uint16_t>(totalNumberOfFragments-1);
                     SetRequestAck(userData->header);
-                    m_sendQueue.enqueue(userData);
+                    Enqueue(userData);
                 }
 
                 HandleSendQueue();
@@ -269,49 +328,18 @@ namespace Com
 
                 lllog(9)<<m_logPrefix.c_str()<<"HandleAck "<<ack.ToString().c_str()<<std::endl;
 
-                //Update queue
-                for (size_t i=0; i<m_sendQueue.first_unhandled_index(); ++i)
-                {
-                    UserDataPtr& ud=m_sendQueue[i];
+                typename WriterType::ScopedBatch batch(*this); //immediate retransmits are sent together
+                bool retransmitted=false;
 
-                    auto receiverListIt=ud->receivers.find(ack.commonHeader.senderId);
-                    if (receiverListIt==ud->receivers.end())
-                    {
-                        //the ack-sender is not a receiver of this message, continue
-                        continue;
-                    }
-
-                    if (ud->header.sendMethod==ack.sendMethod && ud->header.sequenceNumber<=ack.sequenceNumber)
-                    {
-                        //calculate index in missing-array
-                        size_t index=static_cast<size_t>(ack.sequenceNumber-ud->header.sequenceNumber);
-
-                        if (index>m_slidingWindowSize-1)
-                        {
-                            std::ostringstream os;
-                            os<<m_logPrefix<<"Programming Error! Index out of range. Calculated missing index: "<<index<<". AckContent: "<<ack.ToString()<<"\n"<<SendQueueToString();
-                            lllog(1)<<os.str().c_str()<<std::endl;
-                            SEND_SYSTEM_LOG(Error, <<os.str().c_str()<<std::endl);
-                            throw std::logic_error(os.str());
-                        }
+                const auto senderIt=m_nodes.find(ack.commonHeader.senderId);
+                if (senderIt!=m_nodes.end())
+                {
+                    retransmitted=UpdateQueue(ack, senderIt->second);
+                }
 
-                        if (ack.missing[index]!=1)
-                        {
-                            ud->receivers.erase(receiverListIt);
-                        }
-                        else
-                        {
-                            //AckSender is missing a message.
-                            //if the message has already been transmitted 2 times (i.e retransmitted 1 time), we fall back on the retransmit timeouts only.
-                            //This is because every ack will have the missign message marked in the missing list and the retransmit count will explode if
-                            //we retransmit for every ack received.
-                            if (ud->transmitCount<2)
-                            {
-                                //resend immediately if we have not retransmitted this message before
-                                RetransmitMessage(ud);
-                            }
-                        }
-                    }
+                if (retransmitted)
+                {
+                    DecreaseWindow();
                 }
 
                 //Remove from beginning as long as all is acked
@@ -336,7 +364,12 @@ namespace Com
                 ni.endpoint=Resolver::StringToEndpoint(address);
                 ni.lastSentSeqNo=0;
                 ni.welcome=UINT64_MAX;
+                ni.ackedSingleReceiverSeqNo=0;
+                ni.ackedMultiReceiverSeqNo=0;
                 ni.systemNode=false;
+                ni.srtt=std::chrono::steady_clock::duration::zero();
+                ni.rttvar=std::chrono::steady_clock::duration::zero();
+                ni.slot=AllocateSlot(id);
                 m_nodes.insert(std::make_pair(id, ni));
             });
         }
@@ -374,7 +407,13 @@ namespace Com
         {
             boost::asio::post(m_strand, [this, id]
             {
-                m_nodes.erase(id);
+                const auto it=m_nodes.find(id);
+                if (it!=m_nodes.end())
+                {
+                    m_slotNodeIds[it->second.slot]=0; //free the slot, it is removed from all receiver sets below
+                    m_slotRetryTimeout[it->second.slot]=std::chrono::steady_clock::duration::zero();
+                    m_nodes.erase(it);
+                }
                 RemoveExcludedReceivers();
                 RemoveCompletedMessages();
             });
@@ -385,6 +424,17 @@ namespace Com
             return m_sendQueueSize;
         }
 
+        size_t SendQueueCapacity() const
+        {
+            return m_sendQueueCapacity;
+        }
+
+        //Use CRC32C checksum, see NodeType::SetNodeFeatures
+        void SetCrc32c(bool crc32c)
+        {
+            WriterType::SetCrc32c(crc32c);
+        }
+
 #ifndef SAFIR_TEST
     private:
 #endif
@@ -392,12 +442,45 @@ namespace Com
         //we make it explicitly available in this class, so we can call it without qualification.
         using WriterType::IsMulticastEnabled;
 
+        //Queue positions of the messages in one sequence number serie. Messages in a serie have consecutive sequence numbers
+        //and are added to and removed from the sendQueue in order, hence the position of a message can be found directly.
+        //Positions are counted from the first message ever added to the sendQueue.
+        struct SequenceIndex
+        {
+            uint64_t firstSeqNo=0;
+            std::deque<uint64_t> positions;
+
+            void Add(uint64_t seqNo, uint64_t position)
+            {
+                if (positions.empty())
+                {
+                    firstSeqNo=seqNo;
+                }
+                positions.push_back(position);
+            }
+
+            void RemoveFront(uint64_t position)
+            {
+                if (!positions.empty() && positions.front()==position)
+                {
+                    positions.pop_front();
+                    ++firstSeqNo;
+                }
+            }
+        };
+
         struct NodeInfo
         {
             bool systemNode;
             boost::asio::ip::udp::endpoint endpoint;
             uint64_t lastSentSeqNo; //last used, added to sendQueue, not necessarily sent.
             uint64_t welcome;
+            size_t slot; //index used for this node in UserData::receivers
+            SequenceIndex singleReceiverIndex; //queue positions of SingleReceiverSendMethod messages to this node
+            uint64_t ackedSingleReceiverSeqNo; //all messages up to this seq are acked, or not waiting for ack from this node
+            uint64_t ackedMultiReceiverSeqNo;
+            std::chrono::steady_clock::duration srtt;   //smoothed round trip time, zero until the first measurement
+            std::chrono::steady_clock::duration rttvar; //round trip time variation
         };
 
         boost::asio::io_context::strand m_strand;
@@ -406,12 +489,23 @@ namespace Com
         const int64_t m_nodeId;
         const size_t m_slidingWindowSize;
         const size_t m_ackRequestThreshold;
+        const bool m_adaptiveWindow;        //if true the window is adjusted between m_minWindowSize and m_slidingWindowSize
+        const size_t m_minWindowSize;
+        size_t m_windowSize;                //current number of messages allowed to be sent before waiting for ack
+        size_t m_slowStartThreshold;        //below this the window grows by one for every acked message, above by one per window
+        size_t m_ackedInWindow;
+        const size_t m_sendQueueCapacity;
+        std::shared_ptr<FragmentPool> m_fragmentPool; //UserData for the sendQueue, recycled when the last reference is released
         MessageQueue<UserDataPtr> m_sendQueue;
         std::atomic<unsigned int> m_sendQueueSize;
         std::atomic<bool> m_running;
         const std::vector<int> m_retryTimeout;
         const size_t m_fragmentDataSize; //size of a fragments data part, excluding header size.
         std::map<int64_t, NodeInfo> m_nodes;
+        std::vector<int64_t> m_slotNodeIds; //nodeId for every slot, 0 if the slot is free
+        uint64_t m_firstQueuePosition; //position of m_sendQueue.front()
+        uint64_t m_nextQueuePosition;
+        SequenceIndex m_multiReceiverIndex; //queue positions of MultiReceiverSendMethod messages
         uint64_t m_lastSentMultiReceiverSeqNo; // used both for multicast and unicast as long as the message is a multireceiver message. Actually it is lastUsedSeq since message may not have been sent yet.
         uint64_t m_lastAckRequestMultiReceiver; //the last seq we have requested ack
         boost::asio::steady_timer m_resendTimer;
@@ -422,6 +516,16 @@ namespace Com
         size_t m_queueNotFullNotificationLimit; //below number of used slots. NOT percent.
         std::atomic<bool> m_notifyQueueNotFull;
         std::vector<size_t> m_sendAckRequestForMsgIndex;
+        const bool m_coalesceMessages;
+        const size_t m_maxCoalescedSize;    //max size of a message including its CoalescedHeader to be coalesced
+        UserDataPtr m_coalescing;           //the last coalesced datagram, more messages can be added until it is sent
+        char* m_coalescingBuffer;
+        uint64_t m_coalescingPosition;      //queue position of m_coalescing
+        bool m_handleSendQueuePosted;
+        bool m_rttBasedRetryTimeout;        //see Parameters::RttBasedRetryTimeout
+        const std::chrono::steady_clock::duration m_maxRetryTimeout;    //largest configured retry timeout
+        const std::chrono::steady_clock::duration m_retryCheckInterval; //interval of RetransmitUnackedMessages when there are no round trip times
+        std::vector<std::chrono::steady_clock::duration> m_slotRetryTimeout; //retry timeout for every slot, zero if no round trip time has been measured
         const std::string m_logPrefix;
 
         static std::string GenerateLogPrefix(uint8_t deliveryGuarantee, int64_t nodeTypeId)
@@ -431,6 +535,167 @@ namespace Com
            return os.str();
         }
 
+        template <class... Args>
+        UserDataPtr NewUserData(Args&&... args)
+        {
+            return std::allocate_shared<UserData>(FragmentAllocator<UserData>(m_fragmentPool), std::forward<Args>(args)...);
+        }
+
+        size_t AllocateSlot(int64_t nodeId)
+        {
+            auto it=std::find(m_slotNodeIds.begin(), m_slotNodeIds.end(), 0);
+            if (it==m_slotNodeIds.end())
+            {
+                m_slotNodeIds.push_back(nodeId);
+                m_slotRetryTimeout.push_back(std::chrono::steady_clock::duration::zero());
+                return m_slotNodeIds.size()-1;
+            }
+            *it=nodeId;
+            const size_t slot=static_cast<size_t>(it-m_slotNodeIds.begin());
+            m_slotRetryTimeout[slot]=std::chrono::steady_clock::duration::zero();
+            return slot;
+        }
+
+        //returns 0 if the slot is not used by any node
+        int64_t NodeIdOfSlot(size_t slot) const
+        {
+            return slot<m_slotNodeIds.size() ? m_slotNodeIds[slot] : 0;
+        }
+
+        void Enqueue(const UserDataPtr& ud)
+        {
+            if (m_deliveryGuarantee==Acked)
+            {
+                if (ud->header.sendMethod==MultiReceiverSendMethod)
+                {
+                    m_multiReceiverIndex.Add(ud->header.sequenceNumber, m_nextQueuePosition);
+                }
+                else
+                {
+                    m_nodes.at(ud->header.commonHeader.receiverId).singleReceiverIndex.Add(ud->header.sequenceNumber, m_nextQueuePosition);
+                }
+            }
+            ++m_nextQueuePosition;
+            m_sendQueue.enqueue(ud);
+        }
+
+        void Dequeue()
+        {
+            if (m_deliveryGuarantee==Acked)
+            {
+                const auto& ud=m_sendQueue.front();
+                if (ud->header.sendMethod==MultiReceiverSendMethod)
+                {
+                    m_multiReceiverIndex.RemoveFront(m_firstQueuePosition);
+                }
+                else
+                {
+                    auto nodeIt=m_nodes.find(ud->header.commonHeader.receiverId);
+                    if (nodeIt!=m_nodes.end())
+                    {
+                        nodeIt->second.singleReceiverIndex.RemoveFront(m_firstQueuePosition);
+                    }
+                }
+            }
+            ++m_firstQueuePosition;
+            m_sendQueue.dequeue();
+        }
+
+        size_t ClearQueue()
+        {
+            auto numberOfRemoved=m_sendQueue.clear_queue();
+            m_firstQueuePosition=m_nextQueuePosition;
+            m_coalescing.reset();
+            m_multiReceiverIndex=SequenceIndex();
+            for (auto it = m_nodes.begin(); it != m_nodes.end(); ++it)
+            {
+                it->second.singleReceiverIndex=SequenceIndex();
+            }
+            return numberOfRemoved;
+        }
+
+        //Apply an ack from node to the sent messages it covers. Only messages that have not already been acked by the node
+        //are visited, so the total work is proportional to the number of messages, not to the number of acks times the window size.
+        //Returns true if something was retransmitted.
+        bool UpdateQueue(const Ack& ack, NodeInfo& node)
+        {
+            const bool multiReceiver=ack.sendMethod==MultiReceiverSendMethod;
+            const SequenceIndex& index=multiReceiver ? m_multiReceiverIndex : node.singleReceiverIndex;
+            uint64_t& acked=multiReceiver ? node.ackedMultiReceiverSeqNo : node.ackedSingleReceiverSeqNo;
+
+            //Everything we have sent is within the sliding window, so there can't be any outstanding messages before it.
+            if (ack.sequenceNumber>=m_slidingWindowSize && acked<ack.sequenceNumber-m_slidingWindowSize)
+            {
+                acked=ack.sequenceNumber-m_slidingWindowSize;
+            }
+
+            bool retransmitted=false;
+            bool ackedSoFar=true; //all messages so far in this ack are done for this node
+            for (uint64_t seqNo=acked+1; seqNo<=ack.sequenceNumber; ++seqNo)
+            {
+                if (seqNo>=index.firstSeqNo+index.positions.size())
+                {
+                    break; //not in the sendQueue yet
+                }
+
+                if (seqNo>=index.firstSeqNo)
+                {
+                    const size_t i=static_cast<size_t>(index.positions[static_cast<size_t>(seqNo-index.firstSeqNo)]-m_firstQueuePosition);
+                    if (i>=m_sendQueue.first_unhandled_index())
+                    {
+                        //Will only check ack against sent messages. If an ack is received for a message that is still unsent, that ack will be ignored.
+                        break;
+                    }
+
+                    UserDataPtr& ud=m_sendQueue[i];
+                    if (ud->receivers.contains(node.slot))
+                    {
+                        const char missing=ack.missing[static_cast<size_t>(ack.sequenceNumber-seqNo)];
+                        if (missing=='#')
+                        {
+                            //the ack sender has a smaller window than us and did not report this message, wait for next ack
+                            ackedSoFar=false;
+                            continue;
+                        }
+
+                        if (missing!=1)
+                        {
+                            if (seqNo==ack.sequenceNumber && ud->transmitCount==1 && ud->header.ackNow==1)
+                            {
+                                //This message caused the ack and has only been sent once, so the time since it was sent is a
+                                //round trip time sample. Retransmitted messages are never used since we can't tell which transmit was acked.
+                                UpdateRoundTripTime(node, std::chrono::steady_clock::now()-ud->sendTime);
+                            }
+                            ud->receivers.erase(node.slot);
+                        }
+                        else
+                        {
+                            //AckSender is missing a message.
+                            //if the message has already been transmitted 2 times (i.e retransmitted 1 time), we only retransmit again if
+                            //the ack arrives more than a round trip time after the last retransmit, i.e. the retransmit must have been lost too.
+                            //Otherwise we fall back on the retransmit timeouts. This is because every ack will have the missing message marked in
+                            //the missing list and the retransmit count will explode if we retransmit for every ack received.
+                            if (ud->transmitCount<2 || IsRetransmitLost(*ud, node))
+                            {
+                                //resend immediately if we have not retransmitted this message before
+                                RetransmitMessage(ud);
+                                retransmitted=true;
+                            }
+                            ackedSoFar=false;
+                            continue;
+                        }
+                    }
+                }
+
+                if (ackedSoFar)
+                {
+                    acked=seqNo;
+                }
+            }
+
+            return retransmitted;
+        }
+
         void PostWelcome(int64_t nodeId)
         {
             auto& ni=m_nodes.at(nodeId);
@@ -440,20 +705,70 @@ namespace Com
             ++m_sendQueueSize;
             auto welcome=Safir::Utilities::Internal::MakeSharedArray(sizeof(int64_t));
             memcpy(static_cast<void*>(welcome.get()), static_cast<const void*>(&nodeId), sizeof(int64_t));
-            UserDataPtr userData=std::make_shared<UserData>(m_nodeId, 0, WelcomeDataType, welcome, sizeof(int64_t), welcome.get(), sizeof(int64_t));
+            UserDataPtr userData=NewUserData(m_nodeId, 0, WelcomeDataType, welcome, sizeof(int64_t), welcome.get(), sizeof(int64_t));
             userData->header.sendMethod=MultiReceiverSendMethod;
             userData->header.sequenceNumber=ni.welcome;
             userData->header.deliveryGuarantee=true;
             userData->header.numberOfFragments=1;
             userData->header.fragmentNumber=0;
             userData->header.ackNow=1;
-            userData->receivers.insert(nodeId);
-            m_sendQueue.enqueue(userData);
+            userData->receivers.insert(ni.slot);
+            Enqueue(userData);
 
             lllog(6)<<m_logPrefix.c_str()<<"Welcome posted from "<<m_nodeId<<L" to "<<nodeId<<", seq: "<<ni.welcome<<std::endl;
             HandleSendQueue();
         }
 
+        //Add a small message to the last datagram of type CoalescedDataType if it is still unsent, has the same receiver and
+        //is the last message in the sendQueue, so the order of messages is kept. Otherwise a new datagram is added to the sendQueue.
+        void Coalesce(int64_t toId, uint8_t sendMethod, uint64_t& sequenceSerie, const char* data, size_t size, int64_t dataType)
+        {
+            const size_t recordSize=CoalescedHeaderSize+size;
+            if (m_coalescing!=nullptr &&
+                m_coalescing->transmitCount==0 &&
+                m_coalescingPosition+1==m_nextQueuePosition &&
+                m_coalescing->header.commonHeader.receiverId==toId &&
+                m_coalescing->header.totalContentSize+recordSize<=m_fragmentDataSize)
+            {
+                --m_sendQueueSize; //no new entry in the sendQueue was needed
+            }
+            else
+            {
+                auto buffer=Safir::Utilities::Internal::MakeSharedArray(m_fragmentDataSize);
+                ++sequenceSerie;
+                m_coalescing=NewUserData(m_nodeId, toId, CoalescedDataType, buffer, 0, buffer.get(), 0);
+                m_coalescing->header.sendMethod=sendMethod;
+                m_coalescing->header.sequenceNumber=sequenceSerie;
+                m_coalescing->header.deliveryGuarantee=m_deliveryGuarantee;
+                m_coalescing->header.numberOfFragments=1;
+                m_coalescing->header.fragmentNumber=0;
+                SetRequestAck(m_coalescing->header);
+                m_coalescingBuffer=buffer.get();
+                m_coalescingPosition=m_nextQueuePosition;
+                Enqueue(m_coalescing);
+            }
+
+            MessageHeader& header=m_coalescing->header;
+            const CoalescedHeader coalescedHeader(dataType, size);
+            memcpy(m_coalescingBuffer+header.totalContentSize, &coalescedHeader, CoalescedHeaderSize);
+            memcpy(m_coalescingBuffer+header.totalContentSize+CoalescedHeaderSize, data, size);
+            header.totalContentSize+=static_cast<uint32_t>(recordSize);
+            header.fragmentContentSize=header.totalContentSize;
+        }
+
+        void PostHandleSendQueue()
+        {
+            if (!m_handleSendQueuePosted)
+            {
+                m_handleSendQueuePosted=true;
+                boost::asio::post(m_strand, [this]
+                {
+                    m_handleSendQueuePosted=false;
+                    HandleSendQueue();
+                });
+            }
+        }
+
         void SetRequestAck(MessageHeader& header) const
         {
             auto requestAck = (header.sendMethod==SingleReceiverSendMethod) ||
@@ -467,8 +782,13 @@ namespace Com
         {
             //must be called from writeStrand
 
+            //All datagrams produced in this pass are sent together when batch goes out of scope
+            typename WriterType::ScopedBatch batch(*this);
+
+            const bool wasIdle=m_sendQueue.first_unhandled_index()==0;
+
             //Send all unhandled messges that are within our sender window
-            while (m_sendQueue.has_unhandled() && m_sendQueue.first_unhandled_index()<m_slidingWindowSize)
+            while (m_sendQueue.has_unhandled() && m_sendQueue.first_unhandled_index()<m_windowSize)
             {
                 UserDataPtr& ud=m_sendQueue[m_sendQueue.first_unhandled_index()];
                 ++ud->transmitCount;
@@ -485,11 +805,11 @@ namespace Com
                             {
                                 //The node will get the message throuch the multicast message, we just add it to receiver list
                                 //to be able to track the ack
-                                ud->receivers.insert(val->first);
+                                ud->receivers.insert(val->second.slot);
                             }
                         }
 
-                        if (ud->receivers.size()>0)
+                        if (!ud->receivers.empty())
                         {
                             WriterType::SendMulticast(ud);
                         }
@@ -500,7 +820,7 @@ namespace Com
                         {
                             if (val->second.systemNode && val->second.welcome<=ud->header.sequenceNumber)
                             {
-                                ud->receivers.insert(val->first);
+                                ud->receivers.insert(val->second.slot);
                                 WriterType::SendTo(ud, val->second.endpoint);
                             }
                         }
@@ -514,8 +834,8 @@ namespace Com
                         lllog(9)<<m_logPrefix.c_str()<<"Send to: "<<ud->header.commonHeader.receiverId
                                 <<",  seq: "<<ud->header.sequenceNumber<<", ackNow: "<<static_cast<int>(ud->header.ackNow)
                                 << ", dataType:" << ud->header.commonHeader.dataType <<std::endl;
-                        ud->receivers.insert(ud->header.commonHeader.receiverId);
                         NodeInfo& n=nodeIt->second;
+                        ud->receivers.insert(n.slot);
                         WriterType::SendTo(ud, n.endpoint);
                     }
                     else
@@ -548,10 +868,21 @@ namespace Com
                 else
                 {
                     //if unacked, then immediately remove message from queue. Don't wait for ack.
-                    m_sendQueue.dequeue();
+                    Dequeue();
                     --m_sendQueueSize;
                 }
             }
+
+            if (wasIdle && m_running && m_deliveryGuarantee==Acked && m_sendQueue.first_unhandled_index()>0)
+            {
+                //The resend timer runs with the long interval while nothing is waiting for ack, restart it if the
+                //round trip time gives a shorter interval.
+                const auto interval=RetransmitCheckInterval();
+                if (m_resendTimer.expiry()>std::chrono::steady_clock::now()+interval)
+                {
+                    StartResendTimer(interval);
+                }
+            }
         }
 
         std::chrono::milliseconds GetRetryTimeout(size_t transmitCount) const
@@ -562,41 +893,86 @@ namespace Com
                         std::chrono::milliseconds(m_retryTimeout.back());
         }
 
-        void RetransmitUnackedMessages()
+        //Update the round trip time estimate of a node like TCP does (RFC 6298) and calculate a new retry timeout for it.
+        void UpdateRoundTripTime(NodeInfo& node, std::chrono::steady_clock::duration sample)
         {
-            if (!m_running)
+            static const std::chrono::steady_clock::duration minTimeout=std::chrono::milliseconds(Parameters::MinRetryTimeout);
+            static const std::chrono::steady_clock::duration granularity=std::chrono::milliseconds(1);
+
+            sample=std::max(sample, std::chrono::steady_clock::duration(1));
+            if (node.srtt==std::chrono::steady_clock::duration::zero())
             {
-                return;
+                node.srtt=sample;
+                node.rttvar=sample/2;
+            }
+            else
+            {
+                const auto deviation=node.srtt>sample ? node.srtt-sample : sample-node.srtt;
+                node.rttvar=(3*node.rttvar+deviation)/4;
+                node.srtt=(7*node.srtt+sample)/8;
             }
 
-            //Always called from writeStrand
-            static const std::chrono::milliseconds timerInterval(*std::min_element(m_retryTimeout.begin(), m_retryTimeout.end()) / 2);
+            const auto timeout=node.srtt+std::max(granularity, 4*node.rttvar);
+            m_slotRetryTimeout[node.slot]=std::min(std::max(timeout, minTimeout), m_maxRetryTimeout);
+        }
 
-            //Check if there is any unacked messages that are old enough to be retransmitted
-            for (size_t i=0; i<m_sendQueue.first_unhandled_index(); ++i)
+        //Time to wait for ack before a message is retransmitted. If the round trip time to all its receivers is known, the
+        //largest of their retry timeouts is used, doubled for every retransmit. Otherwise the configured retry timeouts are used.
+        std::chrono::steady_clock::duration RetryTimeout(const UserData& ud) const
+        {
+            const std::chrono::steady_clock::duration configured=GetRetryTimeout(ud.transmitCount);
+            if (!m_rttBasedRetryTimeout)
             {
-                UserDataPtr& ud=m_sendQueue[i];
-                auto durationSinceSend=std::chrono::steady_clock::now()-ud->sendTime;
-                auto retransmitLimit = GetRetryTimeout(ud->transmitCount);
-                if (durationSinceSend>retransmitLimit)
-                {
-                    RetransmitMessage(ud);
-                }
-                else if (durationSinceSend>retransmitLimit/2 && ud->transmitCount<2 && m_ackRequestThreshold>1)
-                {
-                    //this message has never been retransmitted, we have not asked receiver to ack,
-                    //and half the restransmitInterval has expired. It is time to send an explicit ack-request
-                    //to avoid unecessary retransmits. If m_ackRequestThreshold==1 we have alredy requested ack at send-time
-                    m_sendAckRequestForMsgIndex.push_back(i);
-                }
+                return configured;
             }
 
-            SendAckRequests();
+            auto timeout=std::chrono::steady_clock::duration::zero();
+            bool measured=true;
+            ud.receivers.for_each([&](size_t slot)
+            {
+                const auto slotTimeout=slot<m_slotRetryTimeout.size() ? m_slotRetryTimeout[slot] : std::chrono::steady_clock::duration::zero();
+                measured=measured && slotTimeout>std::chrono::steady_clock::duration::zero();
+                timeout=std::max(timeout, slotTimeout);
+            });
 
-            RemoveCompletedMessages();
+            if (!measured || timeout==std::chrono::steady_clock::duration::zero())
+            {
+                return configured;
+            }
 
-            //Restart timer
-            m_resendTimer.expires_after(timerInterval);
+            const size_t backoff=std::min<size_t>(ud.transmitCount>0 ? ud.transmitCount-1 : 0, 6);
+            return std::min(timeout*(1<<backoff), m_maxRetryTimeout);
+        }
+
+        //A retransmitted message that is still reported missing in an ack that arrives more than a round trip after the retransmit.
+        bool IsRetransmitLost(const UserData& ud, const NodeInfo& node) const
+        {
+            return m_rttBasedRetryTimeout &&
+                    node.srtt>std::chrono::steady_clock::duration::zero() &&
+                    std::chrono::steady_clock::now()-ud.sendTime>node.srtt+node.rttvar;
+        }
+
+        //Interval of RetransmitUnackedMessages. Half the shortest configured retry timeout, or when there are messages waiting
+        //for ack, half the shortest retry timeout based on round trip time.
+        std::chrono::steady_clock::duration RetransmitCheckInterval() const
+        {
+            auto interval=m_retryCheckInterval;
+            if (m_rttBasedRetryTimeout && m_sendQueue.first_unhandled_index()>0)
+            {
+                for (auto timeout = m_slotRetryTimeout.cbegin(); timeout != m_slotRetryTimeout.cend(); ++timeout)
+                {
+                    if (*timeout>std::chrono::steady_clock::duration::zero())
+                    {
+                        interval=std::min(interval, *timeout/2);
+                    }
+                }
+            }
+            return interval;
+        }
+
+        void StartResendTimer(std::chrono::steady_clock::duration interval)
+        {
+            m_resendTimer.expires_after(interval);
             m_resendTimer.async_wait(boost::asio::bind_executor(m_strand, [this](const boost::system::error_code& error)
             {
                 if (error == boost::asio::error::operation_aborted)
@@ -607,6 +983,53 @@ namespace Com
             }));
         }
 
+        void RetransmitUnackedMessages()
+        {
+            if (!m_running)
+            {
+                return;
+            }
+
+            //Always called from writeStrand
+            {
+                //Retransmits and ack requests are sent together when batch goes out of scope
+                typename WriterType::ScopedBatch batch(*this);
+                bool retransmitted=false;
+
+                //Check if there is any unacked messages that are old enough to be retransmitted
+                for (size_t i=0; i<m_sendQueue.first_unhandled_index(); ++i)
+                {
+                    UserDataPtr& ud=m_sendQueue[i];
+                    auto durationSinceSend=std::chrono::steady_clock::now()-ud->sendTime;
+                    auto retransmitLimit = RetryTimeout(*ud);
+                    if (durationSinceSend>retransmitLimit)
+                    {
+                        RetransmitMessage(ud);
+                        retransmitted=true;
+                    }
+                    else if (durationSinceSend>retransmitLimit/2 && ud->transmitCount<2 && m_ackRequestThreshold>1)
+                    {
+                        //this message has never been retransmitted, we have not asked receiver to ack,
+                        //and half the restransmitInterval has expired. It is time to send an explicit ack-request
+                        //to avoid unecessary retransmits. If m_ackRequestThreshold==1 we have alredy requested ack at send-time
+                        m_sendAckRequestForMsgIndex.push_back(i);
+                    }
+                }
+
+                SendAckRequests();
+
+                if (retransmitted)
+                {
+                    DecreaseWindow();
+                }
+            }
+
+            RemoveCompletedMessages();
+
+            //Restart timer
+            StartResendTimer(RetransmitCheckInterval());
+        }
+
         void SendAckRequests()
         {
             if (m_sendAckRequestForMsgIndex.empty())
@@ -614,52 +1037,54 @@ namespace Com
                 return;
             }
 
-            std::set<int64_t> singleReceiverSendMethod;
-            std::set<int64_t> multiReceiverSendMethod;
+            Receivers singleReceiverSendMethod;
+            Receivers multiReceiverSendMethod;
 
             for (auto index = m_sendAckRequestForMsgIndex.cbegin(); index != m_sendAckRequestForMsgIndex.cend(); ++index)
             {
                 const UserDataPtr& ud=m_sendQueue[*index];
                 if (ud->header.sendMethod==SingleReceiverSendMethod)
                 {
-                    singleReceiverSendMethod.insert(ud->receivers.begin(), ud->receivers.end());
+                    singleReceiverSendMethod.merge(ud->receivers);
                 }
                 else
                 {
-                    multiReceiverSendMethod.insert(ud->receivers.begin(), ud->receivers.end());
+                    multiReceiverSendMethod.merge(ud->receivers);
                 }
             }
 
             Safir::Utilities::Internal::SharedCharArray noData;
-            UserDataPtr ud=std::make_shared<UserData>(m_nodeId, 0, AckRequestType, noData, 0);
+            UserDataPtr ud=NewUserData(m_nodeId, 0, AckRequestType, noData, 0);
 
             //Send ackRequests for SingleReceiver channel
             ud->header.sendMethod=SingleReceiverSendMethod;
 
-            for (auto recvId = singleReceiverSendMethod.cbegin(); recvId != singleReceiverSendMethod.cend(); ++recvId)
+            singleReceiverSendMethod.for_each([&](size_t slot)
             {
-                auto nodeIt=m_nodes.find(*recvId);
+                const int64_t recvId=NodeIdOfSlot(slot);
+                auto nodeIt=m_nodes.find(recvId);
                 if (nodeIt!=m_nodes.end() && nodeIt->second.systemNode)
                 {
-                    lllog(9)<<m_logPrefix.c_str()<<"Send AckRequest for SingleReceiverSendMethod to "<<*recvId<<std::endl;
-                    ud->header.commonHeader.receiverId=*recvId;
+                    lllog(9)<<m_logPrefix.c_str()<<"Send AckRequest for SingleReceiverSendMethod to "<<recvId<<std::endl;
+                    ud->header.commonHeader.receiverId=recvId;
                     WriterType::SendTo(ud, nodeIt->second.endpoint);
                 }
-            }
+            });
 
             //Send ackRequests for MultiReceiver channel
             ud->header.sendMethod=MultiReceiverSendMethod;
 
-            for (auto recvId = multiReceiverSendMethod.cbegin(); recvId != multiReceiverSendMethod.cend(); ++recvId)
+            multiReceiverSendMethod.for_each([&](size_t slot)
             {
-                auto nodeIt=m_nodes.find(*recvId);
+                const int64_t recvId=NodeIdOfSlot(slot);
+                auto nodeIt=m_nodes.find(recvId);
                 if (nodeIt!=m_nodes.end() && nodeIt->second.systemNode)
                 {
-                    lllog(9)<<m_logPrefix.c_str()<<"Send AckRequest for MultiReceiverSendMethod to "<<*recvId<<std::endl;
-                    ud->header.commonHeader.receiverId=*recvId;
+                    lllog(9)<<m_logPrefix.c_str()<<"Send AckRequest for MultiReceiverSendMethod to "<<recvId<<std::endl;
+                    ud->header.commonHeader.receiverId=recvId;
                     WriterType::SendTo(ud, nodeIt->second.endpoint);
                 }
-            }
+            });
 
             m_sendAckRequestForMsgIndex.clear();
         }
@@ -668,10 +1093,10 @@ namespace Com
         {
             ++ud->transmitCount;
             //Always called from writeStrand
-            auto recvIt=ud->receivers.begin();
-            while (recvIt!=ud->receivers.end())
+            ud->receivers.for_each([&](size_t slot)
             {
-                const auto nodeIt=m_nodes.find(*recvIt);
+                const int64_t recvId=NodeIdOfSlot(slot);
+                const auto nodeIt=m_nodes.find(recvId);
                 if (nodeIt!=m_nodes.end() && nodeIt->second.systemNode)
                 {
                     ud->header.ackNow=1; //request ack immediately for retransmitted messages
@@ -679,18 +1104,17 @@ namespace Com
                     WriterType::SendTo(ud, nodeIt->second.endpoint);
                     m_retransmitNotification(nodeIt->first, ud->transmitCount);
                     lllog(9)<<m_logPrefix.c_str()<<"Retransmit  "<<SendMethodToString(ud->header.sendMethod).c_str()<<
-                              ", seq: "<<ud->header.sequenceNumber<<" to "<<*recvIt<<std::endl;
-                    ++recvIt;
+                              ", seq: "<<ud->header.sequenceNumber<<" to "<<recvId<<std::endl;
                 }
                 else
                 {
                     //node does not exist anymore or is not part of the system, dont wait for this node anymore
                     lllog(6)<<m_logPrefix.c_str()<<"Ignore retransmit to receiver that is not longer a system node  "<<
                               (ud->header.sendMethod==SingleReceiverSendMethod ? "SingleReceiverMessage" : "MultiReceiverMessage")<<
-                              ", seq: "<<ud->header.sequenceNumber<<" to "<<*recvIt<<std::endl;
-                    ud->receivers.erase(recvIt++);
+                              ", seq: "<<ud->header.sequenceNumber<<" to "<<recvId<<std::endl;
+                    ud->receivers.erase(slot);
                 }
-            }
+            });
 
             ud->sendTime=std::chrono::steady_clock::now(); //update sendTime so that we will wait for an new WaitForAckTime period before retransmit again
             m_lastSendTime=ud->sendTime;
@@ -726,23 +1150,48 @@ namespace Com
         {
             std::for_each(m_sendQueue.begin(), m_sendQueue.end(), [&](UserDataPtr& ud)
             {
-                auto recvIt=ud->receivers.begin();
-                while (recvIt!=ud->receivers.end())
+                ud->receivers.for_each([&](size_t slot)
                 {
-                    auto nodeIt=m_nodes.find(*recvIt);
-                    if (nodeIt==m_nodes.end())
+                    if (NodeIdOfSlot(slot)==0)
                     {
                         //receiver does not exist anymore, remove it from receiver list
-                        ud->receivers.erase(recvIt++);  //post increment after erase
+                        ud->receivers.erase(slot);
                     }
-                    else
-                    {
-                        ++recvIt;
-                    }
-                }
+                });
             });
         }
 
+        //Adaptive window, called when a message has been acked without retransmit. Like TCP slow start and congestion avoidance
+        //the window grows by one for every acked message below m_slowStartThreshold and by one per full window above it.
+        void IncreaseWindow()
+        {
+            if (!m_adaptiveWindow || m_windowSize>=m_slidingWindowSize)
+            {
+                return;
+            }
+
+            if (m_windowSize<m_slowStartThreshold || ++m_ackedInWindow>=m_windowSize)
+            {
+                ++m_windowSize;
+                m_ackedInWindow=0;
+                lllog(9)<<m_logPrefix.c_str()<<"Increase window to "<<m_windowSize<<std::endl;
+            }
+        }
+
+        //Adaptive window, called when messages have been retransmitted. The window is halved.
+        void DecreaseWindow()
+        {
+            if (!m_adaptiveWindow)
+            {
+                return;
+            }
+
+            m_slowStartThreshold=std::max(m_windowSize/2, m_minWindowSize);
+            m_windowSize=m_slowStartThreshold;
+            m_ackedInWindow=0;
+            lllog(8)<<m_logPrefix.c_str()<<"Retransmit, decrease window to "<<m_windowSize<<std::endl;
+        }
+
         void RemoveCompletedMessages()
         {
             //Always called from writeStrand
@@ -760,16 +1209,20 @@ namespace Com
                     {
                         //no more receivers in receiver list, then message is completed and shall be removed
                         lllog(8)<<m_logPrefix.c_str()<<"Remove message from sendQueue, seq: "<<ud->header.sequenceNumber<<std::endl;
-                        m_sendQueue.dequeue();
+                        if (ud->transmitCount==1)
+                        {
+                            IncreaseWindow();
+                        }
+                        Dequeue();
                         --m_sendQueueSize;
                     }
                     else
                     {
                         //message has not been acked by everyone
-                        for (auto r = ud->receivers.cbegin(); r != ud->receivers.cend(); ++r)
+                        ud->receivers.for_each([&](size_t slot)
                         {
-                            lllog(9)<<m_logPrefix.c_str()<<"Cant remove seq: "<<ud->header.sequenceNumber<<", left: "<<*r<<std::endl;
-                        }
+                            lllog(9)<<m_logPrefix.c_str()<<"Cant remove seq: "<<ud->header.sequenceNumber<<", left: "<<NodeIdOfSlot(slot)<<std::endl;
+                        });
                         break;
                     }
                 }
@@ -778,7 +1231,7 @@ namespace Com
             {
                 //It is possible that m_sendQueueSize has been increased by 1 in AddToSendQueue but still the item has not been added to the queue.
                 //to avoid race conditions we can't just set m_sendQueueSize=0 here but instead decrease it with the actual number of items removed.
-                auto numberOfRemoved=m_sendQueue.clear_queue();
+                auto numberOfRemoved=ClearQueue();
                 m_sendQueueSize -= static_cast<unsigned int>(numberOfRemoved);
                 lllog(9)<<m_logPrefix.c_str()<<"No receivers left, clear sendQueue, numberOfRemoved: "<<numberOfRemoved<<std::endl;
             }
@@ -865,16 +1318,24 @@ namespace Com
                 }
                 else
                 {
-                    for (auto id = ud->receivers.cbegin(); id != ud->receivers.cend(); ++id)
+                    ud->receivers.for_each([&](size_t slot)
                     {
-                        os<<"    recvId="<<*id<<std::endl;
-                    }
+                        os<<"    recvId="<<NodeIdOfSlot(slot)<<std::endl;
+                    });
                 }
             }
             os<<"======== End ========"<<std::endl;
 
             return os.str();
         }
+
+        //debug, the node ids of the receivers of a message in the sendQueue
+        std::set<int64_t> ReceiverIds(const UserData& ud) const
+        {
+            std::set<int64_t> ids;
+            ud.receivers.for_each([&](size_t slot){ids.insert(NodeIdOfSlot(slot));});
+            return ids;
+        }
     };
 
     typedef DataSenderBasic< Writer<UserData> > DataSender;
@@ -70,14 +70,22 @@ namespace Com
     {
     public:
         DeliveryHandlerBasic(boost::asio::io_context& io, int64_t myNodeId, int ipVersion, int slidingWindowSize)
+            :DeliveryHandlerBasic(io, myNodeId, ipVersion, slidingWindowSize, boost::asio::io_context::strand(io))
+        {
+        }
+
+        //Several DeliveryHandlers that share the same deliverStrand never make concurrent calls to the application.
+        DeliveryHandlerBasic(boost::asio::io_context& io, int64_t myNodeId, int ipVersion, int slidingWindowSize,
+                             const boost::asio::io_context::strand& deliverStrand)
             :WriterType(io, ipVersion)
             ,m_running(false)
             ,m_myId(myNodeId)
             ,m_slidingWindowSize(static_cast<size_t>(slidingWindowSize))
-            ,m_deliverStrand(io)
+            ,m_deliverStrand(deliverStrand)
             ,m_nodes()
             ,m_receivers()
             ,m_gotRecvFrom()
+            ,m_missingMessages(false)
             ,m_logPrefix(Parameters::LogPrefix)
         {
             m_numberOfUndeliveredMessages=0;
@@ -95,6 +103,17 @@ namespace Com
                                                            [=](int64_t, int64_t, const char* data, size_t) {delete[] data;})
                                               )
                                );
+
+            m_receivers.insert(std::make_pair(CoalescedDataType,
+                                              DataReceiver([=](size_t size){return new char[size];},
+                                                           [=](const char* data) {delete[] data;},
+                                                           [this](int64_t fromId, int64_t fromNodeType, const char* data, size_t size)
+                                                           {
+                                                               DeliverCoalesced(fromId, fromNodeType, data, size);
+                                                               delete[] data;
+                                                           })
+                                              )
+                               );
         }
 
         void Start()
@@ -106,6 +125,7 @@ namespace Com
         void Stop()
         {
             m_running=false;
+            m_missingMessages=false;
 
             for (auto n : m_nodes)
             {
@@ -237,6 +257,35 @@ namespace Com
             m_nodes.erase(id);
         }
 
+        //True if a message on an acked channel has been received out of order and the earlier messages are still missing.
+        bool HasMissingMessages() const
+        {
+            return m_missingMessages;
+        }
+
+        //Send acks on the acked channels where messages are missing, telling the sender which messages to retransmit.
+        //An ack is sent at most once per Parameters::NackInterval for a channel. Should be called periodically as long
+        //as HasMissingMessages returns true.
+        void SendNacks()
+        {
+            if (!m_running)
+            {
+                return;
+            }
+
+            const auto now=std::chrono::steady_clock::now();
+            m_missingMessages=false;
+            for (auto it = m_nodes.begin(); it != m_nodes.end(); ++it)
+            {
+                NodeInfo& ni=it->second;
+                if (ni.node.systemNode)
+                {
+                    SendNack(ni, ni.ackedSingleReceiverChannel, SingleReceiverSendMethod, now);
+                    SendNack(ni, ni.ackedMultiReceiverChannel, MultiReceiverSendMethod, now);
+                }
+            }
+        }
+
         const Node* GetNode(int64_t id) const
         {
             //Always called from readStrand
@@ -253,6 +302,13 @@ namespace Com
             return m_numberOfUndeliveredMessages;
         }
 
+        // Called from the deliver strand when the number of undelivered messages drops below Parameters::MaxNumberOfUndelivered.
+        // Must be set before Start.
+        void SetReceiverReadyCallback(const std::function<void()>& callback)
+        {
+            m_receiverReady=callback;
+        }
+
 #ifndef SAFIR_TEST
     private:
 #endif
@@ -320,11 +376,13 @@ namespace Com
             uint64_t welcome; //first received message that we are supposed to handle
             uint64_t lastInSequence; //last sequence number that was moved out of the queue. seq(queue[0])-1
             uint64_t biggestSequence; //biggest sequence number recevived (within our window)
+            std::chrono::steady_clock::time_point lastAckTime; //last time an ack was sent for this channel
             CircularArray<RecvData> queue;
             Channel(size_t slidingWindowSize)
                 :welcome(0)
                 ,lastInSequence(0)
                 ,biggestSequence(0)
+                ,lastAckTime()
                 ,queue(slidingWindowSize)
             {
             }
@@ -387,10 +445,12 @@ namespace Com
         const size_t m_slidingWindowSize;
         boost::asio::io_context::strand m_deliverStrand; //for delivering data to application
         std::atomic<unsigned int> m_numberOfUndeliveredMessages;
+        std::function<void()> m_receiverReady;
 
         NodeInfoMap m_nodes;
         ReceiverMap m_receivers;
         GotReceiveFrom m_gotRecvFrom;
+        bool m_missingMessages;
 
         std::string m_logPrefix;
 
@@ -677,6 +737,7 @@ namespace Com
                 //when sender retransmits non-acked messages.
                 m_gotRecvFrom(header->commonHeader.senderId, multicast, false);
                 Insert(header, payload, ni);
+                m_missingMessages=true; //keep reporting the gap until it is filled, see SendNacks
                 return true; //we ack everything we have so far so that the sender becomes aware of the gaps
             }
             else //lost messages, got something too far ahead
@@ -774,7 +835,10 @@ namespace Com
                                 SEND_SYSTEM_LOG(Error, <<os.str().c_str());
                                 throw std::logic_error(os.str());
                             }
-                            m_numberOfUndeliveredMessages--;
+                            if (m_numberOfUndeliveredMessages-- == Parameters::MaxNumberOfUndelivered && m_receiverReady)
+                            {
+                                m_receiverReady(); //we just went below the limit, wake up the reader if it is waiting for us
+                            }
                         });
                     }
 
@@ -815,10 +879,57 @@ namespace Com
             }
         }
 
+        //Split a datagram of type CoalescedDataType and deliver each message to its receiver. Called from the deliverStrand.
+        void DeliverCoalesced(int64_t fromId, int64_t fromNodeType, const char* data, size_t size)
+        {
+            size_t pos=0;
+            while (pos+CoalescedHeaderSize<=size)
+            {
+                CoalescedHeader coalescedHeader(0, 0);
+                memcpy(&coalescedHeader, data+pos, CoalescedHeaderSize);
+                const char* message=data+pos+CoalescedHeaderSize;
+                pos+=CoalescedHeaderSize+coalescedHeader.size;
+
+                auto recvIt=m_receivers.find(coalescedHeader.dataType);
+                if (pos>size || recvIt==m_receivers.end())
+                {
+                    std::ostringstream os;
+                    os<<"COM: Received coalesced data from node "<<fromId<<" with bad size or no registered receiver. DataTypeIdentifier: "
+                      <<coalescedHeader.dataType<<", size: "<<coalescedHeader.size;
+                    SEND_SYSTEM_LOG(Error, <<os.str().c_str());
+                    throw std::logic_error(os.str());
+                }
+
+                char* copy=recvIt->second.alloc(coalescedHeader.size);
+                memcpy(copy, message, coalescedHeader.size);
+                recvIt->second.onRecv(fromId, fromNodeType, copy, coalescedHeader.size);
+            }
+        }
+
         void SendAck(NodeInfo& ni, const MessageHeader* header)
         {
-            Channel& ch=ni.GetChannel(header);
-            auto ackPtr=std::make_shared<Ack>(m_myId, header->commonHeader.senderId, ch.biggestSequence, header->sendMethod);
+            SendAck(ni, ni.GetChannel(header), header->sendMethod);
+        }
+
+        void SendNack(NodeInfo& ni, Channel& ch, uint8_t sendMethod, std::chrono::steady_clock::time_point now)
+        {
+            static const std::chrono::milliseconds nackInterval(Parameters::NackInterval);
+
+            if (ch.biggestSequence>ch.lastInSequence) //something after lastInSequence has been received, i.e. there is a gap
+            {
+                m_missingMessages=true;
+                if (now-ch.lastAckTime>=nackInterval)
+                {
+                    lllog(9)<<m_logPrefix.c_str()<<L"Messages missing from "<<ni.node.nodeId<<" "<<SendMethodToString(sendMethod).c_str()<<
+                              L", lastInSeq: "<<ch.lastInSequence<<L", biggestSeq: "<<ch.biggestSequence<<std::endl;
+                    SendAck(ni, ch, sendMethod);
+                }
+            }
+        }
+
+        void SendAck(NodeInfo& ni, Channel& ch, uint8_t sendMethod)
+        {
+            auto ackPtr=std::make_shared<Ack>(m_myId, ni.node.nodeId, ch.biggestSequence, sendMethod);
 
             uint64_t seq=ch.biggestSequence;
             for (size_t i=0; i<m_slidingWindowSize; ++i)
@@ -836,6 +947,7 @@ namespace Com
             }
 
             lllog(9)<<m_logPrefix.c_str()<<L"SendAck "<<ackPtr->ToString().c_str()<<std::endl;
+            ch.lastAckTime=std::chrono::steady_clock::now();
             WriterType::SendTo(ackPtr, ni.endpoint);
         }
 
@@ -0,0 +1,192 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace Safir
+{
+namespace Dob
+{
+namespace Internal
+{
+namespace Com
+{
+    /**
+     * Pool of fixed size memory blocks used for the fragment descriptors (UserData) in the DataSender send queue.
+     * Blocks are taken from the pool by a single owner (the DataSender strand) but can be returned from any thread,
+     * since the last reference to a fragment may be released by the Writer. Memory is allocated in chunks and is
+     * kept until the pool is destroyed, so a send queue that has reached its working size does not allocate any more.
+     */
+    class FragmentPool
+    {
+    public:
+        //Room for the reference counts that std::allocate_shared stores in the same block as the object.
+        static const size_t SharedCountSize=8*sizeof(void*);
+
+        FragmentPool(size_t blockSize, size_t blocksPerChunk)
+            :m_blockSize(RoundUp(blockSize))
+            ,m_blocksPerChunk(blocksPerChunk>0 ? blocksPerChunk : 1)
+            ,m_free(nullptr)
+            ,m_numberOfBlocks(0)
+        {
+        }
+
+        ~FragmentPool()
+        {
+            for (auto chunk = m_chunks.begin(); chunk != m_chunks.end(); ++chunk)
+            {
+                ::operator delete(*chunk);
+            }
+        }
+
+        FragmentPool(const FragmentPool&) = delete;
+        FragmentPool& operator=(const FragmentPool&) = delete;
+
+        size_t BlockSize() const {return m_blockSize;}
+
+        //Total number of blocks that have been allocated by the pool, used or free.
+        size_t NumberOfBlocks() const {return m_numberOfBlocks;}
+
+        //Must only be called by the owner of the pool, never concurrently.
+        void* Allocate()
+        {
+            FreeBlock* block=m_free.load(std::memory_order_acquire);
+            for (;;)
+            {
+                if (block==nullptr)
+                {
+                    AllocateChunk();
+                    block=m_free.load(std::memory_order_acquire);
+                    continue;
+                }
+
+                //Only one thread ever takes blocks from the list, hence a block that is at the head cannot be taken and
+                //put back by someone else between the load and the exchange, i.e. there is no ABA problem.
+                if (m_free.compare_exchange_weak(block, block->next, std::memory_order_acquire, std::memory_order_acquire))
+                {
+                    return block;
+                }
+            }
+        }
+
+        //Can be called from any thread.
+        void Deallocate(void* p)
+        {
+            FreeBlock* block=static_cast<FreeBlock*>(p);
+            block->next=m_free.load(std::memory_order_relaxed);
+            while (!m_free.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+
+    private:
+        struct FreeBlock
+        {
+            FreeBlock* next;
+        };
+
+        const size_t m_blockSize;
+        const size_t m_blocksPerChunk;
+        std::atomic<FreeBlock*> m_free;
+        std::vector<void*> m_chunks;
+        size_t m_numberOfBlocks;
+
+        static size_t RoundUp(size_t size)
+        {
+            const size_t align=alignof(std::max_align_t);
+            size=size<sizeof(FreeBlock) ? sizeof(FreeBlock) : size;
+            return (size+align-1)/align*align;
+        }
+
+        void AllocateChunk()
+        {
+            char* chunk=static_cast<char*>(::operator new(m_blockSize*m_blocksPerChunk));
+            m_chunks.push_back(chunk);
+            m_numberOfBlocks+=m_blocksPerChunk;
+            for (size_t i=0; i<m_blocksPerChunk; ++i)
+            {
+                Deallocate(chunk+i*m_blockSize);
+            }
+        }
+    };
+
+    /**
+     * Allocator that takes single objects from a FragmentPool, intended for std::allocate_shared so that the object
+     * and its reference count end up in the same pool block. The allocator keeps the pool alive until the last
+     * object allocated from it has been released. Requests that do not fit in a block go to the heap.
+     */
+    template <class T>
+    class FragmentAllocator
+    {
+    public:
+        typedef T value_type;
+
+        explicit FragmentAllocator(const std::shared_ptr<FragmentPool>& pool) :m_pool(pool) {}
+
+        template <class U>
+        FragmentAllocator(const FragmentAllocator<U>& other) :m_pool(other.m_pool) {}
+
+        T* allocate(size_t n)
+        {
+            if (UsePool(n))
+            {
+                return static_cast<T*>(m_pool->Allocate());
+            }
+            return static_cast<T*>(::operator new(n*sizeof(T)));
+        }
+
+        void deallocate(T* p, size_t n)
+        {
+            if (UsePool(n))
+            {
+                m_pool->Deallocate(p);
+            }
+            else
+            {
+                ::operator delete(p);
+            }
+        }
+
+        template <class U>
+        bool operator==(const FragmentAllocator<U>& other) const {return m_pool==other.m_pool;}
+
+        template <class U>
+        bool operator!=(const FragmentAllocator<U>& other) const {return m_pool!=other.m_pool;}
+
+    private:
+        template <class U> friend class FragmentAllocator;
+        std::shared_ptr<FragmentPool> m_pool;
+
+        bool UsePool(size_t n) const
+        {
+            return n==1 && sizeof(T)<=m_pool->BlockSize() && alignof(T)<=alignof(std::max_align_t);
+        }
+    };
+}
+}
+}
+}
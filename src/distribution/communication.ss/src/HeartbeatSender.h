@@ -68,7 +68,7 @@ namespace Com
             :WriterType(ioContext, ipVersion, localIf, multicast)
             ,m_strand(ioContext)
             ,m_heartbeatTimer(ioContext)
-            ,m_heartbeat(new Heartbeat(myNodeId))
+            ,m_heartbeat(new Heartbeat(myNodeId, Parameters::Crc32cEnabled ? Crc32cFeature : 0))
             ,m_interval(heartbeatInterval)
             ,m_nodes()
             ,m_running(false)
@@ -121,6 +121,12 @@ namespace Com
             });
         }
 
+        //Use CRC32C checksum, see NodeType::SetNodeFeatures
+        void SetCrc32c(bool crc32c)
+        {
+            WriterType::SetCrc32c(crc32c);
+        }
+
     private:
         boost::asio::io_context::strand m_strand;
         boost::asio::steady_timer m_heartbeatTimer;
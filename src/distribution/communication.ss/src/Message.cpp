@@ -34,9 +34,10 @@ namespace Com
 {
 
     BOOST_STATIC_ASSERT(CommonHeaderSize == 3*8);
-    BOOST_STATIC_ASSERT(sizeof(Heartbeat) == CommonHeaderSize);
-    BOOST_STATIC_ASSERT(sizeof(Ack) == CommonHeaderSize + 8 + 1 + Parameters::MaxSlidingWindowSize);
+    BOOST_STATIC_ASSERT(sizeof(Heartbeat) == CommonHeaderSize + 1);
+    BOOST_STATIC_ASSERT(AckHeaderSize == CommonHeaderSize + 8 + 1);
     BOOST_STATIC_ASSERT(sizeof(MessageHeader) == CommonHeaderSize + 8 + 6 * 4);
+    BOOST_STATIC_ASSERT(CoalescedHeaderSize == 8 + 4);
 }
 }
 }
@@ -25,7 +25,9 @@
 
 #include <boost/chrono.hpp>
 #include <set>
+#include <algorithm>
 #include <bitset>
+#include <vector>
 #include <cstdint>
 #include "Parameters.h"
 #include <Safir/Utilities/Internal/SharedCharArray.h>
@@ -61,6 +63,7 @@ namespace Com
     static const int64_t AckRequestType=-3908639933957133038; //Hash for 'Communication.AckRequest'
     static const int64_t ControlDataType=186858702748131856; //Hash for 'Communication.ControlData'
     static const int64_t PingDataType=8729948154137041257; //Hash for 'Communication.Ping'
+    static const int64_t CoalescedDataType=-62186235603575064; //Hash for 'Communication.Coalesced'
 
     //Send method
     static const uint8_t SingleReceiverSendMethod=0;
@@ -125,10 +128,14 @@ namespace Com
     };
     static const size_t CommonHeaderSize=sizeof(CommonHeader);
 
+    //Flags in Heartbeat::features
+    static const uint8_t Crc32cFeature=0x01; //sender accepts datagrams with CRC32C checksum
+
     struct Heartbeat
     {
         CommonHeader commonHeader;
-        Heartbeat(int64_t senderId_) : commonHeader(senderId_, 0, HeartbeatType) {}
+        uint8_t features; //not sent by older versions, they only send the commonHeader
+        Heartbeat(int64_t senderId_, uint8_t features_) : commonHeader(senderId_, 0, HeartbeatType), features(features_) {}
     };
 
     struct Ack
@@ -137,6 +144,7 @@ namespace Com
         uint64_t sequenceNumber;
         uint8_t sendMethod; //tells if message being acked was sent to one or many receivers (different sequence numbers)
         unsigned char missing[Parameters::MaxSlidingWindowSize]; //1 means missing, 0 not missing sequenceNumber is index 0, seqNo-1 is index 1 and so on.
+                                                                 //Unused entries are '#', they are not sent.
         Ack(int64_t senderId_, int64_t receiverId_, uint64_t sequenceNumber_, uint8_t sendMethod_)
             :commonHeader(senderId_, receiverId_, AckType)
             ,sequenceNumber(sequenceNumber_)
@@ -146,12 +154,26 @@ namespace Com
                 missing[i]='#';
         }
 
+        //Number of used entries in missing, i.e entries before the first '#'
+        size_t NumberOfMissingEntries() const
+        {
+            return static_cast<size_t>(std::find(missing, missing+Parameters::MaxSlidingWindowSize, '#')-missing);
+        }
+
+        //Number of bytes that are sent. Only the used part of missing is sent, but never less than LegacySlidingWindowSize
+        //entries since that is what older versions expect.
+        size_t WireSize() const
+        {
+            return sizeof(Ack)-Parameters::MaxSlidingWindowSize+std::max(NumberOfMissingEntries(), Parameters::LegacySlidingWindowSize);
+        }
+
         std::string ToString() const
         {
             std::ostringstream os;
             os<<"AckContent: {"<<commonHeader.ToString()<<", sendMethod: "<<SendMethodToString(sendMethod)<<", seq: "<<sequenceNumber<<", gaps: [";
 
-            for (unsigned int i = 0; i < Parameters::MaxSlidingWindowSize; ++i)
+            const size_t numberOfEntries=NumberOfMissingEntries();
+            for (unsigned int i = 0; i < numberOfEntries; ++i)
             {
                     os<<static_cast<int>(missing[i]);
             }
@@ -211,19 +233,158 @@ namespace Com
         }
     };
 
+    //Header of each message packed into a datagram of type CoalescedDataType. The payload of such a datagram is a
+    //sequence of CoalescedHeader, each one followed by the size bytes of the message.
+    struct CoalescedHeader
+    {
+        int64_t dataType;
+        uint32_t size;
+
+        CoalescedHeader(int64_t dataType_, size_t size_)
+            :dataType(dataType_)
+            ,size(static_cast<uint32_t>(size_))
+        {
+        }
+    };
+
     #pragma pack(pop)
 
     static const size_t MessageHeaderSize=sizeof(MessageHeader);
+    static const size_t CoalescedHeaderSize=sizeof(CoalescedHeader);
+    static const size_t AckHeaderSize=sizeof(Ack)-Parameters::MaxSlidingWindowSize;
+
+    //Number of bytes of a value that are sent on the wire. Default is the whole struct.
+    template <class T>
+    inline size_t WireSize(const T&) {return sizeof(T);}
+    inline size_t WireSize(const Ack& ack) {return ack.WireSize();}
 
     //This is for keeping track of ack's and not sent messages.
-    typedef std::set<int64_t> Receivers;
+    //Set of node slots, where a slot is a small index that the DataSender assigns to each node. The first InlineSlots
+    //slots are stored in the object itself, so only node types with very many nodes will cause a heap allocation.
+    class Receivers
+    {
+    public:
+        static const size_t InlineSlots=128;
+
+        Receivers() :m_inline(), m_overflow() {}
+
+        void insert(size_t slot)
+        {
+            if (slot>=InlineSlots && (slot-InlineSlots)/64>=m_overflow.size())
+            {
+                m_overflow.resize((slot-InlineSlots)/64+1, 0);
+            }
+            Word(slot)|=Bit(slot);
+        }
+
+        void erase(size_t slot)
+        {
+            if (contains(slot))
+            {
+                Word(slot)&=~Bit(slot);
+            }
+        }
+
+        bool contains(size_t slot) const
+        {
+            if (slot<InlineSlots)
+            {
+                return (m_inline[slot/64] & Bit(slot))!=0;
+            }
+            const size_t index=(slot-InlineSlots)/64;
+            return index<m_overflow.size() && (m_overflow[index] & Bit(slot))!=0;
+        }
+
+        bool empty() const
+        {
+            for (size_t i=0; i<NumberOfWords(); ++i)
+            {
+                if (WordAt(i)!=0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        size_t size() const
+        {
+            size_t count=0;
+            for (size_t i=0; i<NumberOfWords(); ++i)
+            {
+                count+=std::bitset<64>(WordAt(i)).count();
+            }
+            return count;
+        }
+
+        void clear()
+        {
+            std::fill(std::begin(m_inline), std::end(m_inline), 0);
+            m_overflow.clear();
+        }
+
+        //add all slots in other to this set
+        void merge(const Receivers& other)
+        {
+            if (other.m_overflow.size()>m_overflow.size())
+            {
+                m_overflow.resize(other.m_overflow.size(), 0);
+            }
+            for (size_t i=0; i<other.NumberOfWords(); ++i)
+            {
+                WordAt(i)|=other.WordAt(i);
+            }
+        }
+
+        //Call f(slot) for every slot in the set in increasing order. It is allowed to erase slots from within f.
+        template <class F>
+        void for_each(F f) const
+        {
+            for (size_t i=0; i<NumberOfWords(); ++i)
+            {
+                uint64_t word=WordAt(i);
+                while (word!=0)
+                {
+                    const size_t bit=LowestBit(word);
+                    word&=word-1;
+                    f(i*64+bit);
+                }
+            }
+        }
+
+    private:
+        uint64_t m_inline[InlineSlots/64];
+        std::vector<uint64_t> m_overflow;
+
+        static uint64_t Bit(size_t slot) {return static_cast<uint64_t>(1)<<(slot%64);}
+
+        size_t NumberOfWords() const {return InlineSlots/64+m_overflow.size();}
+        uint64_t WordAt(size_t i) const {return i<InlineSlots/64 ? m_inline[i] : m_overflow[i-InlineSlots/64];}
+        uint64_t& WordAt(size_t i) {return i<InlineSlots/64 ? m_inline[i] : m_overflow[i-InlineSlots/64];}
+        uint64_t& Word(size_t slot) {return WordAt(slot/64);}
+
+        static size_t LowestBit(uint64_t word)
+        {
+#if defined(__GNUC__)
+            return static_cast<size_t>(__builtin_ctzll(word));
+#else
+            size_t bit=0;
+            while ((word & 1)==0)
+            {
+                word>>=1;
+                ++bit;
+            }
+            return bit;
+#endif
+        }
+    };
 
     struct UserData
     {
         MessageHeader header; //message header
         Safir::Utilities::Internal::SharedConstCharArray message; //This is to prevent  destruction of data before all fragments are sent
         const char* fragment; //This is what is sent in this UserData. If not fragmented these will be the same as payload and payloadSize
-        Receivers receivers; //Set of receivers, can be filled with a receiver list, or if MultiReceiverSendMethod it will be filled when its sent
+        Receivers receivers; //Set of receiver slots, can be filled with a receiver list, or if MultiReceiverSendMethod it will be filled when its sent
         std::chrono::steady_clock::time_point sendTime; //timestamp when this messages was last transmitted so we know when it's time to make retransmit
         size_t transmitCount;
 
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <map>
+#include <mutex>
 #include "DataSender.h"
 #include "HeartbeatSender.h"
 
@@ -63,7 +64,10 @@ namespace Com
                  int ackRequestThreshold,
                  int fragmentSize,
                  bool isLightNode,
-                 const std::vector<int>& retryTimeout)
+                 const std::vector<int>& retryTimeout,
+                 size_t sendQueueSize,
+                 bool adaptiveSlidingWindow,
+                 bool coalesceMessages)
             :m_id(id)
             ,m_name(name)
             ,m_multicastAddress(multicastAddr)
@@ -76,8 +80,11 @@ namespace Com
             ,m_useMulticast(useMulticast)
             ,m_isLightNode(isLightNode)
             ,m_heartbeatSender(ioContext, id, thisNodeId, m_ipVersion, localIf, McAddr(m_multicastAddress, m_useMulticast), heartbeatInterval)
-            ,m_ackedDataSender(ioContext, Acked, m_id, thisNodeId, m_ipVersion, localIf, McAddr(m_multicastAddress, m_useMulticast), slidingWindowSize, ackRequestThreshold, retryTimeout, fragmentSize)
-            ,m_unackedDataSender(ioContext, Unacked, m_id, thisNodeId, m_ipVersion, localIf, McAddr(m_multicastAddress, m_useMulticast), slidingWindowSize, ackRequestThreshold, retryTimeout, fragmentSize)
+            ,m_ackedDataSender(ioContext, Acked, m_id, thisNodeId, m_ipVersion, localIf, McAddr(m_multicastAddress, m_useMulticast), slidingWindowSize, ackRequestThreshold, retryTimeout, fragmentSize, sendQueueSize, adaptiveSlidingWindow, coalesceMessages)
+            ,m_unackedDataSender(ioContext, Unacked, m_id, thisNodeId, m_ipVersion, localIf, McAddr(m_multicastAddress, m_useMulticast), slidingWindowSize, ackRequestThreshold, retryTimeout, fragmentSize, sendQueueSize, adaptiveSlidingWindow, coalesceMessages)
+            ,m_featuresMutex()
+            ,m_nodeFeatures()
+            ,m_crc32c(false)
         {
         }
 
@@ -102,6 +109,39 @@ namespace Com
         DataSender& GetUnackedDataSender() {return m_unackedDataSender;}
         const DataSender& GetUnackedDataSender() const {return m_unackedDataSender;}
 
+        //Checksum negotiation. CRC32C is used when sending to this node type when all its nodes have announced
+        //support for it in their heartbeats. A new node is assumed not to support it until its first heartbeat.
+        void NodeAdded(int64_t nodeId)
+        {
+            std::lock_guard<std::mutex> lck(m_featuresMutex);
+            m_nodeFeatures[nodeId]=0;
+            UpdateChecksum();
+        }
+
+        void NodeRemoved(int64_t nodeId)
+        {
+            std::lock_guard<std::mutex> lck(m_featuresMutex);
+            m_nodeFeatures.erase(nodeId);
+            UpdateChecksum();
+        }
+
+        void SetNodeFeatures(int64_t nodeId, uint8_t features)
+        {
+            std::lock_guard<std::mutex> lck(m_featuresMutex);
+            auto it=m_nodeFeatures.find(nodeId);
+            if (it!=m_nodeFeatures.end() && it->second!=features)
+            {
+                it->second=features;
+                UpdateChecksum();
+            }
+        }
+
+        bool UseCrc32c() const
+        {
+            std::lock_guard<std::mutex> lck(m_featuresMutex);
+            return m_crc32c;
+        }
+
     private:
         const int64_t m_id;
         const std::string m_name;               //unique readable name
@@ -119,7 +159,29 @@ namespace Com
         DataSender m_ackedDataSender;
         DataSender m_unackedDataSender;
 
+        mutable std::mutex m_featuresMutex;
+        std::map<int64_t, uint8_t> m_nodeFeatures;
+        bool m_crc32c;
+
         static std::string McAddr(const std::string& addr, bool use){return use ? addr : "";}
+
+        void UpdateChecksum()
+        {
+            bool crc32c=Parameters::Crc32cEnabled && !m_nodeFeatures.empty();
+            for (auto it = m_nodeFeatures.cbegin(); it != m_nodeFeatures.cend() && crc32c; ++it)
+            {
+                crc32c=(it->second & Crc32cFeature)!=0;
+            }
+
+            if (crc32c!=m_crc32c)
+            {
+                m_crc32c=crc32c;
+                lllog(5)<<Parameters::LogPrefix.c_str()<<"Node type "<<m_name.c_str()<<(crc32c ? " uses CRC32C" : " uses CRC32")<<std::endl;
+                m_heartbeatSender.SetCrc32c(crc32c);
+                m_ackedDataSender.SetCrc32c(crc32c);
+                m_unackedDataSender.SetCrc32c(crc32c);
+            }
+        }
     };
 
     typedef std::shared_ptr<NodeType> NodeTypePtr;
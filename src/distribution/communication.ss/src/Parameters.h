@@ -36,22 +36,65 @@ namespace Com
 {
     namespace Parameters
     {
-        //Size of the send queue, number of outstanding messages
+        //Default size of the send queue, number of outstanding messages. Can be set per node type.
         static const size_t SendQueueSize = 100;
 
         //Max number of messages that can be sent in sequence before waiting for ack.
         //Max number of messages out of order that are saved
-        static const size_t MaxSlidingWindowSize=20;
+        static const size_t MaxSlidingWindowSize=256;
+
+        //The sliding window size that older versions always use in acks. Acks are never sent with fewer entries than this.
+        static const size_t LegacySlidingWindowSize=20;
 
         //Max number of undelivered messages to application allowed before slowing down receiver
         static const size_t MaxNumberOfUndelivered=20;
 
+        //When the receiver has reached MaxNumberOfUndelivered, reading is resumed as soon as the DeliveryHandler reports
+        //that the application has caught up. This is a fallback interval for checking the receiver (milliseconds).
+        static const int ReceiverWatchdogInterval=100;
+
+        //With more than one receive strand, max number of received datagrams waiting to be handled in the strand of
+        //their node type before slowing down receiver
+        static const unsigned int MaxPendingReceivedDatagrams=64;
+
         //Receive buffer size, must be at least FragmentSize
         static const size_t ReceiveBufferSize = 66000;
 
+        //Max number of datagrams read from a socket in one wakeup (recvmmsg on Linux, other platforms always read one).
+#ifdef __linux__
+        static const size_t ReceiveBatchSize = 16;
+#else
+        static const size_t ReceiveBatchSize = 1;
+#endif
+
         //This is the socket send and receive buffer. On Windows the default is 8192 wich is far too low.
         static const int SocketBufferSize = 106496;
 
+        //Send datagrams produced in the same pass over the send queue with as few system calls as possible (sendmmsg on Linux).
+        static const bool BatchedSendEnabled = true;
+
+        //Announce support for CRC32C checksums in heartbeats. CRC32C is used when sending to a node type once all its nodes have announced it.
+        //Received datagrams are always accepted with either checksum.
+        static const bool Crc32cEnabled = true;
+
+        //Max number of datagrams sent in one system call when batched send is enabled.
+        static const size_t MaxSendBatchSize = 64;
+
+        //For node types with CoalesceMessages, messages up to this size are packed together with other small messages
+        //into shared datagrams. Never more than half the fragment size is used.
+        static const size_t MaxCoalescedMessageSize = 512;
+
+        //Base the retry timeouts on the measured round trip time to each node (like TCP, RFC 6298). The configured RetryTimeout
+        //values are then only used until a round trip time has been measured, and as an upper limit.
+        static const bool RttBasedRetryTimeout = true;
+
+        //Lower limit of the round trip time based retry timeout.
+        static const int MinRetryTimeout = 10; //millisec
+
+        //As long as messages are missing on an acked channel, i.e. a later message has arrived but not an earlier one,
+        //an ack telling which messages are missing is sent to the sender with this interval.
+        static const int NackInterval = 10; //millisec
+
         //If no acked data has been sent for this time, the system will send a ping message to all other nodes.
         static const int SendPingThreshold = 7000; //millisec
 
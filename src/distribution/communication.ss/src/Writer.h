@@ -25,11 +25,17 @@
 
 #include <map>
 #include <memory>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <atomic>
 #include <Safir/Utilities/Internal/LowLevelLogger.h>
 #include <Safir/Utilities/Internal/SystemLog.h>
 #include "Message.h"
+#include "Checksum.h"
 #include "Resolver.h"
 #include "Parameters.h"
+#include "Utilities.h"
 
 #ifdef _MSC_VER
 #pragma warning (push)
@@ -42,6 +48,12 @@
 #pragma warning (pop)
 #endif
 
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <errno.h>
+#endif
+
 namespace Safir
 {
 namespace Dob
@@ -50,33 +62,107 @@ namespace Internal
 {
 namespace Com
 {
+    //Selects the checksum added to sent datagrams, see Checksum. Can be changed while sending.
+    class ChecksumSelection
+    {
+    public:
+        void SetCrc32c(bool crc32c) {m_crc32c=crc32c;}
+        bool IsCrc32c() const {return m_crc32c;}
+
+    private:
+        std::atomic<bool> m_crc32c{false};
+    };
+
+    //------------------------------------------------------------
+    // Simulates a very unreliable network. Used by the send policy
+    // when COM_USE_UNRELIABLE_SEND_POLICY is defined, and by tests.
+    //------------------------------------------------------------
+    struct UnreliableSender
+    {
+        static const int LossPercent        = 3;
+        static const int DuplicatePercent   = 3;
+        static const int ReorderPercent     = 3;
+
+        void Send(std::vector< boost::asio::const_buffer > bufs,
+                  boost::asio::ip::udp::socket& socket,
+                  const boost::asio::ip::udp::endpoint& to)
+        {
+            Send(bufs, [&](const std::vector< boost::asio::const_buffer >& b){socket.send_to(b, to);});
+        }
+
+        //Same as above but the datagrams that make it through are passed to send, used to simulate a lossy link in tests.
+        template <class SendFunction>
+        void Send(const std::vector< boost::asio::const_buffer >& bufs, const SendFunction& send)
+        {
+            static Utilities::Random random(0, 100);
+
+            if (!m_reorderBuf.empty()) //we have something to reorder
+            {
+                send(bufs);
+                send(std::vector< boost::asio::const_buffer >(1, boost::asio::buffer(m_reorderBuf)));
+                m_reorderBuf.clear();
+                return;
+            }
+
+            auto n=random.Get();
+            if (Loss(n))
+            {
+                return;
+            }
+            else if (Duplicate(n))
+            {
+                send(bufs);
+                send(bufs);
+                send(bufs);
+            }
+            else if (Reorder(n))
+            {
+                m_reorderBuf.clear();
+                m_reorderBuf.resize(boost::asio::buffer_size(bufs));
+                boost::asio::buffer_copy(boost::asio::buffer(m_reorderBuf), bufs);
+            }
+            else //normal send
+            {
+                send(bufs);
+            }
+        }
+
+    private:
+        std::vector<char> m_reorderBuf{};
+
+        inline bool Loss(int n) const {return n<LossPercent;} //0 - 5
+        inline bool Duplicate(int n) const {return n>=LossPercent && n<(LossPercent+DuplicatePercent);} // 10 - 15
+        inline bool Reorder(int n) const {return n>=(LossPercent+DuplicatePercent) && n<(LossPercent+DuplicatePercent+ReorderPercent);} //5 - 10
+    };
+
 //#define COM_USE_UNRELIABLE_SEND_POLICY //Only uncomment during test.
 #ifndef COM_USE_UNRELIABLE_SEND_POLICY
     //------------------------------------------------------------
     // Normal send policy using udp sockets
     //------------------------------------------------------------
     template <class T>
-    struct BasicSendPolicy
+    struct BasicSendPolicy : public ChecksumSelection
     {
         bool Send(const std::shared_ptr<T>& val,
                   boost::asio::ip::udp::socket& socket,
                   const boost::asio::ip::udp::endpoint& to)
         {
             //calculate crc and add it last in sendBuffer
-            boost::crc_32_type crc;
-            crc.process_bytes(static_cast<const void*>(val.get()), sizeof(T));
-            uint32_t crc32=crc.checksum();
+            const size_t size=WireSize(*val);
+            Checksum crc(IsCrc32c());
+            crc.Process(static_cast<const void*>(val.get()), size);
+            uint32_t crc32=crc.Value();
             std::vector< boost::asio::const_buffer > bufs;
-            bufs.push_back(boost::asio::buffer(static_cast<const void*>(val.get()), sizeof(T)));
+            bufs.push_back(boost::asio::buffer(static_cast<const void*>(val.get()), size));
             bufs.push_back(boost::asio::buffer(reinterpret_cast<const char*>(&crc32), sizeof(uint32_t)));
 
             try
             {
                 const size_t sent = socket.send_to(bufs, to);
-                if (sent != sizeof(T) + sizeof(uint32_t))
+                if (sent != size + sizeof(uint32_t))
                 {
                     SEND_SYSTEM_LOG(Informational, <<Parameters::LogPrefix.c_str()<<"Write<T> to " << to << " failed. Only "
-                                    << sent << " bytes were sent, instead of " << sizeof(T) + sizeof(uint32_t));
+                                    << sent << " bytes were sent, instead of " << size + sizeof(uint32_t));
                     return false;
                 }
                 return true;
@@ -90,27 +176,27 @@ namespace Com
     };
 
     template <>
-    struct BasicSendPolicy<UserData>
+    struct BasicSendPolicy<UserData> : public ChecksumSelection
     {
         bool Send(const UserDataPtr& val,
                   boost::asio::ip::udp::socket& socket,
                   const boost::asio::ip::udp::endpoint& to)
         {
             const char* header=reinterpret_cast<const char*>(&(val->header));
-            boost::crc_32_type crc;
+            Checksum crc(IsCrc32c());
             std::vector< boost::asio::const_buffer > bufs;
             size_t size = MessageHeaderSize;
             bufs.push_back(boost::asio::buffer(header, MessageHeaderSize));
-            crc.process_bytes(static_cast<const void*>(header), MessageHeaderSize);
+            crc.Process(static_cast<const void*>(header), MessageHeaderSize);
 
             if (val->header.fragmentContentSize>0)
             {
                 bufs.push_back(boost::asio::buffer(val->fragment, val->header.fragmentContentSize));
-                crc.process_bytes(static_cast<const void*>(val->fragment), val->header.fragmentContentSize);
+                crc.Process(static_cast<const void*>(val->fragment), val->header.fragmentContentSize);
                 size += val->header.fragmentContentSize;
             }
 
-            uint32_t crc32=crc.checksum();
+            uint32_t crc32=crc.Value();
             bufs.push_back(boost::asio::buffer(reinterpret_cast<const char*>(&crc32), sizeof(uint32_t)));
             size += sizeof(uint32_t);
 
@@ -131,76 +217,178 @@ namespace Com
                 return false;
             }
         }
-    };
-
-#else
-    //------------------------------------------------------------
-    // Unsafe sendpolicy - simulates a very unreliable network
-    //------------------------------------------------------------
-    struct UnreliableSender
-    {
-        static const int LossPercent        = 3;
-        static const int DuplicatePercent   = 3;
-        static const int ReorderPercent     = 3;
 
-        void Send(std::vector< boost::asio::const_buffer > bufs,
-                  boost::asio::ip::udp::socket& socket,
-                  const boost::asio::ip::udp::endpoint& to)
+        //Add a datagram to the batch that will be sent by the next call to FlushBatch. The header is copied and the
+        //crc calculated immediately since the caller is allowed to modify the header (ackNow, receiverId) after this call.
+        void QueueBatch(const UserDataPtr& val, const boost::asio::ip::udp::endpoint& to)
         {
-            static Utilities::Random random(0, 100);
-
-            if (!m_reorderBuf.empty()) //we have something to reorder
+            m_batch.emplace_back(val, to);
+            Datagram& dg=m_batch.back();
+            Checksum crc(IsCrc32c());
+            crc.Process(static_cast<const void*>(&dg.header), MessageHeaderSize);
+            if (dg.header.fragmentContentSize>0)
             {
-                socket.send_to(bufs, to);
-                socket.send_to(boost::asio::buffer(m_reorderBuf), to);
-                m_reorderBuf.clear();
-                return;
+                crc.Process(static_cast<const void*>(val->fragment), dg.header.fragmentContentSize);
             }
+            dg.crc32=crc.Value();
+        }
 
-            auto n=random.Get();
-            if (Loss(n))
+        //Send all queued datagrams. On Linux this is done with sendmmsg, i.e one system call for up to
+        //Parameters::MaxSendBatchSize datagrams. Returns false if the socket failed, the rest of the batch is then discarded.
+        bool FlushBatch(boost::asio::ip::udp::socket& socket)
+        {
+            bool result=true;
+            try
             {
-                return;
+#ifdef __linux__
+                result=SendMultiple(socket);
+#else
+                for (auto dg = m_batch.cbegin(); dg != m_batch.cend() && result; ++dg)
+                {
+                    result=SendSingle(*dg, socket);
+                }
+#endif
             }
-            else if (Duplicate(n))
+            catch (const boost::system::system_error& sysErr)
             {
-                socket.send_to(bufs, to);
-                socket.send_to(bufs, to);
-                socket.send_to(bufs, to);
+                SEND_SYSTEM_LOG(Error, <<Parameters::LogPrefix.c_str()<<"Batched write failed with systemError: "<<sysErr.what());
+                result=false;
             }
-            else if (Reorder(n))
+            m_batch.clear();
+            return result;
+        }
+
+    private:
+        struct Datagram
+        {
+            Datagram(const UserDataPtr& data_, const boost::asio::ip::udp::endpoint& to_)
+                :header(data_->header)
+                ,data(data_)
+                ,crc32(0)
+                ,to(to_)
             {
-                m_reorderBuf.clear();
-                m_reorderBuf.resize(boost::asio::buffer_size(bufs));
-                boost::asio::buffer_copy(boost::asio::buffer(m_reorderBuf), bufs);
             }
-            else //normal send
+
+            MessageHeader header;
+            UserDataPtr data; //keeps the fragment alive until it has been sent
+            uint32_t crc32;
+            boost::asio::ip::udp::endpoint to;
+
+            size_t Size() const {return MessageHeaderSize+header.fragmentContentSize+sizeof(uint32_t);}
+        };
+
+        std::vector<Datagram> m_batch;
+
+#ifdef __linux__
+        std::vector<struct mmsghdr> m_msgs;
+        std::vector<struct iovec> m_iovecs;
+
+        bool SendMultiple(boost::asio::ip::udp::socket& socket)
+        {
+            size_t offset=0;
+            while (offset<m_batch.size())
             {
-                socket.send_to(bufs, to);
+                const size_t count=std::min(m_batch.size()-offset, Parameters::MaxSendBatchSize);
+                m_msgs.assign(count, mmsghdr());
+                m_iovecs.resize(count*3);
+
+                for (size_t i=0; i<count; ++i)
+                {
+                    Datagram& dg=m_batch[offset+i];
+                    struct iovec* iov=&m_iovecs[i*3];
+                    size_t numIov=0;
+                    iov[numIov].iov_base=&dg.header;
+                    iov[numIov++].iov_len=MessageHeaderSize;
+                    if (dg.header.fragmentContentSize>0)
+                    {
+                        iov[numIov].iov_base=const_cast<char*>(dg.data->fragment);
+                        iov[numIov++].iov_len=dg.header.fragmentContentSize;
+                    }
+                    iov[numIov].iov_base=&dg.crc32;
+                    iov[numIov++].iov_len=sizeof(uint32_t);
+
+                    struct msghdr& hdr=m_msgs[i].msg_hdr;
+                    hdr.msg_name=dg.to.data();
+                    hdr.msg_namelen=static_cast<socklen_t>(dg.to.size());
+                    hdr.msg_iov=iov;
+                    hdr.msg_iovlen=numIov;
+                }
+
+                size_t sentInCall=0;
+                while (sentInCall<count)
+                {
+                    const int res=::sendmmsg(socket.native_handle(), &m_msgs[sentInCall], static_cast<unsigned int>(count-sentInCall), 0);
+                    if (res<0)
+                    {
+                        if (errno==EINTR)
+                        {
+                            continue;
+                        }
+                        else if (errno==EAGAIN || errno==EWOULDBLOCK)
+                        {
+                            socket.wait(boost::asio::socket_base::wait_write);
+                            continue;
+                        }
+                        const boost::system::error_code ec(errno, boost::asio::error::get_system_category());
+                        SEND_SYSTEM_LOG(Error, <<Parameters::LogPrefix.c_str()<<"Write to " << m_batch[offset+sentInCall].to
+                                        << " failed with systemError: "<<ec.message().c_str());
+                        return false;
+                    }
+
+                    for (size_t i=sentInCall; i<sentInCall+static_cast<size_t>(res); ++i)
+                    {
+                        const Datagram& dg=m_batch[offset+i];
+                        if (m_msgs[i].msg_len!=dg.Size())
+                        {
+                            SEND_SYSTEM_LOG(Informational, <<Parameters::LogPrefix.c_str()<<"Write<UserData> to " << dg.to << " failed. Only "
+                                            << m_msgs[i].msg_len << " bytes were sent, instead of " << dg.Size());
+                            return false;
+                        }
+                    }
+                    sentInCall+=static_cast<size_t>(res);
+                }
+                offset+=count;
             }
+            return true;
         }
+#else
+        bool SendSingle(const Datagram& dg, boost::asio::ip::udp::socket& socket)
+        {
+            std::vector< boost::asio::const_buffer > bufs;
+            bufs.push_back(boost::asio::buffer(reinterpret_cast<const char*>(&dg.header), MessageHeaderSize));
+            if (dg.header.fragmentContentSize>0)
+            {
+                bufs.push_back(boost::asio::buffer(dg.data->fragment, dg.header.fragmentContentSize));
+            }
+            bufs.push_back(boost::asio::buffer(reinterpret_cast<const char*>(&dg.crc32), sizeof(uint32_t)));
 
-    private:
-        std::vector<char> m_reorderBuf{};
-
-        inline bool Loss(int n) const {return n<LossPercent;} //0 - 5
-        inline bool Duplicate(int n) const {return n>=LossPercent && n<(LossPercent+DuplicatePercent);} // 10 - 15
-        inline bool Reorder(int n) const {return n>=(LossPercent+DuplicatePercent) && n<(LossPercent+DuplicatePercent+ReorderPercent);} //5 - 10
+            const size_t sent = socket.send_to(bufs, dg.to);
+            if (sent != dg.Size())
+            {
+                SEND_SYSTEM_LOG(Informational, <<Parameters::LogPrefix.c_str()<<"Write<UserData> to " << dg.to << " failed. Only "
+                                << sent << " bytes were sent, instead of " << dg.Size());
+                return false;
+            }
+            return true;
+        }
+#endif
     };
 
+#else
     template <class T>
-    struct BasicSendPolicy : private UnreliableSender
+    struct BasicSendPolicy : public ChecksumSelection, private UnreliableSender
     {
         bool Send(const std::shared_ptr<T>& val,
                   boost::asio::ip::udp::socket& socket,
                   const boost::asio::ip::udp::endpoint& to)
         {
             //calculate crc and add it last in sendBuffer
-            boost::crc_32_type crc;
-            crc.process_bytes(static_cast<const void*>(val.get()), sizeof(T));
-            uint32_t crc32=crc.checksum();
+            const size_t size=WireSize(*val);
+            Checksum crc(IsCrc32c());
+            crc.Process(static_cast<const void*>(val.get()), size);
+            uint32_t crc32=crc.Value();
             std::vector< boost::asio::const_buffer > bufs;
-            bufs.push_back(boost::asio::buffer(static_cast<const void*>(val.get()), sizeof(T)));
+            bufs.push_back(boost::asio::buffer(static_cast<const void*>(val.get()), size));
             bufs.push_back(boost::asio::buffer(reinterpret_cast<const char*>(&crc32), sizeof(uint32_t)));
             UnreliableSender::Send(bufs, socket, to);
             return true;
@@ -208,26 +396,26 @@ namespace Com
     };
 
     template <>
-    struct BasicSendPolicy<UserData> : private UnreliableSender
+    struct BasicSendPolicy<UserData> : public ChecksumSelection, private UnreliableSender
     {
         bool Send(const UserDataPtr& val,
                   boost::asio::ip::udp::socket& socket,
                   const boost::asio::ip::udp::endpoint& to)
         {
             const char* header=reinterpret_cast<const char*>(&(val->header));
-            boost::crc_32_type crc;
+            Checksum crc(IsCrc32c());
             std::vector< boost::asio::const_buffer > bufs;
 
             bufs.push_back(boost::asio::buffer(header, MessageHeaderSize));
-            crc.process_bytes(static_cast<const void*>(header), MessageHeaderSize);
+            crc.Process(static_cast<const void*>(header), MessageHeaderSize);
 
             if (val->header.fragmentContentSize>0)
             {
                 bufs.push_back(boost::asio::buffer(val->fragment, val->header.fragmentContentSize));
-                crc.process_bytes(static_cast<const void*>(val->fragment), val->header.fragmentContentSize);
+                crc.Process(static_cast<const void*>(val->fragment), val->header.fragmentContentSize);
             }
 
-            uint32_t crc32=crc.checksum();
+            uint32_t crc32=crc.Value();
             bufs.push_back(boost::asio::buffer(reinterpret_cast<const char*>(&crc32), sizeof(uint32_t)));
             UnreliableSender::Send(bufs, socket, to);
             return true;
@@ -236,6 +424,21 @@ namespace Com
     //------------------------------------------------------------
 #endif
 
+    //Detects if a send policy supports batched sending, i.e has QueueBatch and FlushBatch. Policies that don't
+    //(the unreliable policy and the test policies) will always send immediately.
+    template <class SendPolicy, class T, class=void>
+    struct SupportsBatchSend : std::false_type {};
+
+    template <class SendPolicy, class T>
+    struct SupportsBatchSend<SendPolicy, T, decltype(std::declval<SendPolicy&>().QueueBatch(std::declval<const std::shared_ptr<T>&>(),
+                                                                                              std::declval<const boost::asio::ip::udp::endpoint&>()),
+                                                     void(std::declval<SendPolicy&>().FlushBatch(std::declval<boost::asio::ip::udp::socket&>())))>
+        : std::true_type {};
+
+    //Detects if a send policy can select checksum, i.e is derived from ChecksumSelection. Test policies don't calculate any checksum.
+    template <class SendPolicy>
+    struct SupportsChecksumSelection : std::is_base_of<ChecksumSelection, SendPolicy> {};
+
     /**
      * The writer class is responsible for sending data using asynchronous UDP unicast or multicast.
      * It handles the socket setup and add an abstraction level to the send process that makes other parts of
@@ -247,10 +450,29 @@ namespace Com
     public:
         typedef std::shared_ptr<T> Ptr;
 
+        /**
+         * All datagrams sent while a ScopedBatch exists are collected and sent when the outermost
+         * ScopedBatch goes out of scope. Must be used from the same strand as the sends.
+         */
+        class ScopedBatch
+        {
+        public:
+            explicit ScopedBatch(Writer& writer) : m_writer(writer) {m_writer.BeginBatch();}
+            ~ScopedBatch() {m_writer.EndBatch();}
+
+            ScopedBatch(const ScopedBatch&) = delete;
+            const ScopedBatch& operator=(const ScopedBatch&) = delete;
+        private:
+            Writer& m_writer;
+        };
+
         Writer(boost::asio::io_context& ioContext, int protocol)
             :m_ioContext(ioContext)
             ,m_protocol(protocol)
             ,m_multicastEndpoint()
+            ,m_batchEnabled(Parameters::BatchedSendEnabled)
+            ,m_batchDepth(0)
+            ,m_batchPending(false)
         {
             InitSocket();
         }
@@ -264,6 +486,9 @@ namespace Com
             ,m_localIf(localIf)
             ,m_multicastAddress(multicastAddress)
             ,m_multicastEndpoint()
+            ,m_batchEnabled(Parameters::BatchedSendEnabled)
+            ,m_batchDepth(0)
+            ,m_batchPending(false)
         {
             InitSocket();
         }
@@ -274,6 +499,15 @@ namespace Com
 
         bool IsMulticastEnabled() const {return !m_multicastAddress.empty();}
 
+        //Turn batched sending on or off. If off, or if the SendPolicy lacks batch support, every SendTo results in
+        //an immediate send.
+        void SetBatchEnabled(bool enabled) {m_batchEnabled=enabled;}
+        bool IsBatchEnabled() const {return m_batchEnabled && SupportsBatchSend<SendPolicy, T>::value;}
+
+        //Use CRC32C instead of CRC32 as checksum. Only allowed if all receivers support it. Thread safe.
+        void SetCrc32c(bool crc32c) {SetCrc32c(crc32c, SupportsChecksumSelection<SendPolicy>());}
+        bool IsCrc32c() const {return IsCrc32c(SupportsChecksumSelection<SendPolicy>());}
+
         void SendTo(const Ptr& val, const boost::asio::ip::udp::endpoint& to)
         {
             if (!m_socket)
@@ -282,11 +516,13 @@ namespace Com
             }
             if (Parameters::NetworkEnabled && m_socket)
             {
-                auto sendOk = SendPolicy::Send(val, *m_socket, to);
-                if (!sendOk)
+                if (m_batchDepth>0 && m_batchEnabled)
                 {
-                    m_socket->close();
-                    m_socket.reset();
+                    QueueOrSend(val, to, SupportsBatchSend<SendPolicy, T>());
+                }
+                else
+                {
+                    Send(val, to);
                 }
             }
         }
@@ -296,6 +532,19 @@ namespace Com
             SendTo(val, m_multicastEndpoint);
         }
 
+        void BeginBatch()
+        {
+            ++m_batchDepth;
+        }
+
+        void EndBatch()
+        {
+            if (m_batchDepth>0 && --m_batchDepth==0)
+            {
+                Flush(SupportsBatchSend<SendPolicy, T>());
+            }
+        }
+
     private:
         boost::asio::io_context& m_ioContext;
         const int m_protocol;
@@ -303,6 +552,56 @@ namespace Com
         const std::string m_multicastAddress;
         std::unique_ptr<boost::asio::ip::udp::socket> m_socket;
         boost::asio::ip::udp::endpoint m_multicastEndpoint;
+        bool m_batchEnabled;
+        unsigned int m_batchDepth;
+        bool m_batchPending;
+
+        void Send(const Ptr& val, const boost::asio::ip::udp::endpoint& to)
+        {
+            auto sendOk = SendPolicy::Send(val, *m_socket, to);
+            if (!sendOk)
+            {
+                m_socket->close();
+                m_socket.reset();
+            }
+        }
+
+        void QueueOrSend(const Ptr& val, const boost::asio::ip::udp::endpoint& to, std::true_type)
+        {
+            SendPolicy::QueueBatch(val, to);
+            m_batchPending=true;
+        }
+
+        void QueueOrSend(const Ptr& val, const boost::asio::ip::udp::endpoint& to, std::false_type)
+        {
+            Send(val, to);
+        }
+
+        void Flush(std::true_type)
+        {
+            if (!m_batchPending)
+            {
+                return;
+            }
+            m_batchPending=false;
+
+            if (m_socket)
+            {
+                auto sendOk = SendPolicy::FlushBatch(*m_socket);
+                if (!sendOk)
+                {
+                    m_socket->close();
+                    m_socket.reset();
+                }
+            }
+        }
+
+        void Flush(std::false_type) {}
+
+        void SetCrc32c(bool crc32c, std::true_type) {SendPolicy::SetCrc32c(crc32c);}
+        void SetCrc32c(bool, std::false_type) {}
+        bool IsCrc32c(std::true_type) const {return SendPolicy::IsCrc32c();}
+        bool IsCrc32c(std::false_type) const {return false;}
 
         void InitSocket()
         {
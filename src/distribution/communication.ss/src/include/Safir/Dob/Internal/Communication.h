@@ -53,7 +53,10 @@ namespace Com
                             int maxLostHeartbeats_,
                             int slidingWindowSize_,
                             int ackRequestThreshold_,
-                            const std::vector<int>& retryTimeout_)
+                            const std::vector<int>& retryTimeout_,
+                            int sendQueueSize_=0,
+                            bool adaptiveSlidingWindow_=false,
+                            bool coalesceMessages_=false)
                             :id(id_)
                             ,name(name_)
                             ,controlMulticastAddress(controlMulticastAddress_)
@@ -64,6 +67,9 @@ namespace Com
                             ,slidingWindowSize(slidingWindowSize_)
                             ,ackRequestThreshold(ackRequestThreshold_)
                             ,retryTimeout(retryTimeout_)
+                            ,sendQueueSize(sendQueueSize_)
+                            ,adaptiveSlidingWindow(adaptiveSlidingWindow_)
+                            ,coalesceMessages(coalesceMessages_)
                             {
                             }
 
@@ -77,6 +83,30 @@ namespace Com
         int slidingWindowSize;                  //maximum outstanding messages at the same time
         int ackRequestThreshold;                //maximum outstanding before requesting ack from receiver
         std::vector<int> retryTimeout;          //time to wait before retransmitting data (milliseconds)
+        int sendQueueSize;                      //capacity of the send queue, 0 means default size
+        bool adaptiveSlidingWindow;             //adjust the window between ackRequestThreshold and slidingWindowSize depending on retransmits
+        bool coalesceMessages;                  //pack small messages to the same receivers into shared datagrams
+    };
+
+    /**
+     * Counters of the data receive path of a Communication instance. All counters are accumulated since start.
+     */
+    struct ReceiveStatistics
+    {
+        uint64_t receivedDatagrams=0;   //datagrams read from the data sockets
+        uint64_t receiveWakeups=0;      //completed socket reads, one read can return many datagrams
+        uint64_t badCrc=0;              //datagrams thrown away due to bad checksum
+        uint64_t droppedDatagrams=0;    //datagrams dropped by the sockets due to full socket buffers (only reported on Linux)
+    };
+
+    /**
+     * How the handling of received data is spread over the threads running the io_context.
+     */
+    enum class ReceiveStrands
+    {
+        Single,         //everything that is received is handled in one strand
+        PerSocket,      //every socket is read and its checksums verified in a strand of its own, the data is then handled in one strand
+        PerNodeType     //like PerSocket, but the data from the nodes of each node type is handled in a strand of its own
     };
 
     //Callbacks functions used in Communications public interface.
@@ -145,6 +175,7 @@ namespace Com
          * @param dataAddress [in] -  Data channel unicast address on format address:port, mandatory.
          * @param nodeTypes [in] - List of all node types that we shall be able to communicate with.
          * @param fragmentSize [in] - Network fragment size.
+         * @param receiveStrands [in] - How received data is spread over the io_context threads.
          */
         Communication(ControlModeTag,
                       boost::asio::io_context& ioContext,
@@ -154,7 +185,8 @@ namespace Com
                       const ResolvedAddress& controlAddress,
                       const ResolvedAddress& dataAddress,
                       const std::vector<NodeTypeDefinition>& nodeTypes,
-                      int fragmentSize);
+                      int fragmentSize,
+                      ReceiveStrands receiveStrands=ReceiveStrands::Single);
 
         /**
          * @brief Communication - Creates an instance of Communication in data mode. Will not run discover and nodes must be added manually.
@@ -166,6 +198,7 @@ namespace Com
          * @param dataAddress [in] -  Data channel unicast address on format address:port, mandatory.
          * @param nodeTypes [in] - List of all node types that we shall be able to communicate with.
          * @param fragmentSize [in] - Network fragment size.
+         * @param receiveStrands [in] - How received data is spread over the io_context threads.
          */
         Communication(DataModeTag,
                       boost::asio::io_context& ioContext,
@@ -174,7 +207,8 @@ namespace Com
                       int64_t nodeTypeId,
                       const ResolvedAddress& dataAddress,
                       const std::vector<NodeTypeDefinition>& nodeTypes,
-                      int fragmentSize);
+                      int fragmentSize,
+                      ReceiveStrands receiveStrands=ReceiveStrands::Single);
 
         /**
          * ~Communication - destructor.
@@ -342,6 +376,13 @@ namespace Com
          */
         size_t NumberOfQueuedMessages(int64_t nodeTypeId) const;
 
+        /**
+         * Get counters for received data. Can be called from any thread.
+         *
+         * @return Receive statistics since start.
+         */
+        ReceiveStatistics GetReceiveStatistics() const;
+
         /**
          * Get the name that was passed as argument to the constructor.
          *
@@ -23,6 +23,7 @@
 ******************************************************************************/
 #include <iostream>
 #include <limits>
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <boost/chrono.hpp>
@@ -92,6 +93,12 @@ public:
         ,messageSize(1000)
         ,threadCount(2)
         ,acked(true)
+        ,slidingWindowSize(20)
+        ,ackRequestThreshold(10)
+        ,sendQueueSize(0)
+        ,adaptiveWindow(false)
+        ,coalesce(false)
+        ,receiveStrands(Safir::Dob::Internal::Com::ReceiveStrands::Single)
     {
         boost::program_options::options_description desc("Command line options");
         desc.add_options()
@@ -105,7 +112,13 @@ public:
                 ("nrecv", boost::program_options::value<uint64_t>(), "Number of messages to receive from all otherl nodes (accumulated), default unlimited")
                 ("size", boost::program_options::value<size_t>(), "Size of data packets, default is 1000 bytes")
                 ("thread-count", boost::program_options::value<unsigned int>(), "Number of threads to run io_service, default is 2 threads")
-                ("unacked", "Send unacked messages");
+                ("unacked", "Send unacked messages")
+                ("window-size", boost::program_options::value<int>(), "Sliding window size for all node types, default is 20")
+                ("ack-threshold", boost::program_options::value<int>(), "Ack request threshold for all node types, default is 10")
+                ("send-queue-size", boost::program_options::value<int>(), "Send queue capacity for all node types, default is the built in size")
+                ("adaptive-window", "Let the sliding window adapt between ack-threshold and window-size")
+                ("coalesce", "Pack small messages into shared datagrams")
+                ("receive-strands", boost::program_options::value<std::string>(), "How received data is spread over the threads: single, socket or nodetype. Default single.");
         boost::program_options::variables_map vm;
         boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
         boost::program_options::notify(vm);
@@ -162,6 +175,42 @@ public:
         {
             acked=false;
         }
+        if (vm.count("window-size"))
+        {
+            slidingWindowSize=vm["window-size"].as<int>();
+        }
+        if (vm.count("ack-threshold"))
+        {
+            ackRequestThreshold=vm["ack-threshold"].as<int>();
+        }
+        if (vm.count("send-queue-size"))
+        {
+            sendQueueSize=vm["send-queue-size"].as<int>();
+        }
+        if (vm.count("adaptive-window"))
+        {
+            adaptiveWindow=true;
+        }
+        if (vm.count("coalesce"))
+        {
+            coalesce=true;
+        }
+        if (vm.count("receive-strands"))
+        {
+            const auto strands=vm["receive-strands"].as<std::string>();
+            if (strands=="socket")
+            {
+                receiveStrands=Safir::Dob::Internal::Com::ReceiveStrands::PerSocket;
+            }
+            else if (strands=="nodetype")
+            {
+                receiveStrands=Safir::Dob::Internal::Com::ReceiveStrands::PerNodeType;
+            }
+            else if (strands!="single")
+            {
+                throw std::logic_error("Unknown receive-strands '"+strands+"'");
+            }
+        }
     }
 
     std::string unicastAddress;
@@ -174,6 +223,12 @@ public:
     size_t messageSize;
     unsigned int threadCount;
     bool acked;
+    int slidingWindowSize;
+    int ackRequestThreshold;
+    int sendQueueSize;
+    bool adaptiveWindow;
+    bool coalesce;
+    Safir::Dob::Internal::Com::ReceiveStrands receiveStrands;
 };
 
 class NodeTypes
@@ -182,7 +237,7 @@ public:
     static const int NumberOfNodeTypes = 4;
 
 
-    NodeTypes()
+    NodeTypes(int slidingWindowSize=20, int ackRequestThreshold=10, int sendQueueSize=0, bool adaptiveWindow=false, bool coalesce=false)
     {
         std::vector<std::string> names {"su", "sm", "lu", "lm"};
         for (int i=0; i<NumberOfNodeTypes; ++i)
@@ -191,8 +246,6 @@ public:
             std::vector<int> retryTimeout { 40 };
             int heartbeatInterval=1000+500*i;
             int maxLostHeartbeats=10;
-            int slidingWindowSize=20;
-            int ackRequestThreshold=10;
             bool isLightNode = i >1;
             std::string controlMulticastAddress = "";
             std::string dataMulticastAddress = "";
@@ -204,7 +257,8 @@ public:
 
             Safir::Dob::Internal::Com::NodeTypeDefinition n(id, names[i], controlMulticastAddress, dataMulticastAddress, isLightNode,
                                                             heartbeatInterval, maxLostHeartbeats,
-                                                            slidingWindowSize, ackRequestThreshold, retryTimeout);
+                                                            slidingWindowSize, ackRequestThreshold, retryTimeout,
+                                                            sendQueueSize, adaptiveWindow, coalesce);
             m_nodeTypes.insert(std::make_pair(n.id, n));
         }
     }
@@ -515,7 +569,7 @@ int main(int argc, char * argv[])
         stopCondition.Notify();
     }));
 
-    NodeTypes nodeTypes;
+    NodeTypes nodeTypes(cmd.slidingWindowSize, cmd.ackRequestThreshold, cmd.sendQueueSize, cmd.adaptiveWindow, cmd.coalesce);
     int64_t myId=LlufId_GenerateRandom64();
     int64_t myNodeTypeId=nodeTypes.Get(cmd.nodeType).id;
     com.reset(new Safir::Dob::Internal::Com::Communication(Safir::Dob::Internal::Com::controlModeTag,
@@ -526,7 +580,8 @@ int main(int argc, char * argv[])
                                                            Safir::Dob::Internal::Com::ResolvedAddress(cmd.unicastAddress),
                                                            Safir::Dob::Internal::Com::ResolvedAddress(cmd.unicastAddress),
                                                            nodeTypes.ToVector(),
-                                                           1450));
+                                                           1450,
+                                                           cmd.receiveStrands));
 
     std::cout<<"----------------------------------------------------------------------------"<<std::endl;
     std::cout<<"-- Name:      "<<com->Name()<<std::endl;
@@ -534,6 +589,11 @@ int main(int argc, char * argv[])
     std::cout<<"-- CtrlAddr:  "<<com->ControlAddress()<<std::endl;
     std::cout<<"-- DataAddr:  "<<com->DataAddress()<<std::endl;
     std::cout<<"-- Node type: "<<cmd.nodeType<<" ("<<NodeTypes::DisplayName(cmd.nodeType)<<")"<<std::endl;
+    std::cout<<"-- Window:    "<<cmd.slidingWindowSize<<(cmd.adaptiveWindow ? " (adaptive)" : "")
+             <<", send queue: "<<com->SendQueueCapacity(myNodeTypeId)<<(cmd.coalesce ? ", coalesce" : "")<<std::endl;
+    std::cout<<"-- Threads:   "<<cmd.threadCount<<", receive strands: "
+             <<(cmd.receiveStrands==Safir::Dob::Internal::Com::ReceiveStrands::Single ? "single" :
+                cmd.receiveStrands==Safir::Dob::Internal::Com::ReceiveStrands::PerSocket ? "socket" : "nodetype")<<std::endl;
     std::cout<<"----------------------------------------------------------------------------"<<std::endl;
 
     com->SetDataReceiver([=](int64_t fromNode, int64_t /*fromNodeType*/, const char* msg, size_t size){sp->OnRecv(fromNode, msg, size);}, 123, Allocate, DeAllocate);
@@ -647,6 +707,13 @@ int main(int argc, char * argv[])
     std::cout<<"Overflows: "<<numberOfOverflows<<std::endl;
     std::cout<<"Retransmits: "<<sp->RetransmitCount()<<std::endl;
     sp->PrintRecvCount();
+    const auto recvStat=com->GetReceiveStatistics();
+    const double seconds=std::max(static_cast<double>(elapsed.count())/1000.0, 0.001);
+    std::cout<<"Received datagrams: "<<recvStat.receivedDatagrams
+             <<" ("<<static_cast<uint64_t>(recvStat.receivedDatagrams/seconds)<<" datagrams/s)"<<std::endl;
+    std::cout<<"Datagrams per socket read: "
+             <<(recvStat.receiveWakeups>0 ? static_cast<double>(recvStat.receivedDatagrams)/recvStat.receiveWakeups : 0.0)<<std::endl;
+    std::cout<<"Socket drops: "<<recvStat.droppedDatagrams<<", bad CRC: "<<recvStat.badCrc<<std::endl;
     std::cout<<"---------------------------------------------------------"<<std::endl;
     boost::this_thread::sleep_for(boost::chrono::milliseconds(2000)); //allow 1 sec for retransmissions
     ioContext.stop();
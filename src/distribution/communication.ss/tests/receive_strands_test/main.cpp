@@ -0,0 +1,234 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+#define BOOST_TEST_MODULE CommunicationReceiveStrandsTest
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+#include <string>
+#include <map>
+#include <thread>
+#include <boost/asio.hpp>
+#include <Safir/Dob/Internal/Communication.h>
+
+#if defined _MSC_VER
+#  pragma warning (push)
+#  pragma warning (disable : 4100)
+#endif
+
+#include <boost/thread.hpp>
+
+#if defined _MSC_VER
+#  pragma warning (pop)
+#endif
+
+namespace Com = Safir::Dob::Internal::Com;
+
+namespace
+{
+    const int64_t DataType = 123;
+    const uint64_t NumMessages = 1000;
+
+    //A data mode node on the loopback interface that counts what it receives from each node and
+    //checks that the messages from every node arrive in the order they were sent.
+    class Node
+    {
+    public:
+        Node(int64_t nodeId, int64_t nodeTypeId, const std::vector<Com::NodeTypeDefinition>& nodeTypes, Com::ReceiveStrands receiveStrands)
+            :m_io()
+            ,m_work(boost::asio::make_work_guard(m_io))
+            ,m_com(Com::dataModeTag,
+                   m_io,
+                   Name(nodeId),
+                   nodeId,
+                   nodeTypeId,
+                   Com::ResolvedAddress(Address(nodeId)),
+                   nodeTypes,
+                   1450,
+                   receiveStrands)
+        {
+            for (unsigned int i=0; i<3; ++i)
+            {
+                m_threads.create_thread([&]{m_io.run();});
+            }
+
+            m_com.SetNewNodeCallback([](const std::string&, int64_t, int64_t, const std::string&, const std::string&, bool){});
+            m_com.SetGotReceiveFromCallback([](int64_t, bool, bool){});
+            m_com.SetRetransmitToCallback([](int64_t, size_t){});
+
+            m_com.SetDataReceiver([this](int64_t fromNodeId, int64_t /*fromNodeType*/, const char* data, size_t /*size*/){OnReceiveData(fromNodeId, data);},
+                                  DataType, [](size_t s){return new char[s];}, [](const char * data){delete[] data;});
+
+            for (const auto& nt : nodeTypes)
+            {
+                m_com.SetQueueNotFullCallback([](int64_t){}, nt.id);
+            }
+        }
+
+        static std::string Name(int64_t nodeId) {return std::string("Node_")+std::to_string(nodeId);}
+        static std::string Address(int64_t nodeId) {return std::string("127.0.0.1:")+std::to_string(12000+nodeId);}
+
+        void Start() {m_com.Start();}
+
+        void Stop()
+        {
+            m_com.Stop();
+            m_work.reset();
+            m_io.restart();
+            m_threads.join_all();
+        }
+
+        void Inject(int64_t nodeId, int64_t nodeTypeId) {m_com.InjectNode(Name(nodeId), nodeId, nodeTypeId, Address(nodeId));}
+
+        void Exclude(int64_t nodeId) {m_com.ExcludeNode(nodeId);}
+
+        //Send numbered messages, waits while the send queue is full
+        void Send(int64_t toNodeId, int64_t toNodeTypeId, uint64_t count)
+        {
+            for (uint64_t i=0; i<count; ++i)
+            {
+                const size_t size = 20;
+                auto data=Safir::Utilities::Internal::MakeSharedArray(size);
+                (*reinterpret_cast<uint64_t*>(data.get()))=m_sendCounter++;
+                while (!m_com.Send(toNodeId, toNodeTypeId, data, size, DataType, true))
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        }
+
+        uint64_t GetRecvCount(int64_t fromNodeId)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            return m_recvFrom[fromNodeId];
+        }
+
+        unsigned int GetOutOfOrder()
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            return m_outOfOrder;
+        }
+
+    private:
+        boost::asio::io_context m_io;
+        boost::asio::executor_work_guard<boost::asio::io_context::executor_type> m_work;
+        Com::Communication m_com;
+        boost::thread_group m_threads;
+        uint64_t m_sendCounter = 0;
+
+        boost::mutex m_mutex;
+        std::map<int64_t, uint64_t> m_recvFrom;
+        unsigned int m_outOfOrder = 0;
+
+        void OnReceiveData(int64_t fromNodeId, const char* data)
+        {
+            const auto value = *reinterpret_cast<const uint64_t*>(data);
+            delete[] data;
+
+            boost::mutex::scoped_lock lock(m_mutex);
+            auto& count=m_recvFrom[fromNodeId];
+            if (value != count)
+            {
+                std::cout << m_com.Name() << ": received " << value << " from " << fromNodeId << " but expected " << count << std::endl;
+                ++m_outOfOrder;
+            }
+            ++count;
+        }
+    };
+
+    bool WaitForCount(Node& node, int64_t fromNodeId, uint64_t count)
+    {
+        for (int i=0; i<600 && node.GetRecvCount(fromNodeId) < count; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        return node.GetRecvCount(fromNodeId) == count;
+    }
+
+    //Node 1 uses the receive strands under test and receives from node 2 of another node type and from
+    //node 3 of its own node type at the same time. When node 2 has been excluded its data must be thrown
+    //away while node 3 is still received.
+    void RunReceiveTest(Com::ReceiveStrands receiveStrands)
+    {
+        std::vector<Com::NodeTypeDefinition> nodeTypes
+        {
+            Com::NodeTypeDefinition(10, "A10", "", "", false, 1000, 10, 20, 10, {100}),
+            Com::NodeTypeDefinition(11, "B11", "", "", false, 1000, 10, 20, 10, {100})
+        };
+
+        Node receiver(1, 11, nodeTypes, receiveStrands);
+        Node sender2(2, 10, nodeTypes, Com::ReceiveStrands::Single);
+        Node sender3(3, 11, nodeTypes, Com::ReceiveStrands::Single);
+
+        receiver.Inject(2, 10);
+        receiver.Inject(3, 11);
+        sender2.Inject(1, 11);
+        sender3.Inject(1, 11);
+
+        receiver.Start();
+        sender2.Start();
+        sender3.Start();
+
+        std::thread send2([&]{sender2.Send(1, 11, NumMessages);});
+        std::thread send3([&]{sender3.Send(1, 11, NumMessages);});
+        send2.join();
+        send3.join();
+
+        BOOST_CHECK(WaitForCount(receiver, 2, NumMessages));
+        BOOST_CHECK(WaitForCount(receiver, 3, NumMessages));
+        std::cout << "recv from 2: " << receiver.GetRecvCount(2) << ", recv from 3: " << receiver.GetRecvCount(3) << std::endl;
+
+        receiver.Exclude(2);
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        sender3.Send(1, 11, 100);
+        BOOST_CHECK(WaitForCount(receiver, 3, NumMessages + 100));
+
+        sender2.Send(1, 11, 10);
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        BOOST_CHECK_EQUAL(receiver.GetRecvCount(2), NumMessages);
+
+        BOOST_CHECK_EQUAL(receiver.GetOutOfOrder(), 0U);
+
+        // Stop is synchronous calls that wait until fully stopped.
+        receiver.Stop();
+        sender2.Stop();
+        sender3.Stop();
+    }
+}
+
+BOOST_AUTO_TEST_CASE( receive_strands_single )
+{
+    std::cout << "----- receive_strands_single -----" << std::endl;
+    RunReceiveTest(Com::ReceiveStrands::Single);
+}
+
+BOOST_AUTO_TEST_CASE( receive_strands_per_socket )
+{
+    std::cout << "----- receive_strands_per_socket -----" << std::endl;
+    RunReceiveTest(Com::ReceiveStrands::PerSocket);
+}
+
+BOOST_AUTO_TEST_CASE( receive_strands_per_node_type )
+{
+    std::cout << "----- receive_strands_per_node_type -----" << std::endl;
+    RunReceiveTest(Com::ReceiveStrands::PerNodeType);
+}
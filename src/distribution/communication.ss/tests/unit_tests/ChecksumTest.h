@@ -0,0 +1,161 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+#pragma once
+
+#include "fwd.h"
+#include <chrono>
+#include "../../src/Checksum.h"
+#include "../../src/NodeType.h"
+
+//-----------------------------------------------------------------------------
+// Verifies CRC32C against known values and the software implementation,
+// checksum negotiation per node type, and measures checksum throughput for
+// different fragment sizes.
+//-----------------------------------------------------------------------------
+class ChecksumTest
+{
+public:
+    static void Run()
+    {
+        std::wcout<<"ChecksumTest started"<<std::endl;
+        std::wcout<<"CRC32C hardware accelerated: "<<std::boolalpha<<Com::Crc32c::IsHardwareAccelerated()<<std::endl;
+
+        //-------------------------------------------------------
+        // Known values (RFC 3720 B.4)
+        //-------------------------------------------------------
+        CHECK(Com::Crc32c::Calculate("123456789", 9)==0xE3069283);
+        {
+            std::vector<unsigned char> zeros(32, 0);
+            CHECK(Com::Crc32c::Calculate(zeros.data(), zeros.size())==0x8A9136AA);
+            std::vector<unsigned char> ones(32, 0xff);
+            CHECK(Com::Crc32c::Calculate(ones.data(), ones.size())==0x62A8AB43);
+        }
+
+        //-------------------------------------------------------
+        // The active implementation gives the same result as the software
+        // implementation for all sizes and alignments, also when split.
+        //-------------------------------------------------------
+        {
+            std::vector<unsigned char> buf(300);
+            for (size_t i=0; i<buf.size(); ++i)
+            {
+                buf[i]=static_cast<unsigned char>(i*31+7);
+            }
+
+            for (size_t offset=0; offset<8; ++offset)
+            {
+                for (size_t size=0; size+offset<=buf.size(); size+=13)
+                {
+                    const uint32_t expected=Com::Crc32c::Software(0, buf.data()+offset, size);
+                    CHECK(Com::Crc32c::Calculate(buf.data()+offset, size)==expected);
+                    const size_t first=size/3;
+                    CHECK(Com::Crc32c::Update(Com::Crc32c::Calculate(buf.data()+offset, first), buf.data()+offset+first, size-first)==expected);
+                }
+            }
+        }
+
+        //-------------------------------------------------------
+        // Received datagrams are accepted with either checksum
+        //-------------------------------------------------------
+        {
+            std::vector<char> datagram(100, 'x');
+            datagram.resize(datagram.size()+sizeof(uint32_t));
+            const size_t payload=datagram.size()-sizeof(uint32_t);
+
+            Com::Checksum crc32(false);
+            crc32.Process(datagram.data(), payload);
+            uint32_t value=crc32.Value();
+            memcpy(&datagram[payload], &value, sizeof(value));
+            CHECK(Com::Checksum::IsValid(datagram.data(), datagram.size()));
+
+            Com::Checksum crc32c(true);
+            crc32c.Process(datagram.data(), payload);
+            value=crc32c.Value();
+            CHECK(value==Com::Crc32c::Calculate(datagram.data(), payload));
+            memcpy(&datagram[payload], &value, sizeof(value));
+            CHECK(Com::Checksum::IsValid(datagram.data(), datagram.size()));
+
+            datagram[10]='y';
+            CHECK(!Com::Checksum::IsValid(datagram.data(), datagram.size()));
+        }
+
+        //-------------------------------------------------------
+        // Negotiation, CRC32C only when all nodes of the type support it
+        //-------------------------------------------------------
+        {
+            boost::asio::io_context io;
+            std::vector<int> retryTimeout(1, 100);
+            Com::NodeType nodeType(io, 1, "127.0.0.1:10000", false, 10, "nt", "", 4, 1000, 5, 20, 10, 1000, false, retryTimeout,
+                                   Com::Parameters::SendQueueSize, false, false);
+            CHECK(!nodeType.UseCrc32c());
+            nodeType.NodeAdded(2);
+            CHECK(!nodeType.UseCrc32c()); //no heartbeat received yet
+            nodeType.SetNodeFeatures(2, Com::Crc32cFeature);
+            CHECK(nodeType.UseCrc32c()==Com::Parameters::Crc32cEnabled);
+            nodeType.NodeAdded(3);
+            CHECK(!nodeType.UseCrc32c());
+            nodeType.SetNodeFeatures(3, 0); //an older node
+            CHECK(!nodeType.UseCrc32c());
+            nodeType.SetNodeFeatures(4, Com::Crc32cFeature); //unknown node is ignored
+            nodeType.NodeRemoved(3);
+            CHECK(nodeType.UseCrc32c()==Com::Parameters::Crc32cEnabled);
+        }
+
+        //-------------------------------------------------------
+        // Throughput per fragment size
+        //-------------------------------------------------------
+        const size_t sizes[]={64, 256, 512, 1024, 1400, 8192, 65000};
+        for (size_t size : sizes)
+        {
+            std::vector<unsigned char> buf(size, 0x5a);
+            const double crc32=MegabytesPerSecond(buf, [](const unsigned char* p, size_t n)
+            {
+                boost::crc_32_type crc;
+                crc.process_bytes(p, n);
+                return crc.checksum();
+            });
+            const double crc32c=MegabytesPerSecond(buf, [](const unsigned char* p, size_t n){return Com::Crc32c::Calculate(p, n);});
+            const double software=MegabytesPerSecond(buf, [](const unsigned char* p, size_t n){return Com::Crc32c::Software(0, p, n);});
+            std::wcout<<"Fragment size "<<size<<": CRC32 "<<static_cast<uint64_t>(crc32)<<" MB/s, CRC32C "<<static_cast<uint64_t>(crc32c)
+                      <<" MB/s, CRC32C slicing-by-8 "<<static_cast<uint64_t>(software)<<" MB/s"<<std::endl;
+        }
+
+        std::wcout<<"ChecksumTest tests passed"<<std::endl;
+    }
+
+private:
+    template <class F>
+    static double MegabytesPerSecond(const std::vector<unsigned char>& buf, F f)
+    {
+        const size_t totalBytes=64*1024*1024;
+        const size_t iterations=totalBytes/buf.size();
+        uint32_t sum=0;
+        const auto start=std::chrono::steady_clock::now();
+        for (size_t i=0; i<iterations; ++i)
+        {
+            sum+=f(buf.data(), buf.size());
+        }
+        const std::chrono::duration<double> elapsed=std::chrono::steady_clock::now()-start;
+        CHECK(sum!=1); //use the result
+        return iterations*buf.size()/elapsed.count()/1e6;
+    }
+};
@@ -0,0 +1,170 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+#pragma once
+
+#include "fwd.h"
+
+//-----------------------------------------------------------------------------
+// Sends a burst of small messages from a DataSender through a DeliveryHandler and
+// feeds the acks back, with and without coalescing of small messages.
+// Runs all handlers with io.poll in this thread.
+//-----------------------------------------------------------------------------
+class CoalesceTest
+{
+public:
+    static void Run()
+    {
+        std::wcout<<"CoalesceTest started"<<std::endl;
+
+        std::vector<std::string> messages;
+        for (int i=0; i<200; ++i)
+        {
+            std::ostringstream os;
+            os<<"message "<<std::setw(12)<<i; //20 bytes
+            messages.push_back(os.str());
+        }
+        messages[100]=std::string(600, 'L'); //too big to be coalesced, must still be delivered in order
+
+        const auto normal=SendAndReceive(messages, false);
+        const auto coalesced=SendAndReceive(messages, true);
+
+        CHECKMSG(normal.datagrams==messages.size(), normal.datagrams);
+        //20 byte messages take 32 bytes each with CoalescedHeader, i.e 29 fit in a fragment. 100 small, 1 big, 99 small.
+        CHECKMSG(coalesced.datagrams==4+1+4, coalesced.datagrams);
+        CHECK(coalesced.acks<normal.acks);
+
+        std::wcout<<messages.size()<<" messages: "<<normal.datagrams<<" datagrams, "<<normal.acks<<" acks without coalescing, "
+                  <<coalesced.datagrams<<" datagrams, "<<coalesced.acks<<" acks with coalescing"<<std::endl;
+        std::wcout<<"CoalesceTest tests passed"<<std::endl;
+    }
+
+private:
+    struct Result
+    {
+        size_t datagrams=0;
+        size_t acks=0;
+    };
+
+    static std::vector<Com::UserDataPtr> sent;
+    static std::vector<Com::Ack> acks;
+
+    struct SenderPolicy
+    {
+        bool Send(const std::shared_ptr<Com::UserData>& val,
+                  boost::asio::ip::udp::socket& /*socket*/,
+                  const boost::asio::ip::udp::endpoint& /*to*/)
+        {
+            sent.push_back(val);
+            return true;
+        }
+    };
+
+    struct AckPolicy
+    {
+        bool Send(const std::shared_ptr<Com::Ack>& ack,
+                  boost::asio::ip::udp::socket& /*socket*/,
+                  const boost::asio::ip::udp::endpoint& /*to*/)
+        {
+            acks.push_back(*ack);
+            return true;
+        }
+    };
+
+    typedef Com::DataSenderBasic< Com::Writer<Com::UserData, SenderPolicy> > Sender;
+    typedef Com::DeliveryHandlerBasic< Com::Writer<Com::Ack, AckPolicy> > Receiver;
+
+    static Result SendAndReceive(const std::vector<std::string>& messages, bool coalesce)
+    {
+        sent.clear();
+        acks.clear();
+
+        boost::asio::io_context io;
+        std::vector<int> retryTimeout(1, 100000); //no timer based retransmits during the test
+        Sender sender(io, Com::Acked, 1, 1, 4, "127.0.0.1:10000", "", 16, 4, retryTimeout, 1000, 500, false, coalesce);
+        Receiver receiver(io, 2, 4, 16);
+
+        std::vector<std::string> received;
+        receiver.SetGotRecvCallback([](int64_t, bool, bool){});
+        receiver.SetReceiver([&](int64_t fromNodeId, int64_t, const char* data, size_t size)
+                             {
+                                 CHECK(fromNodeId==1);
+                                 received.push_back(std::string(data, size));
+                                 delete[] data;
+                             },
+                             123,
+                             [](size_t s){return new char[s];},
+                             [](const char* data){delete[] data;});
+        receiver.Start();
+        receiver.AddNode(Com::Node("1", 1, 1, "127.0.0.1:1", "", true));
+        receiver.IncludeNode(1);
+
+        sender.SetRetransmitCallback([](int64_t, size_t){});
+        sender.Start();
+        sender.AddNode(2, "127.0.0.1:2");
+        sender.IncludeNode(2); //generates welcome
+        io.poll();
+
+        for (const auto& msg : messages)
+        {
+            auto data=Safir::Utilities::Internal::MakeSharedArray(msg.size());
+            memcpy(data.get(), msg.data(), msg.size());
+            CHECK(sender.AddToSendQueue(0, data, msg.size(), 123));
+        }
+
+        Result result;
+        for (int i=0; i<1000 && received.size()<messages.size(); ++i)
+        {
+            io.poll();
+
+            auto datagrams=std::move(sent);
+            sent.clear();
+            for (const auto& ud : datagrams)
+            {
+                if (ud->header.commonHeader.dataType!=Com::WelcomeDataType)
+                {
+                    ++result.datagrams;
+                }
+                receiver.ReceivedApplicationData(&ud->header, ud->fragment, false);
+            }
+            io.poll();
+
+            auto receivedAcks=std::move(acks);
+            acks.clear();
+            result.acks+=receivedAcks.size();
+            for (const auto& ack : receivedAcks)
+            {
+                sender.HandleAck(ack);
+            }
+        }
+
+        io.poll();
+        CHECK(received==messages);
+
+        sender.Stop();
+        receiver.Stop();
+        io.poll();
+        return result;
+    }
+};
+
+std::vector<Com::UserDataPtr> CoalesceTest::sent;
+std::vector<Com::Ack> CoalesceTest::acks;
@@ -25,6 +25,7 @@
 
 #include "fwd.h"
 #include <memory>
+#include <chrono>
 
 #ifdef _MSC_VER
 #pragma warning (push)
@@ -68,7 +69,7 @@ public:
                        (strand,
                         "127.0.0.1:10000",
                         "239.192.1.1:11000",
-                        [](const char* data, size_t size, bool /*multicast*/){return Recv(data,size);},
+                        [](const Safir::Utilities::Internal::SharedCharArray& data, size_t size, bool /*multicast*/){return Recv(data.get(),size);},
                         []{return IsReaderReady();}));
 
         TRACELINE
@@ -131,11 +132,13 @@ public:
         TRACELINE
 
         SetReaderReady(true); //receiver is ready again, now the '5' is expected to arrive
+        receiver->ResumeReceive(); //tell the reader, otherwise it will be noticed by the watchdog (tested in multicast case)
+        const auto resumeTime=std::chrono::steady_clock::now();
 
         TRACELINE
         for(;;)
         {
-            Wait(200);
+            Wait(1);
             {
                 boost::mutex::scoped_lock lock(mutex);
                 if (!received.empty())
@@ -148,6 +151,10 @@ public:
 
         TRACELINE
 
+        std::wcout<<"Unicast reading resumed after "
+                 <<std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-resumeTime).count()
+                 <<" us"<<std::endl;
+
         //Check that all is as expected
         {
             boost::mutex::scoped_lock lock(mutex);
@@ -304,6 +311,18 @@ private:
                 }
             });
         }
+
+        void AsyncReceiveMultiple(Com::ReceiveBatch& batch,
+                                  boost::asio::ip::udp::socket* socket,
+                                  const std::function< void(const boost::system::error_code&, size_t) >& completionHandler)
+        {
+            AsyncReceive(batch.Data(0), Com::Parameters::ReceiveBufferSize, socket,
+                         [&batch, completionHandler](const boost::system::error_code& ec, size_t size)
+            {
+                batch.sizes[0]=size;
+                completionHandler(ec, 1);
+            });
+        }
     };
 
     typedef Com::DataReceiverType<TestReader> TestDataReceiver;
@@ -529,6 +548,76 @@ private:
 };
 
 
+//--------------------------------------------------------------------
+// Datagrams that are queued in the socket before the read is started
+// shall all be delivered, in order, by SocketReader::AsyncReceiveMultiple
+//--------------------------------------------------------------------
+class DataReceiverBatchedReadTest
+{
+public:
+    DataReceiverBatchedReadTest()
+        :ep(boost::asio::ip::make_address("127.0.0.1"), 10124)
+        ,recvSocket(io, ep)
+        ,senderSocket(io, ep.protocol())
+        ,batch(Safir::Dob::Internal::Com::Parameters::ReceiveBatchSize)
+        ,numberOfReads(0)
+    {
+    }
+
+    void Run()
+    {
+        std::wcout<<"DataReceiverBatchedReadTest started"<<std::endl;
+
+        const int numberOfMessages=100;
+        for (int i=0; i<numberOfMessages; ++i)
+        {
+            senderSocket.send_to(boost::asio::buffer(std::to_string(i)), ep);
+        }
+
+        Read();
+        while (received.size()<static_cast<size_t>(numberOfMessages) && io.run_one_for(std::chrono::seconds(10))>0)
+        {
+        }
+
+        CHECKMSG(received.size()==static_cast<size_t>(numberOfMessages), received.size());
+        for (int i=0; i<numberOfMessages; ++i)
+        {
+            CHECK(received[i]==std::to_string(i));
+        }
+
+        //all datagrams were in the socket when reading started, so every read except the last one shall be full
+        const size_t expectedReads=(numberOfMessages+batch.Capacity()-1)/batch.Capacity();
+        CHECKMSG(numberOfReads==expectedReads, numberOfReads);
+        std::wcout<<"Read "<<numberOfMessages<<" datagrams in "<<numberOfReads<<" reads"<<std::endl;
+
+        std::wcout<<"DataReceiverBatchedReadTest tests passed"<<std::endl;
+    }
+
+private:
+    boost::asio::io_context io;
+    boost::asio::ip::udp::endpoint ep;
+    boost::asio::ip::udp::socket recvSocket;
+    boost::asio::ip::udp::socket senderSocket;
+    Safir::Dob::Internal::Com::ReceiveBatch batch;
+    Safir::Dob::Internal::Com::SocketReader reader;
+    std::vector<std::string> received;
+    size_t numberOfReads;
+
+    void Read()
+    {
+        reader.AsyncReceiveMultiple(batch, &recvSocket, [this](const boost::system::error_code& ec, size_t count)
+        {
+            CHECK(!ec);
+            ++numberOfReads;
+            for (size_t i=0; i<count; ++i)
+            {
+                received.push_back(std::string(batch.Data(i), batch.sizes[i]));
+            }
+            Read();
+        });
+    }
+};
+
 //--------------------------------
 // Start DataReceiverTest tests
 //--------------------------------
@@ -538,5 +627,6 @@ struct DataReceiverTest
     {
         DataReceiverTester::Run();
         DataReceiverSimulateNetworkUpDownTest().Run();
+        DataReceiverBatchedReadTest().Run();
     }
 };
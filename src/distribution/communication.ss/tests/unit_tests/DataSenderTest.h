@@ -24,6 +24,7 @@
 #pragma once
 
 #include "fwd.h"
+#include <chrono>
 
 class AckedDataSenderTest
 {
@@ -48,6 +49,7 @@ public:
         std::vector<int> retryTimeout;
         retryTimeout.push_back(500);
         Sender sender(io, Com::Acked, 1, 1, 4, "127.0.0.1:10000", "224.90.90.241:10000", SlidingWindowSize, RequestAckThreshold, retryTimeout, Com::MessageHeaderSize+3); //ntId, nId, ipV, mc, waitForAck, fragmentSize
+        sender.m_rttBasedRetryTimeout=false; //the test expects retransmits at the configured retry timeouts
 
         std::atomic<unsigned int> go(0);
         auto WaitUntilReady=[&]
@@ -543,6 +545,7 @@ public:
         retryTimeout.push_back(1000);
         retryTimeout.push_back(3000);
         Sender sender(io, Com::Acked, 1, 1, 4, "127.0.0.1:10000", "224.90.90.241:10000", SlidingWindowSize, RequestAckThreshold, retryTimeout, Com::MessageHeaderSize+3); //ntId, nId, ipV, mc, waitForAck, fragmentSize
+        sender.m_rttBasedRetryTimeout=false; //the test expects retransmits at the configured retry timeouts
 
         std::atomic<unsigned int> go(0);
         auto WaitUntilReady=[&]
@@ -867,6 +870,7 @@ public:
         std::vector<int> retryTimeout;
         retryTimeout.push_back(500);
         Sender sender(io, Com::Acked, 1, 1, 4, "127.0.0.1:10000", "224.90.90.241:10000", SlidingWindowSize, RequestAckThreshold, retryTimeout, Com::MessageHeaderSize+3); //ntId, nId, ipV, mc, waitForAck, fragmentSize
+        sender.m_rttBasedRetryTimeout=false; //the test expects retransmits at the configured retry timeouts
 
         std::atomic<unsigned int> go(0);
         auto WaitUntilReady=[&]
@@ -945,8 +949,8 @@ public:
             boost::mutex::scoped_lock lock(mutex);
             CHECK(sender.m_sendQueue.size()==1);
             CHECK(sender.m_sendQueue[0]->receivers.size()==2);
-            CHECK(sender.m_sendQueue[0]->receivers.find(2)!=sender.m_sendQueue[0]->receivers.end());
-            CHECK(sender.m_sendQueue[0]->receivers.find(3)!=sender.m_sendQueue[0]->receivers.end());
+            CHECK(sender.ReceiverIds(*sender.m_sendQueue[0]).count(2)==1);
+            CHECK(sender.ReceiverIds(*sender.m_sendQueue[0]).count(3)==1);
 
             CHECKMSG(sender.m_sendQueue[0]->transmitCount==2, sender.m_sendQueue[0]->transmitCount); //has been resent once
             CHECK(retransmit.size()==2);
@@ -969,7 +973,7 @@ public:
         {
             CHECKMSG(sender.SendQueueSize()==1, sender.SendQueueSize());
             CHECK(sender.m_sendQueue[0]->receivers.size()==1);
-            CHECK(sender.m_sendQueue[0]->receivers.find(3)!=sender.m_sendQueue[0]->receivers.end());
+            CHECK(sender.ReceiverIds(*sender.m_sendQueue[0]).count(3)==1);
             CHECK(sender.m_sendQueue[0]->transmitCount==2); //has still been sent 2 times
         });
 
@@ -984,7 +988,7 @@ public:
             boost::mutex::scoped_lock lock(mutex);
             CHECK(sender.m_sendQueue.size()==1);
             CHECK(sender.m_sendQueue[0]->receivers.size()==1);
-            CHECK(sender.m_sendQueue[0]->receivers.find(3)!=sender.m_sendQueue[0]->receivers.end());
+            CHECK(sender.ReceiverIds(*sender.m_sendQueue[0]).count(3)==1);
 
             //now msg should have been sent 4 times, first two to both node 2 and 3, and last two only to node 3
             CHECKMSG(sender.m_sendQueue[0]->transmitCount==4, sender.m_sendQueue[0]->transmitCount); //has been resent once
@@ -1203,6 +1207,337 @@ private:
 
 std::vector<std::string> DataSenderSimulateNetworkUpDownTest::sent;
 
+//------------------------------------
+// Adaptive sliding window
+//------------------------------------
+class AdaptiveWindowTest
+{
+public:
+    static void Run()
+    {
+        std::wcout<<"AdaptiveWindowTest started"<<std::endl;
+
+        //acks only contain the used part of the window, but never less than what older versions expect
+        {
+            auto small=Ack(2, 1, 1, Com::MultiReceiverSendMethod);
+            CHECK(small.NumberOfMissingEntries()==SlidingWindowSize);
+            CHECK(Com::WireSize(small)==Com::AckHeaderSize+Com::Parameters::LegacySlidingWindowSize);
+
+            Com::Ack large(2, 1, 1, Com::MultiReceiverSendMethod);
+            for (size_t i=0; i<100; ++i)
+            {
+                large.missing[i]=0;
+            }
+            CHECK(Com::WireSize(large)==Com::AckHeaderSize+100);
+        }
+
+        boost::asio::io_context io;
+        auto work=boost::asio::make_work_guard(io);
+        boost::thread_group threads;
+        for (int i = 0; i < 9; ++i)
+        {
+            threads.create_thread([&]{io.run();});
+        }
+
+        std::vector<int> retryTimeout;
+        retryTimeout.push_back(100000); //no timer based retransmits during the test
+        Sender sender(io, Com::Acked, 1, 1, 4, "127.0.0.1:10000", "224.90.90.241:10000", SlidingWindowSize, RequestAckThreshold,
+                      retryTimeout, 1000, 500, true);
+        sender.m_rttBasedRetryTimeout=false; //the test expects retransmits at the configured retry timeouts
+
+        std::atomic<unsigned int> go(0);
+        auto WaitUntilReady=[&]
+        {
+            boost::asio::post(sender.m_strand, [&]{go=1;});
+
+            while(go==0)
+                Wait(20);
+            go=0;
+        };
+
+        CHECK(sender.SendQueueCapacity()==500);
+        sender.SetRetransmitCallback([](int64_t, size_t){});
+        sender.Start();
+        sender.AddNode(2, "127.0.0.1:2");
+        sender.IncludeNode(2); //generates welcome with seq 1
+        WaitUntilReady();
+
+        //starts at the smallest window, and grows by one for every acked message (slow start)
+        boost::asio::post(sender.m_strand, [&]{CHECKMSG(sender.m_windowSize==RequestAckThreshold, sender.m_windowSize);});
+        sender.HandleAck(Ack(2, 1, 1, Com::MultiReceiverSendMethod)); //welcome acked
+        WaitUntilReady();
+        boost::asio::post(sender.m_strand, [&]{CHECKMSG(sender.m_windowSize==RequestAckThreshold+1, sender.m_windowSize);});
+
+        for (int i=0; i<20; ++i)
+        {
+            sender.AddToSendQueue(0, MakeShared("x"), 1, 1); //seq 2..21
+        }
+        WaitUntilReady();
+        boost::asio::post(sender.m_strand, [&]{CHECKMSG(sender.m_sendQueue.first_unhandled_index()==3, sender.m_sendQueue.first_unhandled_index());});
+
+        sender.HandleAck(Ack(2, 1, 4, Com::MultiReceiverSendMethod)); //seq 2,3,4 acked
+        WaitUntilReady();
+        boost::asio::post(sender.m_strand, [&]
+        {
+            CHECKMSG(sender.m_windowSize==6, sender.m_windowSize);
+            CHECKMSG(sender.m_sendQueue.first_unhandled_index()==6, sender.m_sendQueue.first_unhandled_index()); //seq 5..10 sent
+        });
+        WaitUntilReady();
+
+        //seq 5 is missing, it is retransmitted and the window is halved
+        {
+            auto ack=Ack(2, 1, 10, Com::MultiReceiverSendMethod);
+            ack.missing[10-5]=1;
+            sender.HandleAck(ack);
+        }
+        WaitUntilReady();
+        boost::asio::post(sender.m_strand, [&]
+        {
+            CHECKMSG(sender.m_windowSize==3, sender.m_windowSize);
+            CHECKMSG(sender.m_slowStartThreshold==3, sender.m_slowStartThreshold);
+        });
+        WaitUntilReady();
+
+        //now above slow start threshold, the window grows by one for every full window of acked messages.
+        //seq 5 has been retransmitted and does not count.
+        sender.HandleAck(Ack(2, 1, 10, Com::MultiReceiverSendMethod));
+        WaitUntilReady();
+        boost::asio::post(sender.m_strand, [&]
+        {
+            CHECKMSG(sender.m_windowSize==4, sender.m_windowSize);
+            CHECKMSG(sender.m_ackedInWindow==2, sender.m_ackedInWindow);
+        });
+        WaitUntilReady();
+
+        boost::asio::post(sender.m_strand, [&]
+        {
+            sender.Stop();
+            work.reset();
+        });
+
+        threads.join_all();
+        std::wcout<<"AdaptiveWindowTest tests passed"<<std::endl;
+    }
+
+private:
+    static const size_t SlidingWindowSize = 16;
+    static const size_t RequestAckThreshold = 2;
+
+    static Com::Ack Ack(int64_t sender, int64_t receiver, uint64_t seqNo, uint8_t sendMethod)
+    {
+        Com::Ack a(sender, receiver, seqNo, sendMethod);
+        for (size_t i=0; i<SlidingWindowSize; ++i)
+        {
+            a.missing[i]=0;
+        }
+        return a;
+    }
+
+    struct TestSendPolicy
+    {
+        bool Send(const std::shared_ptr<Com::UserData>& /*val*/,
+                  boost::asio::ip::udp::socket& /*socket*/,
+                  const boost::asio::ip::udp::endpoint& /*to*/)
+        {
+            return true;
+        }
+    };
+
+    typedef Com::Writer<Com::UserData, AdaptiveWindowTest::TestSendPolicy> TestWriter;
+    typedef Com::DataSenderBasic<TestWriter> Sender;
+};
+
+//------------------------------------------------------------
+// Microbenchmark of AddToSendQueue + HandleAck cycles.
+// Runs the handlers with io.poll in this thread, no timing noise from other threads.
+//------------------------------------------------------------
+class SendQueueCycleTest
+{
+public:
+    static void Run()
+    {
+        std::wcout<<"SendQueueCycleTest started"<<std::endl;
+
+        boost::asio::io_context io;
+
+        std::vector<int> retryTimeout;
+        retryTimeout.push_back(100000); //no timer based retransmits during the test
+        Sender sender(io, Com::Acked, 1, 1, 4, "127.0.0.1:10000", "224.90.90.241:10000", SlidingWindowSize, RequestAckThreshold,
+                      retryTimeout, 1000, 1000);
+        sender.SetRetransmitCallback([](int64_t, size_t){});
+        sender.Start();
+
+        for (int64_t id=2; id<2+NumberOfNodes; ++id)
+        {
+            sender.AddNode(id, "127.0.0.1:"+std::to_string(10000+id));
+            sender.IncludeNode(id); //welcome seq 1..NumberOfNodes
+        }
+        io.poll();
+
+        uint64_t lastSeq=NumberOfNodes;
+        AckAll(sender, lastSeq);
+        io.poll();
+        CHECK(sender.m_sendQueue.empty());
+
+        auto data=MakeShared("0123456789");
+        const auto start=std::chrono::steady_clock::now();
+        for (int cycle=0; cycle<NumberOfCycles; ++cycle)
+        {
+            for (size_t i=0; i<MessagesPerCycle; ++i)
+            {
+                CHECK(sender.AddToSendQueue(0, data, 10, 1));
+            }
+            io.poll();
+            lastSeq+=MessagesPerCycle;
+            AckAll(sender, lastSeq);
+            io.poll();
+        }
+        const std::chrono::duration<double, std::nano> elapsed=std::chrono::steady_clock::now()-start;
+
+        CHECK(sender.m_sendQueue.empty());
+        CHECK(sender.SendQueueSize()==0);
+        CHECKMSG(sender.m_fragmentPool->NumberOfBlocks()==1000, sender.m_fragmentPool->NumberOfBlocks()); //all fragments recycled, only the first chunk used
+
+        std::wcout<<"AddToSendQueue+HandleAck, "<<NumberOfNodes<<" nodes: "
+                  <<static_cast<uint64_t>(elapsed.count()/(NumberOfCycles*MessagesPerCycle))<<" ns per message"<<std::endl;
+
+        sender.Stop();
+        io.poll();
+        std::wcout<<"SendQueueCycleTest tests passed"<<std::endl;
+    }
+
+private:
+    static const size_t SlidingWindowSize = 20;
+    static const size_t RequestAckThreshold = 10;
+    static const size_t MessagesPerCycle = 10;
+    static const int NumberOfNodes = 8;
+    static const int NumberOfCycles = 20000;
+
+    struct TestSendPolicy
+    {
+        bool Send(const std::shared_ptr<Com::UserData>& /*val*/,
+                  boost::asio::ip::udp::socket& /*socket*/,
+                  const boost::asio::ip::udp::endpoint& /*to*/)
+        {
+            return true;
+        }
+    };
+
+    typedef Com::Writer<Com::UserData, SendQueueCycleTest::TestSendPolicy> TestWriter;
+    typedef Com::DataSenderBasic<TestWriter> Sender;
+
+    static void AckAll(Sender& sender, uint64_t seqNo)
+    {
+        for (int64_t id=2; id<2+NumberOfNodes; ++id)
+        {
+            Com::Ack a(id, 1, seqNo, Com::MultiReceiverSendMethod);
+            for (size_t i=0; i<SlidingWindowSize; ++i)
+            {
+                a.missing[i]=0;
+            }
+            sender.HandleAck(a);
+        }
+    }
+};
+
+//------------------------------------------------------------
+// 64 nodes that ack every message they receive.
+// Runs the handlers with io.poll in this thread, no timing noise from other threads.
+//------------------------------------------------------------
+class AckStormTest
+{
+public:
+    static void Run()
+    {
+        std::wcout<<"AckStormTest started"<<std::endl;
+
+        boost::asio::io_context io;
+
+        std::vector<int> retryTimeout;
+        retryTimeout.push_back(100000); //no timer based retransmits during the test
+        Sender sender(io, Com::Acked, 1, 1, 4, "127.0.0.1:10000", "224.90.90.241:10000", SlidingWindowSize, RequestAckThreshold,
+                      retryTimeout, 1000, 1000);
+        sender.SetRetransmitCallback([](int64_t, size_t){});
+        sender.Start();
+
+        for (int64_t id=2; id<2+NumberOfNodes; ++id)
+        {
+            sender.AddNode(id, "127.0.0.1:"+std::to_string(10000+id));
+            sender.IncludeNode(id); //welcome seq 1..NumberOfNodes
+        }
+        io.poll();
+
+        uint64_t lastSeq=NumberOfNodes;
+        for (int64_t id=2; id<2+NumberOfNodes; ++id)
+        {
+            sender.HandleAck(Ack(id, lastSeq));
+        }
+        io.poll();
+        CHECK(sender.m_sendQueue.empty());
+
+        auto data=MakeShared("0123456789");
+        const auto start=std::chrono::steady_clock::now();
+        for (int cycle=0; cycle<NumberOfCycles; ++cycle)
+        {
+            for (size_t i=0; i<SlidingWindowSize; ++i)
+            {
+                CHECK(sender.AddToSendQueue(0, data, 10, 1));
+            }
+            io.poll();
+            CHECK(sender.m_sendQueue.first_unhandled_index()==SlidingWindowSize);
+
+            //every node acks every message
+            for (size_t i=0; i<SlidingWindowSize; ++i)
+            {
+                ++lastSeq;
+                for (int64_t id=2; id<2+NumberOfNodes; ++id)
+                {
+                    sender.HandleAck(Ack(id, lastSeq));
+                }
+            }
+            io.poll();
+            CHECK(sender.m_sendQueue.empty());
+        }
+        const std::chrono::duration<double, std::nano> elapsed=std::chrono::steady_clock::now()-start;
+
+        std::wcout<<"Ack storm, "<<NumberOfNodes<<" nodes, window "<<SlidingWindowSize<<": "
+                  <<static_cast<uint64_t>(elapsed.count()/(NumberOfCycles*SlidingWindowSize*NumberOfNodes))<<" ns per ack"<<std::endl;
+
+        sender.Stop();
+        io.poll();
+        std::wcout<<"AckStormTest tests passed"<<std::endl;
+    }
+
+private:
+    static const size_t SlidingWindowSize = 100;
+    static const size_t RequestAckThreshold = 1;
+    static const int NumberOfNodes = 64;
+    static const int NumberOfCycles = 100;
+
+    struct TestSendPolicy
+    {
+        bool Send(const std::shared_ptr<Com::UserData>& /*val*/,
+                  boost::asio::ip::udp::socket& /*socket*/,
+                  const boost::asio::ip::udp::endpoint& /*to*/)
+        {
+            return true;
+        }
+    };
+
+    typedef Com::Writer<Com::UserData, AckStormTest::TestSendPolicy> TestWriter;
+    typedef Com::DataSenderBasic<TestWriter> Sender;
+
+    static Com::Ack Ack(int64_t sender, uint64_t seqNo)
+    {
+        Com::Ack a(sender, 1, seqNo, Com::MultiReceiverSendMethod);
+        for (size_t i=0; i<SlidingWindowSize; ++i)
+        {
+            a.missing[i]=0;
+        }
+        return a;
+    }
+};
+
 //-----------------------
 // Start Sender tests
 //-----------------------
@@ -1215,5 +1550,8 @@ struct DataSenderTest
         RetransmissionTest::Run();
         UnackedDataSenderTest::Run();
         DataSenderSimulateNetworkUpDownTest::Run();
+        AdaptiveWindowTest::Run();
+        SendQueueCycleTest::Run();
+        AckStormTest::Run();
     }
 };
@@ -0,0 +1,266 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+#pragma once
+
+#include "fwd.h"
+
+//-----------------------------------------------------------------------------
+// Sends a stream of messages from a DataSender to a DeliveryHandler over a
+// simulated link with 1 ms delay that loses, duplicates and reorders datagrams
+// in both directions (UnreliableSender). Compares the delivery latency with the
+// configured retry timeouts against round trip based timeouts and nacks.
+// Everything runs in one io_context in this thread.
+//-----------------------------------------------------------------------------
+class LossyLinkTest
+{
+public:
+    static void Run()
+    {
+        std::wcout<<"LossyLinkTest started"<<std::endl;
+
+        const auto configured=SendAndReceive(false);
+        const auto rttBased=SendAndReceive(true);
+
+        CHECK(rttBased.retryTimeout>std::chrono::steady_clock::duration::zero());
+        CHECK(rttBased.retryTimeout<std::chrono::milliseconds(RetryTimeout));
+
+        Print(L"configured retry timeout  ", configured);
+        Print(L"round trip based with nack", rttBased);
+        std::wcout<<"LossyLinkTest tests passed"<<std::endl;
+    }
+
+private:
+    static const int NumberOfMessages=2000;
+    static const int OneWayDelay=1; //millisec
+    static const int RetryTimeout=200; //millisec
+
+    typedef std::vector<boost::asio::const_buffer> Buffers;
+    typedef std::function<void(const std::vector<char>&)> Link;
+
+    struct Result
+    {
+        std::chrono::microseconds mean{0};
+        std::chrono::microseconds p99{0};
+        std::chrono::microseconds max{0};
+        size_t retransmits=0;
+        size_t queueFull=0;
+        std::chrono::steady_clock::duration retryTimeout{0};
+    };
+
+    static boost::asio::io_context* io;
+    static Link toReceiver;
+    static Link toSender;
+
+    //deliver a datagram to the other side of the link after OneWayDelay
+    static void Transfer(const Buffers& bufs, const Link& link)
+    {
+        auto data=std::make_shared<std::vector<char>>(boost::asio::buffer_size(bufs));
+        boost::asio::buffer_copy(boost::asio::buffer(*data), bufs);
+        auto timer=std::make_shared<boost::asio::steady_timer>(*io, std::chrono::milliseconds(OneWayDelay));
+        timer->async_wait([timer, data, &link](const boost::system::error_code&){link(*data);});
+    }
+
+    struct SenderPolicy : private Com::UnreliableSender
+    {
+        bool Send(const Com::UserDataPtr& val,
+                  boost::asio::ip::udp::socket& /*socket*/,
+                  const boost::asio::ip::udp::endpoint& /*to*/)
+        {
+            Buffers bufs;
+            bufs.push_back(boost::asio::buffer(static_cast<const void*>(&val->header), Com::MessageHeaderSize));
+            if (val->header.fragmentContentSize>0)
+            {
+                bufs.push_back(boost::asio::buffer(val->fragment, val->header.fragmentContentSize));
+            }
+            UnreliableSender::Send(bufs, [](const Buffers& b){Transfer(b, toReceiver);});
+            return true;
+        }
+    };
+
+    struct AckPolicy : private Com::UnreliableSender
+    {
+        bool Send(const std::shared_ptr<Com::Ack>& ack,
+                  boost::asio::ip::udp::socket& /*socket*/,
+                  const boost::asio::ip::udp::endpoint& /*to*/)
+        {
+            UnreliableSender::Send(Buffers(1, boost::asio::buffer(static_cast<const void*>(ack.get()), ack->WireSize())),
+                                   [](const Buffers& b){Transfer(b, toSender);});
+            return true;
+        }
+    };
+
+    typedef Com::DataSenderBasic< Com::Writer<Com::UserData, SenderPolicy> > Sender;
+    typedef Com::DeliveryHandlerBasic< Com::Writer<Com::Ack, AckPolicy> > Receiver;
+
+    static Result SendAndReceive(bool rttBased)
+    {
+        boost::asio::io_context ioContext;
+        io=&ioContext;
+
+        std::vector<int> retryTimeout;
+        retryTimeout.push_back(RetryTimeout);
+        retryTimeout.push_back(500);
+        Sender sender(ioContext, Com::Acked, 1, 1, 4, "127.0.0.1:10000", "", 20, 10, retryTimeout, 1450, 500);
+        sender.m_rttBasedRetryTimeout=rttBased;
+        Receiver receiver(ioContext, 2, 4, 20);
+
+        std::vector<std::chrono::steady_clock::time_point> sendTime(NumberOfMessages);
+        std::vector<std::chrono::microseconds> latency;
+
+        receiver.SetGotRecvCallback([](int64_t, bool, bool){});
+        receiver.SetReceiver([&](int64_t, int64_t, const char* data, size_t size)
+                             {
+                                 CHECK(size==sizeof(int));
+                                 int index;
+                                 memcpy(&index, data, sizeof(int));
+                                 delete[] data;
+                                 CHECKMSG(index==static_cast<int>(latency.size()), index); //in order and exactly once
+                                 latency.push_back(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-sendTime[index]));
+                             },
+                             123,
+                             [](size_t s){return new char[s];},
+                             [](const char* data){delete[] data;});
+        receiver.Start();
+        receiver.AddNode(Com::Node("1", 1, 1, "127.0.0.1:1", "", true));
+        receiver.IncludeNode(1);
+
+        //the nack timer of CommunicationImpl
+        boost::asio::steady_timer nackTimer(ioContext);
+        bool nackTimerActive=false;
+        std::function<void()> startNackTimer=[&]
+        {
+            nackTimerActive=true;
+            nackTimer.expires_after(std::chrono::milliseconds(Com::Parameters::NackInterval));
+            nackTimer.async_wait([&](const boost::system::error_code& error)
+            {
+                if (error)
+                {
+                    return;
+                }
+                receiver.SendNacks();
+                if (receiver.HasMissingMessages())
+                {
+                    startNackTimer();
+                }
+                else
+                {
+                    nackTimerActive=false;
+                }
+            });
+        };
+
+        toReceiver=[&](const std::vector<char>& datagram)
+        {
+            const auto header=reinterpret_cast<const Com::MessageHeader*>(datagram.data());
+            receiver.ReceivedApplicationData(header, datagram.data()+Com::MessageHeaderSize, false);
+            if (rttBased && !nackTimerActive && receiver.HasMissingMessages())
+            {
+                startNackTimer();
+            }
+        };
+
+        toSender=[&](const std::vector<char>& datagram)
+        {
+            Com::Ack ack(0, 0, 0, 0);
+            memcpy(static_cast<void*>(&ack), datagram.data(), std::min(datagram.size(), sizeof(Com::Ack)));
+            sender.HandleAck(ack);
+        };
+
+        Result result;
+        sender.SetRetransmitCallback([&](int64_t, size_t){++result.retransmits;});
+        sender.Start();
+        sender.AddNode(2, "127.0.0.1:2");
+        sender.IncludeNode(2);
+
+        //send one message every millisecond, or retry every millisecond while the send queue is full
+        int next=0;
+        boost::asio::steady_timer sendTimer(ioContext);
+        std::function<void()> sendNext=[&]
+        {
+            auto data=Safir::Utilities::Internal::MakeSharedArray(sizeof(int));
+            memcpy(data.get(), &next, sizeof(int));
+            sendTime[next]=std::chrono::steady_clock::now();
+            if (sender.AddToSendQueue(2, data, sizeof(int), 123))
+            {
+                ++next;
+            }
+            else
+            {
+                ++result.queueFull; //try again later
+            }
+
+            if (next<NumberOfMessages)
+            {
+                sendTimer.expires_after(std::chrono::milliseconds(1));
+                sendTimer.async_wait([&](const boost::system::error_code&){sendNext();});
+            }
+        };
+        sendTimer.expires_after(std::chrono::milliseconds(10)); //let the welcome get through
+        sendTimer.async_wait([&](const boost::system::error_code&){sendNext();});
+
+        const auto deadline=std::chrono::steady_clock::now()+std::chrono::seconds(60);
+        while (latency.size()<NumberOfMessages && std::chrono::steady_clock::now()<deadline)
+        {
+            ioContext.run_one_for(std::chrono::milliseconds(100));
+        }
+        CHECKMSG(latency.size()==NumberOfMessages, latency.size());
+
+        if (rttBased)
+        {
+            result.retryTimeout=sender.m_slotRetryTimeout.at(sender.m_nodes.at(2).slot);
+        }
+
+        sender.Stop();
+        receiver.Stop();
+        nackTimer.cancel();
+        toReceiver=[](const std::vector<char>&){};
+        toSender=[](const std::vector<char>&){};
+        ioContext.run();
+
+        std::sort(latency.begin(), latency.end());
+        std::chrono::microseconds sum(0);
+        for (auto l : latency)
+        {
+            sum+=l;
+        }
+        result.mean=sum/static_cast<int>(latency.size());
+        result.p99=latency[latency.size()*99/100];
+        result.max=latency.back();
+        return result;
+    }
+
+    static void Print(const wchar_t* name, const Result& result)
+    {
+        std::wcout<<name<<": mean "<<result.mean.count()<<" us, p99 "<<result.p99.count()<<" us, max "<<result.max.count()
+                  <<" us, "<<result.retransmits<<" retransmits, "
+                  <<result.queueFull<<" times send queue full";
+        if (result.retryTimeout>std::chrono::steady_clock::duration::zero())
+        {
+            std::wcout<<", retry timeout "<<std::chrono::duration_cast<std::chrono::microseconds>(result.retryTimeout).count()<<" us";
+        }
+        std::wcout<<std::endl;
+    }
+};
+
+boost::asio::io_context* LossyLinkTest::io=nullptr;
+LossyLinkTest::Link LossyLinkTest::toReceiver;
+LossyLinkTest::Link LossyLinkTest::toSender;
@@ -0,0 +1,134 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+#pragma once
+
+#include "fwd.h"
+#include <chrono>
+
+//-----------------------------------------------------------------------------
+// Verifies batched sending in Writer<UserData> over loopback and compares
+// packets per second for immediate and batched send when a message is fanned
+// out over unicast to many receivers.
+//-----------------------------------------------------------------------------
+class SendBatchTest
+{
+public:
+    static void Run()
+    {
+        std::wcout<<"SendBatchTest started"<<std::endl;
+
+        boost::asio::io_context io;
+
+        boost::asio::ip::udp::socket receiveSocket(io, boost::asio::ip::udp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+        receiveSocket.set_option(boost::asio::socket_base::receive_buffer_size(Com::Parameters::SocketBufferSize));
+        const auto to=receiveSocket.local_endpoint();
+
+        Com::Writer<Com::UserData> writer(io, 4);
+        CHECK(writer.IsBatchEnabled()==Com::Parameters::BatchedSendEnabled);
+
+        //-------------------------------------------------------
+        // Batched datagrams arrive in order with correct crc.
+        // Header changes after SendTo must not affect what is sent.
+        //-------------------------------------------------------
+        {
+            auto data=MakeShared("0123456789");
+            auto ud=std::make_shared<Com::UserData>(1, 0, 1, data, 10);
+            {
+                Com::Writer<Com::UserData>::ScopedBatch batch(writer);
+                for (uint64_t seq=1; seq<=10; ++seq)
+                {
+                    ud->header.sequenceNumber=seq;
+                    writer.SendTo(ud, to);
+                }
+                ud->header.sequenceNumber=4711;
+            }
+
+            for (uint64_t seq=1; seq<=10; ++seq)
+            {
+                char buf[Com::Parameters::ReceiveBufferSize];
+                const size_t size=ReceiveWithTimeout(receiveSocket, buf, sizeof(buf));
+                CHECKMSG(size==Com::MessageHeaderSize+10+sizeof(uint32_t), size);
+
+                boost::crc_32_type crc;
+                crc.process_bytes(buf, size-sizeof(uint32_t));
+                uint32_t checksum=0;
+                memcpy(&checksum, buf+size-sizeof(uint32_t), sizeof(uint32_t));
+                CHECK(checksum==crc.checksum());
+
+                const auto* header=reinterpret_cast<const Com::MessageHeader*>(buf);
+                CHECKMSG(header->sequenceNumber==seq, header->sequenceNumber);
+                CHECK(std::string(buf+Com::MessageHeaderSize, 10)=="0123456789");
+            }
+        }
+
+        //-------------------------------------------------------
+        // Throughput, immediate send versus batched send
+        //-------------------------------------------------------
+        const double immediate=PacketsPerSecond(writer, to, false);
+        const double batched=PacketsPerSecond(writer, to, true);
+        std::wcout<<"Fan out to "<<NumberOfReceivers<<" receivers, immediate send: "<<static_cast<uint64_t>(immediate)
+                  <<" packets/s, batched send: "<<static_cast<uint64_t>(batched)<<" packets/s"<<std::endl;
+
+        writer.SetBatchEnabled(Com::Parameters::BatchedSendEnabled);
+
+        std::wcout<<"SendBatchTest tests passed"<<std::endl;
+    }
+
+private:
+    static const int NumberOfReceivers=24;
+    static const int NumberOfMessages=4000;
+
+    static size_t ReceiveWithTimeout(boost::asio::ip::udp::socket& socket, char* buf, size_t bufSize)
+    {
+        for (int i=0; i<200; ++i)
+        {
+            if (socket.available()>0)
+            {
+                return socket.receive(boost::asio::buffer(buf, bufSize));
+            }
+            Wait(10);
+        }
+        CHECKMSG(false, "Timeout waiting for datagram");
+        return 0;
+    }
+
+    static double PacketsPerSecond(Com::Writer<Com::UserData>& writer, const boost::asio::ip::udp::endpoint& to, bool batchEnabled)
+    {
+        writer.SetBatchEnabled(batchEnabled);
+        auto data=MakeShared(std::string(1000, 'x'));
+        auto ud=std::make_shared<Com::UserData>(1, 0, 1, data, 1000);
+
+        const auto start=std::chrono::steady_clock::now();
+        for (int msg=0; msg<NumberOfMessages; ++msg)
+        {
+            //the same way as DataSender sends a MultiReceiver message over unicast
+            Com::Writer<Com::UserData>::ScopedBatch batch(writer);
+            ud->header.sequenceNumber=static_cast<uint64_t>(msg);
+            for (int r=0; r<NumberOfReceivers; ++r)
+            {
+                writer.SendTo(ud, to);
+            }
+        }
+        const std::chrono::duration<double> elapsed=std::chrono::steady_clock::now()-start;
+        return NumberOfMessages*NumberOfReceivers/elapsed.count();
+    }
+};
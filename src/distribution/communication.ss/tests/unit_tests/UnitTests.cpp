@@ -29,6 +29,10 @@
 #include "DiscovererTest.h"
 #include "ResolverTest.h"
 #include "CommunicationAllocatorTest.h"
+#include "SendBatchTest.h"
+#include "ChecksumTest.h"
+#include "CoalesceTest.h"
+#include "LossyLinkTest.h"
 
 std::atomic<bool> Safir::Dob::Internal::Com::Parameters::NetworkEnabled;
 std::string Safir::Dob::Internal::Com::Parameters::LogPrefix;
@@ -78,6 +82,22 @@ int main(int argc, char* argv[])
             {
                 AllocatorTest::Run();
             }
+            else if (testcase=="SendBatchTest")
+            {
+                SendBatchTest::Run();
+            }
+            else if (testcase=="ChecksumTest")
+            {
+                ChecksumTest::Run();
+            }
+            else if (testcase=="CoalesceTest")
+            {
+                CoalesceTest::Run();
+            }
+            else if (testcase=="LossyLinkTest")
+            {
+                LossyLinkTest::Run();
+            }
             else
             {
                 std::wcout << "Unknown test" << std::endl;
@@ -94,6 +114,10 @@ int main(int argc, char* argv[])
             DiscovererTest::Run();
             ResolverTest::Run();
             AllocatorTest::Run();
+            SendBatchTest::Run();
+            ChecksumTest::Run();
+            CoalesceTest::Run();
+            LossyLinkTest::Run();
         }
 
         std::wcout<<"================================="<<std::endl;
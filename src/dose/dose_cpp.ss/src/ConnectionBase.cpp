@@ -600,6 +600,55 @@ namespace Dob
         }
     }
 
+    void ConnectionBase::SetChangesBatch(const std::vector<std::pair<Dob::EntityPtr, Dob::Typesystem::InstanceId> >& entities,
+                                         const Dob::Typesystem::HandlerId&  handlerId) const
+    {
+        if (entities.empty())
+        {
+            return;
+        }
+
+        //Serialize each entity with its change flags and pass them all to dose in one call.
+        //Dose merges the changes into the current state of each instance, in order.
+        std::vector<Typesystem::BinarySerialization> bins(entities.size());
+        std::vector<const char*> blobs;
+        std::vector<DotsC_Int64> instanceIds;
+        std::vector<std::string> instanceIdStrs;
+        std::vector<const char*> instanceIdStrPtrs;
+        blobs.reserve(entities.size());
+        instanceIds.reserve(entities.size());
+        instanceIdStrs.reserve(entities.size());
+        instanceIdStrPtrs.reserve(entities.size());
+
+        for (size_t i = 0; i < entities.size(); ++i)
+        {
+            Typesystem::Serialization::ToBinary(entities[i].first, bins[i]);
+
+            blobs.push_back(&bins[i][0]);
+            instanceIds.push_back(entities[i].second.GetRawValue());
+            instanceIdStrs.push_back(entities[i].second.Utf8String());
+        }
+
+        for (size_t i = 0; i < instanceIdStrs.size(); ++i)
+        {
+            instanceIdStrPtrs.push_back(instanceIdStrs[i].c_str());
+        }
+
+        bool success;
+        DoseC_SetEntities(GetControllerId(),
+                          &blobs[0],
+                          &instanceIds[0],
+                          &instanceIdStrPtrs[0],
+                          static_cast<DotsC_Int32>(entities.size()),
+                          handlerId.GetRawValue(),
+                          handlerId.Utf8String().c_str(),
+                          success);
+        if (!success)
+        {
+            Typesystem::LibraryExceptions::Instance().Throw();
+        }
+    }
+
     void ConnectionBase::SetAll(const Dob::EntityPtr&              entity,
                                 const Dob::Typesystem::InstanceId& instanceId,
                                 const Dob::Typesystem::HandlerId&  handlerId) const
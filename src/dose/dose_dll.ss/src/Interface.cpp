@@ -34,7 +34,6 @@
 #include <Safir/Dob/Internal/Connections.h>
 #include <Safir/Dob/Internal/InjectionKindTable.h>
 #include <Safir/Dob/Internal/SharedMemoryObject.h>
-#include <Safir/Dob/Internal/TimestampOperations.h>
 #include <Safir/Dob/ConnectionInfo.h>
 #include <boost/current_function.hpp>
 
@@ -793,6 +792,35 @@ void DoseC_SetEntity(const DotsC_Int32 ctrl,
     CATCH_LIBRARY_EXCEPTIONS;
 }
 
+void DoseC_SetEntities(const DotsC_Int32 ctrl,
+                       const char* const * const blobs,
+                       const Safir::Dob::Typesystem::Int64* const instanceIds,
+                       const char* const * const instanceIdStrs,
+                       const DotsC_Int32 numEntities,
+                       const Safir::Dob::Typesystem::Int64 handlerId,
+                       const char* const handlerIdStr,
+                       bool& success)
+{
+    lllog(9) << "Entering " << BOOST_CURRENT_FUNCTION << std::endl;
+    success = false;
+    try
+    {
+        std::vector<Typesystem::InstanceId> instances;
+        instances.reserve(numEntities);
+        for (DotsC_Int32 i = 0; i < numEntities; ++i)
+        {
+            instances.push_back(Typesystem::InstanceId(instanceIds[i],Typesystem::Utilities::ToWstring(instanceIdStrs[i])));
+        }
+
+        ControllerTable::Instance().GetController(ctrl)->
+            SetEntities(blobs,
+                        instances,
+                        Typesystem::HandlerId(handlerId,Typesystem::Utilities::ToWstring(handlerIdStr)));
+        success = true;
+    }
+    CATCH_LIBRARY_EXCEPTIONS;
+}
+
 void DoseC_DeleteEntity(const DotsC_Int32 ctrl,
                         const Safir::Dob::Typesystem::TypeId typeId,
                         const Safir::Dob::Typesystem::Int64 instanceId,
@@ -1182,6 +1210,13 @@ void DoseC_GetQueueSize(const DotsC_Int32 ctrl,
     CATCH_LIBRARY_EXCEPTIONS;
 }
 
+//Deleter for the diff blobs from DoseC_Diff, which are shared by all subscribers that get the same update.
+static void DropDiffBlob(char* & diffBlob)
+{
+    DistributionData::DropDiffReference(diffBlob);
+    diffBlob = NULL;
+}
+
 void DoseC_Diff(const char* const previousState,
                 const char* const currentState,
                 const bool wantCurrent,
@@ -1193,58 +1228,13 @@ void DoseC_Diff(const char* const previousState,
     lllog(9) << "Entering " << BOOST_CURRENT_FUNCTION << std::endl;
     success = false;
     diffBlob = NULL;
-    deleter = Safir::Dob::Typesystem::Internal::BlobOperations::Delete;
+    deleter = DropDiffBlob;
     try
     {
         const DistributionData previous = DistributionData::ConstConstructor(new_data_tag_t(), previousState);
         const DistributionData current = DistributionData::ConstConstructor(new_data_tag_t(), currentState);
 
-        if (wantCurrent)
-        {
-            Typesystem::Internal::BlobWriteHelper writer(current.GetBlob());
-
-            if (!previous.IsCreated())
-            {
-                writer.SetChangedRecursive(true);
-            }
-            else
-            {
-                if (timestampDiff)
-                {
-                    TimestampOperations::SetChangeFlags(previous, current, writer);
-                }
-                else
-                {
-                    //ordinary blob diff
-                    writer.Diff(previous.GetBlob());
-                }
-            }
-
-            diffBlob=writer.ToBlob();
-        }
-        else //wantPrevious
-        {
-            Typesystem::Internal::BlobWriteHelper writer(previous.GetBlob());
-
-            if (!current.IsCreated())
-            {
-                writer.SetChangedRecursive(true);
-            }
-            else
-            {
-                if (timestampDiff)
-                {
-                    TimestampOperations::SetChangeFlags(previous, current, writer);
-                }
-                else
-                {
-                    //ordinary blob diff
-                    writer.Diff(current.GetBlob());
-                }
-            }
-
-            diffBlob=writer.ToBlob();
-        }
+        diffBlob = const_cast<char*>(DistributionData::GetDiffReference(previous, current, wantCurrent, timestampDiff));
 
         success = true;
     }
@@ -1077,6 +1077,75 @@ namespace Internal
                                           initialInjection);
     }
 
+    void Controller::SetEntities(const char* const * const                   blobs,
+                                 const std::vector<Typesystem::InstanceId>&  instanceIds,
+                                 const Typesystem::HandlerId&                handlerId)
+    {
+        if (!m_isConnected)
+        {
+            std::wostringstream ostr;
+            ostr << "This connection to the DOB is not open. (While calling SetEntities with "
+                 << instanceIds.size() << " entities and handler = " << handlerId << ")";
+            throw Safir::Dob::NotOpenException(ostr.str(),__WFILE__,__LINE__);
+        }
+
+        const bool inInjectionCallback = m_dispatcher.InCallback(CallbackId::OnInjectedNewEntity) ||
+                                         m_dispatcher.InCallback(CallbackId::OnInjectedUpdatedEntity) ||
+                                         m_dispatcher.InCallback(CallbackId::OnInjectedDeletedEntity);
+
+        // The subscribers are signalled when this goes out of scope, also if a set fails.
+        DeferredSignalIns deferredSignalIns;
+
+        size_t first = 0;
+        while (first < instanceIds.size())
+        {
+            const Dob::Typesystem::TypeId typeId = Dob::Typesystem::Internal::BlobOperations::GetTypeId(blobs[first]);
+
+            if (!Dob::Typesystem::Operations::IsOfType(typeId, Dob::Entity::ClassTypeId))
+            {
+                std::wostringstream ostr;
+                ostr << "Object passed to SetEntities is not an entity! (Type = "
+                    << Typesystem::Operations::GetName(typeId) << " and instance = " << instanceIds[first]
+                    << " and handler = " << handlerId << ")";
+                throw Typesystem::SoftwareViolationException(ostr.str(),__WFILE__,__LINE__);
+            }
+
+            // Setting the injected entity from within an OnInjected callback has its own
+            // semantics (see SetEntity), which a batch can't have.
+            const auto isDispatchedInjection = [&](const size_t i)
+            {
+                return inInjectionCallback &&
+                    typeId == m_dispatchedInjection.GetTypeId() &&
+                    instanceIds[i] == m_dispatchedInjection.GetInstanceId();
+            };
+
+            if (isDispatchedInjection(first))
+            {
+                std::wostringstream ostr;
+                ostr << "The injected entity can not be set with SetEntities from within an OnInjected callback. (Type = "
+                     << Typesystem::Operations::GetName(typeId) << " and instance = " << instanceIds[first]
+                     << " and handler = " << handlerId << ")";
+                throw Typesystem::SoftwareViolationException(ostr.str(),__WFILE__,__LINE__);
+            }
+
+            size_t last = first + 1;
+            while (last < instanceIds.size() &&
+                   Dob::Typesystem::Internal::BlobOperations::GetTypeId(blobs[last]) == typeId &&
+                   !isDispatchedInjection(last))
+            {
+                ++last;
+            }
+
+            EntityTypes::Instance().SetEntities(m_connection,
+                                                handlerId,
+                                                typeId,
+                                                last - first,
+                                                &instanceIds[first],
+                                                &blobs[first]);
+            first = last;
+        }
+    }
+
     void Controller::DeleteEntity(const Dob::Typesystem::EntityId& entityId,
                                   const bool                       allInstances,
                                   const Typesystem::HandlerId&     handlerId)
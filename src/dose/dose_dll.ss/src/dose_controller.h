@@ -238,6 +238,12 @@ namespace Internal
                        const bool                       considerChangeFlags,
                        const bool                       initialInjection);
 
+        // Merge the changes of a batch of entities into the pool, in order. Runs of consecutive entities
+        // of the same type are set under one type lock, and subscribers are signalled once for the whole batch.
+        void SetEntities(const char* const * const                   blobs,
+                         const std::vector<Typesystem::InstanceId>&  instanceIds,
+                         const Typesystem::HandlerId&                handlerId);
+
         void DeleteEntity(const Dob::Typesystem::EntityId& entityId,
                           const bool                       allInstances,
                           const Typesystem::HandlerId&     handlerId);
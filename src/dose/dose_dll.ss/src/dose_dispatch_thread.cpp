@@ -91,9 +91,9 @@ namespace Internal
 
     void DispatchThread::Run()
     {
-        const boost::function<void(void)> waiter = Connections::Instance().GetConnectionSignalWaiter(m_id);
         try
         {
+            const boost::function<void(void)> waiter = Connections::Instance().GetConnectionSignalWaiter(m_id);
             for (;;)
             {
                 //wait for connection signal
@@ -479,6 +479,18 @@ extern "C"
                                       const bool initialInjection,
                                       bool& success);
 
+    //Merge the changes of a batch of entities for one handler into the pool, in order, as SetChanges
+    //does. The blobs hold the changed members with their change flags set. The arrays hold numEntities
+    //elements each. On failure the entities before the failing one have been set.
+    DOSE_DLL_API void DoseC_SetEntities(const DotsC_Int32 ctrl,
+                                        const char* const * const blobs,
+                                        const DotsC_Int64* const instanceIds,
+                                        const char* const * const instanceIdStrs,
+                                        const DotsC_Int32 numEntities,
+                                        const DotsC_Int64 handlerId,
+                                        const char* const handlerIdStr,
+                                        bool& success);
+
     DOSE_DLL_API void DoseC_DeleteEntity(const DotsC_Int32 ctrl,
                                          const DotsC_TypeId typeId,
                                          const DotsC_Int64 instanceId,
@@ -23,6 +23,7 @@
 ******************************************************************************/
 
 #include <Safir/Dob/Internal/Connection.h>
+#include <Safir/Dob/Internal/Connections.h>
 
 #include "Signals.h"
 #include <Safir/Utilities/Internal/Id.h>
@@ -76,7 +77,7 @@ namespace Internal
         m_id(),
         m_pid(pid),
         m_queueCapacities(GetQueueCapacities(name)),
-        m_outSignal(NULL),
+        m_outSignalSlot(-1),
         m_subscribedTypes(NumberOfSubscriptionTypes),
         m_messageInQueues(GetSharedMemory().construct<MessageQueueContainer>(boost::interprocess::anonymous_instance)()),
         m_messageOutQueue(QueueCapacity(ConnectionQueueId::MessageOutQueue)),
@@ -93,10 +94,12 @@ namespace Internal
         m_nameWithCounter = ShmString(nameWithCounter.begin(),nameWithCounter.end());
         m_id = ConnectionId(node, contextId, CalculateIdentifier(nameWithCounter));
 
+#ifndef DOSE_FUTEX_SIGNALS
         if (IsLocal())
         {
             Signals::Remove(Id());
         }
+#endif
         lllout << "In Connection constructor: Constructing '" << name.c_str() << "' id = " << m_id <<" pid = " << m_pid << std::endl;
     }
 
@@ -104,10 +107,12 @@ namespace Internal
     {
         lllout << "In Connection destructor for '" << m_nameWithoutCounter.c_str() << "' id = " << m_id << std::endl;
 
+#ifndef DOSE_FUTEX_SIGNALS
         if (IsLocal())
         {
             Signals::Remove(Id());
         }
+#endif
     }
 
     RequestInQueuePtr Connection::AddRequestInQueue(const ConsumerId& consumer)
@@ -463,10 +468,9 @@ namespace Internal
 
     void Connection::SignalOut() const
     {
-        if (m_outSignal != NULL)
+        if (m_outSignalSlot >= 0)
         {
-            *m_outSignal = 1;
-            Signals::Instance().SignalConnectOrOut();
+            Connections::Instance().SignalConnectionOut(m_outSignalSlot);
         }
     }
 
@@ -474,7 +478,11 @@ namespace Internal
     {
         if (!IsLocal()) return;
 
+#ifdef DOSE_FUTEX_SIGNALS
+        m_inSignal.Post();
+#else
         Signals::Instance().SignalIn(Id());
+#endif
     }
 
     void Connection::AddPendingRegistration(const PendingRegistration & reg)
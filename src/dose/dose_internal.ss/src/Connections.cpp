@@ -53,8 +53,8 @@ namespace Internal
     Connections::Connections(private_constructor_t, const int64_t nodeId):
         m_nodeId(nodeId),
         m_maxNumConnections(Safir::Dob::NodeParameters::MaxNumberOfConnections()),
-        m_connectionOutIds(m_maxNumConnections), //default constructed (-1,-1)
-        m_lastUsedSlot(0),
+        m_connectionOutSignals(m_maxNumConnections),
+        m_connectionOutSlots(m_maxNumConnections),
         m_connectSignal(0),
         m_connectSem(0),
         m_connectMinusOneSem(0),
@@ -65,13 +65,11 @@ namespace Internal
     {
         ENSURE(nodeId != 0, << "Connections must be constructed with valid nodeId");
 
-        m_connectionOutSignals =
-            static_cast<Safir::Utilities::Internal::AtomicUint32*>
-            (GetSharedMemory().allocate(sizeof(Safir::Utilities::Internal::AtomicUint32)* m_maxNumConnections));
-
-        for (int i = 0; i < m_maxNumConnections; ++i)
+        //pushed in reverse, so that the lowest slots are used first
+        m_freeOutSlots.reserve(m_maxNumConnections);
+        for (int i = m_maxNumConnections - 1; i >= 0; --i)
         {
-            m_connectionOutSignals.get()[i] = 0;
+            m_freeOutSlots.push_back(i);
         }
     }
 
@@ -79,10 +77,12 @@ namespace Internal
     {
         m_instance = GetSharedMemory().find_or_construct<Connections>("Connections")(private_constructor_t(), nodeId);
 
+#ifndef DOSE_FUTEX_SIGNALS
         if (iAmDoseMain)
         {
             Signals::RemoveConnectOrOut();
         }
+#endif
     }
 
 
@@ -95,7 +95,11 @@ namespace Internal
     {
         connect = false;
         connectionOut = false;
+#ifdef DOSE_FUTEX_SIGNALS
+        m_doseMainSignal.Wait();
+#else
         Signals::Instance().WaitForConnectOrOut();
+#endif
         //get the events
         const std::uint32_t oldconnectSignal = m_connectSignal.compare_exchange(0, 1);
 
@@ -110,9 +114,30 @@ namespace Internal
         //std::wcout << "WaitForDoseMainSignal: connect = " << std::boolalpha << connect << ", connectionOut = " << connectionOut << std::endl;
     }
 
+    void Connections::SignalDoseMain() const
+    {
+#ifdef DOSE_FUTEX_SIGNALS
+        m_doseMainSignal.Post();
+#else
+        Signals::Instance().SignalConnectOrOut();
+#endif
+    }
+
+    void Connections::SignalConnectionOut(const int slot)
+    {
+        m_connectionOutSignals.Set(slot);
+        SignalDoseMain();
+    }
+
     const std::function<void(void)> Connections::GetConnectionSignalWaiter(const ConnectionId & connectionId)
     {
+#ifdef DOSE_FUTEX_SIGNALS
+        //the waiter keeps the connection, and with it the signal, alive for as long as it is used
+        const ConnectionPtr connection = GetConnection(connectionId);
+        return [connection]{connection->WaitForSignalIn();};
+#else
         return Signals::Instance().GetConnectionSignalWaiter(connectionId);
+#endif
     }
 
 
@@ -163,7 +188,7 @@ namespace Internal
         m_connectMessage.Set(connect_tag, connectionName, contextId, pid);
 
         m_connectSignal = 1;
-        Signals::Instance().SignalConnectOrOut();
+        SignalDoseMain();
         //wait for response
 
         lllout << "Waiting for m_connectResponseEvent" << std::endl;
@@ -373,46 +398,29 @@ namespace Internal
 
     void Connections::AddToSignalHandling(const ConnectionPtr& connection)
     {
-        //find a free slot
-        Containers<ConnectionId>::vector::iterator findIt = std::find(m_connectionOutIds.begin(),
-                                                                      m_connectionOutIds.end(),
-                                                                      ConnectionId());
-        ENSURE (findIt != m_connectionOutIds.end(), << "No free slot was found in the connection handler arrays!");
+        ENSURE (!m_freeOutSlots.empty(), << "No free slot was found in the connection handler arrays!");
 
-        *findIt = connection->Id();
-        const size_t index = std::distance(m_connectionOutIds.begin(),findIt);
-        m_connectionOutSignals[index] = 0;
-        connection->SetOutSignal(&m_connectionOutSignals[index]);
+        const int slot = m_freeOutSlots.back();
+        m_freeOutSlots.pop_back();
 
-        m_lastUsedSlot = std::max(m_lastUsedSlot,index);
+        m_connectionOutSlots[slot] = connection;
+        m_connectionOutSignals.Reset(slot);
+        connection->SetOutSignalSlot(slot);
     }
 
 
     void Connections::RemoveFromSignalHandling(const ConnectionPtr& connection)
     {
-        Containers<ConnectionId>::vector::iterator findIt =
-            std::find(m_connectionOutIds.begin(),
-                      m_connectionOutIds.end(),
-                      connection->Id());
+        const int slot = connection->OutSignalSlot();
 
-        ENSURE(findIt != m_connectionOutIds.end(), << "Could not find connection " << connection->Id() << " to remove from signalling vector!");
+        ENSURE(slot >= 0 && m_connectionOutSlots[slot] == connection,
+               << "Could not find connection " << connection->Id() << " to remove from signalling vector!");
 
-        //set the signal to false and remove the connection from the vector
-        const size_t index = std::distance(m_connectionOutIds.begin(),findIt);
-        m_connectionOutSignals[index] = false;
-        *findIt = ConnectionId();
-
-        //if it was the last slot that we're no longer using we need to find
-        //the last one that is in use now.
-        if (index == m_lastUsedSlot)
-        {
-            size_t i = index;
-            while(m_connectionOutIds[i] == ConnectionId() && i > 0)
-            {
-                --i;
-            }
-            m_lastUsedSlot = i;
-        }
+        //reset the signal and free the slot
+        m_connectionOutSignals.Reset(slot);
+        m_connectionOutSlots[slot].reset();
+        m_freeOutSlots.push_back(slot);
+        connection->SetOutSignalSlot(-1);
     }
 
 
@@ -421,32 +429,23 @@ namespace Internal
     {
         std::vector<ConnectionPtr> signalledConnections;
 
-        //Take the lock while we loop through the signal vectors, but release it before we
-        //call the handler for the signalled connections.
+        //Take the lock while we collect the signalled connections, but release it before we
+        //call the handler for them.
         {
             boost::interprocess::scoped_lock<ConnectionsTableLock> lck(m_connectionTablesLock);
-            const Safir::Utilities::Internal::AtomicUint32 * end = m_connectionOutSignals.get() + m_lastUsedSlot + 1;
-            for (Safir::Utilities::Internal::AtomicUint32 * it = m_connectionOutSignals.get();
-                 it != end; ++it)
+            m_connectionOutSignals.ForEachSet([this,&signalledConnections](const size_t slot)
             {
-                if (*it != 0)
-                {
-                    *it = 0;
-
-                    const ConnectionId& connId = m_connectionOutIds[std::distance(m_connectionOutSignals.get(), it)];
+                const ConnectionPtr& connection = m_connectionOutSlots[slot];
 
-                    if (connId == ConnectionId()) //compare with dummy-connection
-                    {
-                        SEND_SYSTEM_LOG(Warning, << "A signal was set for a slot that has no valid connection id! Resetting it!");
-                    }
-                    else
-                    {
-                        const auto findIt = m_connections.find(connId);
-                        ENSURE(findIt != m_connections.end(), << "Connections::GetConnection: Failed to find connection! connectionId = " << connId);
-                        signalledConnections.push_back(findIt->second);
-                    }
+                if (!connection)
+                {
+                    SEND_SYSTEM_LOG(Warning, << "A signal was set for a slot that has no valid connection id! Resetting it!");
                 }
-            }
+                else
+                {
+                    signalledConnections.push_back(connection);
+                }
+            });
         }
 
         //The lock is released here, so at all points in the following loop where we're not holding the lock,
@@ -622,6 +621,10 @@ namespace Internal
             {
                 if (it->second->IsDetached())
                 {
+                    if (it->second->IsLocal())
+                    {
+                        RemoveFromSignalHandling(it->second);
+                    }
                     removeConnections.push_back(it->second);
                     it = m_connections.erase(it);
                 }
@@ -695,7 +698,7 @@ namespace Internal
 
     void Connections::GenerateSpuriousConnectOrOutSignal() const
     {
-        Signals::Instance().SignalConnectOrOut();
+        SignalDoseMain();
     }
 }
 }
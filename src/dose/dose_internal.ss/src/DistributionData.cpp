@@ -25,6 +25,7 @@
 #include <Safir/Dob/Internal/DistributionData.h>
 #include <Safir/Dob/Internal/StateDeleter.h>
 #include <Safir/Dob/Internal/InjectionKindTable.h>
+#include <Safir/Dob/Internal/TimestampOperations.h>
 #include <Safir/Dob/Typesystem/Internal/InternalUtils.h>
 #include <Safir/Dob/Typesystem/Serialization.h>
 #include <Safir/Dob/Typesystem/Members.h>
@@ -130,8 +131,57 @@ namespace Internal
         BOOST_STATIC_ASSERT(sizeof (unsigned int) == sizeof(std::uint32_t));
 
         BOOST_STATIC_ASSERT(sizeof(Safir::Utilities::Internal::AtomicUint32) == 4);
+
+        //the slab blocks are 8 byte aligned and the data shall be 4 byte aligned, see Header
+        BOOST_STATIC_ASSERT(IntrusiveOperations::PrefixSize % 8 == 4);
+    }
+
+namespace
+{
+    //Serial numbers are only handed out to data that someone diffs against, so there is no shared
+    //counter to update when ordinary messages and states are allocated.
+    class DiffSerials:
+        public SharedMemoryObject
+    {
+    public:
+        static std::uint64_t Next()
+        {
+            static std::atomic<std::uint64_t>* const counter =
+                GetSharedMemory().find_or_construct<std::atomic<std::uint64_t> >("DISTRIBUTION_DATA_DIFF_SERIAL")(1);
+            return (*counter)++;
+        }
+    };
+
+    //Precedes a diff blob in the shared memory. The blob starts directly after it, 8 byte aligned.
+    struct DiffHeader
+    {
+        std::atomic<std::uint32_t> count;
+        std::uint32_t flags;
+        std::uint64_t otherSerial; //serial of the state the diff is against
+    };
+
+    char* GetDiffBlob(DiffHeader* diff)
+    {
+        return static_cast<char*>(static_cast<void*>(diff + 1));
     }
 
+    DiffHeader* GetDiffHeader(const char* const diffBlob)
+    {
+        return static_cast<DiffHeader*>(static_cast<void*>(const_cast<char*>(diffBlob))) - 1;
+    }
+
+    DiffHeader* GetCachedDiffHeader(const std::atomic<std::int64_t>& slot)
+    {
+        const std::int64_t offset = slot.load();
+        if (offset == 0)
+        {
+            return NULL;
+        }
+        return static_cast<DiffHeader*>(static_cast<void*>(const_cast<char*>
+            (static_cast<const char*>(static_cast<const void*>(&slot)) + offset)));
+    }
+}
+
 
 #ifdef REGISTER_TIMES
     Typesystem::Int32 GenerateId()
@@ -1463,6 +1513,106 @@ namespace Internal
         m_data = data;
     }
 
+    std::uint64_t DistributionData::GetSerial() const
+    {
+        std::atomic<std::uint64_t>& serial = IntrusiveOperations::GetSerial(GetData());
+        std::uint64_t value = serial.load();
+        if (value == 0)
+        {
+            const std::uint64_t next = DiffSerials::Next();
+            if (serial.compare_exchange_strong(value, next))
+            {
+                value = next;
+            }
+        }
+        return value;
+    }
+
+    const char * DistributionData::GetDiffReference(const DistributionData& previous,
+                                                    const DistributionData& current,
+                                                    const bool wantCurrent,
+                                                    const bool timestampDiff)
+    {
+        //state is the one whose blob we return, other is the one it is diffed against
+        const DistributionData& state = wantCurrent ? current : previous;
+        const DistributionData& other = wantCurrent ? previous : current;
+        const std::uint32_t flags = (wantCurrent ? 1 : 0) | (timestampDiff ? 2 : 0);
+        const std::uint64_t otherSerial = other.GetSerial();
+
+        std::atomic<std::int64_t>& slot = IntrusiveOperations::GetCachedDiff(state.GetData());
+
+        //The cached diff is never replaced or removed while the state is alive, and the caller
+        //holds a reference to the state, so it is safe to add a reference to it.
+        DiffHeader* const cached = GetCachedDiffHeader(slot);
+        if (cached != NULL && cached->otherSerial == otherSerial && cached->flags == flags)
+        {
+            ++cached->count;
+            return GetDiffBlob(cached);
+        }
+
+        Typesystem::Internal::BlobWriteHelper writer(state.GetBlob());
+
+        if (!other.IsCreated())
+        {
+            writer.SetChangedRecursive(true);
+        }
+        else if (timestampDiff)
+        {
+            TimestampOperations::SetChangeFlags(previous, current, writer);
+        }
+        else
+        {
+            //ordinary blob diff
+            writer.Diff(other.GetBlob());
+        }
+
+        DiffHeader* const diff = static_cast<DiffHeader*>
+            (SlabAllocator::Instance().Allocate(sizeof(DiffHeader) + static_cast<size_t>(writer.CalculatedSize())));
+        new (diff) DiffHeader();
+        diff->count = 1;
+        diff->flags = flags;
+        diff->otherSerial = otherSerial;
+        writer.ToBlob(GetDiffBlob(diff));
+
+        //One cached diff per state is enough, since nearly all subscribers diff against the state
+        //that the latest update replaced. If another subscriber got here first we keep ours to ourselves.
+        if (cached == NULL)
+        {
+            ++diff->count; //the reference held by the state
+            std::int64_t expected = 0;
+            const std::int64_t offset = static_cast<const char*>(static_cast<const void*>(diff)) -
+                static_cast<const char*>(static_cast<const void*>(&slot));
+            if (!slot.compare_exchange_strong(expected, offset))
+            {
+                --diff->count;
+            }
+        }
+
+        return GetDiffBlob(diff);
+    }
+
+    void DistributionData::DropDiffReference(const char* const diffBlob)
+    {
+        if (diffBlob != NULL)
+        {
+            DiffHeader* const diff = GetDiffHeader(diffBlob);
+            if (1 == diff->count--)
+            {
+                diff->~DiffHeader();
+                SlabAllocator::Instance().Deallocate(diff);
+            }
+        }
+    }
+
+    void DistributionData::ReleaseCachedDiff(const char * data)
+    {
+        DiffHeader* const diff = GetCachedDiffHeader(IntrusiveOperations::GetCachedDiff(data));
+        if (diff != NULL)
+        {
+            DropDiffReference(GetDiffBlob(diff));
+        }
+    }
+
 }
 }
 }
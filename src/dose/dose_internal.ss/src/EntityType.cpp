@@ -27,6 +27,7 @@
 #include <Safir/Dob/AccessDeniedException.h>
 #include <Safir/Dob/LowMemoryException.h>
 #include <Safir/Dob/GhostExistsException.h>
+#include <Safir/Dob/HashedInstanceLookupProperty.h>
 #include <Safir/Dob/NotFoundException.h>
 #include <Safir/Dob/Internal/InjectionKindTable.h>
 #include <Safir/Dob/Internal/LamportClocks.h>
@@ -38,6 +39,10 @@
 #include <Safir/Utilities/Internal/SystemLog.h>
 #include <Safir/Dob/Internal/DistributionScopeReader.h>
 #include <Safir/Dob/Internal/LowMemoryOperationsTable.h>
+#include <Safir/Dob/Typesystem/ObjectFactory.h>
+#include <Safir/Dob/Typesystem/Operations.h>
+#include <Safir/Dob/Typesystem/Serialization.h>
+#include <Safir/Dob/Typesystem/Utilities.h>
 
 using namespace std::placeholders;
 
@@ -47,15 +52,51 @@ namespace Dob
 {
 namespace Internal
 {
+namespace
+{
+    bool ReadHashedInstanceLookup(const Typesystem::TypeId typeId)
+    {
+        if (!Dob::Typesystem::Operations::HasProperty(typeId,Dob::HashedInstanceLookupProperty::ClassTypeId))
+        {
+            return false;
+        }
+
+        try
+        {
+            //unfortunately we have to create dummy object here to be able to read the property, even
+            //though it is a constant
+            Dob::Typesystem::ObjectPtr obj = Typesystem::ObjectFactory::Instance().CreateObject(typeId);
+            const bool hashed = Dob::HashedInstanceLookupProperty::GetHashedInstanceLookup(obj);
+            if (hashed)
+            {
+                lllout << "Type " << Typesystem::Operations::GetName(typeId)
+                       << " uses hashed instance lookup." << std::endl;
+            }
+            return hashed;
+        }
+        catch (const std::exception & exc)
+        {
+            std::wostringstream ostr;
+            ostr << "Failed to read Property member 'HashedInstanceLookup' of property "
+                 << Typesystem::Operations::GetName(Dob::HashedInstanceLookupProperty::ClassTypeId)
+                 << " for class "
+                 << Typesystem::Operations::GetName(typeId)
+                 << ". Got exception " << exc.what();
+            throw Safir::Dob::Typesystem::SoftwareViolationException(ostr.str(),__WFILE__,__LINE__);
+        }
+    }
+}
+
     EntityType::EntityType(const Typesystem::TypeId typeId, const int64_t nodeId)
         : m_typeId(typeId),
           m_typeIsContextShared(ContextSharedTable::Instance().IsContextShared(typeId)),
           m_injectionKind(InjectionKindTable::Instance().GetInjectionKind(typeId)),
           m_nodeId(nodeId),
           m_clock(nodeId),
-          m_entityStates(Safir::Dob::NodeParameters::NumberOfContexts(), typeId),
+          m_entityStates(Safir::Dob::NodeParameters::NumberOfContexts(), typeId, ReadHashedInstanceLookup(typeId)),
           m_handlerRegistrations(Safir::Dob::NodeParameters::NumberOfContexts(), typeId, nodeId),
-          m_typeLocks(Safir::Dob::NodeParameters::NumberOfContexts())
+          m_typeLocks(Safir::Dob::NodeParameters::NumberOfContexts()),
+          m_instanceLocks(Safir::Dob::NodeParameters::NumberOfContexts())
     {
         // Set the correct state container pointer in each registration handler.
         for (ContextId context = 0; context < Safir::Dob::NodeParameters::NumberOfContexts(); ++context)
@@ -259,7 +300,8 @@ namespace Internal
             throw Safir::Dob::Typesystem::SoftwareViolationException(ostr.str(),__WFILE__,__LINE__);
         }
 
-        ScopedTypeLock lck(m_typeLocks[context]);
+        SharableTypeLock lck(m_typeLocks[context]);
+        ScopedInstanceLock instanceLck(GetInstanceLock(context, instanceId));
 
         if (!initialInjection)
         {
@@ -280,6 +322,40 @@ namespace Internal
         }
     }
 
+    void EntityType::SetEntities(const ConnectionPtr&                   connection,
+                                 const Dob::Typesystem::HandlerId&      handlerId,
+                                 const size_t                           numInstances,
+                                 const Dob::Typesystem::InstanceId*     instanceIds,
+                                 const char* const *                    blobs)
+    {
+        const ContextId context = connection->Id().m_contextId;
+
+        if (m_typeIsContextShared && context != 0)
+        {
+            std::wostringstream ostr;
+            ostr << "Entity " << Typesystem::Operations::GetName(m_typeId) <<
+                    ", which is ContextShared, can only be set from context 0.";
+            throw Safir::Dob::Typesystem::SoftwareViolationException(ostr.str(),__WFILE__,__LINE__);
+        }
+
+        SharableTypeLock lck(m_typeLocks[context]);
+
+        for (size_t i = 0; i < numInstances; ++i)
+        {
+            const Dob::Typesystem::InstanceId& instanceId = instanceIds[i];
+            const char* const blob = blobs[i];
+
+            ScopedInstanceLock instanceLck(GetInstanceLock(context, instanceId));
+
+            // Add a state if it is not already present
+            m_entityStates[context].ForSpecificStateAdd
+                (instanceId.GetRawValue(),
+                 [this,&connection,&handlerId,&instanceId,blob]
+                     (const auto /*key*/, const auto& stateSharedPtr)
+                     {SetEntityChangesInternal(stateSharedPtr,connection,handlerId,instanceId,blob);});
+        }
+    }
+
     void EntityType::DeleteEntity(const ConnectionPtr&                  connection,
                                   const Dob::Typesystem::HandlerId&     handlerId,
                                   const Dob::Typesystem::InstanceId&    instanceId,
@@ -295,10 +371,10 @@ namespace Internal
             throw Safir::Dob::Typesystem::SoftwareViolationException(ostr.str(),__WFILE__,__LINE__);
         }
 
-        ScopedTypeLock lck(m_typeLocks[context]);
-
         if (allInstances)
         {
+            ScopedTypeLock lck(m_typeLocks[context]);
+
             m_entityStates[context].ForEachState
                 ([this,&connection,&handlerId]
                      (const auto /*key*/, const auto& stateSharedPtr, bool& exitDispatch)
@@ -307,6 +383,9 @@ namespace Internal
         }
         else
         {
+            SharableTypeLock lck(m_typeLocks[context]);
+            ScopedInstanceLock instanceLck(GetInstanceLock(context, instanceId));
+
             m_entityStates[context].ForSpecificState
                 (instanceId.GetRawValue(),
                  [this,&connection,&handlerId,&instanceId]
@@ -336,7 +415,8 @@ namespace Internal
             throw Safir::Dob::Typesystem::SoftwareViolationException(ostr.str(),__WFILE__,__LINE__);
         }
 
-        ScopedTypeLock lck(m_typeLocks[context]);
+        SharableTypeLock lck(m_typeLocks[context]);
+        ScopedInstanceLock instanceLck(GetInstanceLock(context, instanceId));
 
         m_entityStates[context].ForSpecificStateAdd
             (instanceId.GetRawValue(),
@@ -363,7 +443,8 @@ namespace Internal
             throw Safir::Dob::Typesystem::SoftwareViolationException(ostr.str(),__WFILE__,__LINE__);
         }
 
-        ScopedTypeLock lck(m_typeLocks[context]);
+        SharableTypeLock lck(m_typeLocks[context]);
+        ScopedInstanceLock instanceLck(GetInstanceLock(context, instanceId));
 
         m_entityStates[context].ForSpecificStateAdd
             (instanceId.GetRawValue(),
@@ -384,7 +465,8 @@ namespace Internal
                     ", which is ContextShared, can only be accepted from context 0.");
         }
 
-        ScopedTypeLock lck(m_typeLocks[context]);
+        SharableTypeLock lck(m_typeLocks[context]);
+        ScopedInstanceLock instanceLck(GetInstanceLock(context, injectionState.GetInstanceId()));
 
 
         m_entityStates[context].ForSpecificState
@@ -414,7 +496,8 @@ namespace Internal
             throw Safir::Dob::Typesystem::SoftwareViolationException(ostr.str(),__WFILE__,__LINE__);
         }
 
-        ScopedTypeLock lck(m_typeLocks[context]);
+        SharableTypeLock lck(m_typeLocks[context]);
+        ScopedInstanceLock instanceLck(GetInstanceLock(context, instanceId));
 
         m_entityStates[context].ForSpecificState
             (instanceId.GetRawValue(),
@@ -447,7 +530,8 @@ namespace Internal
             throw Safir::Dob::Typesystem::SoftwareViolationException(ostr.str(),__WFILE__,__LINE__);
         }
 
-        ScopedTypeLock lck(m_typeLocks[context]);
+        SharableTypeLock lck(m_typeLocks[context]);
+        ScopedInstanceLock instanceLck(GetInstanceLock(context, instanceId));
 
         m_entityStates[context].ForSpecificState
             (instanceId.GetRawValue(),
@@ -469,7 +553,8 @@ namespace Internal
                                     ", which is ContextShared, in context " << context);
         }
 
-        ScopedTypeLock lck(m_typeLocks[context]);
+        SharableTypeLock lck(m_typeLocks[context]);
+        ScopedInstanceLock instanceLck(GetInstanceLock(context, entityState.GetInstanceId()));
 
         m_clock.UpdateCurrentTimestamp(entityState.GetCreationTime());
 
@@ -492,7 +577,8 @@ namespace Internal
 
         RemoteSetResult result = RemoteSetAccepted;
         {
-            ScopedTypeLock lck(m_typeLocks[context]);
+            SharableTypeLock lck(m_typeLocks[context]);
+            ScopedInstanceLock instanceLck(GetInstanceLock(context, entityState.GetInstanceId()));
 
             m_clock.UpdateCurrentTimestamp(entityState.GetCreationTime());
 
@@ -525,7 +611,8 @@ namespace Internal
 
         RemoteSetResult result;
         {
-            ScopedTypeLock lck(m_typeLocks[context]);
+            SharableTypeLock lck(m_typeLocks[context]);
+            ScopedInstanceLock instanceLck(GetInstanceLock(context, entityState.GetInstanceId()));
 
             m_clock.UpdateCurrentTimestamp(entityState.GetCreationTime());
 
@@ -896,6 +983,31 @@ namespace Internal
                        DistributionData(no_state_tag));  // No injection state to consider in this case (is used to set correct top timestamps)
     }
 
+    void EntityType::SetEntityChangesInternal(const StateSharedPtr&                statePtr,
+                                              const ConnectionPtr&                 connection,
+                                              const Dob::Typesystem::HandlerId&    handlerId,
+                                              const Dob::Typesystem::InstanceId&   instanceId,
+                                              const char* const                    blob)
+    {
+        ENSURE(blob != NULL, << "Trying to call a SetEntities with a NULL blob! connId = " << connection->Id());
+
+        if (!IsCreated(statePtr))
+        {
+            // Nothing to merge the changes into, so set the whole entity.
+            SetEntityInternal(statePtr,connection,handlerId,instanceId,false,blob);
+            return;
+        }
+
+        // Merge the changes into the current state, the same way as ConnectionBase::SetChanges does.
+        Typesystem::ObjectPtr merged = Typesystem::ObjectFactory::Instance().CreateObject(statePtr->GetRealState().GetBlob());
+        Typesystem::Utilities::MergeChanges(merged, Typesystem::ObjectFactory::Instance().CreateObject(blob));
+
+        Typesystem::BinarySerialization bin;
+        Typesystem::Serialization::ToBinary(merged, bin);
+
+        SetEntityInternal(statePtr,connection,handlerId,instanceId,true,&bin[0]);
+    }
+
     void EntityType::DeleteEntityInternal(const StateSharedPtr&                statePtr,
                                           const ConnectionPtr&                 connection,
                                           const Dob::Typesystem::HandlerId&    handlerId,
@@ -286,6 +286,16 @@ namespace Internal
         GetType(entityId.GetTypeId()).SetEntity(connection, handlerId, entityId.GetInstanceId(), blob, considerChangeFlags, initialInjection);
     }
 
+    void EntityTypes::SetEntities(const ConnectionPtr&                   connection,
+                                  const Dob::Typesystem::HandlerId&      handlerId,
+                                  const Dob::Typesystem::TypeId          typeId,
+                                  const size_t                           numInstances,
+                                  const Dob::Typesystem::InstanceId*     instanceIds,
+                                  const char* const *                    blobs)
+    {
+        GetType(typeId).SetEntities(connection, handlerId, numInstances, instanceIds, blobs);
+    }
+
     void EntityTypes::DeleteEntity(const ConnectionPtr&              connection,
                                    const Dob::Typesystem::HandlerId& handlerId,
                                    const Dob::Typesystem::EntityId&  entityId,
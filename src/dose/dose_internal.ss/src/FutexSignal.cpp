@@ -0,0 +1,95 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+#include <Safir/Dob/Internal/FutexSignal.h>
+
+#ifdef DOSE_FUTEX_SIGNALS
+
+#include <Safir/Dob/Typesystem/Internal/InternalUtils.h>
+#include <climits>
+#include <cerrno>
+#include <cstring>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Safir
+{
+namespace Dob
+{
+namespace Internal
+{
+namespace
+{
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(int) && ATOMIC_INT_LOCK_FREE == 2,
+                  "The futex word has to be a plain lock free 32 bit integer");
+
+    //The futexes are in shared memory and used by several processes, so they must not be FUTEX_PRIVATE.
+    int Futex(std::atomic<std::uint32_t>& word, const int op, const std::uint32_t value)
+    {
+        return static_cast<int>(syscall(SYS_futex, static_cast<void*>(&word), op, value, NULL, NULL, 0));
+    }
+}
+
+    FutexSignal::FutexSignal()
+        : m_state(Idle)
+    {
+
+    }
+
+    void FutexSignal::Post()
+    {
+        if (m_state.exchange(Posted) == Waiting)
+        {
+            //wake everyone, a waiter that does not get the Posted state goes back to sleep
+            Futex(m_state, FUTEX_WAKE, INT_MAX);
+        }
+    }
+
+    void FutexSignal::Wait()
+    {
+        for (;;)
+        {
+            std::uint32_t state = Posted;
+            if (m_state.compare_exchange_strong(state, Idle))
+            {
+                return;
+            }
+
+            //announce that we are going to sleep, unless a Post got in between
+            if (state == Idle && !m_state.compare_exchange_strong(state, Waiting))
+            {
+                continue;
+            }
+
+            //the kernel only puts us to sleep if the state is still Waiting
+            if (Futex(m_state, FUTEX_WAIT, Waiting) != 0)
+            {
+                ENSURE(errno == EAGAIN || errno == EINTR,
+                       << "FutexSignal::Wait: futex wait failed: " << strerror(errno));
+            }
+        }
+    }
+}
+}
+}
+
+#endif
@@ -30,6 +30,7 @@
 #include <Safir/Dob/Internal/ServiceTypes.h>
 #include <Safir/Dob/Internal/InjectionKindTable.h>
 #include <Safir/Dob/Internal/EntityTypes.h>
+#include <Safir/Dob/Internal/LockStatistics.h>
 #include <Safir/Utilities/Internal/LowLevelLogger.h>
 #include <thread>
 
@@ -43,6 +44,7 @@ namespace Internal
 void InitializeDoseInternalFromDoseMain(const int64_t nodeId)
 {
     lllog(1) << "Initializing dose_internal from dose_main" << std::endl;
+    LockStatistics::Initialize();
     Connections::Initialize(true,nodeId);
     ContextSharedTable::Initialize();
     LowMemoryOperationsTable::Initialize();
@@ -80,6 +82,7 @@ void InitializeDoseInternalFromApp()
     sem->post();
 
     lllog(1) << "Connecting to dose_internal from app" << std::endl;
+    LockStatistics::Initialize();
     Connections::Initialize(false,0);
     ContextSharedTable::Initialize();
     LowMemoryOperationsTable::Initialize();
@@ -0,0 +1,96 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+#include <Safir/Dob/Internal/LockStatistics.h>
+#include <Safir/Dob/Typesystem/Internal/InternalUtils.h>
+
+namespace Safir
+{
+namespace Dob
+{
+namespace Internal
+{
+    LockStatistics* LockStatistics::m_instance = NULL;
+
+    LockStatistics& LockStatistics::Instance()
+    {
+        ENSURE(m_instance != NULL, << "LockStatistics::Instance was called before Initialize!!!");
+        return *m_instance;
+    }
+
+    void LockStatistics::Initialize()
+    {
+        m_instance = GetSharedMemory().find_or_construct<LockStatistics>("LOCK_STATISTICS")(private_constructor_t());
+    }
+
+    LockStatistics::LockStatistics(private_constructor_t)
+        : m_enabled(false)
+    {
+        Reset();
+    }
+
+    void LockStatistics::Reset()
+    {
+        for (auto& counters : m_counters)
+        {
+            counters.acquisitions = 0;
+            counters.contendedAcquisitions = 0;
+            counters.totalWaitTime = 0;
+            counters.totalHoldTime = 0;
+            for (int i = 0; i < NumBuckets; ++i)
+            {
+                counters.waitHistogram[i] = 0;
+                counters.holdHistogram[i] = 0;
+            }
+            counters.level = 0;
+        }
+    }
+
+    const char* LockStatistics::GetName(const LockKind kind)
+    {
+        switch (kind)
+        {
+        case LockKind::Other:                  return "Other";
+        case LockKind::EntityType:             return "EntityType";
+        case LockKind::EntityInstance:         return "EntityInstance";
+        case LockKind::ServiceType:            return "ServiceType";
+        case LockKind::MessageType:            return "MessageType";
+        case LockKind::ConnectionsTable:       return "ConnectionsTable";
+        case LockKind::Connect:                return "Connect";
+        case LockKind::Connection:             return "Connection";
+        case LockKind::StateContainer:         return "StateContainer";
+        case LockKind::StateContainerMetaSub:  return "StateContainerMetaSub";
+        case LockKind::State:                  return "State";
+        case LockKind::StateHolder:            return "StateHolder";
+        case LockKind::UpgradeablePtr:         return "UpgradeablePtr";
+        case LockKind::ConsumerQueueContainer: return "ConsumerQueueContainer";
+        case LockKind::MessageQueue:           return "MessageQueue";
+        case LockKind::RequestInQueue:         return "RequestInQueue";
+        case LockKind::RequestOutQueue:        return "RequestOutQueue";
+        case LockKind::SubscriptionQueue:      return "SubscriptionQueue";
+        case LockKind::Signals:                return "Signals";
+        case LockKind::NumKinds:               break;
+        }
+        return "Unknown";
+    }
+}
+}
+}
@@ -25,6 +25,9 @@
 #include <Safir/Dob/Internal/MessageQueue.h>
 #include <Safir/Dob/Internal/StateDeleter.h>
 #include <Safir/Dob/Internal/ScopeExit.h>
+#include <Safir/Dob/QueueParameters.h>
+#include <new>
+#include <vector>
 
 namespace Safir
 {
@@ -33,20 +36,56 @@ namespace Dob
 namespace Internal
 {
     MessageQueue::MessageQueue(const size_t capacity):
+        MessageQueue(capacity, Dob::QueueParameters::LockFreeMessageQueues())
+    {
+
+    }
+
+    MessageQueue::MessageQueue(const size_t capacity, const bool lockFree):
         m_capacity(static_cast<std::uint32_t>(capacity)),
         m_size(0),
+        m_tail(0),
+        m_head(0),
         m_noPushed(0),
         m_noOverflows(0),
         m_noDispatchedMsg(0),
         m_simulateFull(false)
     {
+        static_assert(sizeof(Cell) == CacheLineSize, "MessageQueue::Cell is expected to fill a cache line");
 
+        if (lockFree && m_capacity > 0)
+        {
+            //construct<Cell>[] only aligns to 8 bytes, so the cells are constructed in memory that is aligned to
+            //a cache line to make every cell fill exactly one line
+            m_cells = static_cast<Cell*>(GetSharedMemory().allocate_aligned(sizeof(Cell) * m_capacity, CacheLineSize));
+            for (size_t i = 0; i < m_capacity; ++i)
+            {
+                Cell* const cell = new (&m_cells[static_cast<std::ptrdiff_t>(i)]) Cell();
+                cell->sequence.store(i, std::memory_order_relaxed);
+            }
+        }
     }
 
+    MessageQueue::~MessageQueue()
+    {
+        if (m_cells)
+        {
+            for (size_t i = 0; i < m_capacity; ++i)
+            {
+                m_cells[static_cast<std::ptrdiff_t>(i)].~Cell();
+            }
+            GetSharedMemory().deallocate(m_cells.get());
+        }
+    }
 
     //Returns false if queue is full
     bool MessageQueue::push(const DistributionData & msg)
     {
+        if (m_cells)
+        {
+            return PushLockFree(msg);
+        }
+
         ScopedMessageQueueLock lck(m_lock);
         if ((m_size < m_capacity) && m_simulateFull == 0) //not full
         {
@@ -62,6 +101,46 @@ namespace Internal
         }
     }
 
+    bool MessageQueue::PushLockFree(const DistributionData & msg)
+    {
+        if (m_simulateFull != 0)
+        {
+            ++m_noOverflows;
+            return false;
+        }
+
+        //Claim a position by moving the tail past it, which only succeeds if the cell at that
+        //position has been released by the consumer. Then publish the message in the cell.
+        std::uint64_t position = m_tail.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell& cell = GetCell(position);
+            const std::uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const std::int64_t diff = static_cast<std::int64_t>(sequence - position);
+            if (diff == 0)
+            {
+                if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.msg = msg;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    ++m_noPushed;
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                //the cell still holds a message from the previous lap, the queue is full
+                ++m_noOverflows;
+                return false;
+            }
+            else
+            {
+                //another producer got this position
+                position = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
     void MessageQueue::FinishDispatch(QueueData& queue, const size_t& numDispatched, bool& isNoLongerFull)
     {
         ScopedMessageQueueLock lck(m_lock);
@@ -84,6 +163,11 @@ namespace Internal
     size_t MessageQueue::Dispatch(const DispatchFunc & dispatchFunc,
                                   const ActionFunc & postFullAction)
     {
+        if (m_cells)
+        {
+            return DispatchLockFree(dispatchFunc, postFullAction);
+        }
+
         //This is set to true by the guard if the queue has gone from a full to a not-full state.
         bool isNoLongerFull = false;
         size_t numDispatched = 0;
@@ -147,6 +231,96 @@ namespace Internal
         }
         return numDispatched;
     }
+
+    size_t MessageQueue::DispatchLockFree(const DispatchFunc & dispatchFunc,
+                                          const ActionFunc & postFullAction)
+    {
+        //Only the owner of the queue dispatches it, so the head is only changed here.
+        const std::uint64_t head = m_head.load(std::memory_order_relaxed);
+
+        //Dispatch the messages that have been published when we start, messages pushed while
+        //dispatching are left for the next dispatch just as with the list.
+        std::uint64_t end = head;
+        while (end - head < m_capacity && GetCell(end).sequence.load(std::memory_order_acquire) == end + 1)
+        {
+            ++end;
+        }
+
+        if (end == head)
+        {
+            return 0;
+        }
+
+        //This is set to true by the guard if the queue has gone from a full to a not-full state.
+        bool isNoLongerFull = false;
+        size_t numDispatched = 0;
+
+        {
+            std::uint64_t processedEnd = head;
+            std::vector<std::uint64_t> kept; //positions of messages that are not to be removed
+
+            //Algorithm: The kept messages are moved to the end of the processed range, keeping their
+            //order, so that they are still first in the queue. The cells before them are released to the producers.
+            //This is done when the scope exits normally or if exitDispatch is used or there is an exception.
+            ScopeExit releaseGuard([this, head, &processedEnd, &kept, &numDispatched, &isNoLongerFull]
+            {
+                std::uint64_t newHead = processedEnd;
+                for (auto it = kept.rbegin(); it != kept.rend(); ++it)
+                {
+                    --newHead;
+                    if (newHead != *it)
+                    {
+                        GetCell(newHead).msg = GetCell(*it).msg;
+                    }
+                }
+
+                numDispatched = static_cast<size_t>(newHead - head);
+                if (numDispatched == 0)
+                {
+                    return;
+                }
+
+                isNoLongerFull = m_tail.load(std::memory_order_relaxed) - head >= m_capacity;
+
+                for (std::uint64_t position = head; position < newHead; ++position)
+                {
+                    Cell& cell = GetCell(position);
+                    cell.msg = DistributionData(no_state_tag);
+                    cell.sequence.store(position + m_capacity, std::memory_order_release);
+                }
+                m_head.store(newHead, std::memory_order_relaxed);
+                m_noDispatchedMsg += static_cast<Typesystem::Int32>(numDispatched);
+            });
+
+            bool exitDispatch;
+            bool dontRemove;
+
+            for (std::uint64_t position = head; position < end; ++position)
+            {
+                dispatchFunc(GetCell(position).msg, exitDispatch, dontRemove);
+
+                if (dontRemove)
+                {
+                    kept.push_back(position);
+                }
+                processedEnd = position + 1;
+
+                if (exitDispatch)
+                {
+                    break;
+                }
+            }
+
+            //guard gets executed here
+        }
+
+        //Execute the postaction if the queue was full.
+        if (isNoLongerFull && postFullAction != NULL)
+        {
+            postFullAction();
+        }
+        return numDispatched;
+    }
 }
 }
 }
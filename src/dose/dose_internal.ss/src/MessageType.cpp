@@ -80,6 +80,8 @@ namespace Internal
         {
             subIt->second.subscriptionState.Subscribe(channelId.GetRawValue());
         }
+
+        UpdateSubscribers();
     }
 
     void MessageType::Unsubscribe(const ConnectionPtr&              connection,
@@ -111,12 +113,15 @@ namespace Internal
             // its subscription
             m_subscriptions.erase(subIt);
         }
+
+        UpdateSubscribers();
     }
 
     void MessageType::UnsubscribeAll(const ConnectionPtr& connection)
     {
         ScopedMessageTypeLock lck(m_lock);
 
+        bool removed = false;
         for (ConsumerSubscriptions::iterator it = m_subscriptions.begin();
             it != m_subscriptions.end();)
         {
@@ -124,35 +129,64 @@ namespace Internal
             {
                 it->second.subscriptionState.UnsubscribeAll();
                 m_subscriptions.erase(it++);
+                removed = true;
             }
             else
             {
                 ++it;
             }
         }
+
+        if (removed)
+        {
+            UpdateSubscribers();
+        }
     }
 
-    void MessageType::DistributeMsg(const DistributionData& msg)
+    void MessageType::DistributeMsg(const DistributionData& msg, PendingSignalIns* pendingSignalIns)
     {
-        ScopedMessageTypeLock lck(m_lock);
+        // Only hold the lock while picking up the current subscribers, so that neither
+        // (un)subscribers nor other distributors of this type have to wait for the pushes
+        // and signals below.
+        SubscribersPtr subscribers;
+        {
+            ScopedMessageTypeLock lck(m_lock);
+            subscribers = m_subscribers;
+        }
 
-        for (ConsumerSubscriptions::iterator subIt = m_subscriptions.begin(); subIt != m_subscriptions.end(); ++subIt)
+        if (!subscribers)
         {
-            if ((msg.GetSenderId().m_contextId == subIt->first.connection->Id().m_contextId ||
-                ContextSharedTable::Instance().IsContextShared(msg.GetTypeId())) &&                
-                subIt->second.subscriptionState.IsSubscribed(msg.GetChannelId().GetRawValue()))
+            return;
+        }
+
+        const bool contextShared = ContextSharedTable::Instance().IsContextShared(msg.GetTypeId());
+
+        for (Subscribers::const_iterator subIt = subscribers->begin(); subIt != subscribers->end(); ++subIt)
+        {
+            if ((contextShared || msg.GetSenderId().m_contextId == subIt->connection->Id().m_contextId) &&
+                subIt->subscriptionState.IsSubscribed(msg.GetChannelId().GetRawValue()))
             {
                 /*
                 // Put the message in the in-queue ...
-                if (subIt->second.consumerInQueue->push(msg))
+                if (subIt->consumerInQueue->push(msg))
                 {
                     // ... and kick the application if it didn't overflow
-                    subIt->first.connection->SignalIn();
+                    subIt->connection->SignalIn();
                 }
                 */
                 //An attempt at workaround for #696, we kick even if there is an overflow.
-                subIt->second.consumerInQueue->push(msg);
-                subIt->first.connection->SignalIn();
+                const bool pushed = subIt->consumerInQueue->push(msg);
+
+                //A subscriber whose queue overflowed or just became full is kicked right away, so that it starts
+                //dispatching before the rest of a batch overflows its queue. The others can wait for the caller.
+                if (pendingSignalIns != nullptr && pushed && !subIt->consumerInQueue->full())
+                {
+                    pendingSignalIns->insert(std::make_pair(&*subIt->connection, subIt->connection));
+                }
+                else
+                {
+                    subIt->connection->SignalIn();
+                }
             }
         }
     }
@@ -167,6 +201,26 @@ namespace Internal
         return m_subscriptions.find(key) != m_subscriptions.end();
     }
 
+    void MessageType::UpdateSubscribers()
+    {
+        if (m_subscriptions.empty())
+        {
+            m_subscribers.reset();
+            return;
+        }
+
+        SubscribersPtr subscribers(GetSharedMemory().construct<Subscribers>
+                                   (boost::interprocess::anonymous_instance)());
+
+        subscribers->reserve(m_subscriptions.size());
+        for (ConsumerSubscriptions::const_iterator it = m_subscriptions.begin(); it != m_subscriptions.end(); ++it)
+        {
+            subscribers->push_back(Subscriber(it->first.connection, it->second));
+        }
+
+        m_subscribers = subscribers;
+    }
+
 }
 }
 }
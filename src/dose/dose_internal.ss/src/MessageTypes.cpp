@@ -133,9 +133,9 @@ namespace Internal
             GetType(typeId).UnsubscribeAll(connection);
     }
 
-    void MessageTypes::DistributeMsg(const DistributionData& msg)
+    void MessageTypes::DistributeMsg(const DistributionData& msg, PendingSignalIns* pendingSignalIns)
     {
-        GetType(msg.GetTypeId()).DistributeMsg(msg);
+        GetType(msg.GetTypeId()).DistributeMsg(msg, pendingSignalIns);
     }
 
     bool MessageTypes::HasSubscription(const ConnectionPtr&             connection,
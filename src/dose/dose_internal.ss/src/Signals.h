@@ -42,6 +42,8 @@ namespace Internal
     /**
      * A singleton for caching signals.
      * Note that this class does NOT reside in shared memory!
+     * On Linux the connections use FutexSignals in shared memory instead, see Connection::SignalIn
+     * and Connections::SignalDoseMain.
      */
     class Signals:
         private boost::noncopyable
@@ -111,7 +113,8 @@ namespace Internal
 
             typedef Safir::Dob::Internal::LeveledLock<boost::shared_mutex,
                                                       SIGNALS_LOCK_LEVEL,
-                                                      NO_MASTER_LEVEL_REQUIRED> SignalsLock;
+                                                      NO_MASTER_LEVEL_REQUIRED,
+                                                      LockKind::Signals> SignalsLock;
             SignalsLock m_lock;
         };
 
@@ -0,0 +1,245 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+#include <Safir/Dob/Internal/SlabAllocator.h>
+#include <Safir/Utilities/Internal/LowLevelLogger.h>
+#include <algorithm>
+#include <mutex>
+
+namespace Safir
+{
+namespace Dob
+{
+namespace Internal
+{
+namespace
+{
+    std::once_flag instanceOnceFlag;
+}
+
+    SlabAllocator* SlabAllocator::m_instance = NULL;
+
+    SlabAllocator& SlabAllocator::Instance()
+    {
+        //DistributionData is used before dose_internal is initialized, so the allocator is created on first use
+        std::call_once(instanceOnceFlag, []
+        {
+            m_instance = GetSharedMemory().find_or_construct<SlabAllocator>("SLAB_ALLOCATOR")(private_constructor_t());
+        });
+        return *m_instance;
+    }
+
+    SlabAllocator::SlabAllocator(private_constructor_t)
+        : m_maxSlabsPerSizeClass(std::max<uint64_t>(1, GetSharedMemory().get_size() / MaxSlabShare / NumSizeClasses / SlabSize))
+    {
+        for (auto& sizeClass : m_sizeClasses)
+        {
+            sizeClass.head = 0;
+            sizeClass.slabs = 0;
+            sizeClass.reservedBlocks = 0;
+            sizeClass.usedBlocks = 0;
+            sizeClass.requestedBytes = 0;
+        }
+        m_largeAllocations = 0;
+        m_largeBytes = 0;
+    }
+
+    void* SlabAllocator::Allocate(const size_t size)
+    {
+        const size_t blockSize = size + sizeof(BlockHeader);
+        uint32_t sizeClass = 0;
+        while (sizeClass < NumSizeClasses && BlockSize(sizeClass) < blockSize)
+        {
+            ++sizeClass;
+        }
+
+        char* block = NULL;
+        if (sizeClass < NumSizeClasses)
+        {
+            block = Pop(m_sizeClasses[sizeClass]);
+            if (block == NULL)
+            {
+                block = NewSlab(sizeClass);
+            }
+        }
+
+        if (block == NULL)
+        {
+            //too big for the slabs, or the size class may not take another slab
+            block = static_cast<char*>(GetSharedMemory().allocate(blockSize));
+            sizeClass = LargeSizeClass;
+            ++m_largeAllocations;
+            m_largeBytes += blockSize;
+        }
+        else
+        {
+            ++m_sizeClasses[sizeClass].usedBlocks;
+            m_sizeClasses[sizeClass].requestedBytes += size;
+        }
+
+        BlockHeader* header = static_cast<BlockHeader*>(static_cast<void*>(block));
+        header->sizeClass = sizeClass;
+        header->size = static_cast<uint32_t>(blockSize);
+        return block + sizeof(BlockHeader);
+    }
+
+    void SlabAllocator::Deallocate(void* p)
+    {
+        char* block = static_cast<char*>(p) - sizeof(BlockHeader);
+        const BlockHeader* header = static_cast<const BlockHeader*>(static_cast<const void*>(block));
+
+        if (header->sizeClass == LargeSizeClass)
+        {
+            --m_largeAllocations;
+            m_largeBytes -= header->size;
+            GetSharedMemory().deallocate(block);
+            return;
+        }
+
+        SizeClass& sizeClass = m_sizeClasses[header->sizeClass];
+        --sizeClass.usedBlocks;
+        sizeClass.requestedBytes -= header->size - sizeof(BlockHeader);
+        Push(sizeClass, block, block);
+    }
+
+    SlabAllocator::Statistics SlabAllocator::GetStatistics() const
+    {
+        Statistics statistics;
+        for (uint32_t i = 0; i < NumSizeClasses; ++i)
+        {
+            const SizeClass& sizeClass = m_sizeClasses[i];
+            SizeClassStatistics s;
+            s.blockSize = BlockSize(i);
+            s.reservedBlocks = static_cast<size_t>(sizeClass.reservedBlocks);
+            s.usedBlocks = static_cast<size_t>(sizeClass.usedBlocks);
+            statistics.sizeClasses.push_back(s);
+
+            statistics.slabBytes += s.reservedBlocks * s.blockSize;
+            statistics.usedBlockBytes += s.usedBlocks * s.blockSize;
+            statistics.requestedBytes += static_cast<size_t>(sizeClass.requestedBytes);
+        }
+        statistics.cachedFreeBytes = statistics.slabBytes - statistics.usedBlockBytes;
+        statistics.largeAllocations = static_cast<size_t>(m_largeAllocations);
+        statistics.largeBytes = static_cast<size_t>(m_largeBytes);
+        return statistics;
+    }
+
+    char* SlabAllocator::Base() const
+    {
+        //the segment is mapped at different addresses in different processes, so the free lists hold offsets
+        return static_cast<char*>(GetSharedMemory().get_address());
+    }
+
+    uint32_t SlabAllocator::ToOffset(const char* block) const
+    {
+        return static_cast<uint32_t>((block - Base()) / Granularity);
+    }
+
+    char* SlabAllocator::FromOffset(const uint32_t offset) const
+    {
+        return offset == 0 ? NULL : Base() + static_cast<size_t>(offset) * Granularity;
+    }
+
+    std::atomic<uint32_t>& SlabAllocator::Next(char* block) const
+    {
+        //a free block holds the offset of the next free block where the user data would be
+        return *static_cast<std::atomic<uint32_t>*>(static_cast<void*>(block + sizeof(BlockHeader)));
+    }
+
+    char* SlabAllocator::Pop(SizeClass& sizeClass)
+    {
+        uint64_t head = sizeClass.head.load();
+        for (;;)
+        {
+            char* const block = FromOffset(static_cast<uint32_t>(head));
+            if (block == NULL)
+            {
+                return NULL;
+            }
+
+            //The block may be popped and reused by someone else before the exchange below, in which case
+            //we read garbage here. Slabs are never unmapped, so that is harmless, and the tag that is
+            //incremented on every change of the head makes the exchange fail.
+            const uint64_t next = Next(block).load(std::memory_order_relaxed);
+            const uint64_t newHead = ((head >> 32) + 1) << 32 | next;
+            if (sizeClass.head.compare_exchange_weak(head, newHead))
+            {
+                return block;
+            }
+        }
+    }
+
+    void SlabAllocator::Push(SizeClass& sizeClass, char* first, char* last)
+    {
+        const uint64_t firstOffset = ToOffset(first);
+        uint64_t head = sizeClass.head.load();
+        for (;;)
+        {
+            Next(last).store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            const uint64_t newHead = ((head >> 32) + 1) << 32 | firstOffset;
+            if (sizeClass.head.compare_exchange_weak(head, newHead))
+            {
+                return;
+            }
+        }
+    }
+
+    char* SlabAllocator::NewSlab(const uint32_t sizeClass)
+    {
+        const size_t blockSize = BlockSize(sizeClass);
+        const size_t numBlocks = SlabSize / blockSize;
+
+        //the free blocks of a slab can only be used by this size class, so it may only keep a limited number of slabs
+        if (++m_sizeClasses[sizeClass].slabs > m_maxSlabsPerSizeClass)
+        {
+            --m_sizeClasses[sizeClass].slabs;
+            return NULL;
+        }
+
+        char* const slab = static_cast<char*>(GetSharedMemory().allocate(SlabSize, std::nothrow));
+        if (slab == NULL)
+        {
+            lllog(4) << "SlabAllocator: No room for a new slab of " << blockSize << " byte blocks" << std::endl;
+            --m_sizeClasses[sizeClass].slabs;
+            return NULL;
+        }
+
+        if (static_cast<size_t>(slab + SlabSize - Base()) / Granularity > 0xffffffffu)
+        {
+            //beyond what the free list offsets can address, only happens with a shared memory larger than 32 GB
+            GetSharedMemory().deallocate(slab);
+            --m_sizeClasses[sizeClass].slabs;
+            return NULL;
+        }
+
+        //the first block goes to the caller and the rest are linked together and put in the free list
+        for (size_t i = 1; i < numBlocks - 1; ++i)
+        {
+            char* const block = slab + i * blockSize;
+            Next(block).store(ToOffset(block + blockSize), std::memory_order_relaxed);
+        }
+        m_sizeClasses[sizeClass].reservedBlocks += numBlocks;
+        Push(m_sizeClasses[sizeClass], slab + blockSize, slab + (numBlocks - 1) * blockSize);
+        return slab;
+    }
+}
+}
+}
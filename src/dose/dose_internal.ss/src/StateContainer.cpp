@@ -37,8 +37,9 @@ namespace Dob
 {
 namespace Internal
 {
-    StateContainer::StateContainer(const Typesystem::TypeId typeId)
-        : m_typeId(typeId)
+    StateContainer::StateContainer(const Typesystem::TypeId typeId, const bool hashedLookup)
+        : m_typeId(typeId),
+          m_states(hashedLookup)
     {
     }
 
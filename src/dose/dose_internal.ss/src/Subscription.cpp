@@ -32,6 +32,12 @@ namespace Dob
 {
 namespace Internal
 {
+    namespace
+    {
+        // The signals that are deferred by the innermost DeferredSignalIns of this thread, if any.
+        thread_local PendingSignalIns* deferredSignalIns = nullptr;
+    }
+
     void AddDirty(const UpgradeableSubscriptionPtr::SharedPtr& subPtr)
     {
         const ConnectionPtr& connection = subPtr->GetSubscriptionId().connectionConsumer.connection;
@@ -39,7 +45,31 @@ namespace Internal
         connection->GetDirtySubscriptionQueue().push(subPtr);
 
         // Kick the subscriber application
-        connection->SignalIn();
+        if (deferredSignalIns != nullptr)
+        {
+            deferredSignalIns->insert(std::make_pair(&*connection, connection));
+        }
+        else
+        {
+            connection->SignalIn();
+        }
+    }
+
+    DeferredSignalIns::DeferredSignalIns()
+        : m_outer(deferredSignalIns)
+    {
+        deferredSignalIns = &m_pendingSignalIns;
+    }
+
+    DeferredSignalIns::~DeferredSignalIns()
+    {
+        deferredSignalIns = m_outer;
+
+        for (PendingSignalIns::const_iterator it = m_pendingSignalIns.begin();
+             it != m_pendingSignalIns.end(); ++it)
+        {
+            it->second->SignalIn();
+        }
     }
 
     Subscription::Subscription(const SubscriptionId&          subsciptionId,
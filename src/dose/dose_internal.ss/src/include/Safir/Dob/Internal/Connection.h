@@ -44,6 +44,7 @@
 #include <Safir/Dob/Internal/ShmWrappers.h>
 #include <Safir/Dob/Internal/LeveledLock.h>
 #include <Safir/Dob/Internal/SmartSyncState.h>
+#include <Safir/Dob/Internal/FutexSignal.h>
 
 namespace Safir
 {
@@ -51,7 +52,6 @@ namespace Dob
 {
 namespace Internal
 {
-    typedef boost::interprocess::offset_ptr<Safir::Utilities::Internal::AtomicUint32> SignalPtr;
     typedef std::pair<Dob::Typesystem::TypeId, Dob::Typesystem::HandlerId> TypeHandlerPair;
 
     class DOSE_INTERNAL_API Connection:
@@ -201,7 +201,9 @@ namespace Internal
                                         const Dob::Typesystem::HandlerId & handlerId);
         /** @} */
 
-        void SetOutSignal(const SignalPtr & signal) {m_outSignal = signal;}
+        //The slot of the out signal of this connection in Connections, or -1 if it has none.
+        void SetOutSignalSlot(const int slot) {m_outSignalSlot = slot;}
+        int OutSignalSlot() const {return m_outSignalSlot;}
 
         //Signal the event that the application has done something.
         void SignalOut() const;
@@ -209,6 +211,11 @@ namespace Internal
         //Signal in-event
         void SignalIn() const;
 
+#ifdef DOSE_FUTEX_SIGNALS
+        //Wait for the in-event. Only for the dispatch thread of the application that owns the connection.
+        void WaitForSignalIn() const {m_inSignal.Wait();}
+#endif
+
         void SendStopOrder() {m_stopOrderPending = 1; SignalIn();}
         bool StopOrderPending() const {return m_stopOrderPending != 0;}
         void SetStopOrderHandled() {m_stopOrderPending = 0;}
@@ -241,10 +248,9 @@ namespace Internal
         typedef Containers<size_t>::vector QueueCapacities;
         const QueueCapacities m_queueCapacities;
 
-        //set to true if dose_main is to be told of queue changes.
-        //Also the dose_main event must be set for it to wake up.
-        //Don't ever set this directly, use the SignalDoseMain function in Controller.
-        SignalPtr m_outSignal;
+        //The slot in Connections that is set when dose_main is to be told of queue changes.
+        //Don't ever set the slot directly, use SignalOut.
+        int m_outSignalSlot;
 
         typedef std::pair<Typesystem::TypeId, ShmHandlerId> TypeHandlerKey;
         struct TypeHandlerData
@@ -289,6 +295,10 @@ namespace Internal
         Safir::Utilities::Internal::AtomicUint32 m_nodeDown;
         Safir::Utilities::Internal::AtomicUint32 m_detached;
 
+#ifdef DOSE_FUTEX_SIGNALS
+        mutable FutexSignal m_inSignal;
+#endif
+
         const bool m_isLocal;
 
         //Locking Policy:
@@ -299,7 +309,8 @@ namespace Internal
         //programming errors.
         typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_mutex,
                                                   CONNECTION_LOCK_LEVEL,
-                                                  NO_MASTER_LEVEL_REQUIRED> ConnectionLock;
+                                                  NO_MASTER_LEVEL_REQUIRED,
+                                                  LockKind::Connection> ConnectionLock;
         mutable ConnectionLock m_lock;
         typedef boost::interprocess::scoped_lock<ConnectionLock> ScopedConnectionLock;
 
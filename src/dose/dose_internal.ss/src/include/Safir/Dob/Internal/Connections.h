@@ -30,6 +30,8 @@
 #include <Safir/Dob/Internal/SharedMemoryObject.h>
 #include <Safir/Dob/Internal/Connection.h>
 #include <Safir/Dob/Internal/Semaphore.h>
+#include <Safir/Dob/Internal/FutexSignal.h>
+#include <Safir/Dob/Internal/SlotSignals.h>
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
 #include <Safir/Dob/Internal/ConnectRequest.h>
 #include <Safir/Dob/Internal/LeveledLock.h>
@@ -88,6 +90,18 @@ namespace Internal
          */
         void WaitForDoseMainSignal(bool & connect, bool & connectionOut);
 
+        /**
+         * Wake up dose_main from WaitForDoseMainSignal.
+         * The flags that say why have to be set before this is called.
+         */
+        void SignalDoseMain() const;
+
+        /**
+         * Tell dose_main that the connection in the given slot has done something.
+         * Used by Connection::SignalOut.
+         */
+        void SignalConnectionOut(const int slot);
+
         /** For applications to connect to the DOB.
          * If the connectionName contains the string ";dose_main;" (ie the connectionNameCommonPart is "dose_main")
          *        it means that the connection is being made from within dose_main itself
@@ -211,36 +225,41 @@ namespace Internal
         typedef PairContainers<ConnectionId, ConnectionPtr>::map ConnectionTable;
         ConnectionTable m_connections;
 
-        //these two vectors handle handle out-signals from the connections.
-        //The positions in the vectors correspond to each other (i.e. the signal at position 20 in
-        //m_connectionOutSignals represent the out signal of the app in position 20 in m_connectionOutIds).
-        //They have a static size, and a connId of -1,-1 (default constructed ConnectionId) means that that "slot" is not occupied
-        //THIS DATA STRUCTURE CAN NOT BE RESIZED!! EACH CONNECTION HOLDS A POINTER TO IT'S SIGNAL!
-        //RESIZING/MOVING THE STRUCTURE WILL INVALIDATE THE POINTERS!
-
-        boost::interprocess::offset_ptr<Safir::Utilities::Internal::AtomicUint32> m_connectionOutSignals;
-        Containers<ConnectionId>::vector m_connectionOutIds;
-        size_t m_lastUsedSlot; //slot that marks the end of the region of used slots. optimization
+        //These handle the out-signals from the connections. Each local connection gets a slot, and
+        //sets the signal for its slot in m_connectionOutSignals when it has done something.
+        //m_connectionOutSlots holds the connection of each slot (null if the slot is free) and
+        //m_freeOutSlots the free slots, so that both finding the signalled connections and
+        //finding a free slot is independent of the number of connections.
+        SlotSignals m_connectionOutSignals;
+        Containers<ConnectionPtr>::vector m_connectionOutSlots;
+        Containers<int>::vector m_freeOutSlots;
 
 
         //Signal for when an application is trying to connect
         Safir::Utilities::Internal::AtomicUint32 m_connectSignal;
 
+#ifdef DOSE_FUTEX_SIGNALS
+        //What dose_main waits for in WaitForDoseMainSignal
+        mutable FutexSignal m_doseMainSignal;
+#endif
+
         Semaphore m_connectSem;
         Semaphore m_connectMinusOneSem;
 
         typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_mutex,
                                                   CONNECT_LOCK_LEVEL,
-                                                  NO_MASTER_LEVEL_REQUIRED> ConnectLock;
+                                                  NO_MASTER_LEVEL_REQUIRED,
+                                                  LockKind::Connect> ConnectLock;
         mutable ConnectLock m_connectLock;
         typedef boost::interprocess::scoped_lock<ConnectLock> ScopedConnectLock;
 
         Semaphore m_connectResponseEvent;
 
-        //lock for m_connections, m_connectionOutIds, and m_connectionOutSignals
+        //lock for m_connections, m_connectionOutSlots, and m_freeOutSlots
         typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_mutex,
                                                   CONNECTIONS_TABLE_LOCK_LEVEL,
-                                                  NO_MASTER_LEVEL_REQUIRED> ConnectionsTableLock;
+                                                  NO_MASTER_LEVEL_REQUIRED,
+                                                  LockKind::ConnectionsTable> ConnectionsTableLock;
         mutable ConnectionsTableLock m_connectionTablesLock;
 
         ConnectRequest m_connectMessage;
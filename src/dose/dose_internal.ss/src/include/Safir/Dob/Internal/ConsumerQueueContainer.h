@@ -245,7 +245,8 @@ namespace Internal
         //programming errors.
         typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_mutex,
                                                   CONSUMER_QUEUE_CONTAINER_LOCK_LEVEL,
-                                                  NO_MASTER_LEVEL_REQUIRED> ContainerLock;
+                                                  NO_MASTER_LEVEL_REQUIRED,
+                                                  LockKind::ConsumerQueueContainer> ContainerLock;
         mutable ContainerLock m_lock;
         typedef boost::interprocess::scoped_lock<ContainerLock> ScopedContainerLock;
 
@@ -31,6 +31,7 @@ void intrusive_ptr_release(const char * p);
 #include <Safir/Dob/Internal/InternalDefs.h>
 #include <Safir/Dob/Internal/InternalExportDefs.h>
 #include <Safir/Dob/Internal/SharedMemoryObject.h>
+#include <Safir/Dob/Internal/SlabAllocator.h>
 #include <Safir/Dob/Internal/InternalFwd.h>
 #include <Safir/Dob/Internal/ConnectionId.h>
 #include <Safir/Utilities/Internal/Atomic.h>
@@ -39,6 +40,7 @@ void intrusive_ptr_release(const char * p);
 #include <Safir/Dob/Typesystem/ChannelId.h>
 #include <Safir/Dob/Typesystem/Internal/BlobOperations.h>
 #include <Safir/Dob/Internal/VersionNumber.h>
+#include <atomic>
 
 //#define REGISTER_TIMES
 
@@ -551,6 +553,37 @@ namespace Internal
 
         /** @} */
 
+        /**
+         * @name Change flags
+         */
+        /** @{ */
+
+        /**
+         * Get the blob of current (if wantCurrent is true) or previous (if it is false) with the
+         * change flags set where the two states differ, which is what the subscribers get in
+         * OnUpdatedEntity. If timestampDiff is true the change flags are set from the timestamps
+         * of the states rather than by comparing the blobs.
+         *
+         * The diff is computed the first time it is asked for and is then cached in shared memory
+         * with the state whose blob it is a copy of, so all subscribers that get the same update,
+         * i.e. diff against the same previous state, share one diff blob rather than each one
+         * parsing and reserializing the blobs. Diffs against other states (e.g. of a subscriber
+         * that has missed some updates) are computed but not cached.
+         *
+         * The returned blob must be released with DropDiffReference.
+         */
+        static const char * GetDiffReference(const DistributionData& previous,
+                                             const DistributionData& current,
+                                             const bool wantCurrent,
+                                             const bool timestampDiff);
+
+        /**
+         * Drop a blob returned by GetDiffReference.
+         */
+        static void DropDiffReference(const char* const diffBlob);
+
+        /** @} */
+
         //--------------------------------
         // DEBUG
         //--------------------------------
@@ -741,6 +774,13 @@ namespace Internal
         //allocate new (unitialized) memory into m_data
         void Allocate(const size_t size);
 
+        //Get the serial number of the data, which is unique among all data in the shared memory
+        //over its whole lifetime, unlike the address. It is used to tell what a cached diff is a diff against.
+        std::uint64_t GetSerial() const;
+
+        //Drop the diff that is cached for data that is being deallocated.
+        static void ReleaseCachedDiff(const char * data);
+
         const std::wstring HeaderImage() const;
         const std::wstring RequestHeaderImage() const;
 
@@ -749,19 +789,39 @@ namespace Internal
          * arrays that are contained by DistributionData.
          * The use_count is an atomic 32 bit integer, so be aware that the alignment
          * of the data is 4.
+         * Before the use_count there are two 64 bit words that belong to the data in this
+         * node only, they are never sent anywhere: the serial number of the data (0 until
+         * someone asks for it, see GetSerial) and the offset from the word itself to the
+         * diff blob that is cached for the data (0 if there is none, see GetDiffReference).
+         * The memory is allocated with the SlabAllocator.
          */
         class IntrusiveOperations
         {
         public:
+            //the size of the words before the data, 8 byte aligned blocks give 4 byte aligned data
+            static const size_t PrefixSize = 2 * sizeof(std::uint64_t) + sizeof(Safir::Utilities::Internal::AtomicUint32);
+
             static inline char * Allocate(const size_t size)
             {
-                char * data = static_cast<char*>(GetSharedMemory().allocate(size + 
-                                                                            sizeof(Safir::Utilities::Internal::AtomicUint32))) +
-                    sizeof(Safir::Utilities::Internal::AtomicUint32);
+                char * data = static_cast<char*>(SlabAllocator::Instance().Allocate(size + PrefixSize)) + PrefixSize;
+                GetSerial(data) = 0;
+                GetCachedDiff(data) = 0;
                 GetCount(data) = 0;
                 return data;
             }
 
+            static inline std::atomic<std::uint64_t>& GetSerial(const char * p)
+            {
+                return *static_cast<std::atomic<std::uint64_t>*>
+                    (static_cast<void *>(const_cast<char*>(p - PrefixSize)));
+            }
+
+            static inline std::atomic<std::int64_t>& GetCachedDiff(const char * p)
+            {
+                return *static_cast<std::atomic<std::int64_t>*>
+                    (static_cast<void *>(const_cast<char*>(p - PrefixSize + sizeof(std::uint64_t))));
+            }
+
             static inline Safir::Utilities::Internal::AtomicUint32& GetCount(const char * p)
             {
                 return *static_cast<Safir::Utilities::Internal::AtomicUint32*>
@@ -778,7 +838,11 @@ namespace Internal
                 //if the old value is 0 the new value is 0 and we can deallocate.
                 if(1 == GetCount(p)--)
                 {
-                    GetSharedMemory().deallocate(const_cast<char*>(p) - sizeof(Safir::Utilities::Internal::AtomicUint32));
+                    if (GetCachedDiff(p) != 0)
+                    {
+                        DistributionData::ReleaseCachedDiff(p);
+                    }
+                    SlabAllocator::Instance().Deallocate(const_cast<char*>(p) - PrefixSize);
                 }
             }
 
@@ -34,6 +34,7 @@
 #include <Safir/Dob/InjectionKind.h>
 #include <Safir/Dob/InstanceIdPolicy.h>
 #include <Safir/Dob/Internal/LeveledLock.h>
+#include <boost/interprocess/sync/sharable_lock.hpp>
 #include <Safir/Dob/Internal/ShmArray.h>
 #include <Safir/Dob/Internal/SmartSyncState.h>
 
@@ -120,6 +121,14 @@ namespace Internal
                        const bool                           considerChangeFlags,
                        const bool                           initialInjection);
 
+        // Merge the changed members of a number of instances into the pool, in order, as if
+        // ConnectionBase::SetChanges was called for each of them, but with the type lock taken once.
+        void SetEntities(const ConnectionPtr&                   connection,
+                         const Dob::Typesystem::HandlerId&      handlerId,
+                         const size_t                           numInstances,
+                         const Dob::Typesystem::InstanceId*     instanceIds,
+                         const char* const *                    blobs);
+
         void DeleteEntity(const ConnectionPtr&                  connection,
                           const Dob::Typesystem::HandlerId&     handlerId,
                           const Dob::Typesystem::InstanceId&    instanceId,
@@ -258,13 +267,42 @@ namespace Internal
         // operations, there is a risk for a deadlock. The reason why we have locks at both type-level and
         // state-level is that we want subscribers to fetch data from single states withot locking
         // the whole type.
-        typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_mutex,
-                                                  TYPE_LOCK_LEVEL, NO_MASTER_LEVEL_REQUIRED> TypeLock;
+        // Operations on a single instance (set, delete, inject, and the corresponding remote operations)
+        // only take EntityState locks before RegistrationState locks, so they hold the TypeLock sharable,
+        // which lets them run in parallel with each other. Operations on the same instance are still
+        // serialized by an InstanceLock, picked from a fixed number of stripes by the instance id.
+        // Registrations, subscriptions and operations that go through all instances hold the TypeLock
+        // exclusively.
+        typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_upgradable_mutex,
+                                                  TYPE_LOCK_LEVEL, NO_MASTER_LEVEL_REQUIRED,
+                                                  LockKind::EntityType> TypeLock;
 
         typedef ShmArray<TypeLock> TypeLockVector;
         TypeLockVector m_typeLocks;
 
         typedef boost::interprocess::scoped_lock<TypeLock> ScopedTypeLock;
+        typedef boost::interprocess::sharable_lock<TypeLock> SharableTypeLock;
+
+        typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_mutex,
+                                                  ENTITY_INSTANCE_LOCK_LEVEL, NO_MASTER_LEVEL_REQUIRED,
+                                                  LockKind::EntityInstance> InstanceLock;
+
+        static const size_t NumInstanceLockStripes = 64;
+
+        struct InstanceLocks
+        {
+            InstanceLock stripes[NumInstanceLockStripes];
+        };
+
+        typedef ShmArray<InstanceLocks> InstanceLocksVector;
+        InstanceLocksVector m_instanceLocks;
+
+        typedef boost::interprocess::scoped_lock<InstanceLock> ScopedInstanceLock;
+
+        InstanceLock& GetInstanceLock(const ContextId context, const Dob::Typesystem::InstanceId& instanceId)
+        {
+            return m_instanceLocks[context].stripes[static_cast<uint64_t>(instanceId.GetRawValue()) % NumInstanceLockStripes];
+        }
 
         void SetEntityInternal(const StateSharedPtr&                statePtr,
                                const ConnectionPtr&                 connection,
@@ -273,6 +311,12 @@ namespace Internal
                                const bool                           considerChangeFlags,
                                const char* const                    blob);
 
+        void SetEntityChangesInternal(const StateSharedPtr&                statePtr,
+                                      const ConnectionPtr&                 connection,
+                                      const Dob::Typesystem::HandlerId&    handlerId,
+                                      const Dob::Typesystem::InstanceId&   instanceId,
+                                      const char* const                    blob);
+
         void DeleteEntityInternal(const StateSharedPtr&                statePtr,
                                   const ConnectionPtr&                 connection,
                                   const Dob::Typesystem::HandlerId&    handlerId,
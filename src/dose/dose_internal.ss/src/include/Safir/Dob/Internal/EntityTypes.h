@@ -174,6 +174,15 @@ namespace Internal
                        const bool                           considerChangeFlags,
                        const bool                           initialInjection);
 
+        // Merge the changed members of a number of instances of one type into the pool, in order,
+        // as if ConnectionBase::SetChanges was called for each of them, but with the type lock taken once.
+        void SetEntities(const ConnectionPtr&                   connection,
+                         const Dob::Typesystem::HandlerId&      handlerId,
+                         const Dob::Typesystem::TypeId          typeId,
+                         const size_t                           numInstances,
+                         const Dob::Typesystem::InstanceId*     instanceIds,
+                         const char* const *                    blobs);
+
         void DeleteEntity(const ConnectionPtr&              connection,
                           const Dob::Typesystem::HandlerId& handlerId,
                           const Dob::Typesystem::EntityId&  entityId,
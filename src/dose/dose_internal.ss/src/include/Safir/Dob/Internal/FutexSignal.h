@@ -0,0 +1,80 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+#pragma once
+
+#if defined(linux) || defined(__linux) || defined(__linux__)
+#  define DOSE_FUTEX_SIGNALS
+#endif
+
+#ifdef DOSE_FUTEX_SIGNALS
+
+#include <Safir/Dob/Internal/InternalExportDefs.h>
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <cstdint>
+
+namespace Safir
+{
+namespace Dob
+{
+namespace Internal
+{
+    /**
+     * A wakeup signal that lives in shared memory and is built on a futex.
+     *
+     * Unlike a (named) semaphore Post does not make a system call unless someone is
+     * actually sleeping in Wait, so signalling an application that is busy dispatching
+     * is just an atomic exchange.
+     *
+     * Posts are not counted: any number of Posts before a Wait makes that Wait return
+     * at once, and only that one. This suits the connection signals, where the one who
+     * waits handles everything that has happened when it wakes up.
+     *
+     * On other platforms than Linux the named semaphores of Signals are used instead.
+     */
+    class DOSE_INTERNAL_API FutexSignal:
+        private boost::noncopyable
+    {
+    public:
+        FutexSignal();
+
+        /** Wake the one waiting in Wait, or make the next Wait return at once. */
+        void Post();
+
+        /** Wait until Post has been called since the last time Wait returned. */
+        void Wait();
+
+    private:
+        enum State
+        {
+            Idle = 0,
+            Posted = 1,
+            Waiting = 2 //someone is, or is about to go, to sleep in the kernel
+        };
+
+        std::atomic<std::uint32_t> m_state;
+    };
+}
+}
+}
+
+#endif
@@ -94,6 +94,7 @@ namespace Internal
     const unsigned short NO_MASTER_LEVEL_REQUIRED = 0;
 
     const unsigned short TYPE_LOCK_LEVEL              = 50;
+    const unsigned short ENTITY_INSTANCE_LOCK_LEVEL   = 45;
     const unsigned short CONNECTIONS_TABLE_LOCK_LEVEL = 40;
 
     const unsigned short STATE_CONTAINER_META_SUB_LOCK_LEVEL = 30;
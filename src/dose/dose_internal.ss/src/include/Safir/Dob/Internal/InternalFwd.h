@@ -29,6 +29,7 @@
 #include <Safir/Dob/Internal/UpgradeablePtr.h>
 #include <Safir/Dob/Internal/SharedLock.h>
 #include <Safir/Dob/Typesystem/HandlerId.h>
+#include <unordered_map>
 
 namespace Safir
 {
@@ -44,6 +45,10 @@ namespace Internal
     typedef SharedMemoryObject::SmartPointers<Connection>::shared_ptr ConnectionPtr;
     typedef SharedMemoryObject::SmartPointers<Connection>::const_shared_ptr ConnectionConstPtr;
     //typedef SharedMemoryObject::SmartPointers<const Connection>::shared_ptr ConnectionConstPtr;
+
+    // Connections that are to be signalled when a batch of messages or entity changes has been
+    // distributed, each of them once. See MessageType::DistributeMsg and DeferredSignalIns.
+    typedef std::unordered_map<const Connection*, ConnectionPtr> PendingSignalIns;
     
     class Instance;
     typedef boost::interprocess::offset_ptr<Instance> InstancePtr;
@@ -26,6 +26,7 @@
 
 #include <Safir/Dob/Typesystem/Internal/InternalUtils.h>
 #include <Safir/Dob/Internal/LeveledLockHelper.h>
+#include <Safir/Dob/Internal/LockStatistics.h>
 #include <boost/interprocess/sync/interprocess_upgradable_mutex.hpp>
 #include <boost/thread/shared_mutex.hpp>
 
@@ -67,13 +68,18 @@ namespace Internal
     // 2. The thread holds a higher level lock.
     //
     // 3. The thread holds a lock at the same level AND the master lock is held.
+    //
+    // The locks can also record contention statistics in LockStatistics, per lock kind. This is
+    // turned on and off at runtime (see LockStatistics) and costs one flag check per lock
+    // operation when it is off.
 
 
-    // Base class that contains the AddLevel and RemoveLevel methods
-    template<unsigned short level, unsigned short masterLevel>
+    // Base class that contains the AddLevel and RemoveLevel methods, and the statistics recording
+    template<unsigned short level, unsigned short masterLevel, LockKind kind>
     class LeveledLockBase
     {
     public:
+        LeveledLockBase(): m_lockedAt(0) {}
 
         inline void AddLevel()
         {
@@ -90,10 +96,54 @@ namespace Internal
 #endif
         }
 
+        // Take the lock with lockFunc. If statistics are enabled tryLockFunc is tried first, to find
+        // out if the lock is contended. For exclusive locks the time the lock is held is measured too.
+        template <class TryLockFunc, class LockFunc>
+        inline void Acquire(const TryLockFunc& tryLockFunc, const LockFunc& lockFunc, const bool exclusive)
+        {
+            if (!LockStatistics::IsEnabled())
+            {
+                lockFunc();
+                return;
+            }
+
+            if (tryLockFunc())
+            {
+                Acquired(false, 0, exclusive);
+            }
+            else
+            {
+                const std::uint64_t start = LockStatistics::Now();
+                lockFunc();
+                Acquired(true, LockStatistics::Now() - start, exclusive);
+            }
+        }
+
+        // Record an acquisition by a successful try_lock.
+        inline void TryAcquired(const bool exclusive)
+        {
+            if (LockStatistics::IsEnabled())
+            {
+                Acquired(false, 0, exclusive);
+            }
+        }
+
+        // Must be called while the lock is still held.
+        inline void Releasing()
+        {
+            if (m_lockedAt != 0)
+            {
+                const std::uint64_t lockedAt = m_lockedAt;
+                m_lockedAt = 0;
+                LockStatistics::RecordHold(kind, LockStatistics::Now() - lockedAt);
+            }
+        }
+
     private:
         inline void Check() const
         {
-            ENSURE(LeveledLockHelper::Instance().GetNumberOfHeldLocks() < 5,
+            // Deepest nesting: type, entity instance, state container, entity state, registration state and a leaf lock.
+            ENSURE(LeveledLockHelper::Instance().GetNumberOfHeldLocks() < 6,
                    << "The number of current held locks exceeds the expected limit. "
                    << "Please change the expected limit if you have made code changes that justify this.");
 
@@ -122,6 +172,17 @@ namespace Internal
             }
         }
 
+        inline void Acquired(const bool contended, const std::uint64_t waitTime, const bool exclusive)
+        {
+            LockStatistics::RecordAcquisition(kind, level, contended, waitTime);
+            if (exclusive)
+            {
+                m_lockedAt = LockStatistics::Now();
+            }
+        }
+
+        //when the lock was taken, if it is held exclusively and statistics were enabled, otherwise 0
+        std::uint64_t m_lockedAt;
     };
 
 
@@ -129,19 +190,21 @@ namespace Internal
      * A template wrapper that add level awareness for any lock that exhibits
      * a lock() and an unlock() method.
      */
-    template <typename Lock, unsigned short level, unsigned short masterLevel>
-    class LeveledLock : private LeveledLockBase<level, masterLevel>
+    template <typename Lock, unsigned short level, unsigned short masterLevel, LockKind kind = LockKind::Other>
+    class LeveledLock : private LeveledLockBase<level, masterLevel, kind>
     {
+        typedef LeveledLockBase<level, masterLevel, kind> Base;
     public:
         inline void lock()
         {
-            LeveledLockBase<level, masterLevel>::AddLevel();
-            m_lock.lock();
+            Base::AddLevel();
+            Base::Acquire([this]{return m_lock.try_lock();}, [this]{m_lock.lock();}, true);
         }
 
         inline void unlock()
         {
-            LeveledLockBase<level, masterLevel>::RemoveLevel();
+            Base::RemoveLevel();
+            Base::Releasing();
             m_lock.unlock();
         }
 
@@ -149,7 +212,8 @@ namespace Internal
         {
             if (m_lock.try_lock())
             {
-                LeveledLockBase<level, masterLevel>::AddLevel();
+                Base::AddLevel();
+                Base::TryAcquired(true);
                 return true;
             }
             else
@@ -166,58 +230,62 @@ namespace Internal
      * A template specialization for boost::interprocess::interprocess_upgradable_mutex.
      * (This type requires some additional operations.)
      */
-    template<unsigned short level, unsigned short masterLevel>
-    class LeveledLock<boost::interprocess::interprocess_upgradable_mutex, level, masterLevel>
-        : private LeveledLockBase<level, masterLevel>
+    template<unsigned short level, unsigned short masterLevel, LockKind kind>
+    class LeveledLock<boost::interprocess::interprocess_upgradable_mutex, level, masterLevel, kind>
+        : private LeveledLockBase<level, masterLevel, kind>
     {
+        typedef LeveledLockBase<level, masterLevel, kind> Base;
     public:
         inline void lock()
         {
-            LeveledLockBase<level, masterLevel>::AddLevel();
-            m_lock.lock();
+            Base::AddLevel();
+            Base::Acquire([this]{return m_lock.try_lock();}, [this]{m_lock.lock();}, true);
         }
 
         inline void unlock()
         {
-            LeveledLockBase<level, masterLevel>::RemoveLevel();
+            Base::RemoveLevel();
+            Base::Releasing();
             m_lock.unlock();
         }
 
         inline void lock_upgradable()
         {
-            LeveledLockBase<level, masterLevel>::AddLevel();
-            m_lock.lock_upgradable();
+            Base::AddLevel();
+            Base::Acquire([this]{return m_lock.try_lock_upgradable();}, [this]{m_lock.lock_upgradable();}, false);
         }
 
         inline void unlock_upgradable()
         {
-            LeveledLockBase<level, masterLevel>::RemoveLevel();
+            Base::RemoveLevel();
             m_lock.unlock_upgradable();
         }
 
         inline void lock_sharable()
         {
-            LeveledLockBase<level, masterLevel>::AddLevel();
-            m_lock.lock_sharable();
+            Base::AddLevel();
+            Base::Acquire([this]{return m_lock.try_lock_sharable();}, [this]{m_lock.lock_sharable();}, false);
         }
 
         inline void unlock_sharable()
         {
-            LeveledLockBase<level, masterLevel>::RemoveLevel();
+            Base::RemoveLevel();
             m_lock.unlock_sharable();
         }
 
         inline void unlock_upgradable_and_lock()
         {
-            // Need no level check for lock promotion.
-            m_lock.unlock_upgradable_and_lock();
+            // Need no level check for lock promotion. The wait for the readers to leave is recorded
+            // like an acquisition, and the exclusive hold is measured from the promotion.
+            Base::Acquire([this]{return m_lock.try_unlock_upgradable_and_lock();}, [this]{m_lock.unlock_upgradable_and_lock();}, true);
         }
 
         inline bool try_lock()
         {
             if (m_lock.try_lock())
             {
-                LeveledLockBase<level, masterLevel>::AddLevel();
+                Base::AddLevel();
+                Base::TryAcquired(true);
                 return true;
             }
             else
@@ -234,57 +302,61 @@ namespace Internal
      * A template specialization for boost::shared_mutex
      * (This type requires some additional operations.)
      */
-    template<unsigned short level, unsigned short masterLevel>
-    class LeveledLock<boost::shared_mutex, level, masterLevel>
-        : private LeveledLockBase<level, masterLevel>
+    template<unsigned short level, unsigned short masterLevel, LockKind kind>
+    class LeveledLock<boost::shared_mutex, level, masterLevel, kind>
+        : private LeveledLockBase<level, masterLevel, kind>
     {
+        typedef LeveledLockBase<level, masterLevel, kind> Base;
     public:
         inline void lock()
         {
-            LeveledLockBase<level, masterLevel>::AddLevel();
-            m_lock.lock();
+            Base::AddLevel();
+            Base::Acquire([this]{return m_lock.try_lock();}, [this]{m_lock.lock();}, true);
         }
 
         inline void unlock()
         {
-            LeveledLockBase<level, masterLevel>::RemoveLevel();
+            Base::RemoveLevel();
+            Base::Releasing();
             m_lock.unlock();
         }
 
         inline void lock_upgrade()
         {
-            LeveledLockBase<level, masterLevel>::AddLevel();
-            m_lock.lock_upgrade();
+            Base::AddLevel();
+            Base::Acquire([this]{return m_lock.try_lock_upgrade();}, [this]{m_lock.lock_upgrade();}, false);
         }
 
         inline void unlock_upgrade()
         {
-            LeveledLockBase<level, masterLevel>::RemoveLevel();
+            Base::RemoveLevel();
             m_lock.unlock_upgrade();
         }
 
         inline void lock_shared()
         {
-            LeveledLockBase<level, masterLevel>::AddLevel();
-            m_lock.lock_shared();
+            Base::AddLevel();
+            Base::Acquire([this]{return m_lock.try_lock_shared();}, [this]{m_lock.lock_shared();}, false);
         }
 
         inline void unlock_shared()
         {
-            LeveledLockBase<level, masterLevel>::RemoveLevel();
+            Base::RemoveLevel();
             m_lock.unlock_shared();
         }
 
         inline void unlock_and_lock_upgrade()
         {
             // Need no level check for lock demotion.
+            Base::Releasing();
             m_lock.unlock_and_lock_upgrade();
         }
 
         inline void unlock_upgrade_and_lock()
         {
-            // Need no level check for lock promotion.
-            m_lock.unlock_upgrade_and_lock();
+            // Need no level check for lock promotion. The wait for the readers to leave is recorded
+            // like an acquisition, and the exclusive hold is measured from the promotion.
+            Base::Acquire([this]{return m_lock.try_unlock_upgrade_and_lock();}, [this]{m_lock.unlock_upgrade_and_lock();}, true);
         }
 
     private:
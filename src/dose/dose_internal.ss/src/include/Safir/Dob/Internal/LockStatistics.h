@@ -0,0 +1,172 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+#pragma once
+
+#include <Safir/Dob/Internal/InternalExportDefs.h>
+#include <Safir/Dob/Internal/SharedMemoryObject.h>
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Safir
+{
+namespace Dob
+{
+namespace Internal
+{
+    /**
+     * The kinds of locks that LockStatistics keeps apart. Several kinds share the same
+     * lock level, so the level alone does not tell which lock it is.
+     */
+    enum class LockKind : unsigned short
+    {
+        Other,
+        EntityType,
+        EntityInstance,
+        ServiceType,
+        MessageType,
+        ConnectionsTable,
+        Connect,
+        Connection,
+        StateContainer,
+        StateContainerMetaSub,
+        State,
+        StateHolder,
+        UpgradeablePtr,
+        ConsumerQueueContainer,
+        MessageQueue,
+        RequestInQueue,
+        RequestOutQueue,
+        SubscriptionQueue,
+        Signals,
+
+        NumKinds
+    };
+
+    /**
+     * Contention statistics for the LeveledLocks, per lock kind, in shared memory.
+     *
+     * Collection is off by default and is turned on and off at runtime with Enable, e.g. by
+     * safir_lock_stats, so it can be used on a running system. When it is off a lock operation
+     * only pays for checking the flag. When it is on every acquisition is counted. An acquisition
+     * is contended when an initial try_lock fails, and then the time spent waiting for the lock
+     * is also measured. For exclusive locks the time that the lock is held is measured as well.
+     * Times are kept as histograms with power of two nanosecond buckets.
+     */
+    class DOSE_INTERNAL_API LockStatistics:
+        public SharedMemoryObject,
+        private boost::noncopyable
+    {
+    private:
+        //This is to make sure that only Instance can call the constructor even though the constructor
+        //itself has to be public (limitation of boost::interprocess)
+        struct private_constructor_t {};
+    public:
+        /** Bucket i counts times from 2^i up to 2^(i+1) ns, the last bucket also everything longer. */
+        static const int NumBuckets = 32;
+
+        struct Counters
+        {
+            std::atomic<std::uint64_t> acquisitions;
+            std::atomic<std::uint64_t> contendedAcquisitions;
+            std::atomic<std::uint64_t> totalWaitTime; //ns, of the contended acquisitions
+            std::atomic<std::uint64_t> totalHoldTime; //ns, exclusive locks only
+            std::atomic<std::uint64_t> waitHistogram[NumBuckets];
+            std::atomic<std::uint64_t> holdHistogram[NumBuckets];
+            std::atomic<unsigned short> level;
+        };
+
+        static void Initialize();
+
+        static LockStatistics& Instance();
+
+        /** Cheap check used by LeveledLock on every lock operation. */
+        static bool IsEnabled()
+        {
+            return m_instance != NULL && m_instance->m_enabled.load(std::memory_order_relaxed);
+        }
+
+        static std::uint64_t Now()
+        {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>
+                                              (std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        static void RecordAcquisition(const LockKind kind,
+                                      const unsigned short level,
+                                      const bool contended,
+                                      const std::uint64_t waitTime)
+        {
+            Counters& counters = m_instance->m_counters[static_cast<size_t>(kind)];
+            counters.level.store(level, std::memory_order_relaxed);
+            counters.acquisitions.fetch_add(1, std::memory_order_relaxed);
+            if (contended)
+            {
+                counters.contendedAcquisitions.fetch_add(1, std::memory_order_relaxed);
+                counters.totalWaitTime.fetch_add(waitTime, std::memory_order_relaxed);
+                counters.waitHistogram[Bucket(waitTime)].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        static void RecordHold(const LockKind kind, const std::uint64_t holdTime)
+        {
+            Counters& counters = m_instance->m_counters[static_cast<size_t>(kind)];
+            counters.totalHoldTime.fetch_add(holdTime, std::memory_order_relaxed);
+            counters.holdHistogram[Bucket(holdTime)].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void Enable(const bool enabled) {m_enabled = enabled;}
+
+        bool Enabled() const {return m_enabled;}
+
+        /** Set all counters to zero. */
+        void Reset();
+
+        const Counters& GetCounters(const LockKind kind) const {return m_counters[static_cast<size_t>(kind)];}
+
+        static const char* GetName(const LockKind kind);
+
+        //The constructor and destructor have to be public for the boost::interprocess internals to be able to call
+        //them, but we can make the constructor "fake-private" by making it require a private type as argument.
+        explicit LockStatistics(private_constructor_t);
+
+    private:
+        static int Bucket(std::uint64_t time)
+        {
+            int bucket = 0;
+            while (time > 1 && bucket < NumBuckets - 1)
+            {
+                time >>= 1;
+                ++bucket;
+            }
+            return bucket;
+        }
+
+        std::atomic<bool> m_enabled;
+        Counters m_counters[static_cast<size_t>(LockKind::NumKinds)];
+
+        static LockStatistics* m_instance;
+    };
+}
+}
+}
@@ -32,6 +32,7 @@
 #include <boost/interprocess/sync/scoped_lock.hpp>
 #include <Safir/Dob/Internal/ConsumerQueueContainer.h>
 #include <Safir/Dob/Internal/LeveledLock.h>
+#include <atomic>
 
 namespace Safir
 {
@@ -42,6 +43,10 @@ namespace Internal
 
     /**
      * A queue for DistributionData containing messages (of message_tag type).
+     *
+     * There are two implementations, chosen when the queue is created. Either a list guarded by a lock,
+     * or a bounded lock free ring buffer (Safir.Dob.QueueParameters.LockFreeMessageQueues) that allows
+     * any number of concurrent producers and one consumer, which is how message in and out queues are used.
      */
     class DOSE_INTERNAL_API MessageQueue:
         public SharedMemoryObject,
@@ -49,8 +54,14 @@ namespace Internal
     {
     public:
         //Constructor, creates a queue with a capacity for given number of elements.
+        //The implementation is given by the parameter Safir.Dob.QueueParameters.LockFreeMessageQueues.
         explicit MessageQueue(const size_t capacity);
 
+        //Constructor, creates a queue with a capacity for given number of elements and the given implementation.
+        MessageQueue(const size_t capacity, const bool lockFree);
+
+        ~MessageQueue();
+
         //Returns false if queue is full
         bool push(const DistributionData & msg);
 
@@ -63,6 +74,10 @@ namespace Internal
         //Checks if the queue is empty
         bool empty() const
         {
+            if (m_cells)
+            {
+                return m_tail == m_head && m_simulateFull == 0;
+            }
             ScopedMessageQueueLock lck(m_lock);
             return (m_size == 0) && (m_simulateFull == 0);
         }
@@ -70,6 +85,10 @@ namespace Internal
         /**Checks if the queue is full. Will also return true if queue is set to simulate overflows. */
         bool full() const
         {
+            if (m_cells)
+            {
+                return RingSize() >= m_capacity || m_simulateFull != 0;
+            }
             ScopedMessageQueueLock lck(m_lock);
             return m_size == m_capacity || m_simulateFull != 0;
         }
@@ -79,6 +98,10 @@ namespace Internal
         */
         size_t size() const
         {
+            if (m_cells)
+            {
+                return m_simulateFull != 0 ? m_capacity : RingSize();
+            }
             ScopedMessageQueueLock lck(m_lock);
             return m_simulateFull != 0 ? m_capacity : m_size;
         }
@@ -93,11 +116,15 @@ namespace Internal
         /**
          * Enlarge the size of a queue.
          * If newSize is smaller than the current size the call is ignored.
+         * The capacity of a lock free queue can not be changed, and the call is ignored.
          */
         void resize(const size_t newCapacity)
         {
             ScopedMessageQueueLock lck(m_lock);
-            m_capacity = std::max(m_capacity,newCapacity);
+            if (!m_cells)
+            {
+                m_capacity = std::max(m_capacity,newCapacity);
+            }
         }
 
         Typesystem::Int32 NumberOfPushes() const {return m_noPushed;}
@@ -108,6 +135,28 @@ namespace Internal
         void SimulateFull(const bool simulateFull) {m_simulateFull = simulateFull?1:0;}
 
     private:
+        //Size of a cache line, used to keep data that is written by producers and consumer apart
+        static const size_t CacheLineSize = 64;
+
+        //A slot in the ring buffer. The sequence number says who may use the slot (Vyukov's bounded queue):
+        //equal to the position in the queue when the slot is free for a producer to push to that position,
+        //position + 1 when a message has been pushed to it, and position + number of cells when the
+        //consumer is done with it.
+        struct Cell
+        {
+            Cell(): sequence(0), msg(no_state_tag) {}
+
+            std::atomic<std::uint64_t> sequence;
+            DistributionData msg;
+            char pad[CacheLineSize - sizeof(std::atomic<std::uint64_t>) - sizeof(DistributionData)];
+        };
+
+        Cell& GetCell(const std::uint64_t position) const {return m_cells[static_cast<std::ptrdiff_t>(position % m_capacity)];}
+        size_t RingSize() const {return static_cast<size_t>(m_tail - m_head);}
+
+        bool PushLockFree(const DistributionData & msg);
+        size_t DispatchLockFree(const DispatchFunc & dispatchFunc, const ActionFunc & postFullAction);
+
         //Locking Policy:
         //This class uses a non-recursive lock, since there should be no
         //recursive locking (all callbacks from within Dispatch are
@@ -116,7 +165,8 @@ namespace Internal
         //programming errors.
         typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_mutex,
                                                   MESSAGE_QUEUE_LOCK_LEVEL,
-                                                  NO_MASTER_LEVEL_REQUIRED> MessageQueueLock;
+                                                  NO_MASTER_LEVEL_REQUIRED,
+                                                  LockKind::MessageQueue> MessageQueueLock;
         mutable MessageQueueLock m_lock;
         typedef boost::interprocess::scoped_lock<MessageQueueLock> ScopedMessageQueueLock;
 
@@ -129,9 +179,17 @@ namespace Internal
 
         QueueData m_data;
 
-        Typesystem::Int32 m_noPushed;
-        Typesystem::Int32 m_noOverflows;
-        Typesystem::Int32 m_noDispatchedMsg;
+        //The ring buffer of a lock free queue, null for a queue with a list
+        boost::interprocess::offset_ptr<Cell> m_cells;
+        char m_pad0[CacheLineSize];
+        std::atomic<std::uint64_t> m_tail; //next position to push to, shared by the producers
+        char m_pad1[CacheLineSize - sizeof(std::atomic<std::uint64_t>)];
+        std::atomic<std::uint64_t> m_head; //first position that is not dispatched, only changed by the consumer
+        char m_pad2[CacheLineSize - sizeof(std::atomic<std::uint64_t>)];
+
+        std::atomic<Typesystem::Int32> m_noPushed;
+        std::atomic<Typesystem::Int32> m_noOverflows;
+        std::atomic<Typesystem::Int32> m_noDispatchedMsg;
         Safir::Utilities::Internal::AtomicUint32 m_simulateFull;
 
         friend void StatisticsCollector(MessageQueue&, void*);
@@ -58,8 +58,11 @@ namespace Internal
 
         void UnsubscribeAll(const ConnectionPtr& connection);
 
-        // Distribute a message to the subscribers
-        void DistributeMsg(const DistributionData& msg);
+        // Distribute a message to the subscribers.
+        // The subscribing connections are signalled directly, unless pendingSignalIns is given,
+        // in which case they are added to it and the caller has to signal them. Connections whose
+        // queue overflows or becomes full are always signalled directly.
+        void DistributeMsg(const DistributionData& msg, PendingSignalIns* pendingSignalIns = nullptr);
 
         Dob::Typesystem::TypeId GetTypeId() const {return m_typeId;}
 
@@ -72,7 +75,8 @@ namespace Internal
 
         typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_mutex,
                                                   MESSAGE_TYPE_LOCK_LEVEL,
-                                                  NO_MASTER_LEVEL_REQUIRED> MessageTypeLock;
+                                                  NO_MASTER_LEVEL_REQUIRED,
+                                                  LockKind::MessageType> MessageTypeLock;
         mutable MessageTypeLock m_lock;
         typedef boost::interprocess::scoped_lock<MessageTypeLock> ScopedMessageTypeLock;
 
@@ -87,6 +91,29 @@ namespace Internal
 
         ConsumerSubscriptions m_subscriptions;
 
+        // A copy of m_subscriptions that DistributeMsg can use without holding m_lock.
+        // It is never modified, every change of m_subscriptions replaces it with a new copy,
+        // and a DistributeMsg that is using the old one keeps it alive until it is done.
+        struct Subscriber
+        {
+            Subscriber(const ConnectionPtr& _connection, const ConsumerSubscription& subscription)
+                : connection(_connection),
+                  subscriptionState(subscription.subscriptionState),
+                  consumerInQueue(subscription.consumerInQueue) {}
+
+            ConnectionPtr                      connection;
+            MetaSubscription                   subscriptionState;
+            MessageQueueContainer::QueuePtr    consumerInQueue;
+        };
+
+        typedef Containers<Subscriber>::vector Subscribers;
+        typedef SmartPointers<Subscribers>::shared_ptr SubscribersPtr;
+
+        SubscribersPtr m_subscribers;
+
+        // Replace m_subscribers with a copy of m_subscriptions. m_lock must be held.
+        void UpdateSubscribers();
+
     };
 }
 }
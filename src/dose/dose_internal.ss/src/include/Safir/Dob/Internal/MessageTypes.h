@@ -66,8 +66,8 @@ namespace Internal
         void UnsubscribeAll(const ConnectionPtr&           connection,
                             const Dob::Typesystem::TypeId  typeId);
 
-        // Distribute a message to the subscribers in-queues
-        void DistributeMsg(const DistributionData& msg);
+        // Distribute a message to the subscribers in-queues, see MessageType::DistributeMsg.
+        void DistributeMsg(const DistributionData& msg, PendingSignalIns* pendingSignalIns = nullptr);
 
         // Returns true if the given connection/consumer has any message subscription for the given type.
         bool HasSubscription(const ConnectionPtr&           connection,
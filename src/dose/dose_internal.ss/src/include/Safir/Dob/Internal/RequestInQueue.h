@@ -106,7 +106,8 @@ namespace Internal
         //programming errors.
         typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_mutex,
                                                   REQUEST_IN_QUEUE_LOCK_LEVEL,
-                                                  NO_MASTER_LEVEL_REQUIRED> RequestInQueueLock;
+                                                  NO_MASTER_LEVEL_REQUIRED,
+                                                  LockKind::RequestInQueue> RequestInQueueLock;
         mutable RequestInQueueLock m_lock;
         typedef boost::interprocess::scoped_lock<RequestInQueueLock> ScopedRequestInQueueLock;
 
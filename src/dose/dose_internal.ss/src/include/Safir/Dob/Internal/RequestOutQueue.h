@@ -106,7 +106,8 @@ namespace Internal
         //programming errors.
         typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_mutex,
                                                   REQUEST_OUT_QUEUE_LOCK_LEVEL,
-                                                  NO_MASTER_LEVEL_REQUIRED> RequestOutQueueLock;
+                                                  NO_MASTER_LEVEL_REQUIRED,
+                                                  LockKind::RequestOutQueue> RequestOutQueueLock;
         mutable RequestOutQueueLock m_lock;
         typedef boost::interprocess::scoped_lock<RequestOutQueueLock> ScopedRequestOutQueueLock;
 
@@ -112,7 +112,8 @@ namespace Internal
         HandlerRegistrationVector m_handlerRegistrations;
 
         typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_mutex,
-                                                  TYPE_LOCK_LEVEL, NO_MASTER_LEVEL_REQUIRED> TypeLock;
+                                                  TYPE_LOCK_LEVEL, NO_MASTER_LEVEL_REQUIRED,
+                                                  LockKind::ServiceType> TypeLock;
 
 
         typedef ShmArray<TypeLock> TypeLockVector;
@@ -0,0 +1,146 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+#pragma once
+
+#include <Safir/Dob/Internal/InternalExportDefs.h>
+#include <Safir/Dob/Internal/SharedMemoryObject.h>
+#include <atomic>
+#include <vector>
+
+namespace Safir
+{
+namespace Dob
+{
+namespace Internal
+{
+    /**
+     * Allocator for the data of DistributionData objects.
+     *
+     * Small blocks are handed out from per size class free lists that live in shared memory and
+     * are pushed and popped lock free by all processes, so the segment manager (and its segment
+     * wide mutex) is only used to get new slabs when a size class runs out of blocks. Slabs are
+     * never given back to the segment, which keeps the segment from being fragmented by the
+     * steady stream of short lived DistributionData of different sizes. The free blocks in a slab
+     * can only be used by its own size class, so they are not free memory. To keep a burst of one
+     * size class from holding on to the memory for good, each size class may only take a limited
+     * number of slabs, together at most 1/MaxSlabShare of the segment. When a size class has
+     * used up its slabs, and for blocks that are too big for the largest size class, the memory
+     * is allocated directly from the segment and given back to it when it is deallocated.
+     */
+    class DOSE_INTERNAL_API SlabAllocator:
+        public SharedMemoryObject,
+        private boost::noncopyable
+    {
+    private:
+        //This is to make sure that only Instance can call the constructor even though the constructor
+        //itself has to be public (limitation of boost::interprocess)
+        struct private_constructor_t {};
+    public:
+        /**
+         * Get the allocator of the shared memory. It is created the first time it is used by any process.
+         */
+        static SlabAllocator& Instance();
+
+        /**
+         * Allocate size bytes. The returned memory is 8 byte aligned.
+         * Throws boost::interprocess::bad_alloc if the shared memory is exhausted.
+         */
+        void* Allocate(const size_t size);
+
+        /** Deallocate memory returned by Allocate. */
+        void Deallocate(void* p);
+
+        struct SizeClassStatistics
+        {
+            size_t blockSize;       //including the block header
+            size_t reservedBlocks;  //blocks in slabs of this size class
+            size_t usedBlocks;      //blocks that are allocated
+        };
+
+        struct Statistics
+        {
+            std::vector<SizeClassStatistics> sizeClasses;
+            size_t slabBytes = 0;        //shared memory taken by slabs
+            size_t cachedFreeBytes = 0;  //free blocks in the slabs, only usable for allocations of the same size class
+            size_t usedBlockBytes = 0;   //allocated blocks in the slabs
+            size_t requestedBytes = 0;   //bytes requested in the allocations that are in slab blocks
+            size_t largeAllocations = 0; //allocations not in the slabs, allocated directly from the segment
+            size_t largeBytes = 0;
+        };
+
+        /**
+         * Get a snapshot of the statistics. The counters are read one by one while other processes
+         * may be allocating, so the numbers are only approximately consistent with each other.
+         */
+        Statistics GetStatistics() const;
+
+        //The constructor and destructor have to be public for the boost::interprocess internals to be able to call
+        //them, but we can make the constructor "fake-private" by making it require a private type as argument.
+        explicit SlabAllocator(private_constructor_t);
+
+    private:
+        //Precedes every block. The user data starts directly after it.
+        struct BlockHeader
+        {
+            uint32_t sizeClass;
+            uint32_t size;
+        };
+
+        //Free list of one size class. head is the offset of the first free block (in units of Granularity from
+        //the start of the segment, 0 means empty) in the low 32 bits and an ABA tag in the high 32 bits.
+        struct SizeClass
+        {
+            std::atomic<uint64_t> head;
+            std::atomic<uint64_t> slabs;
+            std::atomic<uint64_t> reservedBlocks;
+            std::atomic<uint64_t> usedBlocks;
+            std::atomic<uint64_t> requestedBytes;
+        };
+
+        static const uint32_t NumSizeClasses = 9; //64 bytes to 16 kB
+        static const uint32_t LargeSizeClass = 0xffffffff;
+        static const size_t MinBlockSize = 64;
+        static const size_t SlabSize = 128 * 1024;
+        static const size_t Granularity = 8;
+        static const size_t MaxSlabShare = 16; //all slabs together take at most 1/16 of the segment
+
+        static size_t BlockSize(const uint32_t sizeClass) {return MinBlockSize << sizeClass;}
+
+        char* Base() const;
+        uint32_t ToOffset(const char* block) const;
+        char* FromOffset(const uint32_t offset) const;
+        std::atomic<uint32_t>& Next(char* block) const;
+
+        char* Pop(SizeClass& sizeClass);
+        void Push(SizeClass& sizeClass, char* first, char* last);
+        char* NewSlab(const uint32_t sizeClass);
+
+        SizeClass m_sizeClasses[NumSizeClasses];
+        const uint64_t m_maxSlabsPerSizeClass;
+        std::atomic<uint64_t> m_largeAllocations;
+        std::atomic<uint64_t> m_largeBytes;
+
+        static SlabAllocator* m_instance;
+    };
+}
+}
+}
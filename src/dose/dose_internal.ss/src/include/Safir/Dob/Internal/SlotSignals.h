@@ -0,0 +1,148 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+#pragma once
+
+#include <Safir/Dob/Internal/SharedMemoryObject.h>
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <cstdint>
+
+namespace Safir
+{
+namespace Dob
+{
+namespace Internal
+{
+    /**
+     * A set of signal flags, one per slot, in shared memory.
+     *
+     * The flags are kept in a two level bitmap: one bit per slot, and one summary bit per
+     * 64 slots that tells that at least one of them may be set. This lets the one who
+     * handles the signals find the few slots that are set among many idle ones by looking
+     * at one summary word per 4096 slots, instead of checking every slot.
+     *
+     * Set and Reset may be called by any process at any time, they are lock free.
+     * ForEachSet must only be called by one thread at a time.
+     */
+    class SlotSignals:
+        public SharedMemoryObject,
+        private boost::noncopyable
+    {
+    public:
+        explicit SlotSignals(const size_t numSlots)
+            : m_numWords((numSlots + 63) / 64)
+            , m_numSummaryWords((m_numWords + 63) / 64)
+            , m_words(Allocate(m_numWords))
+            , m_summary(Allocate(m_numSummaryWords))
+        {
+
+        }
+
+        ~SlotSignals()
+        {
+            GetSharedMemory().deallocate(m_words.get());
+            GetSharedMemory().deallocate(m_summary.get());
+        }
+
+        void Set(const size_t slot)
+        {
+            const size_t word = slot / 64;
+            const std::uint64_t bit = std::uint64_t(1) << (slot % 64);
+
+            //If the bit was already set the one who set it will set (or has set) the summary bit, and
+            //ForEachSet has not yet taken the bit, since it clears the summary before the word.
+            if ((m_words[word].fetch_or(bit) & bit) == 0)
+            {
+                m_summary[word / 64].fetch_or(std::uint64_t(1) << (word % 64));
+            }
+        }
+
+        void Reset(const size_t slot)
+        {
+            //the summary bit is left as it is, an empty word is skipped by ForEachSet
+            m_words[slot / 64].fetch_and(~(std::uint64_t(1) << (slot % 64)));
+        }
+
+        /**
+         * Reset the slots that are set and call func(slot) for each of them.
+         * A slot that is set while this is running is either included or left for the next call.
+         */
+        template <class Func>
+        void ForEachSet(const Func& func)
+        {
+            for (size_t summaryWord = 0; summaryWord < m_numSummaryWords; ++summaryWord)
+            {
+                if (m_summary[summaryWord].load(std::memory_order_relaxed) == 0)
+                {
+                    continue;
+                }
+
+                std::uint64_t summary = m_summary[summaryWord].exchange(0);
+                while (summary != 0)
+                {
+                    const size_t word = summaryWord * 64 + LowestBit(summary);
+                    summary &= summary - 1;
+
+                    std::uint64_t bits = m_words[word].exchange(0);
+                    while (bits != 0)
+                    {
+                        func(word * 64 + LowestBit(bits));
+                        bits &= bits - 1;
+                    }
+                }
+            }
+        }
+
+    private:
+        static std::atomic<std::uint64_t>* Allocate(const size_t numWords)
+        {
+            std::atomic<std::uint64_t>* words = static_cast<std::atomic<std::uint64_t>*>
+                (GetSharedMemory().allocate(sizeof(std::atomic<std::uint64_t>) * numWords));
+            for (size_t i = 0; i < numWords; ++i)
+            {
+                new (&words[i]) std::atomic<std::uint64_t>(0);
+            }
+            return words;
+        }
+
+        static size_t LowestBit(const std::uint64_t bits)
+        {
+#if defined(__GNUC__)
+            return static_cast<size_t>(__builtin_ctzll(bits));
+#else
+            size_t index = 0;
+            while (((bits >> index) & 1) == 0)
+            {
+                ++index;
+            }
+            return index;
+#endif
+        }
+
+        const size_t m_numWords;
+        const size_t m_numSummaryWords;
+        boost::interprocess::offset_ptr<std::atomic<std::uint64_t> > m_words;
+        boost::interprocess::offset_ptr<std::atomic<std::uint64_t> > m_summary;
+    };
+}
+}
+}
@@ -109,7 +109,8 @@ namespace Internal
         // The LeveledLock is therefor instantiated to enforce this restriction.
         typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_mutex,
                                                   STATE_LOCK_LEVEL,
-                                                  TYPE_LOCK_LEVEL> StateLock;
+                                                  TYPE_LOCK_LEVEL,
+                                                  LockKind::State> StateLock;
         mutable StateLock m_lock;
 
         ConnectionPtr                           m_connection;
@@ -34,6 +34,7 @@
 #include <Safir/Dob/Internal/SubscriptionId.h>
 #include <Safir/Dob/Internal/SubscriptionOptions.h>
 #include <Safir/Dob/Internal/LeveledLock.h>
+#include <Safir/Dob/Internal/StateMap.h>
 #include <Safir/Dob/Typesystem/Internal/InternalUtils.h>
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
 #include <boost/interprocess/sync/interprocess_upgradable_mutex.hpp>
@@ -55,10 +56,14 @@ namespace Internal
             StateSharedPtr
         >
         UpgradeableStatePtr;
-        typedef PairContainers<Dob::Typesystem::Int64, UpgradeableStatePtr>::map States;
+        typedef StateMap<UpgradeableStatePtr> States;
     public:
 
-        explicit StateContainer(const Typesystem::TypeId typeId);
+        /**
+         * If hashedLookup is true the states are found with a hash table instead of a tree, and the
+         * iteration order is the order in which the states were added instead of the key order.
+         */
+        explicit StateContainer(const Typesystem::TypeId typeId, const bool hashedLookup = false);
 
         ~StateContainer();
 
@@ -157,7 +162,8 @@ namespace Internal
         // programming errors.
         typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_mutex,
                                                   STATE_CONTAINER_META_SUB_LOCK_LEVEL,
-                                                  TYPE_LOCK_LEVEL> MetaSubLock;
+                                                  TYPE_LOCK_LEVEL,
+                                                  LockKind::StateContainerMetaSub> MetaSubLock;
         mutable MetaSubLock m_metaSubLock;
         typedef boost::interprocess::scoped_lock<MetaSubLock> ScopedMetaSubLock;
 
@@ -173,7 +179,8 @@ namespace Internal
         // instantiated to enforce this restriction.
         typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_upgradable_mutex,
                                                   STATE_CONTAINER_RW_LOCK_LEVEL,
-                                                  TYPE_LOCK_LEVEL> StateContainerRwLock;
+                                                  TYPE_LOCK_LEVEL,
+                                                  LockKind::StateContainer> StateContainerRwLock;
         mutable StateContainerRwLock m_stateReaderWriterlock;
         typedef boost::interprocess::scoped_lock<StateContainerRwLock> ScopedStateContainerRwLock;
         typedef boost::interprocess::sharable_lock<StateContainerRwLock> SharableStateContainerRwLock;
@@ -64,7 +64,8 @@ namespace Internal
         //counted variable.
         typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_mutex,
                                                   STATE_HOLDER_LOCK_LEVEL,
-                                                  NO_MASTER_LEVEL_REQUIRED> StateHolderLock;
+                                                  NO_MASTER_LEVEL_REQUIRED,
+                                                  LockKind::StateHolder> StateHolderLock;
         mutable StateHolderLock m_lock;
         typedef boost::interprocess::scoped_lock<StateHolderLock> ScopedStateHolderLock;
     };
@@ -0,0 +1,245 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+#pragma once
+
+#include <Safir/Dob/Internal/SharedMemoryObject.h>
+#include <Safir/Dob/Typesystem/Defs.h>
+#include <boost/noncopyable.hpp>
+
+namespace Safir
+{
+namespace Dob
+{
+namespace Internal
+{
+    /**
+     * Map from an Int64 key (instance id or handler id) to T in shared memory, with the subset
+     * of the std::map interface that StateContainer uses.
+     *
+     * The map is either an ordinary tree, or "hashed". A hashed map keeps its entries in a list and
+     * finds them with an open addressing hash table (linear probing) of keys and list positions, so
+     * a lookup is a few probes in a contiguous array instead of a walk down a tree of some twenty
+     * nodes for a map of 100k entries.
+     *
+     * In both variants an iterator stays valid until the entry it refers to is erased, also when
+     * other entries are inserted or erased, which the StateContainer iterators rely on.
+     * A hashed map is iterated in insertion order rather than in key order.
+     */
+    template <class T>
+    class StateMap:
+        public SharedMemoryObject,
+        private boost::noncopyable
+    {
+    public:
+        typedef Dob::Typesystem::Int64 key_type;
+        typedef std::pair<const key_type, T> value_type;
+
+    private:
+        typedef typename PairContainers<key_type, T>::map Tree;
+        typedef typename boost::interprocess::list<value_type, my_allocator<value_type> > List;
+
+        struct Slot
+        {
+            Slot(): key(0), used(false) {}
+
+            key_type key;
+            typename List::iterator entry;
+            bool used;
+        };
+
+        typedef typename Containers<Slot>::vector Index;
+
+    public:
+        class iterator
+        {
+        public:
+            iterator(): m_hashed(false) {}
+
+            value_type& operator*() const {return m_hashed ? *m_list : *m_tree;}
+            value_type* operator->() const {return &**this;}
+
+            iterator& operator++()
+            {
+                if (m_hashed)
+                {
+                    ++m_list;
+                }
+                else
+                {
+                    ++m_tree;
+                }
+                return *this;
+            }
+
+            bool operator==(const iterator& other) const
+            {
+                return m_hashed ? m_list == other.m_list : m_tree == other.m_tree;
+            }
+
+            bool operator!=(const iterator& other) const {return !(*this == other);}
+
+        private:
+            friend class StateMap;
+
+            explicit iterator(const typename Tree::iterator& it): m_hashed(false), m_tree(it) {}
+            explicit iterator(const typename List::iterator& it): m_hashed(true), m_list(it) {}
+
+            bool m_hashed;
+            typename Tree::iterator m_tree;
+            typename List::iterator m_list;
+        };
+
+        explicit StateMap(const bool hashed)
+            : m_hashed(hashed)
+        {
+        }
+
+        bool IsHashed() const {return m_hashed;}
+
+        size_t size() const {return m_hashed ? m_list.size() : m_tree.size();}
+
+        iterator begin() {return m_hashed ? iterator(m_list.begin()) : iterator(m_tree.begin());}
+        iterator end() {return m_hashed ? iterator(m_list.end()) : iterator(m_tree.end());}
+
+        iterator find(const key_type key)
+        {
+            if (!m_hashed)
+            {
+                return iterator(m_tree.find(key));
+            }
+
+            if (m_index.empty())
+            {
+                return end();
+            }
+
+            const size_t slot = FindSlot(key);
+            return m_index[slot].used ? iterator(m_index[slot].entry) : end();
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value)
+        {
+            if (!m_hashed)
+            {
+                const std::pair<typename Tree::iterator, bool> result = m_tree.insert(value);
+                return std::make_pair(iterator(result.first), result.second);
+            }
+
+            //keep the load factor below 0.7, which keeps the probe sequences short
+            if ((m_list.size() + 1) * 10 > m_index.size() * 7)
+            {
+                Rehash(std::max<size_t>(16, m_index.size() * 2));
+            }
+
+            const size_t slot = FindSlot(value.first);
+            if (m_index[slot].used)
+            {
+                return std::make_pair(iterator(m_index[slot].entry), false);
+            }
+
+            m_list.push_back(value);
+            m_index[slot].key = value.first;
+            m_index[slot].entry = --m_list.end();
+            m_index[slot].used = true;
+            return std::make_pair(iterator(m_index[slot].entry), true);
+        }
+
+        void erase(const iterator& it)
+        {
+            if (!m_hashed)
+            {
+                m_tree.erase(it.m_tree);
+                return;
+            }
+
+            size_t hole = FindSlot(it->first);
+            m_list.erase(it.m_list);
+
+            //Backward shift deletion: move entries later in the probe sequence into the hole,
+            //so that lookups never have to step over deleted slots.
+            const size_t mask = m_index.size() - 1;
+            for (size_t next = (hole + 1) & mask; m_index[next].used; next = (next + 1) & mask)
+            {
+                const size_t home = Hash(m_index[next].key) & mask;
+
+                //can the entry in next be moved to hole, i.e. is home cyclically outside (hole, next]?
+                const bool movable = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+                if (movable)
+                {
+                    m_index[hole] = m_index[next];
+                    hole = next;
+                }
+            }
+            m_index[hole] = Slot();
+        }
+
+    private:
+        static size_t Hash(const key_type key)
+        {
+            //Instance ids made from strings are already hashes, but numeric instance ids are often
+            //consecutive numbers, so mix the bits (the finalizer of splitmix64).
+            uint64_t x = static_cast<uint64_t>(key);
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            return static_cast<size_t>(x ^ (x >> 31));
+        }
+
+        //Returns the slot holding key, or the empty slot where it would be inserted.
+        //The index must not be empty.
+        size_t FindSlot(const key_type key) const
+        {
+            const size_t mask = m_index.size() - 1;
+            size_t slot = Hash(key) & mask;
+            while (m_index[slot].used && m_index[slot].key != key)
+            {
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        }
+
+        void Rehash(const size_t numSlots)
+        {
+            m_index.clear();
+            m_index.resize(numSlots);
+
+            const size_t mask = numSlots - 1;
+            for (typename List::iterator it = m_list.begin(); it != m_list.end(); ++it)
+            {
+                size_t slot = Hash(it->first) & mask;
+                while (m_index[slot].used)
+                {
+                    slot = (slot + 1) & mask;
+                }
+                m_index[slot].key = it->first;
+                m_index[slot].entry = it;
+                m_index[slot].used = true;
+            }
+        }
+
+        const bool m_hashed;
+        Tree m_tree;
+        List m_list;
+        Index m_index;
+    };
+}
+}
+}
@@ -34,6 +34,7 @@
 #include <Safir/Dob/Internal/SharedFlag.h>
 #include <Safir/Dob/Internal/SubscriptionOptions.h>
 #include <Safir/Dob/Internal/SubscriptionId.h>
+#include <boost/noncopyable.hpp>
 
 namespace Safir
 {
@@ -94,6 +95,27 @@ namespace Internal
 
         SubscriptionOptionsPtr m_subscriptionOptions;
     };
+
+    /**
+     * While an instance of this class exists, the subscribers that are kicked by the
+     * thread that created it are not signalled right away. Instead each of them is
+     * signalled once when the instance is destroyed.
+     *
+     * Used when a batch of entity instances is set, where a subscriber of many of the
+     * instances would otherwise be signalled once per instance. Must not outlive the
+     * batch, and must be destroyed on the thread that created it.
+     */
+    class DOSE_INTERNAL_API DeferredSignalIns:
+        private boost::noncopyable
+    {
+    public:
+        DeferredSignalIns();
+        ~DeferredSignalIns();
+
+    private:
+        PendingSignalIns m_pendingSignalIns;
+        PendingSignalIns* m_outer;
+    };
 }
 }
 }
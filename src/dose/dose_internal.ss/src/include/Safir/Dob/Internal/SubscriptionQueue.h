@@ -68,7 +68,8 @@ namespace Internal
         //programming errors.
         typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_mutex,
                                                   SUBSCRIPTION_QUEUE_LOCK_LEVEL,
-                                                  NO_MASTER_LEVEL_REQUIRED> SubscriptionQueueLock;
+                                                  NO_MASTER_LEVEL_REQUIRED,
+                                                  LockKind::SubscriptionQueue> SubscriptionQueueLock;
         mutable SubscriptionQueueLock m_lock;
         typedef boost::interprocess::scoped_lock<SubscriptionQueueLock> ScopedSubscriptionQueueLock;
 
@@ -123,7 +123,8 @@ namespace Internal
 
         typedef Safir::Dob::Internal::LeveledLock<boost::interprocess::interprocess_recursive_mutex,
                                                   UPGRADABLE_PTR_LOCK_LEVEL,
-                                                  NO_MASTER_LEVEL_REQUIRED> UpgradablePtrLock;
+                                                  NO_MASTER_LEVEL_REQUIRED,
+                                                  LockKind::UpgradeablePtr> UpgradablePtrLock;
 
         typedef SmartPointers<UpgradablePtrLock>::shared_ptr LockPtr;
 
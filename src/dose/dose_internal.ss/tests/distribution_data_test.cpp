@@ -25,7 +25,11 @@
 #include <Safir/Dob/Internal/DistributionData.h>
 #include <Safir/Dob/Internal/StateDeleter.h>
 #include <Safir/Dob/Internal/SharedMemoryObject.h>
+#include <Safir/Dob/Internal/InjectionKindTable.h>
+#include <Safir/Dob/Internal/SlabAllocator.h>
 #include <Safir/Dob/Message.h>
+#include <Safir/Dob/ProcessInfo.h>
+#include <Safir/Dob/Typesystem/ObjectFactory.h>
 #include <Safir/Dob/Typesystem/Serialization.h>
 
 using namespace Safir::Dob::Internal;
@@ -39,7 +43,8 @@ public:
 
     void DumpMemoryUsage()
     {
-        Int64 free = GetSharedMemory().get_free_memory();
+        //the free blocks that the SlabAllocator keeps are as good as free
+        Int64 free = GetSharedMemory().get_free_memory() + SlabAllocator::Instance().GetStatistics().cachedFreeBytes;
         m_delta = m_lastFree - free;
         std::wcout << "Size / Free = " << GetSharedMemory().get_size() << " / " << free << std::endl;
         std::wcout << "Allocated delta = " << m_delta << std::endl;
@@ -52,8 +57,92 @@ private:
     Int64 m_delta;
 };
 
+DistributionData CreateProcessInfoState(const Int32 pid)
+{
+    Safir::Dob::ProcessInfoPtr processInfo = Safir::Dob::ProcessInfo::Create();
+    processInfo->Name() = L"process";
+    processInfo->Pid() = pid;
+    Safir::Dob::Typesystem::BinarySerialization ser;
+    Safir::Dob::Typesystem::Serialization::ToBinary(processInfo,ser);
+
+    return DistributionData(entity_state_tag,
+                            ConnectionId(100,0,100),
+                            Safir::Dob::ProcessInfo::ClassTypeId,
+                            HandlerId(),
+                            LamportTimestamp(),
+                            InstanceId(1),
+                            LamportTimestamp(),
+                            DistributionData::Real,
+                            false,
+                            false,
+                            &ser[0]);
+}
+
+bool CheckDiff(const char* const diffBlob, const bool pidChanged)
+{
+    Safir::Dob::ProcessInfoPtr processInfo = std::static_pointer_cast<Safir::Dob::ProcessInfo>
+        (Safir::Dob::Typesystem::ObjectFactory::Instance().CreateObject(diffBlob));
+    return !processInfo->Name().IsChanged() && processInfo->Pid().IsChanged() == pidChanged;
+}
+
+//Subscribers that diff against the same previous state shall share one diff blob, and
+//the diff blobs shall be released when the subscribers and the states are done with them.
+bool TestDiff()
+{
+    const size_t usedBlockBytes = SlabAllocator::Instance().GetStatistics().usedBlockBytes;
+    bool ok = true;
+    {
+        const DistributionData first = CreateProcessInfoState(1);
+        const DistributionData previous = CreateProcessInfoState(1);
+        const DistributionData current = CreateProcessInfoState(2);
+
+        const char* const diff1 = DistributionData::GetDiffReference(previous, current, true, false);
+        const char* const diff2 = DistributionData::GetDiffReference(previous, current, true, false);
+        ok = ok && diff1 == diff2 && CheckDiff(diff1, true);
+
+        //a subscriber that missed an update does not get the cached diff
+        const char* const diff3 = DistributionData::GetDiffReference(first, current, true, false);
+        ok = ok && diff3 != diff1 && CheckDiff(diff3, true);
+
+        //the previous state with change flags, which is cached with the previous state
+        const char* const diff4 = DistributionData::GetDiffReference(previous, current, false, false);
+        const char* const diff5 = DistributionData::GetDiffReference(first, previous, true, false);
+        ok = ok && diff4 != diff1 && CheckDiff(diff4, true) && CheckDiff(diff5, false);
+
+        DistributionData::DropDiffReference(diff1);
+        DistributionData::DropDiffReference(diff3);
+
+        //the cached diff lives as long as the state, also when no subscriber holds it
+        const char* const diff6 = DistributionData::GetDiffReference(previous, current, true, false);
+        ok = ok && diff6 == diff2;
+
+        DistributionData::DropDiffReference(diff2);
+        DistributionData::DropDiffReference(diff4);
+        DistributionData::DropDiffReference(diff5);
+        DistributionData::DropDiffReference(diff6);
+    }
+
+    if (!ok)
+    {
+        std::wcout << "Diffs were not shared or had the wrong change flags!" << std::endl;
+    }
+    if (SlabAllocator::Instance().GetStatistics().usedBlockBytes != usedBlockBytes)
+    {
+        std::wcout << "Diffs were not released!" << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
 int main(int, char**)
 {
+    //This creates a couple of singletons in the shared memory, so do it before measuring the memory usage
+    InjectionKindTable::Initialize();
+    if (!TestDiff())
+    {
+        return 1;
+    }
+
     ShmStatistics stats;
     stats.DumpMemoryUsage();
     {
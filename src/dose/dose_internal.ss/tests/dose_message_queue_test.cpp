@@ -52,6 +52,7 @@ void DumpFunc(const char* const dumpPath)
 using namespace Safir::Dob::Internal;
 
 const int NUM_MSG = 1000;
+const int NUM_SENDERS = 2;
 
 long dispatched = 0;
 
@@ -68,13 +69,18 @@ void Dispatch(const DistributionData &, bool & exitDispatch, bool & dontRemove)
     dontRemove = false;
 }
 
-void Sender(MessageQueue& queue, long& sent)
+DistributionData CreateMessage()
 {
     Safir::Dob::MessagePtr m = Safir::Dob::Message::Create();
     Safir::Dob::Typesystem::BinarySerialization ser;
     Safir::Dob::Typesystem::Serialization::ToBinary(m,ser);
 
-    DistributionData d(message_tag,ConnectionId(100,0,100),Safir::Dob::Typesystem::ChannelId(),&ser[0]);
+    return DistributionData(message_tag,ConnectionId(100,0,100),Safir::Dob::Typesystem::ChannelId(),&ser[0]);
+}
+
+void Sender(MessageQueue& queue, long& sent)
+{
+    const DistributionData d = CreateMessage();
     lllog(1) << "Push loop starting (in thread)" << std::endl;
     for (;;)
     {
@@ -102,20 +108,20 @@ void Sender(MessageQueue& queue, long& sent)
     }
 }
 
-int main(int, char**)
+//Several threads push to the queue while this thread dispatches it
+bool TestSenders(const bool lockFree)
 {
-    MessageQueue queue(10);
+    MessageQueue queue(10, lockFree);
+    dispatched = 0;
 
-    Safir::Utilities::CrashReporter::RegisterCallback(DumpFunc);
-    Safir::Utilities::CrashReporter::Start();
-
-    //ensure call to CrashReporter::Stop at application exit
-    boost::shared_ptr<void> guard(static_cast<void*>(0),
-                                  [](void*){Safir::Utilities::CrashReporter::Stop();});
-
-    lllog(1) << "Starting thread" << std::endl;
-    long sent = 0;
-    boost::thread t([&queue,&sent]{Sender(queue,sent);});
+    lllog(1) << "Starting threads" << std::endl;
+    long sent[NUM_SENDERS] = {0};
+    boost::thread_group threads;
+    for (int i = 0; i < NUM_SENDERS; ++i)
+    {
+        long& s = sent[i];
+        threads.create_thread([&queue,&s]{Sender(queue,s);});
+    }
 
     lllog(1) << "Dispatch loop starting" << std::endl;
     for(;;)
@@ -128,18 +134,117 @@ int main(int, char**)
             continue;
         }
 
-        if (dispatched == NUM_MSG)
+        if (dispatched == NUM_SENDERS * NUM_MSG)
         {
             break;
         }
     }
-    lllog(1) << "Joining thread" << std::endl;
-    t.join();
-    if (sent != NUM_MSG)
+    lllog(1) << "Joining threads" << std::endl;
+    threads.join_all();
+    for (int i = 0; i < NUM_SENDERS; ++i)
     {
-        lllog(1) << "unexpected number of sent " << sent << std::endl;
-        return 1;
+        if (sent[i] != NUM_MSG)
+        {
+            lllog(1) << "unexpected number of sent " << sent[i] << std::endl;
+            return false;
+        }
+    }
+    if (!queue.empty() || queue.NumberOfDispatchedMsg() != NUM_SENDERS * NUM_MSG)
+    {
+        lllog(1) << "unexpected queue state after dispatch" << std::endl;
+        return false;
     }
+    return true;
+}
+
+//Messages that are not removed stay first in the queue, and a full queue calls the post full action
+bool TestDontRemove(const bool lockFree)
+{
+    MessageQueue queue(4, lockFree);
+    const DistributionData d = CreateMessage();
+
+    for (int i = 0; i < 4; ++i)
+    {
+        if (!queue.push(d))
+        {
+            return false;
+        }
+    }
+    if (queue.push(d) || !queue.full() || queue.NumberOfOverflows() != 1)
+    {
+        lllog(1) << "queue did not overflow" << std::endl;
+        return false;
+    }
+
+    //keep the first and third message
+    int calls = 0;
+    bool postFullActionCalled = false;
+    size_t res = queue.Dispatch([&calls](const DistributionData &, bool & exitDispatch, bool & dontRemove)
+                                {
+                                    exitDispatch = false;
+                                    dontRemove = calls % 2 == 0;
+                                    ++calls;
+                                },
+                                [&postFullActionCalled]{postFullActionCalled = true;});
+    if (res != 2 || calls != 4 || queue.size() != 2 || !postFullActionCalled)
+    {
+        lllog(1) << "unexpected result of dispatch with dontRemove" << std::endl;
+        return false;
+    }
+
+    //fill it up again, and then stop the dispatch after the first message
+    if (!queue.push(d) || !queue.push(d) || queue.push(d))
+    {
+        lllog(1) << "unexpected result of push after dispatch" << std::endl;
+        return false;
+    }
+    res = queue.Dispatch([](const DistributionData &, bool & exitDispatch, bool & dontRemove)
+                         {
+                             exitDispatch = true;
+                             dontRemove = false;
+                         },
+                         NULL);
+    if (res != 1 || queue.size() != 3)
+    {
+        lllog(1) << "unexpected result of dispatch with exitDispatch" << std::endl;
+        return false;
+    }
+
+    queue.SimulateFull(true);
+    if (queue.push(d) || queue.size() != 4)
+    {
+        lllog(1) << "SimulateFull did not work" << std::endl;
+        return false;
+    }
+    queue.SimulateFull(false);
+
+    res = queue.Dispatch(Dispatch, NULL);
+    if (res != 3 || !queue.empty() || queue.NumberOfPushes() != 6 || queue.NumberOfDispatchedMsg() != 6)
+    {
+        lllog(1) << "unexpected queue state after final dispatch" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int, char**)
+{
+    Safir::Utilities::CrashReporter::RegisterCallback(DumpFunc);
+    Safir::Utilities::CrashReporter::Start();
+
+    //ensure call to CrashReporter::Stop at application exit
+    boost::shared_ptr<void> guard(static_cast<void*>(0),
+                                  [](void*){Safir::Utilities::CrashReporter::Stop();});
+
+    for (int lockFree = 0; lockFree < 2; ++lockFree)
+    {
+        lllog(1) << "Testing " << (lockFree ? "lock free" : "locked") << " queue" << std::endl;
+        if (!TestSenders(lockFree != 0) || !TestDontRemove(lockFree != 0))
+        {
+            return 1;
+        }
+    }
+
     lllog(1) << "all seems good" << std::endl;
     return 0;
 }
@@ -0,0 +1,198 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+
+//Test and benchmark of FutexSignal against the named semaphores that are used on other platforms.
+//Two processes play ping-pong, which measures the wakeup latency, and then one process posts
+//without anyone waiting, which is the case of an application that is busy dispatching.
+//Finally one process posts as fast as it can to another that waits, which would hang if a
+//wakeup was lost.
+
+#include <Safir/Dob/Internal/FutexSignal.h>
+#include <iostream>
+
+#ifdef DOSE_FUTEX_SIGNALS
+
+#include <Safir/Dob/Internal/SharedMemoryObject.h>
+#include <Safir/Dob/Internal/Semaphore.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#if defined _MSC_VER
+#  pragma warning (push)
+#  pragma warning (disable : 4244 4267 4458)
+#endif
+
+#include <boost/process.hpp>
+
+#if defined _MSC_VER
+#  pragma warning (pop)
+#endif
+
+using namespace Safir::Dob::Internal;
+
+namespace
+{
+    const int NUM_ROUND_TRIPS = 100000;
+    const int NUM_POSTS = 1000000;
+
+    struct Shared
+    {
+        FutexSignal ping;
+        FutexSignal pong;
+        std::atomic<int> counter;
+    };
+
+    class Shm: public SharedMemoryObject
+    {
+    public:
+        static Shared& Get()
+        {
+            return *GetSharedMemory().find_or_construct<Shared>("FutexSignalTestShared")();
+        }
+    };
+
+    const std::string PingName = "FUTEX_SIGNAL_TEST_PING";
+    const std::string PongName = "FUTEX_SIGNAL_TEST_PONG";
+
+    int FutexPonger()
+    {
+        Shared& shared = Shm::Get();
+        for (int i = 0; i < NUM_ROUND_TRIPS; ++i)
+        {
+            shared.ping.Wait();
+            shared.pong.Post();
+        }
+        return 0;
+    }
+
+    int SemaphorePonger()
+    {
+        NamedSemaphore ping(PingName);
+        NamedSemaphore pong(PongName);
+        for (int i = 0; i < NUM_ROUND_TRIPS; ++i)
+        {
+            ping.wait();
+            pong.post();
+        }
+        return 0;
+    }
+
+    int FutexReceiver()
+    {
+        Shared& shared = Shm::Get();
+        while (shared.counter != NUM_POSTS)
+        {
+            shared.ping.Wait();
+        }
+        return 0;
+    }
+
+    //returns microseconds per round trip
+    template <class Ping, class Pong>
+    double PingPong(const char* self, const char* kind, Ping ping, Pong pong)
+    {
+        boost::process::child ponger(self, "--ponger", kind);
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < NUM_ROUND_TRIPS; ++i)
+        {
+            ping();
+            pong();
+        }
+        const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        ponger.wait();
+        return elapsed.count() / NUM_ROUND_TRIPS;
+    }
+
+    //returns nanoseconds per post
+    template <class Post>
+    double PostWithoutWaiter(Post post)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < NUM_POSTS; ++i)
+        {
+            post();
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / NUM_POSTS;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc == 3 && std::string(argv[1]) == "--ponger")
+    {
+        return std::string(argv[2]) == "futex" ? FutexPonger() : SemaphorePonger();
+    }
+    if (argc == 2 && std::string(argv[1]) == "--receiver")
+    {
+        return FutexReceiver();
+    }
+
+    Shared& shared = Shm::Get();
+    const double futexLatency = PingPong(argv[0], "futex",
+                                         [&shared]{shared.ping.Post();},
+                                         [&shared]{shared.pong.Wait();});
+
+    NamedSemaphore::remove(PingName);
+    NamedSemaphore::remove(PongName);
+    NamedSemaphore ping(PingName);
+    NamedSemaphore pong(PongName);
+    const double semaphoreLatency = PingPong(argv[0], "semaphore",
+                                             [&ping]{ping.post();},
+                                             [&pong]{pong.wait();});
+    std::wcout << "Ping-pong round trip: FutexSignal " << futexLatency << " us, NamedSemaphore "
+               << semaphoreLatency << " us" << std::endl;
+
+    const double futexPost = PostWithoutWaiter([&shared]{shared.pong.Post();});
+    const double semaphorePost = PostWithoutWaiter([&ping]{ping.post();});
+    std::wcout << "Post without waiter: FutexSignal " << futexPost << " ns, NamedSemaphore "
+               << semaphorePost << " ns" << std::endl;
+    NamedSemaphore::remove(PingName);
+    NamedSemaphore::remove(PongName);
+
+    shared.counter = 0;
+    boost::process::child receiver(argv[0], "--receiver");
+    for (int i = 0; i < NUM_POSTS; ++i)
+    {
+        ++shared.counter;
+        shared.ping.Post();
+    }
+    receiver.wait();
+    if (receiver.exit_code() != 0)
+    {
+        std::wcout << "Receiver failed" << std::endl;
+        return 1;
+    }
+    std::wcout << "Receiver got all " << NUM_POSTS << " posts" << std::endl;
+    return 0;
+}
+
+#else
+
+int main()
+{
+    std::wcout << "FutexSignal is only used on Linux" << std::endl;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,235 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+
+//Test of the LeveledLock contention statistics. Checks that nothing is recorded while the statistics
+//are disabled, that acquisitions, contention and wait and hold times are recorded when they are
+//enabled, also for upgradable locks that are promoted to exclusive, and times an uncontended lock and unlock with and without statistics.
+
+#include <Safir/Dob/Internal/LeveledLock.h>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+using namespace Safir::Dob::Internal;
+
+namespace
+{
+    typedef LeveledLock<boost::interprocess::interprocess_mutex, 1, 0, LockKind::MessageQueue> ExclusiveLock;
+    typedef LeveledLock<boost::interprocess::interprocess_upgradable_mutex, 50, 0, LockKind::EntityType> UpgradableLock;
+
+    class Shm: public SharedMemoryObject
+    {
+    public:
+        template <class T>
+        static T& Create()
+        {
+            return *GetSharedMemory().construct<T>(boost::interprocess::anonymous_instance)();
+        }
+
+        template <class T>
+        static void Destroy(T& t)
+        {
+            GetSharedMemory().destroy_ptr(&t);
+        }
+    };
+
+    bool Check(const bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::wcout << "Check failed: " << what << std::endl;
+        }
+        return condition;
+    }
+
+    std::uint64_t Sum(const std::atomic<std::uint64_t>* histogram)
+    {
+        std::uint64_t sum = 0;
+        for (int i = 0; i < LockStatistics::NumBuckets; ++i)
+        {
+            sum += histogram[i];
+        }
+        return sum;
+    }
+
+    bool TestDisabled()
+    {
+        LockStatistics::Instance().Enable(false);
+        LockStatistics::Instance().Reset();
+
+        ExclusiveLock& lock = Shm::Create<ExclusiveLock>();
+        for (int i = 0; i < 1000; ++i)
+        {
+            std::lock_guard<ExclusiveLock> lck(lock);
+        }
+        Shm::Destroy(lock);
+
+        return Check(LockStatistics::Instance().GetCounters(LockKind::MessageQueue).acquisitions == 0,
+                     "nothing recorded when disabled");
+    }
+
+    bool TestExclusive()
+    {
+        LockStatistics::Instance().Reset();
+        LockStatistics::Instance().Enable(true);
+
+        ExclusiveLock& lock = Shm::Create<ExclusiveLock>();
+        for (int i = 0; i < 1000; ++i)
+        {
+            std::lock_guard<ExclusiveLock> lck(lock);
+        }
+
+        //hold the lock for a while in another thread, so that we have to wait for it
+        std::atomic<bool> locked(false);
+        std::thread holder([&lock,&locked]
+        {
+            std::lock_guard<ExclusiveLock> lck(lock);
+            locked = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        });
+        while (!locked)
+        {
+            std::this_thread::yield();
+        }
+        {
+            std::lock_guard<ExclusiveLock> lck(lock);
+        }
+        holder.join();
+
+        LockStatistics::Instance().Enable(false);
+        Shm::Destroy(lock);
+
+        const LockStatistics::Counters& counters = LockStatistics::Instance().GetCounters(LockKind::MessageQueue);
+        bool ok = true;
+        ok = ok && Check(counters.level == 1, "level");
+        ok = ok && Check(counters.acquisitions == 1002, "acquisitions");
+        ok = ok && Check(counters.contendedAcquisitions == 1, "contended acquisitions");
+        ok = ok && Check(Sum(counters.waitHistogram) == 1, "wait histogram");
+        ok = ok && Check(Sum(counters.holdHistogram) == 1002, "hold histogram");
+        ok = ok && Check(counters.totalWaitTime > 10000000, "wait time"); //at least 10 ms
+        ok = ok && Check(counters.totalHoldTime > 10000000, "hold time");
+        ok = ok && Check(counters.waitHistogram[23] + counters.waitHistogram[24] == 1, "wait time bucket"); //8-33 ms
+        ok = ok && Check(LockStatistics::Instance().GetCounters(LockKind::Other).acquisitions == 0, "other kinds");
+        return ok;
+    }
+
+    bool TestUpgradable()
+    {
+        LockStatistics::Instance().Reset();
+        LockStatistics::Instance().Enable(true);
+
+        UpgradableLock& lock = Shm::Create<UpgradableLock>();
+        for (int i = 0; i < 10; ++i)
+        {
+            lock.lock_sharable();
+            lock.unlock_sharable();
+            lock.lock_upgradable();
+            lock.unlock_upgradable();
+            lock.lock();
+            lock.unlock();
+            lock.lock_upgradable();
+            lock.unlock_upgradable_and_lock();
+            lock.unlock();
+        }
+
+        //promote while another thread holds the lock sharable for a while, so that the promotion has to wait
+        std::atomic<bool> locked(false);
+        std::thread reader([&lock,&locked]
+        {
+            lock.lock_sharable();
+            locked = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            lock.unlock_sharable();
+        });
+        while (!locked)
+        {
+            std::this_thread::yield();
+        }
+        lock.lock_upgradable();
+        lock.unlock_upgradable_and_lock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        lock.unlock();
+        reader.join();
+
+        LockStatistics::Instance().Enable(false);
+        Shm::Destroy(lock);
+
+        const LockStatistics::Counters& counters = LockStatistics::Instance().GetCounters(LockKind::EntityType);
+        bool ok = true;
+        ok = ok && Check(counters.level == 50, "level");
+        ok = ok && Check(counters.acquisitions == 53, "acquisitions, promotions included");
+        ok = ok && Check(counters.contendedAcquisitions == 1, "contended promotion");
+        ok = ok && Check(counters.totalWaitTime > 10000000, "promotion wait time"); //at least 10 ms
+        ok = ok && Check(Sum(counters.holdHistogram) == 21, "exclusive holds, promotions included");
+        ok = ok && Check(counters.totalHoldTime > 10000000, "promoted hold time");
+        return ok;
+    }
+
+    template <class Lock>
+    double TimeLockUnlock(Lock& lock)
+    {
+        const int numIterations = 5000000;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < numIterations; ++i)
+        {
+            lock.lock();
+            lock.unlock();
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / numIterations;
+    }
+
+    void Benchmark()
+    {
+        boost::interprocess::interprocess_mutex& raw = Shm::Create<boost::interprocess::interprocess_mutex>();
+        ExclusiveLock& lock = Shm::Create<ExclusiveLock>();
+
+        const double rawTime = TimeLockUnlock(raw);
+        LockStatistics::Instance().Enable(false);
+        const double disabledTime = TimeLockUnlock(lock);
+        LockStatistics::Instance().Enable(true);
+        const double enabledTime = TimeLockUnlock(lock);
+        LockStatistics::Instance().Enable(false);
+
+        std::wcout << "Uncontended lock and unlock: interprocess_mutex " << rawTime
+                   << " ns, LeveledLock " << disabledTime
+                   << " ns, LeveledLock with statistics " << enabledTime << " ns" << std::endl;
+
+        Shm::Destroy(lock);
+        Shm::Destroy(raw);
+    }
+}
+
+int main()
+{
+    LockStatistics::Initialize();
+
+    if (!TestDisabled() || !TestExclusive() || !TestUpgradable())
+    {
+        return 1;
+    }
+
+    Benchmark();
+    return 0;
+}
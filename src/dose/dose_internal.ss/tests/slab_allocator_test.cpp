@@ -0,0 +1,261 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+
+//Benchmark and test of SlabAllocator. A number of processes allocate and free blocks of mixed sizes
+//in the shared memory at the same time, first with the segment manager and then with the SlabAllocator.
+//Every block is filled with a pattern that is verified before it is freed, to catch blocks that are
+//handed out twice. It also checks that the memory level recovers when a burst of blocks is freed.
+
+#include <Safir/Dob/Internal/SlabAllocator.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined _MSC_VER
+#  pragma warning (push)
+#  pragma warning (disable : 4244 4267 4458)
+#endif
+
+#include <boost/process.hpp>
+
+#if defined _MSC_VER
+#  pragma warning (pop)
+#endif
+
+using namespace Safir::Dob::Internal;
+
+namespace
+{
+    const int NUM_PROCESSES = 8;
+    const int NUM_ITERATIONS = 200000;
+    const int NUM_LIVE = 32; //blocks held by each process at any time
+
+    struct Control
+    {
+        std::atomic<int> ready;
+        std::atomic<bool> go;
+    };
+
+    class Shm: public SharedMemoryObject
+    {
+    public:
+        static Control& GetControl()
+        {
+            return *GetSharedMemory().find_or_construct<Control>("SlabAllocatorTestControl")();
+        }
+
+        static void* Allocate(const bool slab, const size_t size)
+        {
+            return slab ? SlabAllocator::Instance().Allocate(size) : GetSharedMemory().allocate(size);
+        }
+
+        static Safir::Dob::MemoryLevel::Enumeration GetLevel()
+        {
+            return GetMemoryLevel();
+        }
+
+        static size_t GetSize()
+        {
+            return GetSharedMemory().get_size();
+        }
+
+        static void Deallocate(const bool slab, void* p)
+        {
+            if (slab)
+            {
+                SlabAllocator::Instance().Deallocate(p);
+            }
+            else
+            {
+                GetSharedMemory().deallocate(p);
+            }
+        }
+    };
+
+    //mostly small sizes like the DistributionData of messages and entities, now and then a big one
+    size_t NextSize(uint32_t& random)
+    {
+        random = random * 1664525 + 1013904223;
+        const uint32_t r = random >> 8;
+        if (r % 100 == 0)
+        {
+            return 20000 + r % 10000;
+        }
+        return 16 + r % 3000;
+    }
+
+    int Worker(const int id, const bool slab)
+    {
+        Control& control = Shm::GetControl();
+        ++control.ready;
+        while (!control.go)
+        {
+            std::this_thread::yield();
+        }
+
+        struct Block {char* p; size_t size; uint64_t pattern;};
+        std::vector<Block> live(NUM_LIVE, Block{nullptr, 0, 0});
+        uint32_t random = static_cast<uint32_t>(id);
+        for (int i = 0; i < NUM_ITERATIONS; ++i)
+        {
+            Block& block = live[i % NUM_LIVE];
+            if (block.p != nullptr)
+            {
+                for (size_t offset = 0; offset + sizeof(uint64_t) <= block.size; offset += 256)
+                {
+                    uint64_t value;
+                    memcpy(&value, block.p + offset, sizeof(value));
+                    if (value != block.pattern)
+                    {
+                        std::wcout << "Worker " << id << " found a block that has been overwritten!" << std::endl;
+                        return 1;
+                    }
+                }
+                Shm::Deallocate(slab, block.p);
+            }
+
+            block.size = NextSize(random);
+            block.pattern = static_cast<uint64_t>(id) << 32 | static_cast<uint64_t>(i);
+            block.p = static_cast<char*>(Shm::Allocate(slab, block.size));
+            for (size_t offset = 0; offset + sizeof(uint64_t) <= block.size; offset += 256)
+            {
+                memcpy(block.p + offset, &block.pattern, sizeof(block.pattern));
+            }
+        }
+
+        for (auto& block : live)
+        {
+            Shm::Deallocate(slab, block.p);
+        }
+        return 0;
+    }
+
+    //Allocate blocks of one size class until the memory level drops, then free them all. The size class
+    //may only keep a few slabs and the rest of the burst is allocated from the segment, so the level
+    //recovers although the free slab blocks are not counted as free memory.
+    bool MemoryLevelRecovers()
+    {
+        const auto before = Shm::GetLevel();
+        std::vector<void*> burst;
+        while (Shm::GetLevel() == before && burst.size() < Shm::GetSize() / 256)
+        {
+            burst.push_back(SlabAllocator::Instance().Allocate(200));
+        }
+        const auto during = Shm::GetLevel();
+
+        for (auto p : burst)
+        {
+            SlabAllocator::Instance().Deallocate(p);
+        }
+        const auto after = Shm::GetLevel();
+        const size_t slabBytes = SlabAllocator::Instance().GetStatistics().slabBytes;
+
+        std::wcout << "Memory level before burst of " << burst.size() << " blocks: " << Safir::Dob::MemoryLevel::ToString(before).c_str()
+                   << ", during: " << Safir::Dob::MemoryLevel::ToString(during).c_str()
+                   << ", after: " << Safir::Dob::MemoryLevel::ToString(after).c_str()
+                   << ", " << slabBytes << " bytes kept in slabs" << std::endl;
+
+        //all slabs together may take at most 1/16 of the segment, and a size class always gets one slab
+        return during != before && after == before && slabBytes <= std::max<size_t>(Shm::GetSize() / 16, 128 * 1024);
+    }
+
+    //returns elapsed seconds, or a negative value if a worker failed
+    double Run(const char* self, const bool slab)
+    {
+        Control& control = Shm::GetControl();
+        control.ready = 0;
+        control.go = false;
+
+        std::vector<boost::process::child> workers;
+        for (int i = 0; i < NUM_PROCESSES; ++i)
+        {
+            workers.emplace_back(self, "--worker", std::to_string(i + 1), slab ? "slab" : "segment");
+        }
+
+        while (control.ready != NUM_PROCESSES)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        control.go = true;
+        bool ok = true;
+        for (auto& worker : workers)
+        {
+            worker.wait();
+            ok = ok && worker.exit_code() == 0;
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return ok ? elapsed.count() : -1;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc == 4 && std::string(argv[1]) == "--worker")
+    {
+        return Worker(std::stoi(argv[2]), std::string(argv[3]) == "slab");
+    }
+
+    if (!MemoryLevelRecovers())
+    {
+        std::wcout << "Memory level did not recover after the burst was freed!" << std::endl;
+        return 1;
+    }
+
+    const double segmentTime = Run(argv[0], false);
+    const double slabTime = Run(argv[0], true);
+    if (segmentTime < 0 || slabTime < 0)
+    {
+        std::wcout << "A worker process failed" << std::endl;
+        return 1;
+    }
+
+    const double operations = 2.0 * NUM_PROCESSES * NUM_ITERATIONS;
+    std::wcout << NUM_PROCESSES << " processes, " << operations << " allocations and deallocations" << std::endl;
+    std::wcout << "Segment manager: " << segmentTime << " s, " << operations / segmentTime / 1e6 << " Mops/s" << std::endl;
+    std::wcout << "SlabAllocator:   " << slabTime << " s, " << operations / slabTime / 1e6 << " Mops/s" << std::endl;
+
+    const auto statistics = SlabAllocator::Instance().GetStatistics();
+    for (const auto& sizeClass : statistics.sizeClasses)
+    {
+        std::wcout << "    " << sizeClass.blockSize << " byte blocks: " << sizeClass.usedBlocks
+                   << " used of " << sizeClass.reservedBlocks << std::endl;
+        if (sizeClass.usedBlocks != 0)
+        {
+            std::wcout << "Blocks have leaked!" << std::endl;
+            return 1;
+        }
+    }
+    std::wcout << "Slabs: " << statistics.slabBytes << " bytes, large allocations: " << statistics.largeAllocations << std::endl;
+    if (statistics.largeAllocations != 0 || statistics.requestedBytes != 0 || statistics.cachedFreeBytes != statistics.slabBytes)
+    {
+        std::wcout << "Unexpected statistics!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,230 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+
+//Test and benchmark of SlotSignals, the out signals of the connections. Random sets and resets are
+//checked against a std::set, a few sender threads check that no signal is lost while the signals
+//are handled concurrently, and then handling 500 connections of which a few are busy is timed,
+//compared to checking one flag per connection as Connections used to do.
+
+#include <Safir/Dob/Internal/SlotSignals.h>
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace Safir::Dob::Internal;
+
+namespace
+{
+    class Shm: public SharedMemoryObject
+    {
+    public:
+        static SlotSignals* Create(const size_t numSlots)
+        {
+            return GetSharedMemory().construct<SlotSignals>(boost::interprocess::anonymous_instance)(numSlots);
+        }
+
+        static void Destroy(SlotSignals* signals)
+        {
+            GetSharedMemory().destroy_ptr(signals);
+        }
+    };
+
+    uint64_t Next(uint64_t& random)
+    {
+        random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+        return random >> 16;
+    }
+
+    bool Check(const bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::wcout << "Check failed: " << what << std::endl;
+        }
+        return condition;
+    }
+
+    bool TestAgainstReference(const size_t numSlots)
+    {
+        SlotSignals& signals = *Shm::Create(numSlots);
+        std::set<size_t> reference;
+        uint64_t random = numSlots;
+
+        bool ok = true;
+        for (int round = 0; round < 20000 && ok; ++round)
+        {
+            const int numOperations = static_cast<int>(Next(random) % 20);
+            for (int i = 0; i < numOperations; ++i)
+            {
+                const size_t slot = static_cast<size_t>(Next(random) % numSlots);
+                if (Next(random) % 4 != 0)
+                {
+                    signals.Set(slot);
+                    reference.insert(slot);
+                }
+                else
+                {
+                    signals.Reset(slot);
+                    reference.erase(slot);
+                }
+            }
+
+            std::vector<size_t> found;
+            signals.ForEachSet([&found](const size_t slot){found.push_back(slot);});
+            ok = ok && Check(std::vector<size_t>(reference.begin(), reference.end()) == found, "set slots");
+            reference.clear();
+        }
+
+        Shm::Destroy(&signals);
+        return ok;
+    }
+
+    //Each sender sets its slot and waits for the handler to have seen it, so a lost signal makes
+    //the test hang.
+    bool TestConcurrent()
+    {
+        const size_t numSlots = 5000;
+        const int numSenders = 4;
+        const int numSignals = 20000;
+
+        SlotSignals& signals = *Shm::Create(numSlots);
+        std::vector<std::atomic<int>> handled(numSlots);
+        for (auto& count : handled)
+        {
+            count = 0;
+        }
+        std::atomic<int> done(0);
+
+        std::vector<std::thread> senders;
+        for (int sender = 0; sender < numSenders; ++sender)
+        {
+            senders.emplace_back([&, sender]
+            {
+                //spread the senders over different words and summary words
+                const size_t slot = numSlots - 1 - sender * 1237;
+                for (int i = 0; i < numSignals; ++i)
+                {
+                    const int before = handled[slot];
+                    signals.Set(slot);
+                    while (handled[slot] == before)
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+                ++done;
+            });
+        }
+
+        while (done != numSenders)
+        {
+            signals.ForEachSet([&handled](const size_t slot){++handled[slot];});
+            std::this_thread::yield();
+        }
+
+        for (auto& sender : senders)
+        {
+            sender.join();
+        }
+
+        int total = 0;
+        for (auto& count : handled)
+        {
+            total += count;
+        }
+
+        Shm::Destroy(&signals);
+        return Check(total == numSenders * numSignals, "number of handled signals");
+    }
+
+    void Benchmark(const size_t numConnections, const size_t numBusy)
+    {
+        const int numRounds = 1000000;
+
+        std::vector<size_t> busy;
+        for (size_t i = 0; i < numBusy; ++i)
+        {
+            busy.push_back((i * 97) % numConnections);
+        }
+
+        size_t handled = 0;
+
+        //one flag per connection, all of them checked for every signal, like Connections used to do
+        std::vector<std::atomic<uint32_t>> flags(numConnections);
+        for (auto& flag : flags)
+        {
+            flag = 0;
+        }
+
+        const auto flagsStart = std::chrono::steady_clock::now();
+        for (int round = 0; round < numRounds; ++round)
+        {
+            for (size_t slot: busy)
+            {
+                flags[slot] = 1;
+            }
+            for (auto& flag : flags)
+            {
+                if (flag != 0)
+                {
+                    flag = 0;
+                    ++handled;
+                }
+            }
+        }
+        const std::chrono::duration<double, std::nano> flagsTime = std::chrono::steady_clock::now() - flagsStart;
+
+        SlotSignals& signals = *Shm::Create(numConnections);
+        const auto signalsStart = std::chrono::steady_clock::now();
+        for (int round = 0; round < numRounds; ++round)
+        {
+            for (size_t slot: busy)
+            {
+                signals.Set(slot);
+            }
+            signals.ForEachSet([&handled](const size_t){++handled;});
+        }
+        const std::chrono::duration<double, std::nano> signalsTime = std::chrono::steady_clock::now() - signalsStart;
+        Shm::Destroy(&signals);
+
+        std::wcout << numConnections << " connections, " << numBusy << " busy: flag scan "
+                   << flagsTime.count() / numRounds << " ns, SlotSignals "
+                   << signalsTime.count() / numRounds << " ns per round"
+                   << (handled == 2 * numRounds * numBusy ? "" : "!") << std::endl;
+    }
+}
+
+int main()
+{
+    if (!TestAgainstReference(1) || !TestAgainstReference(64) || !TestAgainstReference(500) ||
+        !TestAgainstReference(10000) || !TestConcurrent())
+    {
+        return 1;
+    }
+
+    Benchmark(50, 4);
+    Benchmark(500, 4);
+    Benchmark(500, 50);
+    Benchmark(5000, 4);
+    return 0;
+}
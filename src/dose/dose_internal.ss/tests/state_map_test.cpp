@@ -0,0 +1,195 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+
+//Test and benchmark of StateMap. Random inserts and erases are checked against a std::map for
+//both the tree and the hashed variant, and then lookups and inserts are timed for maps of
+//1k, 100k and 1M entries.
+
+#include <Safir/Dob/Internal/StateMap.h>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <vector>
+
+using namespace Safir::Dob::Internal;
+using Safir::Dob::Typesystem::Int64;
+
+namespace
+{
+    typedef StateMap<Int64> Map;
+
+    class Shm: public SharedMemoryObject
+    {
+    public:
+        static Map* Create(const bool hashed)
+        {
+            return GetSharedMemory().construct<Map>(boost::interprocess::anonymous_instance)(hashed);
+        }
+
+        static void Destroy(Map* map)
+        {
+            GetSharedMemory().destroy_ptr(map);
+        }
+    };
+
+    uint64_t Next(uint64_t& random)
+    {
+        random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+        return random;
+    }
+
+    bool Check(const bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::wcout << "Check failed: " << what << std::endl;
+        }
+        return condition;
+    }
+
+    bool TestAgainstReference(const bool hashed)
+    {
+        Map& map = *Shm::Create(hashed);
+        std::map<Int64, Int64> reference;
+        uint64_t random = 17;
+
+        //an entry that is kept while lots of others come and go, its iterator must stay valid
+        const Int64 stableKey = -1;
+        const Map::iterator stable = map.insert(std::make_pair(stableKey, Int64(4711))).first;
+        reference[stableKey] = 4711;
+
+        bool ok = true;
+        for (int i = 0; i < 200000 && ok; ++i)
+        {
+            //small key range, so that both inserts of existing keys and erases of missing keys happen,
+            //and consecutive keys, which are the worst case for linear probing without a good hash
+            const Int64 key = i % 3 == 0 ? static_cast<Int64>(Next(random) % 5000) : static_cast<Int64>(Next(random));
+            const Int64 value = static_cast<Int64>(i);
+
+            if (Next(random) % 3 != 0)
+            {
+                const std::pair<Map::iterator, bool> res = map.insert(std::make_pair(key, value));
+                const bool inserted = reference.insert(std::make_pair(key, value)).second;
+                ok = ok && Check(res.second == inserted, "insert result");
+                ok = ok && Check(res.first->first == key && res.first->second == reference[key], "inserted value");
+            }
+            else
+            {
+                const Map::iterator it = map.find(key);
+                const bool found = reference.erase(key) != 0;
+                ok = ok && Check((it != map.end()) == found, "find before erase");
+                if (it != map.end() && key != stableKey)
+                {
+                    map.erase(it);
+                }
+            }
+
+            ok = ok && Check(map.size() == reference.size(), "size");
+            ok = ok && Check(stable->first == stableKey && stable->second == 4711, "iterator stability");
+        }
+
+        for (std::map<Int64, Int64>::const_iterator it = reference.begin(); it != reference.end() && ok; ++it)
+        {
+            const Map::iterator found = map.find(it->first);
+            ok = ok && Check(found != map.end() && found->second == it->second, "find after random operations");
+        }
+
+        size_t count = 0;
+        for (Map::iterator it = map.begin(); it != map.end() && ok; ++it)
+        {
+            ++count;
+            ok = ok && Check(reference.count(it->first) == 1, "iteration");
+        }
+        ok = ok && Check(count == reference.size(), "number of iterated entries");
+
+        Shm::Destroy(&map);
+        return ok;
+    }
+
+    void Benchmark(const size_t numEntries)
+    {
+        //instance ids are usually hashes of strings, i.e. random 64 bit numbers
+        std::vector<Int64> keys;
+        uint64_t random = 4711;
+        for (size_t i = 0; i < numEntries; ++i)
+        {
+            keys.push_back(static_cast<Int64>(Next(random)));
+        }
+
+        std::vector<size_t> lookupOrder;
+        for (size_t i = 0; i < 1000000; ++i)
+        {
+            lookupOrder.push_back(static_cast<size_t>(Next(random) % numEntries));
+        }
+
+        for (int hashed = 0; hashed < 2; ++hashed)
+        {
+            Map* map = NULL;
+            try
+            {
+                map = Shm::Create(hashed != 0);
+
+                const auto insertStart = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < numEntries; ++i)
+                {
+                    map->insert(std::make_pair(keys[i], Int64(0)));
+                }
+                const std::chrono::duration<double, std::nano> insertTime = std::chrono::steady_clock::now() - insertStart;
+
+                Int64 sum = 0;
+                const auto lookupStart = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < lookupOrder.size(); ++i)
+                {
+                    sum += map->find(keys[lookupOrder[i]])->second;
+                }
+                const std::chrono::duration<double, std::nano> lookupTime = std::chrono::steady_clock::now() - lookupStart;
+
+                std::wcout << (hashed != 0 ? "hashed " : "tree   ") << numEntries << " entries: insert "
+                           << insertTime.count() / numEntries << " ns, lookup "
+                           << lookupTime.count() / lookupOrder.size() << " ns" << (sum == 0 ? "" : "!") << std::endl;
+            }
+            catch (const boost::interprocess::bad_alloc&)
+            {
+                std::wcout << (hashed != 0 ? "hashed " : "tree   ") << numEntries
+                           << " entries: skipped, not enough shared memory" << std::endl;
+            }
+
+            if (map != NULL)
+            {
+                Shm::Destroy(map);
+            }
+        }
+    }
+}
+
+int main()
+{
+    if (!TestAgainstReference(false) || !TestAgainstReference(true))
+    {
+        return 1;
+    }
+
+    Benchmark(1000);
+    Benchmark(100000);
+    Benchmark(1000000);
+    return 0;
+}
@@ -111,7 +111,10 @@ namespace Internal
                                          nt->maxLostHeartbeats,
                                          nt->slidingWindowSize,
                                          nt->ackRequestThreshold,
-                                         nt->retryTimeout));
+                                         nt->retryTimeout,
+                                         nt->sendQueueSize,
+                                         nt->adaptiveSlidingWindow,
+                                         nt->coalesceMessages));
 
                 std::vector<std::chrono::steady_clock::duration> retryTimeouts;
                 for (auto rt = nt->retryTimeout.cbegin(); rt != nt->retryTimeout.cend(); ++rt)
@@ -135,7 +138,8 @@ namespace Internal
                                                      ownNodeTypeId,
                                                      Com::ResolvedAddress(ownDataAddress),
                                                      commNodeTypes,
-                                                     m_config.fragmentSize));
+                                                     m_config.fragmentSize,
+                                                     CalculateReceiveStrands(m_config, ownNodeTypeId)));
 
             m_sp.reset(new SystemPictureT(SP::slave_tag,
                                           ioContext,
@@ -339,6 +343,27 @@ namespace Internal
             return lightNodeTypeIds;
         }
 
+        static Com::ReceiveStrands CalculateReceiveStrands(const ConfigT& config, int64_t ownNodeTypeId)
+        {
+            for (const auto& nt : config.nodeTypesParam)
+            {
+                if (nt.id == ownNodeTypeId)
+                {
+                    switch (nt.receiveStrands)
+                    {
+                    case Safir::Dob::ReceiveStrands::PerSocket:
+                        return Com::ReceiveStrands::PerSocket;
+                    case Safir::Dob::ReceiveStrands::PerNodeType:
+                        return Com::ReceiveStrands::PerNodeType;
+                    default:
+                        return Com::ReceiveStrands::Single;
+                    }
+                }
+            }
+
+            return Com::ReceiveStrands::Single;
+        }
+
         const int64_t m_nodeId;
         bool m_isLightNode; // Is this node a lightNode
         std::unique_ptr<CommunicationT> m_communication;
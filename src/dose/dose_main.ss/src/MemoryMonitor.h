@@ -27,6 +27,7 @@
 #include <Safir/Utilities/Internal/LowLevelLogger.h>
 #include <Safir/Utilities/Internal/SystemLog.h>
 #include <Safir/Dob/NodeParameters.h>
+#include <Safir/Dob/Internal/SlabAllocator.h>
 
 namespace Safir
 {
@@ -71,11 +72,25 @@ namespace Internal
                     const size_t free = GetSharedMemory().get_free_memory();
                     const double percentFree = static_cast<double>(free)/static_cast<double>(m_capacity) * 100;
                     lllog(4) << percentFree << "% of shared memory is available" << std::endl;
+
+                    const auto slabs = SlabAllocator::Instance().GetStatistics();
+                    const double percentCached = static_cast<double>(slabs.cachedFreeBytes)/static_cast<double>(m_capacity) * 100;
+                    lllog(4) << "DistributionData slabs: " << slabs.slabBytes << " bytes, of which "
+                             << slabs.cachedFreeBytes << " bytes (" << percentCached << "% of shared memory) are free blocks. "
+                             << "Requested " << slabs.requestedBytes << " bytes in " << slabs.usedBlockBytes << " bytes of used blocks. "
+                             << slabs.largeAllocations << " large allocations with " << slabs.largeBytes << " bytes." << std::endl;
+                    for (const auto& sizeClass : slabs.sizeClasses)
+                    {
+                        lllog(5) << "    " << sizeClass.blockSize << " byte blocks: " << sizeClass.usedBlocks
+                                 << " used of " << sizeClass.reservedBlocks << std::endl;
+                    }
+
                     if (percentFree < m_warningPercent)
                     {
                         SEND_SYSTEM_LOG(Alert,
                                         << "Only " << percentFree << "% of the Dob shared memory is available! "
                                         << "This means that you're close to running out of memory! "
+                                        << "(Another " << percentCached << "% is free blocks kept for DistributionData.) "
                                         << "Increase Safir.Dob.NodeParameters.SharedMemorySize.");
                     }
                 }
@@ -90,7 +90,7 @@ namespace Internal
 
         Send(msg);
 
-        MessageTypes::Instance().DistributeMsg(msg);
+        MessageTypes::Instance().DistributeMsg(msg, &m_pendingSignalIns);
         ++numberDispatched;
 
         //If we have dispatched more than the connection queue length of messages
@@ -123,6 +123,12 @@ namespace Internal
                                  dontRemove);
              },
              [&connection]{connection->SignalIn();});
+
+        for (auto it = m_pendingSignalIns.cbegin(); it != m_pendingSignalIns.cend(); ++it)
+        {
+            it->second->SignalIn();
+        }
+        m_pendingSignalIns.clear();
     }
 
     void MessageHandler::Send(const DistributionData& msg)
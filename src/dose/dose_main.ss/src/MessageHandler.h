@@ -26,6 +26,7 @@
 #include "Distribution.h"
 #include "Node.h"
 #include <Safir/Dob/Internal/InternalFwd.h>
+#include <Safir/Dob/Internal/MessageType.h>
 #include <boost/noncopyable.hpp>
 
 namespace Safir
@@ -62,6 +63,10 @@ namespace Internal
 
         Distribution&      m_distribution;
         const int64_t      m_dataTypeIdentifier;
+
+        // The subscribers of the messages distributed by TraverseMessageQueue, which are
+        // signalled once when it is done instead of once per message.
+        PendingSignalIns   m_pendingSignalIns;
     };
 }
 }
@@ -50,7 +50,8 @@ public:
                   int64_t /*nodeTypeId*/,
                   const Safir::Dob::Internal::Com::ResolvedAddress& /*dataAddress*/,
                   const std::vector<Safir::Dob::Internal::Com::NodeTypeDefinition>& /*nodeTypes*/,
-                  int /*fragmentSize*/)
+                  int /*fragmentSize*/,
+                  Safir::Dob::Internal::Com::ReceiveStrands /*receiveStrands*/)
     {}
 
     void Start() {}
@@ -86,6 +87,10 @@ struct NodeType
     int slidingWindowSize;
     int ackRequestThreshold;
     std::vector<int> retryTimeout;
+    int sendQueueSize;
+    bool adaptiveSlidingWindow;
+    bool coalesceMessages;
+    Safir::Dob::ReceiveStrands::Enumeration receiveStrands;
 };
 
 class Config
@@ -93,7 +98,7 @@ class Config
 public:
     Config()
     {
-        nodeTypesParam.push_back({"test",878787,false,"","",10,10,10,10,{10}});
+        nodeTypesParam.push_back({"test",878787,false,"","",10,10,10,10,{10},0,false,false,Safir::Dob::ReceiveStrands::Single});
     }
     
     std::vector<NodeType> nodeTypesParam;
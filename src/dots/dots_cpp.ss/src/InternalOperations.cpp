@@ -29,6 +29,7 @@
 #include <Safir/Dob/Typesystem/Utilities.h>
 #include <Safir/Dob/Typesystem/Object.h>
 #include <Safir/Dob/Typesystem/ObjectFactory.h>
+#include <algorithm>
 
 namespace Safir
 {
@@ -61,21 +62,25 @@ namespace Internal
 
     std::string ToJson(const char * const blob)
     {
-        int BUF_SIZE = 100000;
-        std::vector<char> json8(BUF_SIZE);
+        std::string json8;
+        ToJson(blob, json8);
+        return json8;
+    }
+
+    void ToJson(const char * const blob, std::string& json8)
+    {
+        //Serialize straight into the spare capacity of the string. If that is too small the kernel
+        //tells us the size that is needed, so grow the string to that and serialize again.
+        const size_t start=json8.size();
+        json8.resize(std::max(json8.capacity(), start + 1000));
         Int32 resultSize;
-        DotsC_BlobToJson(&json8[0], blob, BUF_SIZE, resultSize);
-        if (resultSize> BUF_SIZE)
+        DotsC_BlobToJson(&json8[start], blob, static_cast<Int32>(json8.size() - start), resultSize);
+        if (static_cast<size_t>(resultSize) > json8.size() - start)
         {
-            BUF_SIZE = resultSize;
-            json8.resize(BUF_SIZE);
-            DotsC_BlobToJson(&json8[0], blob, BUF_SIZE, resultSize);
-            if (resultSize != BUF_SIZE)
-            {
-                throw SoftwareViolationException(L"Error in serialization buffer sizes",__WFILE__,__LINE__);
-            }
+            json8.resize(start + static_cast<size_t>(resultSize));
+            DotsC_BlobToJson(&json8[start], blob, resultSize, resultSize);
         }
-        return std::string(json8.begin(), json8.begin() + resultSize - 1);
+        json8.resize(start + static_cast<size_t>(resultSize) - 1); //remove null
     }
 
     Dob::Typesystem::ObjectPtr ToObjectFromJson(const std::string & json8)
@@ -100,22 +100,7 @@ namespace Typesystem
     const std::wstring
     Serialization::ToJson(const char * const blob)
     {
-        int BUF_SIZE = 100000;
-        std::vector<char> json8(BUF_SIZE);
-        Int32 resultSize;
-        DotsC_BlobToJson(&json8[0], blob, BUF_SIZE, resultSize);
-        if (resultSize> BUF_SIZE)
-        {
-            BUF_SIZE = resultSize;
-            json8.resize(BUF_SIZE);
-            DotsC_BlobToJson(&json8[0], blob, BUF_SIZE, resultSize);
-            if (resultSize != BUF_SIZE)
-            {
-                throw SoftwareViolationException(L"Error in serialization buffer sizes",__WFILE__,__LINE__);
-            }
-        }
-        return Utilities::ToWstring(std::string(json8.begin(),
-                                                json8.begin() + resultSize - 1)); //remove null.
+        return Utilities::ToWstring(Internal::ToJson(blob));
     }
 
     Dob::Typesystem::ObjectPtr
@@ -22,7 +22,12 @@
 *
 ******************************************************************************/
 #include <Safir/Dob/Typesystem/ToolSupport/Internal/Blob.h>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+#include <vector>
 
 #ifdef _MSC_VER
 #  pragma warning (push)
@@ -36,6 +41,488 @@
 #  pragma warning (pop)
 #endif
 
+namespace
+{
+    using Safir::Dob::Typesystem::ToolSupport::Internal::AnyObject;
+    using Safir::Dob::Typesystem::ToolSupport::Internal::AnyObject_AnyType;
+    using Safir::Dob::Typesystem::ToolSupport::Internal::AnyObject_Member;
+    using Safir::Dob::Typesystem::ToolSupport::Internal::AnyObject_Value;
+    using Safir::Dob::Typesystem::ToolSupport::Internal::Blob;
+    using Safir::Dob::Typesystem::ToolSupport::ParseError;
+
+    //The flat blob format, version 1. All integers are in host byte order like the blob header, and are
+    //accessed with memcpy since nothing in a blob is aligned.
+    //
+    //  blob:   int32 size, int64 typeId (the header, same as in the protobuf format),
+    //          uint8 0 (a protobuf message never starts with a 0 byte), uint8 version, uint16 unused,
+    //          int32 numberOfMembers, uint32 memberOffset[numberOfMembers]
+    //  member: uint32 numberOfValues with isChangedTopLevel in the highest bit, uint32 valueOffset[numberOfValues]
+    //  value:  uint8 isChanged, uint8 keyFields, uint8 valueFields, the key fields, the value fields
+    //
+    //keyFields and valueFields are bit masks of the fields that are present, and the present fields follow
+    //in the order int32, int64, float32, float64, bool, hash, string (int32 length including the terminating
+    //null character, and the characters) and binary (int32 length, and the bytes). So the position of any
+    //field is given by the masks and at most one string length.
+    //All offsets are from the start of the blob. A value that is null, unchanged and without key has offset 0.
+    //A member that is not changed at top level and has no values has offset 0, and one that has a single such
+    //value has offset 1, which is what most members that are not set look like.
+    const size_t BlobHeaderSize=sizeof(std::int32_t)+sizeof(std::int64_t);
+    const size_t FlatHeaderSize=BlobHeaderSize+4+sizeof(std::int32_t);
+    const size_t FlatMemberHeaderSize=sizeof(std::uint32_t);
+    const std::uint32_t ChangedTopLevelBit=0x80000000;
+    const std::uint32_t EmptyMember=0;
+    const std::uint32_t SingleNullMember=1;
+    const size_t FlatValueHeaderSize=3;
+    const char FlatFormatMarker=0;
+    const char FlatFormatVersion=1;
+
+    enum FieldBits
+    {
+        Int32Field=1,
+        Int64Field=2,
+        Float32Field=4,
+        Float64Field=8,
+        BoolField=16,
+        HashField=32,
+        StringField=64,
+        BinaryField=128
+    };
+
+    template <class T> T Load(const char* p)
+    {
+        T val;
+        memcpy(&val, p, sizeof(T));
+        return val;
+    }
+
+    template <class T> char* Store(char* p, const T val)
+    {
+        memcpy(p, &val, sizeof(T));
+        return p+sizeof(T);
+    }
+
+    inline size_t FixedFieldsSize(const std::uint8_t fields)
+    {
+        return ((fields&Int32Field)!=0 ? sizeof(std::int32_t) : 0)
+            + ((fields&Int64Field)!=0 ? sizeof(std::int64_t) : 0)
+            + ((fields&Float32Field)!=0 ? sizeof(float) : 0)
+            + ((fields&Float64Field)!=0 ? sizeof(double) : 0)
+            + ((fields&BoolField)!=0 ? 1 : 0)
+            + ((fields&HashField)!=0 ? sizeof(std::int64_t) : 0);
+    }
+
+    //A flat blob is read in place, so every offset and length in it is checked against the blob size when
+    //it is used. That keeps a corrupt blob from being read outside its end, at the cost of a few compares
+    //per read instead of a walk through the whole blob every time a blob is read.
+    void ThrowOutsideBlob(const char* blob, const char* what)
+    {
+        std::ostringstream os;
+        os<<"Failed to read blob. TypeId: "<<Blob::GetTypeId(blob)<<", size: "<<Blob::GetSize(blob)<<". (The "<<what<<" is outside the blob)";
+        throw ParseError("Bad blob", os.str(), "Blob.cpp", 197);
+    }
+
+    //returns the size of the fields that start at data, throws if they are outside the blob or a string is not null terminated
+    size_t FieldsSize(const char* blob, const std::uint8_t fields, const char* data)
+    {
+        const char* const blobEnd=blob+Blob::GetSize(blob);
+        if (static_cast<size_t>(blobEnd-data)<FixedFieldsSize(fields))
+        {
+            ThrowOutsideBlob(blob, "key or value");
+        }
+        const char* p=data+FixedFieldsSize(fields);
+        if ((fields&StringField)!=0)
+        {
+            if (blobEnd-p<static_cast<std::ptrdiff_t>(sizeof(std::int32_t)))
+            {
+                ThrowOutsideBlob(blob, "string length");
+            }
+            const std::int32_t length=Load<std::int32_t>(p);
+            p+=sizeof(std::int32_t);
+            if (length<1 || blobEnd-p<length || p[length-1]!=0)
+            {
+                ThrowOutsideBlob(blob, "string");
+            }
+            p+=length;
+        }
+        if ((fields&BinaryField)!=0)
+        {
+            if (blobEnd-p<static_cast<std::ptrdiff_t>(sizeof(std::int32_t)))
+            {
+                ThrowOutsideBlob(blob, "binary length");
+            }
+            const std::int32_t length=Load<std::int32_t>(p);
+            p+=sizeof(std::int32_t);
+            if (length<0 || blobEnd-p<length)
+            {
+                ThrowOutsideBlob(blob, "binary");
+            }
+            p+=length;
+        }
+        return static_cast<size_t>(p-data);
+    }
+
+    //The key or value fields of a value in a flat blob. Only created by FlatKey and FlatValueFields, which
+    //check that the fields are inside the blob.
+    class FlatFields
+    {
+    public:
+        FlatFields():m_fields(0), m_data(NULL) {}
+        FlatFields(std::uint8_t fields, const char* data):m_fields(fields), m_data(data) {}
+
+        bool Has(const FieldBits field) const {return (m_fields&field)!=0;}
+        bool Empty() const {return m_fields==0;}
+
+        //returns the default value of T if the field is not present, like protobuf does
+        template <class T> T Get(const FieldBits field) const
+        {
+            return Has(field) ? Load<T>(m_data+FixedFieldsSize(m_fields&(field-1))) : T();
+        }
+
+        bool GetBool() const {return Has(BoolField) && m_data[FixedFieldsSize(m_fields&(BoolField-1))]!=0;}
+
+        //returns NULL if there is no string
+        const char* GetString() const
+        {
+            return Has(StringField) ? m_data+FixedFieldsSize(m_fields)+sizeof(std::int32_t) : NULL;
+        }
+
+        std::pair<const char*, std::int32_t> GetBinary() const
+        {
+            if (!Has(BinaryField))
+            {
+                return std::make_pair("", 0);
+            }
+            const char* p=m_data+FixedFieldsSize(m_fields);
+            if (Has(StringField))
+            {
+                p+=sizeof(std::int32_t)+static_cast<size_t>(Load<std::int32_t>(p));
+            }
+            return std::make_pair(p+sizeof(std::int32_t), Load<std::int32_t>(p));
+        }
+
+        void CopyTo(AnyObject_AnyType* target) const
+        {
+            if (Has(Int32Field)) {target->set_int32_value(Get<std::int32_t>(Int32Field));}
+            if (Has(Int64Field)) {target->set_int64_value(Get<std::int64_t>(Int64Field));}
+            if (Has(Float32Field)) {target->set_float32_value(Get<float>(Float32Field));}
+            if (Has(Float64Field)) {target->set_float64_value(Get<double>(Float64Field));}
+            if (Has(BoolField)) {target->set_boolean_value(GetBool());}
+            if (Has(HashField)) {target->set_hash_value(Get<std::int64_t>(HashField));}
+            if (Has(StringField))
+            {
+                const char* str=GetString();
+                target->set_string_value(str, static_cast<size_t>(Load<std::int32_t>(str-sizeof(std::int32_t))-1));
+            }
+            if (Has(BinaryField))
+            {
+                const std::pair<const char*, std::int32_t> bin=GetBinary();
+                target->set_binary_value(bin.first, static_cast<size_t>(bin.second));
+            }
+        }
+
+    private:
+        std::uint8_t m_fields;
+        const char* m_data;
+    };
+
+    //the member table itself is checked to be inside the blob when the Blob is constructed
+    inline std::uint32_t FlatMemberOffset(const char* blob, int member)
+    {
+        if (member<0 || member>=Load<std::int32_t>(blob+BlobHeaderSize+4))
+        {
+            ThrowOutsideBlob(blob, "member");
+        }
+        return Load<std::uint32_t>(blob+FlatHeaderSize+sizeof(std::uint32_t)*static_cast<size_t>(member));
+    }
+
+    //returns the member in a flat blob, or NULL if it is stored in its offset only
+    inline const char* FlatMember(const char* blob, int member)
+    {
+        const std::uint32_t offset=FlatMemberOffset(blob, member);
+        if (offset<=SingleNullMember)
+        {
+            return NULL;
+        }
+        const size_t size=static_cast<size_t>(Blob::GetSize(blob));
+        if (offset>size || size-offset<FlatMemberHeaderSize ||
+            (size-offset-FlatMemberHeaderSize)/sizeof(std::uint32_t)<(Load<std::uint32_t>(blob+offset)&~ChangedTopLevelBit))
+        {
+            ThrowOutsideBlob(blob, "member");
+        }
+        return blob+offset;
+    }
+
+    inline int FlatNumberOfValues(const char* blob, int member)
+    {
+        const char* m=FlatMember(blob, member);
+        if (m==NULL)
+        {
+            return static_cast<int>(FlatMemberOffset(blob, member));
+        }
+        return static_cast<int>(Load<std::uint32_t>(m)&~ChangedTopLevelBit);
+    }
+
+    inline bool FlatIsChangedTopLevel(const char* blob, int member)
+    {
+        const char* m=FlatMember(blob, member);
+        return m!=NULL && (Load<std::uint32_t>(m)&ChangedTopLevelBit)!=0;
+    }
+
+    //returns the value in a flat blob, or NULL if it does not exist or has offset 0
+    inline const char* FlatValue(const char* blob, int member, int index)
+    {
+        const char* m=FlatMember(blob, member);
+        if (m==NULL || index>=static_cast<int>(Load<std::uint32_t>(m)&~ChangedTopLevelBit))
+        {
+            return NULL;
+        }
+        const std::uint32_t offset=Load<std::uint32_t>(m+FlatMemberHeaderSize+sizeof(std::uint32_t)*static_cast<size_t>(index));
+        if (offset==0)
+        {
+            return NULL;
+        }
+        const size_t size=static_cast<size_t>(Blob::GetSize(blob));
+        if (offset>size || size-offset<FlatValueHeaderSize)
+        {
+            ThrowOutsideBlob(blob, "value");
+        }
+        return blob+offset;
+    }
+
+    inline FlatFields FlatKey(const char* blob, const char* value)
+    {
+        if (value==NULL)
+        {
+            return FlatFields();
+        }
+        const std::uint8_t fields=static_cast<std::uint8_t>(value[1]);
+        FieldsSize(blob, fields, value+FlatValueHeaderSize);
+        return FlatFields(fields, value+FlatValueHeaderSize);
+    }
+
+    inline FlatFields FlatValueFields(const char* blob, const char* value)
+    {
+        if (value==NULL)
+        {
+            return FlatFields();
+        }
+        const std::uint8_t fields=static_cast<std::uint8_t>(value[2]);
+        const char* const data=value+FlatValueHeaderSize+FieldsSize(blob, static_cast<std::uint8_t>(value[1]), value+FlatValueHeaderSize);
+        FieldsSize(blob, fields, data);
+        return FlatFields(fields, data);
+    }
+
+    //---- writing of the flat format from an AnyObject ----
+
+    std::uint8_t FieldsOf(const AnyObject_Value& val, bool key)
+    {
+        if (key ? !val.has_key() : !val.has_value())
+        {
+            return 0;
+        }
+        const AnyObject_AnyType& t=key ? val.key() : val.value();
+        return static_cast<std::uint8_t>((t.has_int32_value() ? Int32Field : 0)
+                                         | (t.has_int64_value() ? Int64Field : 0)
+                                         | (t.has_float32_value() ? Float32Field : 0)
+                                         | (t.has_float64_value() ? Float64Field : 0)
+                                         | (t.has_boolean_value() ? BoolField : 0)
+                                         | (t.has_hash_value() ? HashField : 0)
+                                         | (t.has_string_value() ? StringField : 0)
+                                         | (t.has_binary_value() ? BinaryField : 0));
+    }
+
+    size_t EncodedFieldsSize(const AnyObject_AnyType& t, const std::uint8_t fields)
+    {
+        size_t size=FixedFieldsSize(fields);
+        if ((fields&StringField)!=0)
+        {
+            size+=sizeof(std::int32_t)+t.string_value().size()+1;
+        }
+        if ((fields&BinaryField)!=0)
+        {
+            size+=sizeof(std::int32_t)+t.binary_value().size();
+        }
+        return size;
+    }
+
+    char* EncodeFields(char* p, const AnyObject_AnyType& t, const std::uint8_t fields)
+    {
+        if ((fields&Int32Field)!=0) {p=Store(p, t.int32_value());}
+        if ((fields&Int64Field)!=0) {p=Store(p, static_cast<std::int64_t>(t.int64_value()));}
+        if ((fields&Float32Field)!=0) {p=Store(p, t.float32_value());}
+        if ((fields&Float64Field)!=0) {p=Store(p, t.float64_value());}
+        if ((fields&BoolField)!=0) {*p++=t.boolean_value() ? 1 : 0;}
+        if ((fields&HashField)!=0) {p=Store(p, static_cast<std::int64_t>(t.hash_value()));}
+        if ((fields&StringField)!=0)
+        {
+            const std::string& str=t.string_value();
+            p=Store(p, static_cast<std::int32_t>(str.size()+1));
+            memcpy(p, str.c_str(), str.size()+1);
+            p+=str.size()+1;
+        }
+        if ((fields&BinaryField)!=0)
+        {
+            const std::string& bin=t.binary_value();
+            p=Store(p, static_cast<std::int32_t>(bin.size()));
+            memcpy(p, bin.data(), bin.size());
+            p+=bin.size();
+        }
+        return p;
+    }
+
+    inline bool IsChanged(const AnyObject_Value& val) {return val.has_is_changed() && val.is_changed();}
+    inline bool IsChangedTopLevel(const AnyObject_Member& m) {return m.has_is_changed_top_level() && m.is_changed_top_level();}
+
+    //a value that is stored as offset 0
+    inline bool IsEmpty(const AnyObject_Value& val)
+    {
+        return !IsChanged(val) && FieldsOf(val, true)==0 && FieldsOf(val, false)==0;
+    }
+
+    //returns EmptyMember or SingleNullMember for a member that is stored in its offset only, otherwise 0xffffffff
+    inline std::uint32_t OffsetOnly(const AnyObject_Member& m)
+    {
+        if (IsChangedTopLevel(m) || m.values_size()>1)
+        {
+            return 0xffffffff;
+        }
+        if (m.values_size()==0)
+        {
+            return EmptyMember;
+        }
+        return IsEmpty(m.values(0)) ? SingleNullMember : 0xffffffff;
+    }
+
+    size_t FlatSize(const AnyObject& obj)
+    {
+        size_t size=FlatHeaderSize+sizeof(std::uint32_t)*static_cast<size_t>(obj.members_size());
+        for (const AnyObject_Member& m : obj.members())
+        {
+            if (OffsetOnly(m)!=0xffffffff)
+            {
+                continue;
+            }
+            size+=FlatMemberHeaderSize+sizeof(std::uint32_t)*static_cast<size_t>(m.values_size());
+            for (const AnyObject_Value& val : m.values())
+            {
+                if (!IsEmpty(val))
+                {
+                    size+=FlatValueHeaderSize
+                        +EncodedFieldsSize(val.key(), FieldsOf(val, true))
+                        +EncodedFieldsSize(val.value(), FieldsOf(val, false));
+                }
+            }
+        }
+        return size;
+    }
+
+    //writes everything but the blob header, returns the size of the blob
+    size_t WriteFlat(const AnyObject& obj, char* blob)
+    {
+        char* p=blob+BlobHeaderSize;
+        *p++=FlatFormatMarker;
+        *p++=FlatFormatVersion;
+        *p++=0;
+        *p++=0;
+        p=Store(p, static_cast<std::int32_t>(obj.members_size()));
+
+        char* memberOffsets=p;
+        p+=sizeof(std::uint32_t)*static_cast<size_t>(obj.members_size());
+
+        for (const AnyObject_Member& m : obj.members())
+        {
+            const std::uint32_t offsetOnly=OffsetOnly(m);
+            if (offsetOnly!=0xffffffff)
+            {
+                memberOffsets=Store(memberOffsets, offsetOnly);
+                continue;
+            }
+            memberOffsets=Store(memberOffsets, static_cast<std::uint32_t>(p-blob));
+
+            p=Store(p, static_cast<std::uint32_t>(m.values_size())|(IsChangedTopLevel(m) ? ChangedTopLevelBit : 0));
+
+            char* valueOffsets=p;
+            p+=sizeof(std::uint32_t)*static_cast<size_t>(m.values_size());
+
+            for (const AnyObject_Value& val : m.values())
+            {
+                if (IsEmpty(val))
+                {
+                    valueOffsets=Store(valueOffsets, std::uint32_t(0));
+                    continue;
+                }
+                valueOffsets=Store(valueOffsets, static_cast<std::uint32_t>(p-blob));
+
+                const std::uint8_t keyFields=FieldsOf(val, true);
+                const std::uint8_t valueFields=FieldsOf(val, false);
+                *p++=IsChanged(val) ? 1 : 0;
+                *p++=static_cast<char>(keyFields);
+                *p++=static_cast<char>(valueFields);
+                p=EncodeFields(p, val.key(), keyFields);
+                p=EncodeFields(p, val.value(), valueFields);
+            }
+        }
+        return static_cast<size_t>(p-blob);
+    }
+
+    //Writable blobs are built in protobuf arenas that are reused by the thread that creates the blobs, so
+    //that building or unpacking a blob does not make one heap allocation per member, value and key.
+    //Strings longer than what std::string holds inline still allocate their characters on the heap.
+    const size_t ArenaInitialBlockSize=16*1024;
+    const size_t ArenasPerThread=4;
+
+    class PooledArena
+    {
+    public:
+        PooledArena()
+            :m_arena(Options(m_initialBlock))
+        {
+        }
+
+        google::protobuf::Arena* Get() {return &m_arena;}
+
+    private:
+        static google::protobuf::ArenaOptions Options(char* initialBlock)
+        {
+            //the initial block is kept when the arena is reset, bigger blobs get more blocks from the heap
+            google::protobuf::ArenaOptions options;
+            options.initial_block=initialBlock;
+            options.initial_block_size=ArenaInitialBlockSize;
+            return options;
+        }
+
+        char m_initialBlock[ArenaInitialBlockSize];
+        google::protobuf::Arena m_arena;
+    };
+
+    //An arena is in use as long as some Blob, possibly on another thread, refers to an AnyObject in it,
+    //and is reset when it is taken again. If all arenas of the thread are in use the AnyObject is
+    //allocated on the heap instead.
+    std::shared_ptr<AnyObject> CreateAnyObject()
+    {
+        static thread_local std::vector<std::shared_ptr<PooledArena> > arenas;
+
+        for (std::shared_ptr<PooledArena>& arena : arenas)
+        {
+            if (arena.use_count()==1)
+            {
+                //the last blob using the arena may have been destroyed on another thread
+                std::atomic_thread_fence(std::memory_order_acquire);
+                arena->Get()->Reset();
+                return std::shared_ptr<AnyObject>(arena, google::protobuf::Arena::CreateMessage<AnyObject>(arena->Get()));
+            }
+        }
+
+        if (arenas.size()<ArenasPerThread)
+        {
+            arenas.push_back(std::make_shared<PooledArena>());
+            return std::shared_ptr<AnyObject>(arenas.back(), google::protobuf::Arena::CreateMessage<AnyObject>(arenas.back()->Get()));
+        }
+
+        return std::make_shared<AnyObject>();
+    }
+}
+
 namespace Safir
 {
 namespace Dob
@@ -49,8 +536,10 @@ namespace Internal
     Blob::Blob(std::int64_t typeId, int numberOfMembers)
         :m_blobSize(0)
         ,m_typeId(typeId)
-        ,m_object(std::make_shared<AnyObject>())
+        ,m_flat(NULL)
+        ,m_object(CreateAnyObject())
     {
+        m_object->mutable_members()->Reserve(numberOfMembers);
         for (int i=0; i<numberOfMembers; ++i)
         {
             m_object->add_members();
@@ -60,8 +549,32 @@ namespace Internal
     Blob::Blob(const char* blob)
         :m_blobSize(Blob::GetSize(blob))
         ,m_typeId(Blob::GetTypeId(blob))
-        ,m_object(std::make_shared<AnyObject>())
+        ,m_flat(NULL)
     {
+        if (IsFlat(blob))
+        {
+            if (m_blobSize<static_cast<std::int32_t>(FlatHeaderSize))
+            {
+                std::ostringstream os;
+                os<<"Failed to read blob. TypeId: "<<m_typeId<<", size: "<<m_blobSize<<". (Blob is smaller than the flat header)";
+                throw ParseError("Bad blob", os.str(), "Blob.cpp", 197);
+            }
+            if (blob[HeaderSize+1]!=FlatFormatVersion)
+            {
+                std::ostringstream os;
+                os<<"Failed to read blob. TypeId: "<<m_typeId<<", size: "<<m_blobSize<<". (Unknown flat format version "<<static_cast<int>(blob[HeaderSize+1])<<")";
+                throw ParseError("Bad blob", os.str(), "Blob.cpp", 199);
+            }
+            const std::int32_t numberOfMembers=Load<std::int32_t>(blob+BlobHeaderSize+4);
+            if (numberOfMembers<0 || (static_cast<size_t>(m_blobSize)-FlatHeaderSize)/sizeof(std::uint32_t)<static_cast<size_t>(numberOfMembers))
+            {
+                ThrowOutsideBlob(blob, "member table");
+            }
+            m_flat=blob;
+            return;
+        }
+
+        m_object=CreateAnyObject();
         bool ok=m_object->ParseFromArray(static_cast<const void*>(blob+HeaderSize), m_blobSize-HeaderSize);
         if (!ok)
         {
@@ -86,28 +599,97 @@ namespace Internal
 
     }
 
+    bool Blob::IsFlat(const char* blob)
+    {
+        //an empty protobuf object has no content at all, and any other starts with a field tag, which is never 0
+        return static_cast<size_t>(GetSize(blob))>HeaderSize && blob[HeaderSize]==FlatFormatMarker;
+    }
+
+    void Blob::MakeWritable()
+    {
+        if (m_flat==NULL)
+        {
+            return;
+        }
+
+        std::shared_ptr<AnyObject> object=CreateAnyObject();
+        const int numberOfMembers=Load<std::int32_t>(m_flat+HeaderSize+4);
+        object->mutable_members()->Reserve(numberOfMembers);
+        for (int member=0; member<numberOfMembers; ++member)
+        {
+            AnyObject_Member* m=object->add_members();
+            if (FlatIsChangedTopLevel(m_flat, member))
+            {
+                m->set_is_changed_top_level(true);
+            }
+
+            const int numberOfValues=FlatNumberOfValues(m_flat, member);
+            m->mutable_values()->Reserve(numberOfValues);
+            for (int index=0; index<numberOfValues; ++index)
+            {
+                AnyObject_Value* v=m->add_values();
+                const char* value=FlatValue(m_flat, member, index);
+                if (value==NULL)
+                {
+                    continue;
+                }
+
+                if (value[0]!=0)
+                {
+                    v->set_is_changed(true);
+                }
+
+                const FlatFields key=FlatKey(m_flat, value);
+                if (!key.Empty())
+                {
+                    key.CopyTo(v->mutable_key());
+                }
+
+                const FlatFields val=FlatValueFields(m_flat, value);
+                if (!val.Empty())
+                {
+                    val.CopyTo(v->mutable_value());
+                }
+            }
+        }
+
+        m_object=object;
+        m_flat=NULL;
+    }
+
     std::int32_t Blob::CalculateBlobSize()
     {
-        m_blobSize=static_cast<std::int32_t>(HeaderSize + m_object->ByteSizeLong());
+        if (m_flat==NULL)
+        {
+            m_blobSize=static_cast<std::int32_t>(FlatSize(*m_object));
+        }
         return m_blobSize;
     }
 
     void Blob::Serialize(char* destBlob)
     {
-        //set size, header+protobufSize
-        m_blobSize=static_cast<std::int32_t>(HeaderSize)+static_cast<std::int32_t>(m_object->GetCachedSize());
+        if (m_flat!=NULL)
+        {
+            //unmodified, the raw blob is already what we want
+            memcpy(destBlob, m_flat, static_cast<size_t>(m_blobSize));
+            return;
+        }
 
-        //copy header(size, typeId), not part of the protbuf type
+        //write the content first, since that gives the size
+        m_blobSize=static_cast<std::int32_t>(WriteFlat(*m_object, destBlob));
+
+        //header(size, typeId)
         memcpy(destBlob, reinterpret_cast<void*>(&m_blobSize), sizeof(m_blobSize));
         memcpy(destBlob+sizeof(m_blobSize), reinterpret_cast<void*>(&m_typeId), sizeof(m_typeId));
-
-        //serialize the protobuf content immediately after the header in destBuf
-        google::protobuf::uint8* content=reinterpret_cast<google::protobuf::uint8*>(destBlob+HeaderSize);
-        m_object->SerializeWithCachedSizesToArray(content);
     }
 
     bool Blob::IsChangedTopLevel(int member) const
     {
+        if (m_flat!=NULL)
+        {
+            return FlatIsChangedTopLevel(m_flat, member);
+        }
+
         return m_object->members(member).has_is_changed_top_level()
             && m_object->members(member).is_changed_top_level();
     }
@@ -115,7 +697,13 @@ namespace Internal
     bool Blob::IsChangedHere(int member,
                              int index) const
     {
-        assert (index < m_object->members(member).values_size());
+        assert (index < NumberOfValues(member));
+
+        if (m_flat!=NULL)
+        {
+            const char* value=FlatValue(m_flat, member, index);
+            return value!=NULL && value[0]!=0;
+        }
 
         const AnyObject_Value& val=m_object->members(member).values(index);
 
@@ -126,11 +714,24 @@ namespace Internal
 
     int Blob::NumberOfValues(int member) const
     {
+        if (m_flat!=NULL)
+        {
+            return FlatNumberOfValues(m_flat, member);
+        }
+
         return m_object->members(member).values_size();
     }
 
     void Blob::ValueStatus(int member, int index, bool &isNull, bool &isChanged) const
     {
+        if (m_flat!=NULL)
+        {
+            const char* value=FlatValue(m_flat, member, index);
+            isNull=(value==NULL || value[2]==0);
+            isChanged=(value!=NULL && value[0]!=0);
+            return;
+        }
+
         if (index >= m_object->members(member).values_size())
         {
             isNull = true;
@@ -155,24 +756,44 @@ namespace Internal
 
     std::int32_t Blob::GetKeyInt32(int member, int index) const
     {
+        if (m_flat!=NULL)
+        {
+            return FlatKey(m_flat, FlatValue(m_flat, member, index)).Get<std::int32_t>(Int32Field);
+        }
+
         const AnyObject_Value& val=m_object->members(member).values(index);
         return val.key().int32_value();
     }
 
     std::int64_t Blob::GetKeyInt64(int member, int index) const
     {
+        if (m_flat!=NULL)
+        {
+            return FlatKey(m_flat, FlatValue(m_flat, member, index)).Get<std::int64_t>(Int64Field);
+        }
+
         const AnyObject_Value& val=m_object->members(member).values(index);
         return val.key().int64_value();
     }
 
     std::int64_t Blob::GetKeyHash(int member, int index) const
     {
+        if (m_flat!=NULL)
+        {
+            return FlatKey(m_flat, FlatValue(m_flat, member, index)).Get<std::int64_t>(HashField);
+        }
+
         const AnyObject_Value& val=m_object->members(member).values(index);
         return val.key().hash_value();
     }
 
     const char* Blob::GetKeyString(int member, int index) const
     {
+        if (m_flat!=NULL)
+        {
+            return FlatKey(m_flat, FlatValue(m_flat, member, index)).GetString();
+        }
+
         const AnyObject_Value& val=m_object->members(member).values(index);
         if (val.key().has_string_value())
         {
@@ -186,42 +807,77 @@ namespace Internal
 
     std::int32_t Blob::GetValueInt32(int member, int index) const
     {
+        if (m_flat!=NULL)
+        {
+            return FlatValueFields(m_flat, FlatValue(m_flat, member, index)).Get<std::int32_t>(Int32Field);
+        }
+
         const AnyObject_Value& val=m_object->members(member).values(index);
         return val.value().int32_value();
     }
 
     std::int64_t Blob::GetValueInt64(int member, int index) const
     {
+        if (m_flat!=NULL)
+        {
+            return FlatValueFields(m_flat, FlatValue(m_flat, member, index)).Get<std::int64_t>(Int64Field);
+        }
+
         const AnyObject_Value& val=m_object->members(member).values(index);
         return val.value().int64_value();
     }
 
     float Blob::GetValueFloat32(int member, int index) const
     {
+        if (m_flat!=NULL)
+        {
+            return FlatValueFields(m_flat, FlatValue(m_flat, member, index)).Get<float>(Float32Field);
+        }
+
         const AnyObject_Value& val=m_object->members(member).values(index);
         return val.value().float32_value();
     }
 
     double Blob::GetValueFloat64(int member, int index) const
     {
+        if (m_flat!=NULL)
+        {
+            return FlatValueFields(m_flat, FlatValue(m_flat, member, index)).Get<double>(Float64Field);
+        }
+
         const AnyObject_Value& val=m_object->members(member).values(index);
         return val.value().float64_value();
     }
 
     bool Blob::GetValueBool(int member, int index) const
     {
+        if (m_flat!=NULL)
+        {
+            return FlatValueFields(m_flat, FlatValue(m_flat, member, index)).GetBool();
+        }
+
         const AnyObject_Value& val=m_object->members(member).values(index);
         return val.value().boolean_value();
     }
 
     std::int64_t Blob::GetValueHash(int member, int index) const
     {
+        if (m_flat!=NULL)
+        {
+            return FlatValueFields(m_flat, FlatValue(m_flat, member, index)).Get<std::int64_t>(HashField);
+        }
+
         const AnyObject_Value& val=m_object->members(member).values(index);
         return val.value().hash_value();
     }
 
     const char* Blob::GetValueString(int member, int index) const
     {
+        if (m_flat!=NULL)
+        {
+            return FlatValueFields(m_flat, FlatValue(m_flat, member, index)).GetString();
+        }
+
         const AnyObject_Value& val=m_object->members(member).values(index);
         if (val.value().has_string_value())
         {
@@ -235,6 +891,11 @@ namespace Internal
 
     std::pair<const char*, std::int32_t> Blob::GetValueBinary(int member, int index) const
     {
+        if (m_flat!=NULL)
+        {
+            return FlatValueFields(m_flat, FlatValue(m_flat, member, index)).GetBinary();
+        }
+
         const AnyObject_Value& val=m_object->members(member).values(index);
         const std::string& s=val.value().binary_value();
         return std::make_pair(s.c_str(), static_cast<std::int32_t>(s.size()));
@@ -242,11 +903,13 @@ namespace Internal
 
     void Blob::SetChangedTopLevel(int member, bool isChanged)
     {
+        MakeWritable();
         m_object->mutable_members(member)->set_is_changed_top_level(isChanged);
     }
 
     int Blob::AddValue(int member, bool isChanged)
     {
+        MakeWritable();
         AnyObject_Member* m=m_object->mutable_members(member);
         AnyObject_Value* value=m->add_values();
         if (isChanged)
@@ -259,6 +922,7 @@ namespace Internal
 
     void Blob::SetChangedHere(int member, int index, bool isChanged)
     {
+        MakeWritable();
         AnyObject_Member* m=m_object->mutable_members(member);
         AnyObject_Value* v=m->mutable_values(index);
         if (isChanged)
@@ -273,6 +937,7 @@ namespace Internal
 
     void Blob::SetKeyInt32(int member, int index, std::int32_t val)
     {
+        MakeWritable();
         AnyObject_Member* m=m_object->mutable_members(member);
         AnyObject_Value* v=m->mutable_values(index);
         v->mutable_key()->set_int32_value(val);
@@ -280,6 +945,7 @@ namespace Internal
 
     void Blob::SetKeyInt64(int member, int index, std::int64_t val)
     {
+        MakeWritable();
         AnyObject_Member* m=m_object->mutable_members(member);
         AnyObject_Value* v=m->mutable_values(index);
         v->mutable_key()->set_int64_value(val);
@@ -287,6 +953,7 @@ namespace Internal
 
     void Blob::SetKeyHash(int member, int index, std::int64_t val)
     {
+        MakeWritable();
         AnyObject_Member* m=m_object->mutable_members(member);
         AnyObject_Value* v=m->mutable_values(index);
         v->mutable_key()->set_hash_value(val);
@@ -294,6 +961,7 @@ namespace Internal
 
     void Blob::SetKeyString(int member, int index, const char* val)
     {
+        MakeWritable();
         AnyObject_Member* m=m_object->mutable_members(member);
         AnyObject_Value* v=m->mutable_values(index);
         v->mutable_key()->set_string_value(val);
@@ -301,6 +969,7 @@ namespace Internal
 
     void Blob::SetValueInt32(int member, int index, std::int32_t val)
     {
+        MakeWritable();
         AnyObject_Member* m=m_object->mutable_members(member);
         AnyObject_Value* v=m->mutable_values(index);
         v->mutable_value()->set_int32_value(val);
@@ -308,6 +977,7 @@ namespace Internal
 
     void Blob::SetValueInt64(int member, int index, std::int64_t val)
     {
+        MakeWritable();
         AnyObject_Member* m=m_object->mutable_members(member);
         AnyObject_Value* v=m->mutable_values(index);
         v->mutable_value()->set_int64_value(val);
@@ -315,6 +985,7 @@ namespace Internal
 
     void Blob::SetValueFloat32(int member, int index, float val)
     {
+        MakeWritable();
         AnyObject_Member* m=m_object->mutable_members(member);
         AnyObject_Value* v=m->mutable_values(index);
         v->mutable_value()->set_float32_value(val);
@@ -322,6 +993,7 @@ namespace Internal
 
     void Blob::SetValueFloat64(int member, int index, double val)
     {
+        MakeWritable();
         AnyObject_Member* m=m_object->mutable_members(member);
         AnyObject_Value* v=m->mutable_values(index);
         v->mutable_value()->set_float64_value(val);
@@ -329,6 +1001,7 @@ namespace Internal
 
     void Blob::SetValueBool(int member, int index, bool val)
     {
+        MakeWritable();
         AnyObject_Member* m=m_object->mutable_members(member);
         AnyObject_Value* v=m->mutable_values(index);
         v->mutable_value()->set_boolean_value(val);
@@ -336,6 +1009,7 @@ namespace Internal
 
     void Blob::SetValueHash(int member, int index, std::int64_t val)
     {
+        MakeWritable();
         AnyObject_Member* m=m_object->mutable_members(member);
         AnyObject_Value* v=m->mutable_values(index);
         v->mutable_value()->set_hash_value(val);
@@ -343,6 +1017,7 @@ namespace Internal
 
     void Blob::SetValueString(int member, int index, const char* val)
     {
+        MakeWritable();
         AnyObject_Member* m=m_object->mutable_members(member);
         AnyObject_Value* v=m->mutable_values(index);
         v->mutable_value()->set_string_value(val);
@@ -350,6 +1025,7 @@ namespace Internal
 
     void Blob::SetValueBinary(int member, int index, const char *val, std::int32_t size)
     {
+        MakeWritable();
         AnyObject_Member* m=m_object->mutable_members(member);
         AnyObject_Value* v=m->mutable_values(index);
         v->mutable_value()->set_binary_value(val, static_cast<size_t>(size));
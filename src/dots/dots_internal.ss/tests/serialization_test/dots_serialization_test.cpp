@@ -5,8 +5,12 @@
 * Created by: Joel Ottosson / joot
 *
 *******************************************************************************/
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include <limits>
 #include <set>
 #include <boost/chrono.hpp>
 #include <boost/lexical_cast.hpp>
@@ -16,6 +20,7 @@
 #include <Safir/Dob/Typesystem/ToolSupport/Serialization.h>
 #include <Safir/Dob/Typesystem/ToolSupport/BlobWriter.h>
 #include <Safir/Dob/Typesystem/ToolSupport/BlobReader.h>
+#include "AllocationCounter.h"
 
 using namespace Safir::Dob::Typesystem::ToolSupport;
 
@@ -218,68 +223,71 @@ void BlobDiffTest(RepositoryPtr rep)
     std::vector<char> diffBlob(static_cast<size_t>(diffSize));
     diffWriter.CopyRawBlob(&diffBlob[0]);
 
+    //read the result from the diff blob, the reader r is not affected by the writer
+    BlobReader<Safir::Dob::Typesystem::ToolSupport::TypeRepository> diff(rep.get(), &diffBlob[0]);
+
     std::cout<<"Diff\n---"<<std::endl;
-    r.ReadStatus(myNum, 0, isNull, isChanged);
+    diff.ReadStatus(myNum, 0, isNull, isChanged);
     std::cout<<"myNum - "<<std::boolalpha<<"isNull: "<<isNull<<", isChanged: "<<isChanged<<std::endl;
     CHECK(!isChanged)
 
-    r.ReadStatus(myChildName, 0, isNull, isChanged);
+    diff.ReadStatus(myChildName, 0, isNull, isChanged);
     std::cout<<"myChildName - "<<std::boolalpha<<"isNull: "<<isNull<<", isChanged: "<<isChanged<<std::endl;
     CHECK(isChanged)
 
-    std::cout<<"mySeqInt32 - changedTopLevel: "<<r.IsChangedTopLevel(mySeqInt32)<<std::endl;
-    CHECK(r.IsChangedTopLevel(mySeqInt32))
-    std::cout<<"mySeqInt64 - changedTopLevel: "<<r.IsChangedTopLevel(mySeqInt64)<<std::endl;
-    CHECK(!r.IsChangedTopLevel(mySeqInt64))
-    std::cout<<"mySeqBool - changedTopLevel: "<<r.IsChangedTopLevel(mySeqBool)<<std::endl;
-    CHECK(r.IsChangedTopLevel(mySeqBool))
+    std::cout<<"mySeqInt32 - changedTopLevel: "<<diff.IsChangedTopLevel(mySeqInt32)<<std::endl;
+    CHECK(diff.IsChangedTopLevel(mySeqInt32))
+    std::cout<<"mySeqInt64 - changedTopLevel: "<<diff.IsChangedTopLevel(mySeqInt64)<<std::endl;
+    CHECK(!diff.IsChangedTopLevel(mySeqInt64))
+    std::cout<<"mySeqBool - changedTopLevel: "<<diff.IsChangedTopLevel(mySeqBool)<<std::endl;
+    CHECK(diff.IsChangedTopLevel(mySeqBool))
 
     for (int i=0; i<5; ++i)
     {
-        r.ReadStatus(myStrings, i, isNull, isChanged);
+        diff.ReadStatus(myStrings, i, isNull, isChanged);
         std::cout<<"myStrings["<<i<<"] - "<<std::boolalpha<<"isNull: "<<isNull<<", isChanged: "<<isChanged<<std::endl;
         if (i==4) {CHECK(isChanged)}
         else {CHECK(!isChanged)}
     }
 
-    std::cout<<"myDictStringInt32 - changedTopLevel: "<<r.IsChangedTopLevel(myDictStringInt32)<<std::endl;
-    CHECK(!r.IsChangedTopLevel(myDictStringInt32))
-    for (int i=0; i<r.NumberOfValues(myDictStringInt32); ++i)
+    std::cout<<"myDictStringInt32 - changedTopLevel: "<<diff.IsChangedTopLevel(myDictStringInt32)<<std::endl;
+    CHECK(!diff.IsChangedTopLevel(myDictStringInt32))
+    for (int i=0; i<diff.NumberOfValues(myDictStringInt32); ++i)
     {
-        std::string key=r.ReadKey<const char*>(myDictStringInt32, i);
-        r.ReadStatus(myDictStringInt32, i, isNull, isChanged);
+        std::string key=diff.ReadKey<const char*>(myDictStringInt32, i);
+        diff.ReadStatus(myDictStringInt32, i, isNull, isChanged);
         std::cout<<"    myDictStringInt32["<<key<<"] - "<<std::boolalpha<<"isNull: "<<isNull<<", isChanged: "<<isChanged<<std::endl;
         if (key=="first") {CHECK(!isChanged)}
         else {CHECK(isChanged)}
     }
 
-    std::cout<<"myDictInt32Int32 - changedTopLevel: "<<r.IsChangedTopLevel(myDictInt32Int32)<<std::endl;
-    CHECK(r.IsChangedTopLevel(myDictInt32Int32))
-    for (int i=0; i<r.NumberOfValues(myDictInt32Int32); ++i)
+    std::cout<<"myDictInt32Int32 - changedTopLevel: "<<diff.IsChangedTopLevel(myDictInt32Int32)<<std::endl;
+    CHECK(diff.IsChangedTopLevel(myDictInt32Int32))
+    for (int i=0; i<diff.NumberOfValues(myDictInt32Int32); ++i)
     {
-        DotsC_Int32 key=r.ReadKey<DotsC_Int32>(myDictInt32Int32, i);
-        r.ReadStatus(myDictInt32Int32, i, isNull, isChanged);
+        DotsC_Int32 key=diff.ReadKey<DotsC_Int32>(myDictInt32Int32, i);
+        diff.ReadStatus(myDictInt32Int32, i, isNull, isChanged);
         std::cout<<"    myDictInt32Int32["<<key<<"] - "<<std::boolalpha<<"isNull: "<<isNull<<", isChanged: "<<isChanged<<std::endl;
         if (key==1) {CHECK(isChanged)}
         else {CHECK(!isChanged)}
     }
 
-    std::cout<<"myDictInt32Bool - changedTopLevel: "<<r.IsChangedTopLevel(myDictInt32Bool)<<std::endl;
-    CHECK(r.IsChangedTopLevel(myDictInt32Bool))
-    for (int i=0; i<r.NumberOfValues(myDictInt32Bool); ++i)
+    std::cout<<"myDictInt32Bool - changedTopLevel: "<<diff.IsChangedTopLevel(myDictInt32Bool)<<std::endl;
+    CHECK(diff.IsChangedTopLevel(myDictInt32Bool))
+    for (int i=0; i<diff.NumberOfValues(myDictInt32Bool); ++i)
     {
-        DotsC_Int32 key=r.ReadKey<DotsC_Int32>(myDictInt32Bool, i);
-        r.ReadStatus(myDictInt32Bool, i, isNull, isChanged);
+        DotsC_Int32 key=diff.ReadKey<DotsC_Int32>(myDictInt32Bool, i);
+        diff.ReadStatus(myDictInt32Bool, i, isNull, isChanged);
         std::cout<<"    myDictInt32Bool["<<key<<"] - "<<std::boolalpha<<"isNull: "<<isNull<<", isChanged: "<<isChanged<<std::endl;
         CHECK(!isChanged)
     }
 
-    std::cout<<"myDictStringString - changedTopLevel: "<<r.IsChangedTopLevel(myDictStringString)<<std::endl;
-    CHECK(!r.IsChangedTopLevel(myDictStringString))
-    for (int i=0; i<r.NumberOfValues(myDictStringString); ++i)
+    std::cout<<"myDictStringString - changedTopLevel: "<<diff.IsChangedTopLevel(myDictStringString)<<std::endl;
+    CHECK(!diff.IsChangedTopLevel(myDictStringString))
+    for (int i=0; i<diff.NumberOfValues(myDictStringString); ++i)
     {
-        std::string key=r.ReadKey<const char*>(myDictStringString, i);
-        r.ReadStatus(myDictStringString, i, isNull, isChanged);
+        std::string key=diff.ReadKey<const char*>(myDictStringString, i);
+        diff.ReadStatus(myDictStringString, i, isNull, isChanged);
         std::cout<<"    myDictStringString["<<key<<"] - "<<std::boolalpha<<"isNull: "<<isNull<<", isChanged: "<<isChanged<<std::endl;
         CHECK(!isChanged)
     }
@@ -482,8 +490,12 @@ void BlobChangeTest(RepositoryPtr rep)
     std::cout<<"--- SetChangedRecursive"<<std::endl;
     BlobWriter<Safir::Dob::Typesystem::ToolSupport::TypeRepository> w3(r);
     w3.SetChangedRecursive(true);
+    std::vector<char> changedBlob(static_cast<size_t>(w3.CalculateBlobSize()));
+    w3.CopyRawBlob(&changedBlob[0]);
 
     {
+        //read the result from the changed blob, the reader above is not affected by the writer
+        BlobReader<Safir::Dob::Typesystem::ToolSupport::TypeRepository> r(rep.get(), &changedBlob[0]);
         //---------- Print Object --------------------------
         bool isNull=false, isChanged=true;
         DotsC_Int32 myNumVal=0;
@@ -622,6 +634,469 @@ void BlobChangeTest(RepositoryPtr rep)
     std::cout<<"========= Blob Change Test Done ========"<<std::endl;
 }
 
+//Benchmark of the blob operations that dominate the cost of using objects: writing and serializing
+//a blob, unpacking a blob to read one or all of its members, and diffing two blobs.
+void BlobBenchmark(RepositoryPtr rep)
+{
+    std::cout<<"========= Blob Benchmark ========"<<std::endl;
+    typedef boost::chrono::duration<double, boost::nano> Nanos;
+    const int iterations=20000;
+
+    //An object with 300 members of mixed types. There is no such class in the test dou files, so
+    //it is built directly on Internal::Blob, which does not need a type repository.
+    const int numberOfMembers=300;
+    auto writeBig=[numberOfMembers](std::vector<char>& bin)
+    {
+        Internal::Blob blob(4711, numberOfMembers);
+        for (int member=0; member<numberOfMembers; ++member)
+        {
+            const int index=blob.AddValue(member, member%10==0);
+            switch (member%4)
+            {
+            case 0: blob.SetValueInt32(member, index, member); break;
+            case 1: blob.SetValueFloat64(member, index, member*0.5); break;
+            case 2: blob.SetValueHash(member, index, member); blob.SetValueString(member, index, "instance"); break;
+            default: blob.SetValueString(member, index, "a string member of moderate length"); break;
+            }
+        }
+        bin.resize(static_cast<size_t>(blob.CalculateBlobSize()));
+        blob.Serialize(&bin[0]);
+    };
+
+    std::vector<char> big;
+    boost::chrono::high_resolution_clock::time_point start=boost::chrono::high_resolution_clock::now();
+    for (int i=0; i<iterations; ++i)
+    {
+        writeBig(big);
+    }
+    const Nanos writeTime=boost::chrono::high_resolution_clock::now()-start;
+
+    DotsC_Int64 sum=0;
+    start=boost::chrono::high_resolution_clock::now();
+    for (int i=0; i<iterations; ++i)
+    {
+        const Internal::Blob blob(&big[0]);
+        sum+=blob.GetValueInt32(148, 0);
+    }
+    const Nanos readOneTime=boost::chrono::high_resolution_clock::now()-start;
+    CHECK((sum==148*static_cast<DotsC_Int64>(iterations)))
+
+    start=boost::chrono::high_resolution_clock::now();
+    for (int i=0; i<iterations; ++i)
+    {
+        const Internal::Blob blob(&big[0]);
+        for (int member=0; member<numberOfMembers; ++member)
+        {
+            bool isNull=true, isChanged=false;
+            blob.ValueStatus(member, 0, isNull, isChanged);
+            switch (member%4)
+            {
+            case 0: sum+=blob.GetValueInt32(member, 0); break;
+            case 1: sum+=static_cast<DotsC_Int64>(blob.GetValueFloat64(member, 0)); break;
+            case 2: sum+=blob.GetValueHash(member, 0)+blob.GetValueString(member, 0)[0]; break;
+            default: sum+=blob.GetValueString(member, 0)[0]; break;
+            }
+        }
+    }
+    const Nanos readAllTime=boost::chrono::high_resolution_clock::now()-start;
+
+    //Diff of two versions of a BlobTest.MyEntity, which is what is done on every SetChanges.
+    const DotsC_TypeId tid=TypeUtilities::CalculateTypeId("BlobTest.MyEntity");
+    const ClassDescription* cd=rep->GetClass(tid);
+    auto writeEntity=[&rep, cd, tid](std::vector<char>& bin, const DotsC_Int32 version)
+    {
+        BlobWriter<Safir::Dob::Typesystem::ToolSupport::TypeRepository> w(rep.get(), tid);
+        w.WriteValue(cd->GetMemberIndex("MyInt32Val"), 0, version, false, true);
+        w.WriteValue(cd->GetMemberIndex("MyInt64Val"), 0, DotsC_Int64(12345678), false, true);
+        w.WriteValue(cd->GetMemberIndex("MyFloat64Val"), 0, 3.14, false, true);
+        w.WriteValue(cd->GetMemberIndex("MyStringVal"), 0, version==1 ? "one" : "two", false, true);
+        w.SetChangedRecursive(false);
+        bin.resize(static_cast<size_t>(w.CalculateBlobSize()));
+        w.CopyRawBlob(&bin[0]);
+    };
+    std::vector<char> entity1, entity2;
+    writeEntity(entity1, 1);
+    writeEntity(entity2, 2);
+
+    start=boost::chrono::high_resolution_clock::now();
+    for (int i=0; i<iterations; ++i)
+    {
+        const BlobReader<Safir::Dob::Typesystem::ToolSupport::TypeRepository> original(rep.get(), &entity1[0]);
+        const BlobReader<Safir::Dob::Typesystem::ToolSupport::TypeRepository> current(rep.get(), &entity2[0]);
+        BlobWriter<Safir::Dob::Typesystem::ToolSupport::TypeRepository> diff(current);
+        CHECK(diff.MarkChanges(original))
+    }
+    const Nanos diffTime=boost::chrono::high_resolution_clock::now()-start;
+
+    std::cout<<"300 members, blob size "<<big.size()<<" bytes:"<<std::endl;
+    std::cout<<"  write and serialize: "<<writeTime.count()/iterations<<" ns"<<std::endl;
+    std::cout<<"  read one member:     "<<readOneTime.count()/iterations<<" ns"<<std::endl;
+    std::cout<<"  read all members:    "<<readAllTime.count()/iterations<<" ns"<<(sum==0 ? "!" : "")<<std::endl;
+    std::cout<<"BlobTest.MyEntity, blob size "<<entity1.size()<<" bytes:"<<std::endl;
+    std::cout<<"  diff:                "<<diffTime.count()/iterations<<" ns"<<std::endl;
+    std::cout<<"========= Blob Benchmark Done ========"<<std::endl;
+}
+
+//Count the heap allocations made by the blob operations of SetEntity and SetChanges, which make a
+//writable copy of the blob in the application and another one in dose_main to clear change flags
+//or to mark changes.
+void BlobAllocationTest(RepositoryPtr rep)
+{
+    std::cout<<"========= Blob Allocation Test ========"<<std::endl;
+    const int iterations=1000;
+    const DotsC_TypeId tid=TypeUtilities::CalculateTypeId("BlobTest.MyEntity");
+    const ClassDescription* cd=rep->GetClass(tid);
+
+    std::vector<char> original, current;
+    {
+        BlobWriter<Safir::Dob::Typesystem::ToolSupport::TypeRepository> w(rep.get(), tid);
+        w.WriteValue(cd->GetMemberIndex("MyInt32Val"), 0, DotsC_Int32(1), false, true);
+        w.WriteValue(cd->GetMemberIndex("MyStringVal"), 0, "one", false, true);
+        original.resize(static_cast<size_t>(w.CalculateBlobSize()));
+        w.CopyRawBlob(&original[0]);
+
+        w.WriteValue(cd->GetMemberIndex("MyInt32Val"), 0, DotsC_Int32(2), false, true);
+        current.resize(static_cast<size_t>(w.CalculateBlobSize()));
+        w.CopyRawBlob(&current[0]);
+    }
+
+    std::vector<char> result(current.size()*2);
+    auto setEntity=[&]
+    {
+        const BlobReader<Safir::Dob::Typesystem::ToolSupport::TypeRepository> r(rep.get(), &current[0]);
+        BlobWriter<Safir::Dob::Typesystem::ToolSupport::TypeRepository> w(r);
+        w.SetChangedRecursive(false);
+        CHECK((static_cast<size_t>(w.CalculateBlobSize())<=result.size()))
+        w.CopyRawBlob(&result[0]);
+    };
+    auto setChanges=[&]
+    {
+        const BlobReader<Safir::Dob::Typesystem::ToolSupport::TypeRepository> o(rep.get(), &original[0]);
+        const BlobReader<Safir::Dob::Typesystem::ToolSupport::TypeRepository> c(rep.get(), &current[0]);
+        BlobWriter<Safir::Dob::Typesystem::ToolSupport::TypeRepository> w(c);
+        CHECK(w.MarkChanges(o))
+        CHECK((static_cast<size_t>(w.CalculateBlobSize())<=result.size()))
+        w.CopyRawBlob(&result[0]);
+    };
+
+    //the first time the thread sets up its arenas
+    setEntity();
+    setChanges();
+
+    size_t before=NumberOfAllocations();
+    for (int i=0; i<iterations; ++i)
+    {
+        setEntity();
+    }
+    const double setEntityAllocations=static_cast<double>(NumberOfAllocations()-before)/iterations;
+
+    before=NumberOfAllocations();
+    for (int i=0; i<iterations; ++i)
+    {
+        setChanges();
+    }
+    const double setChangesAllocations=static_cast<double>(NumberOfAllocations()-before)/iterations;
+
+    std::cout<<"Allocations per SetEntity: "<<setEntityAllocations<<", per SetChanges: "<<setChangesAllocations<<std::endl;
+
+    //Blobs are read in place and writable blobs are built in reused arenas. Allocations made inside
+    //dots_internal are not seen by this counter on platforms where a dll has its own operator new,
+    //which only makes this check weaker.
+    CHECK((setEntityAllocations==0))
+    CHECK((setChangesAllocations==0))
+    std::cout<<"========= Blob Allocation Test Done ========"<<std::endl;
+}
+
+//Blobs written by nodes and persistence from before the flat format are protobuf blobs. The checked in
+//BlobTest.MyEntity.protobuf.blob was written by the protobuf BlobWriter. It must be read with all values and
+//change flags, and a writer made from it must serialize the same content in the flat format.
+void ProtobufBlobTest(RepositoryPtr rep, const boost::filesystem::path& blobFile)
+{
+    std::cout<<"========= Protobuf Blob Test ========"<<std::endl;
+    typedef BlobReader<Safir::Dob::Typesystem::ToolSupport::TypeRepository> Reader;
+    const DotsC_TypeId tid=TypeUtilities::CalculateTypeId("BlobTest.MyEntity");
+    const DotsC_TypeId itemTid=TypeUtilities::CalculateTypeId("BlobTest.MyItem");
+    const ClassDescription* cd=rep->GetClass(tid);
+    const ClassDescription* icd=rep->GetClass(itemTid);
+
+    std::ifstream file(blobFile.string().c_str(), std::ios::binary);
+    const std::vector<char> protobufBlob((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    CHECK((protobufBlob.size()>12 && static_cast<size_t>(Reader::GetSize(&protobufBlob[0]))==protobufBlob.size()))
+    CHECK((Reader::GetTypeId(&protobufBlob[0])==tid))
+    CHECK(!Internal::Blob::IsFlat(&protobufBlob[0]))
+
+    auto checkEntity=[&](const char* blob)
+    {
+        const Reader r(rep.get(), blob);
+        bool isNull=true, isChanged=false;
+
+        bool b=false;
+        r.ReadValue(cd->GetMemberIndex("MyBoolVal"), 0, b, isNull, isChanged);
+        CHECK((!isNull && isChanged && b))
+
+        DotsC_Int32 i32=0;
+        r.ReadValue(cd->GetMemberIndex("MyInt32Val"), 0, i32, isNull, isChanged);
+        CHECK((!isNull && !isChanged && i32==-4711))
+
+        DotsC_Int64 i64=0;
+        r.ReadValue(cd->GetMemberIndex("MyInt64Val"), 0, i64, isNull, isChanged);
+        CHECK((!isNull && isChanged && i64==1234567890123LL))
+
+        DotsC_Float32 f32=0;
+        r.ReadValue(cd->GetMemberIndex("MyFloat32Val"), 0, f32, isNull, isChanged);
+        CHECK((!isNull && !isChanged && f32==1.5f))
+
+        DotsC_Float64 f64=0;
+        r.ReadValue(cd->GetMemberIndex("MyFloat64Val"), 0, f64, isNull, isChanged);
+        CHECK((!isNull && isChanged && f64==3.25))
+
+        std::pair<DotsC_Int64, const char*> instanceId(0, static_cast<const char*>(NULL));
+        r.ReadValue(cd->GetMemberIndex("MyInstanceIdVal"), 0, instanceId, isNull, isChanged);
+        CHECK((!isNull && isChanged && instanceId.first==LlufId_Generate64("InstanceName") && std::string(instanceId.second)=="InstanceName"))
+
+        const char* str=NULL;
+        r.ReadValue(cd->GetMemberIndex("MyStringVal"), 0, str, isNull, isChanged);
+        CHECK((!isNull && !isChanged && std::string(str)=="Protobuf string"))
+
+        std::pair<const char*, DotsC_Int32> bin(static_cast<const char*>(NULL), 0);
+        r.ReadValue(cd->GetMemberIndex("MyBinaryVal"), 0, bin, isNull, isChanged);
+        CHECK((!isNull && isChanged && std::string(bin.first, static_cast<size_t>(bin.second))==std::string("b\0in", 4)))
+
+        DotsC_EnumerationValue e=0;
+        r.ReadValue(cd->GetMemberIndex("MyEnumVal"), 0, e, isNull, isChanged);
+        CHECK((!isNull && isChanged && e==2))
+
+        r.ReadStatus(cd->GetMemberIndex("MyTypeIdVal"), 0, isNull, isChanged);
+        CHECK((isNull && !isChanged))
+
+        r.ReadStatus(cd->GetMemberIndex("MyInt32Array"), 0, isNull, isChanged);
+        CHECK((isNull && !isChanged))
+        r.ReadValue(cd->GetMemberIndex("MyInt32Array"), 1, i32, isNull, isChanged);
+        CHECK((!isNull && isChanged && i32==11))
+        r.ReadValue(cd->GetMemberIndex("MyInt32Array"), 2, i32, isNull, isChanged);
+        CHECK((!isNull && !isChanged && i32==22))
+
+        r.ReadValue(cd->GetMemberIndex("MyStringArray"), 0, str, isNull, isChanged);
+        CHECK((!isNull && isChanged && std::string(str)=="first"))
+        r.ReadStatus(cd->GetMemberIndex("MyStringArray"), 1, isNull, isChanged);
+        CHECK((isNull && !isChanged))
+        r.ReadValue(cd->GetMemberIndex("MyStringArray"), 2, str, isNull, isChanged);
+        CHECK((!isNull && !isChanged && std::string(str)=="third"))
+
+        r.ReadValue(cd->GetMemberIndex("MyBaseStringArray"), 4, str, isNull, isChanged);
+        CHECK((!isNull && isChanged && std::string(str)=="base"))
+
+        std::pair<const char*, DotsC_Int32> inner(static_cast<const char*>(NULL), 0);
+        r.ReadValue(cd->GetMemberIndex("MyItemVal"), 0, inner, isNull, isChanged);
+        CHECK((!isNull && !isChanged))
+        const Reader item(rep.get(), inner.first);
+        CHECK((item.TypeId()==itemTid))
+        item.ReadValue(icd->GetMemberIndex("MyNumber"), 0, i32, isNull, isChanged);
+        CHECK((!isNull && isChanged && i32==42))
+        item.ReadValue(icd->GetMemberIndex("MyStrings"), 3, str, isNull, isChanged);
+        CHECK((!isNull && !isChanged && std::string(str)=="inner"))
+    };
+
+    std::cout<<"Read protobuf blob, size "<<protobufBlob.size()<<std::endl;
+    checkEntity(&protobufBlob[0]);
+
+    const Reader r(rep.get(), &protobufBlob[0]);
+    BlobWriter<Safir::Dob::Typesystem::ToolSupport::TypeRepository> w(r);
+    std::vector<char> flatBlob(static_cast<size_t>(w.CalculateBlobSize()));
+    w.CopyRawBlob(&flatBlob[0]);
+    CHECK(Internal::Blob::IsFlat(&flatBlob[0]))
+
+    std::cout<<"Read flat blob written from it, size "<<flatBlob.size()<<std::endl;
+    checkEntity(&flatBlob[0]);
+
+    //A flat blob is read in place, an offset or length outside the blob must be rejected when it is read.
+    const size_t memberTableOffset=12+4+4;
+    const DotsC_MemberIndex stringMember=cd->GetMemberIndex("MyStringVal");
+    std::uint32_t stringMemberOffset=0;
+    memcpy(&stringMemberOffset, &flatBlob[memberTableOffset+4*static_cast<size_t>(stringMember)], 4);
+    CHECK((stringMemberOffset>1))
+    auto isRejected=[&rep, stringMember](const std::vector<char>& blob)
+    {
+        try
+        {
+            const Reader bad(rep.get(), &blob[0]);
+            const char* str=NULL;
+            bool isNull=true, isChanged=false;
+            bad.ReadValue(stringMember, 0, str, isNull, isChanged);
+        }
+        catch (const ParseError&)
+        {
+            return true;
+        }
+        return false;
+    };
+
+    std::vector<char> bad=flatBlob;
+    const std::uint32_t outside=static_cast<std::uint32_t>(bad.size());
+    memcpy(&bad[memberTableOffset+4*static_cast<size_t>(stringMember)], &outside, 4);
+    CHECK(isRejected(bad))
+
+    bad=flatBlob;
+    const std::int32_t tooManyMembers=1000;
+    memcpy(&bad[12+4], &tooManyMembers, 4);
+    CHECK(isRejected(bad))
+
+    //the string is the last field of the value, its length is right before the characters
+    bad=flatBlob;
+    const char* const protobufString="Protobuf string";
+    const std::vector<char>::iterator chars=std::search(bad.begin(), bad.end(), protobufString, protobufString+strlen(protobufString)+1);
+    CHECK((chars!=bad.end()))
+    const std::int32_t tooLong=static_cast<std::int32_t>(bad.end()-chars)+1;
+    memcpy(&*(chars-4), &tooLong, 4);
+    CHECK(isRejected(bad))
+
+    CHECK(!isRejected(flatBlob))
+    std::cout<<"========= Protobuf Blob Test Done ========"<<std::endl;
+}
+
+void JsonWriterTest(RepositoryPtr rep)
+{
+    std::cout<<"========= JSON Writer Test ========"<<std::endl;
+    const DotsC_TypeId tid=TypeUtilities::CalculateTypeId("BlobTest.MyEntity");
+    const ClassDescription* cd=rep->GetClass(tid);
+
+    //strings that must be escaped, and binaries of all lengths modulo 3 for the base64 padding
+    const char* strings[]={"a\"b\\c\nd", "\t\r\x01/\x1f", "\xc3\xa5\xc3\xa4\xc3\xb6"};
+    const std::string binaries[]={std::string("a", 1), std::string("\0\xff", 2), std::string("\xfb\xef\xbe", 3), std::string("abcd", 4)};
+
+    std::vector<char> blob;
+    {
+        BlobWriter<Safir::Dob::Typesystem::ToolSupport::TypeRepository> w(rep.get(), tid);
+        for (DotsC_Int32 i=0; i<3; ++i)
+        {
+            w.WriteValue(cd->GetMemberIndex("MyStringArray"), i, strings[i], false, true);
+            w.WriteValue(cd->GetMemberIndex("MyBinaryArray"), i, std::make_pair(binaries[i].c_str(), static_cast<DotsC_Int32>(binaries[i].size())), false, true);
+        }
+        w.WriteValue(cd->GetMemberIndex("MyBinaryVal"), 0, std::make_pair(binaries[3].c_str(), static_cast<DotsC_Int32>(binaries[3].size())), false, true);
+        w.WriteValue(cd->GetMemberIndex("MyInt64Val"), 0, std::numeric_limits<DotsC_Int64>::min(), false, true);
+        w.WriteValue(cd->GetMemberIndex("MyFloat64Val"), 0, DotsC_Float64(-0.1), false, true);
+        blob.resize(static_cast<size_t>(w.CalculateBlobSize()));
+        w.CopyRawBlob(&blob[0]);
+    }
+
+    //the json is appended to what is already in the string
+    std::string json("prefix");
+    BinaryToJson(rep.get(), &blob[0], json);
+    std::cout<<json<<std::endl;
+    CHECK((json.compare(0, 7, "prefix{")==0))
+    json.erase(0, 6);
+
+    std::ostringstream os;
+    BinaryToJson(rep.get(), &blob[0], os);
+    CHECK((os.str()==json))
+
+    //a buffer that is too small gets what fits and the size that is needed, a big enough one all of it
+    std::vector<char> buf(json.size()/2, '#');
+    Internal::JsonBufferWriter small(&buf[0], buf.size());
+    BinaryToJson(rep.get(), &blob[0], small);
+    CHECK((small.size()==json.size() && !small.fits()))
+    CHECK((json.compare(0, buf.size(), &buf[0], buf.size())==0))
+    buf.assign(small.size(), '#');
+    Internal::JsonBufferWriter big(&buf[0], buf.size());
+    BinaryToJson(rep.get(), &blob[0], big);
+    CHECK((big.fits() && std::string(buf.begin(), buf.end())==json))
+
+    CHECK((json.find("[\"a\\\"b\\\\c\\nd\",\"\\t\\r\\u0001/\\u001f\",\"\xc3\xa5\xc3\xa4\xc3\xb6\"]")!=std::string::npos))
+    CHECK((json.find("\"MyInt64Val\":-9223372036854775808")!=std::string::npos))
+    CHECK((json.find("\"MyFloat64Val\":-0.1,")!=std::string::npos))
+    for (size_t i=0; i<4; ++i)
+    {
+        CHECK((json.find("\""+Internal::SerializationUtils::ToBase64(binaries[i], false)+"\"")!=std::string::npos))
+    }
+
+    std::vector<char> roundtrip;
+    JsonToBinary(rep.get(), json.c_str(), roundtrip);
+    const BlobReader<Safir::Dob::Typesystem::ToolSupport::TypeRepository> r(rep.get(), &roundtrip[0]);
+    for (DotsC_Int32 i=0; i<3; ++i)
+    {
+        const char* str=NULL;
+        bool isNull=true, isChanged=false;
+        r.ReadValue(cd->GetMemberIndex("MyStringArray"), i, str, isNull, isChanged);
+        CHECK((!isNull && std::string(str)==strings[i]))
+    }
+    std::cout<<"========= JSON Writer Test Done ========"<<std::endl;
+}
+
+//Benchmark of converting a big object to JSON the way safir_websocket does for every entity
+//notification sent to a client, i.e. the JSON of the blob wrapped in a notification object.
+//The old way of doing it with string streams is compared to appending to a reused string, and to
+//writing into a buffer owned by the caller the way DotsC_BlobToJson does.
+void JsonBenchmark(RepositoryPtr rep, const boost::filesystem::path& xmlFile)
+{
+    std::cout<<"========= JSON Benchmark ========"<<std::endl;
+    std::ostringstream xml;
+    {
+        std::ifstream is(xmlFile.string().c_str());
+        xml<<is.rdbuf();
+    }
+    std::vector<char> blob;
+    XmlToBinary(rep.get(), xml.str().c_str(), blob);
+
+    const int iterations=20000;
+    std::string json;
+    auto reusedString=[&](int i)
+    {
+        json.clear();
+        json+="{\"instanceId\":";
+        json+=std::to_string(i);
+        json+=",\"entity\":";
+        BinaryToJson(rep.get(), &blob[0], json);
+        json+='}';
+        return json.size();
+    };
+    std::vector<char> buf(1000000);
+    auto callerBuffer=[&](int i)
+    {
+        Internal::JsonBufferWriter writer(&buf[0], buf.size());
+        writer+="{\"instanceId\":";
+        writer+=std::to_string(i).c_str();
+        writer+=",\"entity\":";
+        BinaryToJson(rep.get(), &blob[0], writer);
+        writer+='}';
+        return writer.size();
+    };
+    auto stringStreams=[&](int i)
+    {
+        std::ostringstream entity;
+        BinaryToJson(rep.get(), &blob[0], entity);
+        std::ostringstream notification;
+        notification<<"{\"instanceId\":"<<i<<",\"entity\":"<<entity.str()<<"}";
+        return notification.str().size();
+    };
+
+    reusedString(0); //let the string grow to its final size
+
+    double reusedStringAllocations=0;
+    for (int method=0; method<3; ++method)
+    {
+        size_t jsonSize=0;
+        const size_t allocationsBefore=NumberOfAllocations();
+        const boost::chrono::high_resolution_clock::time_point start=boost::chrono::high_resolution_clock::now();
+        for (int i=0; i<iterations; ++i)
+        {
+            jsonSize+=method==0 ? stringStreams(i) : method==1 ? reusedString(i) : callerBuffer(i);
+        }
+        const boost::chrono::duration<double, boost::micro> elapsed=boost::chrono::high_resolution_clock::now()-start;
+        const double allocations=static_cast<double>(NumberOfAllocations()-allocationsBefore)/iterations;
+
+        std::cout<<(method==0 ? "String streams: " : method==1 ? "Reused string:  " : "Caller buffer:  ")<<"blob of "<<blob.size()<<" bytes to "
+                 <<jsonSize/iterations<<" bytes of JSON: "<<elapsed.count()/iterations<<" us, "
+                 <<jsonSize/elapsed.count()<<" MB/s, "<<allocations<<" allocations"<<std::endl;
+        if (method==1)
+        {
+            reusedStringAllocations=allocations;
+        }
+    }
+
+    CHECK((reusedStringAllocations==0))
+    std::cout<<"========= JSON Benchmark Done ========"<<std::endl;
+}
+
 int main(int argc, char* argv[])
 {    
     //-----------------------------------------------------------
@@ -629,10 +1104,12 @@ int main(int argc, char* argv[])
     //-----------------------------------------------------------
     boost::filesystem::path douDir;  //= boost::filesystem::path("/home/joel/dev/safir_open/src/dots/dots_internal.ss/tests/dou_test_files");
     boost::filesystem::path testDir;
-    if (argc>2)
+    boost::filesystem::path protobufBlobFile;
+    if (argc>3)
     {
         douDir=boost::filesystem::path(argv[1]);
         testDir=boost::filesystem::path(argv[2]);
+        protobufBlobFile=boost::filesystem::path(argv[3]);
     }
     else
     {
@@ -655,6 +1132,11 @@ int main(int argc, char* argv[])
     BlobChangeTest(repository);
     BlobDiffTest(repository);
     BlobArraySizeDiff(repository);
+    BlobBenchmark(repository);
+    BlobAllocationTest(repository);
+    ProtobufBlobTest(repository, protobufBlobFile);
+    JsonWriterTest(repository);
+    JsonBenchmark(repository, testDir / "108.very_big.xml");
 
     std::cout<<"========= Repository ========"<<std::endl;
 
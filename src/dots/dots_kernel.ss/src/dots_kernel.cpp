@@ -570,16 +570,7 @@ DotsC_ParameterIndex DotsC_GetParameterId(const DotsC_TypeId typeId, const char*
         return -1;
     }
 
-    std::string name(parameterName);
-    for (int i=0; i<cd->GetNumberOfParameters(); ++i)
-    {
-        if (name==cd->GetParameter(i)->GetName())
-        {
-            return i;
-        }
-    }
-
-    return -1;
+    return cd->GetParameterIndex(parameterName);
 }
 
 void DotsC_GetParameterInfo(DotsC_TypeId typeId,
@@ -785,14 +776,10 @@ void DotsC_BlobToJson(char * const jsonDest,
                       DotsC_Int32 & resultSize)
 {
     Init();
-    std::ostringstream jsonStream;
-    ts::BinaryToJson(RepositoryKeeper::GetRepository(), blobSource, jsonStream);
-    std::string json=jsonStream.str();
-    resultSize=static_cast<DotsC_Int32>(json.size())+1; //add one char for null termination
-    if (resultSize <= bufSize)
-    {
-        strncpy(jsonDest, json.c_str(), resultSize);
-    }
+    ts::Internal::JsonBufferWriter json(jsonDest, static_cast<size_t>(std::max(bufSize, 0)));
+    ts::BinaryToJson(RepositoryKeeper::GetRepository(), blobSource, json);
+    json+='\0';
+    resultSize=static_cast<DotsC_Int32>(json.size()); //including null termination
 }
 
 void DotsC_JsonToBlob(char * & blobDest,
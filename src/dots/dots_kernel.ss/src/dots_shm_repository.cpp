@@ -21,7 +21,9 @@
 * along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
 *
 ******************************************************************************/
+#include <algorithm>
 #include <iostream>
+#include <set>
 #include <Safir/Utilities/Internal/SystemLog.h>
 #include "dots_shm_repository.h"
 
@@ -152,6 +154,7 @@ namespace Internal
                 }
             }
 
+            repository->IndexClasses();
         }
         catch (const boost::interprocess::interprocess_exception&e)
         {
@@ -171,6 +174,134 @@ namespace Internal
 
     }
 
+    void RepositoryShm::IndexClasses()
+    {
+        for (ClassMapShm::iterator it=m_classes.begin(); it!=m_classes.end(); ++it)
+        {
+            it->second.IndexNames();
+        }
+
+        //a power of two of at least four times the number of classes keeps almost all lookups at one probe
+        size_t numSlots=16;
+        while (numSlots<4*m_classes.size())
+        {
+            numSlots*=2;
+        }
+        m_classIndex.resize(numSlots);
+
+        const size_t mask=numSlots-1;
+        for (ClassMapShm::const_iterator it=m_classes.begin(); it!=m_classes.end(); ++it)
+        {
+            size_t slot=ClassHash(it->first)&mask;
+            while (m_classIndex[slot].cls)
+            {
+                slot=(slot+1)&mask;
+            }
+            m_classIndex[slot].typeId=it->first;
+            m_classIndex[slot].cls=&(it->second);
+        }
+    }
+
+    void ClassDescriptionShm::IndexNames()
+    {
+        //members in the order GetMemberIndex looks for them, own members before the inherited ones
+        std::vector<std::pair<std::string, int> > names;
+        for (const ClassDescriptionShm* cls=this; cls!=NULL; cls=cls->GetBaseClass())
+        {
+            for (int i=0; i<cls->GetNumberOfOwnMembers(); ++i)
+            {
+                const DotsC_MemberIndex index=cls->GetNumberOfInheritedMembers()+i;
+                names.push_back(std::make_pair(std::string(cls->GetMember(index)->GetName()), index));
+            }
+        }
+        m_memberIndex.Build(names);
+
+        names.clear();
+        for (int i=0; i<GetNumberOfParameters(); ++i)
+        {
+            names.push_back(std::make_pair(std::string(GetParameter(i)->GetName()), i));
+        }
+        m_parameterIndex.Build(names);
+    }
+
+    void NameIndexShm::Build(const std::vector<std::pair<std::string, int> >& names)
+    {
+        m_seeds.clear();
+        m_slots.clear();
+
+        std::vector<std::pair<std::uint64_t, int> > keys; //hash and index of each distinct name
+        std::set<std::string> distinct;
+        for (const auto& name : names)
+        {
+            if (distinct.insert(name.first).second)
+            {
+                keys.push_back(std::make_pair(Hash(name.first.c_str(), name.first.size()), name.second));
+            }
+        }
+        if (keys.empty())
+        {
+            return;
+        }
+
+        //Hash and displace: place the buckets with most names first, each with the first seed that puts
+        //all its names in free slots. About two names per bucket makes that quick.
+        const size_t numSlots=keys.size();
+        const size_t numBuckets=numSlots/2+1;
+        std::vector<std::vector<size_t> > buckets(numBuckets);
+        for (size_t i=0; i<keys.size(); ++i)
+        {
+            buckets[keys[i].first%numBuckets].push_back(i);
+        }
+
+        std::vector<size_t> order;
+        for (size_t b=0; b<numBuckets; ++b)
+        {
+            order.push_back(b);
+        }
+        std::stable_sort(order.begin(), order.end(), [&buckets](size_t a, size_t b){return buckets[a].size()>buckets[b].size();});
+
+        const std::uint32_t maxSeed=100000; //only reached if two names have the same hash
+        std::vector<std::uint32_t> seeds(numBuckets, 0);
+        std::vector<int> slots(numSlots, -1);
+        std::vector<size_t> taken;
+        for (size_t b : order)
+        {
+            const std::vector<size_t>& bucket=buckets[b];
+            std::uint32_t seed=0;
+            for (; seed<maxSeed; ++seed)
+            {
+                taken.clear();
+                for (size_t key : bucket)
+                {
+                    const size_t slot=Slot(keys[key].first, seed, numSlots);
+                    if (slots[slot]!=-1 || std::find(taken.begin(), taken.end(), slot)!=taken.end())
+                    {
+                        break;
+                    }
+                    taken.push_back(slot);
+                }
+                if (taken.size()==bucket.size())
+                {
+                    break;
+                }
+            }
+
+            if (seed==maxSeed)
+            {
+                return;
+            }
+
+            seeds[b]=seed;
+            for (size_t i=0; i<bucket.size(); ++i)
+            {
+                slots[taken[i]]=keys[bucket[i]].second;
+            }
+        }
+
+        m_seeds.assign(seeds.begin(), seeds.end());
+        m_slots.assign(slots.begin(), slots.end());
+    }
+
     ParameterDescriptionShm::ParameterDescriptionShm(const ParameterDescription* pd, boost::interprocess::managed_shared_memory* shm)
         :m_name(pd->GetName(), shm->get_segment_manager())
         ,m_qualifiedName(pd->GetQualifiedName(), shm->get_segment_manager())
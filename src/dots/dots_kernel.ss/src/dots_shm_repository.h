@@ -26,6 +26,10 @@
 
 #include <Safir/Dob/Typesystem/ToolSupport/TypeParser.h>
 #include <Safir/Dob/Typesystem/ToolSupport/TypeUtilities.h>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
 
 #ifdef _MSC_VER
 #  pragma warning(push)
@@ -85,6 +89,65 @@ namespace Internal
     typedef boost::interprocess::basic_string<char, std::char_traits<char>, boost::interprocess::allocator<char, boost::interprocess::managed_shared_memory::segment_manager> > StringShm;
     typedef VectorShm<StringShm>::Type StringVectorShm;
 
+    //-------------------------------------------
+    //NameIndexShm
+    //-------------------------------------------
+    /**
+     * Minimal perfect hash table from names to indices, built once when the repository is copied into
+     * shared memory. The hash of a name selects a bucket, and the seed of the bucket selects the slot
+     * that holds the index, so a lookup is one hash of the name and one string compare whatever the
+     * number of names. If no perfect hash is found the table is left empty, and the owner falls back
+     * on a linear search.
+     */
+    class NameIndexShm
+    {
+    public:
+        explicit NameIndexShm(boost::interprocess::managed_shared_memory::segment_manager* segmentManager)
+            :m_seeds(segmentManager)
+            ,m_slots(segmentManager)
+        {
+        }
+
+        //Build the table from names and their indices. If a name occurs more than once it gets the first index.
+        void Build(const std::vector<std::pair<std::string, int> >& names);
+
+        bool IsBuilt() const {return !m_slots.empty();}
+
+        //Returns the index of a name, or -1 if it is not in the table. nameOf(index) must return the name of an index.
+        template <class NameOf>
+        int Find(const char* name, size_t length, const NameOf& nameOf) const
+        {
+            const std::uint64_t hash=Hash(name, length);
+            const int index=m_slots[Slot(hash, m_seeds[hash%m_seeds.size()], m_slots.size())];
+            const char* candidate=nameOf(index);
+            return std::strncmp(candidate, name, length)==0 && candidate[length]=='\0' ? index : -1;
+        }
+
+    private:
+        static std::uint64_t Hash(const char* name, size_t length)
+        {
+            //FNV-1a
+            std::uint64_t hash=14695981039346656037ULL;
+            for (size_t i=0; i<length; ++i)
+            {
+                hash=(hash^static_cast<unsigned char>(name[i]))*1099511628211ULL;
+            }
+            return hash;
+        }
+
+        static size_t Slot(std::uint64_t hash, std::uint32_t seed, size_t numSlots)
+        {
+            //the finalizer of splitmix64, on the hash displaced by the seed
+            std::uint64_t x=hash+seed*0x9e3779b97f4a7c15ULL;
+            x=(x^(x>>30))*0xbf58476d1ce4e5b9ULL;
+            x=(x^(x>>27))*0x94d049bb133111ebULL;
+            return static_cast<size_t>((x^(x>>31))%numSlots);
+        }
+
+        VectorShm<std::uint32_t>::Type m_seeds;
+        VectorShm<std::int32_t>::Type m_slots;
+    };
+
     //-------------------------------------------
     //MemberDescriptionShm
     //-------------------------------------------
@@ -164,11 +227,15 @@ namespace Internal
             ,m_name(ed->GetName(), shm->get_segment_manager())
             ,m_enumerationValues(shm->get_segment_manager())
             ,m_checksum(ed->GetChecksum())
+            ,m_valueIndex(shm->get_segment_manager())
         {
+            std::vector<std::pair<std::string, int> > names;
             for (int i=0; i<ed->GetNumberOfValues(); ++i)
             {
                 m_enumerationValues.push_back(StringShm(ed->GetValueName(i), shm->get_segment_manager()));
+                names.push_back(std::make_pair(std::string(ed->GetValueName(i)), i));
             }
+            m_valueIndex.Build(names);
         }
 
         const char* FileName() const {return m_file.c_str();}
@@ -178,7 +245,17 @@ namespace Internal
         DotsC_TypeId GetChecksum() const {return m_checksum;}
         int GetNumberOfValues() const {return static_cast<int>(m_enumerationValues.size());}
         const char* GetValueName(DotsC_EnumerationValue val) const {return m_enumerationValues[static_cast<size_t>(val)].c_str();}
-        int GetIndexOfValue(const std::string& valueName) const {return TypeUtilities::GetIndexOfEnumValue(this, valueName);}
+        int GetIndexOfValue(const std::string& valueName) const //Supports short name and fully qualified name
+        {
+            if (!m_valueIndex.IsBuilt())
+            {
+                return TypeUtilities::GetIndexOfEnumValue(this, valueName);
+            }
+
+            const size_t pos=valueName.rfind('.');
+            const size_t start=pos==std::string::npos ? 0 : pos+1;
+            return m_valueIndex.Find(valueName.c_str()+start, valueName.size()-start, [this](int index){return GetValueName(index);});
+        }
 
     private:
         DotsC_TypeId m_typeId;
@@ -186,6 +263,7 @@ namespace Internal
         StringShm m_name;
         StringVectorShm m_enumerationValues;
         DotsC_TypeId m_checksum;
+        NameIndexShm m_valueIndex;
     };
     typedef MapShm<EnumDescriptionShm>::Type EnumMapShm;
 
@@ -560,6 +638,8 @@ namespace Internal
             ,m_properties(shm->get_segment_manager())
             ,m_ownParameters(shm->get_segment_manager())
             ,m_checksum(cd->GetChecksum())
+            ,m_memberIndex(shm->get_segment_manager())
+            ,m_parameterIndex(shm->get_segment_manager())
         {
             int totalNumMembers=cd->GetNumberOfMembers();
             int startOwnMembers=totalNumMembers-cd->GetNumberOfOwnMembers();
@@ -582,6 +662,11 @@ namespace Internal
 
         DotsC_MemberIndex GetMemberIndex(const std::string& memberName) const
         {
+            if (m_memberIndex.IsBuilt())
+            {
+                return m_memberIndex.Find(memberName.c_str(), memberName.size(), [this](int index){return GetMember(index)->GetName();});
+            }
+
             for (MemberDescriptionVectorShm::const_iterator it=m_members.begin(); it!=m_members.end(); ++it)
             {
                 if (it->GetName()==memberName)
@@ -624,6 +709,23 @@ namespace Internal
             return m_ownParameters[index-numInherited].get();
         }
 
+        DotsC_ParameterIndex GetParameterIndex(const std::string& parameterName) const
+        {
+            if (m_parameterIndex.IsBuilt())
+            {
+                return m_parameterIndex.Find(parameterName.c_str(), parameterName.size(), [this](int index){return GetParameter(index)->GetName();});
+            }
+
+            for (int i=0; i<GetNumberOfParameters(); ++i)
+            {
+                if (parameterName==GetParameter(i)->GetName())
+                {
+                    return i;
+                }
+            }
+            return -1;
+        }
+
         void GetPropertyIds(std::set<DotsC_TypeId>& propertyIds) const
         {
             if (m_base)
@@ -667,6 +769,10 @@ namespace Internal
         void AddPropertyMapping(const PropertyMappingDescriptionShm& property) {m_properties.push_back(property);}
 
         DotsC_Int64 GetChecksum() const {return m_checksum;}
+
+        //build the name lookup tables, when the base classes have been set up
+        void IndexNames();
+
     private:
         DotsC_TypeId m_typeId;
         StringShm m_file;
@@ -679,9 +785,21 @@ namespace Internal
         ParameterPtrVectorShm m_ownParameters;
 
         DotsC_Int64 m_checksum;
+        NameIndexShm m_memberIndex;
+        NameIndexShm m_parameterIndex;
     };
     typedef MapShm<ClassDescriptionShm>::Type ClassMapShm;
 
+    //slot in the open addressing hash table of classes in RepositoryShm, empty if cls is null
+    struct ClassSlotShm
+    {
+        ClassSlotShm():typeId(0) {}
+
+        DotsC_TypeId typeId;
+        ClassDescriptionShmPtr cls;
+    };
+    typedef VectorShm<ClassSlotShm>::Type ClassIndexShm;
+
     class RepositoryShm
     {
     public:
@@ -704,6 +822,7 @@ namespace Internal
             ,m_properties(std::less<const DotsC_TypeId>(), shm->get_segment_manager())
             ,m_exceptions(std::less<const DotsC_TypeId>(), shm->get_segment_manager())
             ,m_params(std::less<const StringShm>(), shm->get_segment_manager())
+            ,m_classIndex(shm->get_segment_manager())
         {
         }
 
@@ -718,7 +837,24 @@ namespace Internal
         void GetAllPropertyTypeIds(std::set<DotsC_TypeId>& typeIds) const {GetKeys<PropertyDescriptionShm>(m_properties, typeIds);}
 
         //Classes
-        const ClassDescriptionShm* GetClass(DotsC_TypeId typeId) const {return GetPtr<ClassDescriptionShm>(m_classes, typeId);}
+        const ClassDescriptionShm* GetClass(DotsC_TypeId typeId) const
+        {
+            if (m_classIndex.empty())
+            {
+                return GetPtr<ClassDescriptionShm>(m_classes, typeId);
+            }
+
+            const size_t mask=m_classIndex.size()-1;
+            for (size_t slot=ClassHash(typeId)&mask; m_classIndex[slot].cls; slot=(slot+1)&mask)
+            {
+                if (m_classIndex[slot].typeId==typeId)
+                {
+                    return m_classIndex[slot].cls.get();
+                }
+            }
+            return NULL;
+        }
+
         int GetNumberOfClasses() const {return static_cast<int>(m_classes.size());}
         void GetAllClassTypeIds(std::set<DotsC_TypeId>& typeIds) const {GetKeys<ClassDescriptionShm>(m_classes, typeIds);}
 
@@ -729,6 +865,16 @@ namespace Internal
 
     private:
 
+        //build the name lookup tables of the classes and the hash table used by GetClass
+        void IndexClasses();
+
+        static size_t ClassHash(DotsC_TypeId typeId)
+        {
+            //type ids are hashes of the type names, just fold the high bits into the low ones
+            const std::uint64_t id=static_cast<std::uint64_t>(typeId);
+            return static_cast<size_t>(id^(id>>32));
+        }
+
         template <class Val>
         static const Val* GetPtr(const typename MapShm<Val>::Type& m, DotsC_TypeId key)
         {
@@ -754,6 +900,7 @@ namespace Internal
         PropertyMapShm m_properties;
         ExceptionMapShm m_exceptions;
         ParameterMapShm m_params;
+        ClassIndexShm m_classIndex;
     };
 }
 
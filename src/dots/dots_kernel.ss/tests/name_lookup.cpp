@@ -0,0 +1,194 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+
+//Test and benchmark of the name lookup tables of the shared memory repository. A class with 200
+//members and a subclass of it are generated, and member, parameter and enumeration value lookups
+//in the shared memory repository are checked against the local repository. Then JSON to binary
+//conversion of an object with all 200 members set is timed.
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <Safir/Utilities/Internal/ConfigReader.h>
+#include <Safir/Dob/Typesystem/ToolSupport/Serialization.h>
+#include "../src/dots_shm_repository.h"
+
+namespace
+{
+    const int NUM_MEMBERS=200;
+    const int NUM_SUB_MEMBERS=10;
+    const int NUM_PARAMETERS=20;
+    const int NUM_ENUM_VALUES=50;
+
+    std::string MemberName(int i) {return "Member" + std::to_string(i);}
+
+    const char* MemberType(int i)
+    {
+        switch (i%4)
+        {
+        case 0: return "Int32";
+        case 1: return "Float64";
+        case 2: return "String";
+        default: return "DotsTest.BigEnum";
+        }
+    }
+
+    void WriteDou(const boost::filesystem::path& dir)
+    {
+        std::ofstream enumeration((dir / "DotsTest.BigEnum.dou").string().c_str());
+        enumeration<<"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+                   <<"<enumeration xmlns=\"urn:safir-dots-unit\" xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\">\n"
+                   <<"  <name>DotsTest.BigEnum</name>\n  <values>\n";
+        for (int i=0; i<NUM_ENUM_VALUES; ++i)
+        {
+            enumeration<<"    <value>Value"<<i<<"</value>\n";
+        }
+        enumeration<<"  </values>\n</enumeration>\n";
+
+        std::ofstream cls((dir / "DotsTest.BigClass.dou").string().c_str());
+        cls<<"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+           <<"<class xmlns=\"urn:safir-dots-unit\" xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\">\n"
+           <<"  <name>DotsTest.BigClass</name>\n  <baseClass>Object</baseClass>\n  <parameters>\n";
+        for (int i=0; i<NUM_PARAMETERS; ++i)
+        {
+            cls<<"    <parameter><name>Parameter"<<i<<"</name><type>Int32</type><value>"<<i<<"</value></parameter>\n";
+        }
+        cls<<"  </parameters>\n  <members>\n";
+        for (int i=0; i<NUM_MEMBERS; ++i)
+        {
+            cls<<"    <member><name>"<<MemberName(i)<<"</name><type>"<<MemberType(i)<<"</type>"
+               <<(i%4==2 ? "<maxLength>50</maxLength>" : "")<<"</member>\n";
+        }
+        cls<<"  </members>\n</class>\n";
+
+        std::ofstream sub((dir / "DotsTest.BigSubClass.dou").string().c_str());
+        sub<<"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+           <<"<class xmlns=\"urn:safir-dots-unit\" xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\">\n"
+           <<"  <name>DotsTest.BigSubClass</name>\n  <baseClass>DotsTest.BigClass</baseClass>\n  <members>\n";
+        for (int i=0; i<NUM_SUB_MEMBERS; ++i)
+        {
+            sub<<"    <member><name>SubMember"<<i<<"</name><type>Int64</type></member>\n";
+        }
+        sub<<"  </members>\n</class>\n";
+    }
+
+    template <class ClassT>
+    bool CheckClass(const ClassT* local, const Safir::Dob::Typesystem::Internal::ClassDescriptionShm* shm)
+    {
+        for (int i=0; i<local->GetNumberOfMembers(); ++i)
+        {
+            const std::string name=local->GetMember(i)->GetName();
+            if (shm->GetMemberIndex(name)!=local->GetMemberIndex(name))
+            {
+                std::wcout<<"GetMemberIndex differs for "<<name.c_str()<<std::endl;
+                return false;
+            }
+        }
+
+        for (int i=0; i<local->GetNumberOfParameters(); ++i)
+        {
+            if (shm->GetParameterIndex(local->GetParameter(i)->GetName())!=i)
+            {
+                std::wcout<<"GetParameterIndex failed for "<<local->GetParameter(i)->GetName()<<std::endl;
+                return false;
+            }
+        }
+
+        if (shm->GetMemberIndex("NoSuchMember")!=-1 || shm->GetMemberIndex("")!=-1 || shm->GetMemberIndex("Member1x")!=-1 ||
+            shm->GetParameterIndex("NoSuchParameter")!=-1)
+        {
+            std::wcout<<"Unknown names are not handled correctly"<<std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    const boost::filesystem::path dir=boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(dir);
+    WriteDou(dir);
+
+    std::shared_ptr<const Safir::Dob::Typesystem::ToolSupport::TypeRepository> local=Safir::Dob::Typesystem::ToolSupport::ParseTypeDefinitions(dir);
+    boost::filesystem::remove_all(dir);
+
+    const std::string shmName("SAFIR_DOTS_SHM_NAME_LOOKUP_TEST" + Safir::Utilities::Internal::Expansion::GetSafirInstanceSuffix());
+    boost::interprocess::shared_memory_object::remove(shmName.c_str());
+    boost::interprocess::managed_shared_memory sharedMemory(boost::interprocess::create_only, shmName.c_str(), 5000000);
+    Safir::Dob::Typesystem::Internal::RepositoryShm::CreateShmCopyOfRepository(*local, "NameLookupTestRepository", sharedMemory);
+    const Safir::Dob::Typesystem::Internal::RepositoryShm* shm=sharedMemory.find<Safir::Dob::Typesystem::Internal::RepositoryShm>("NameLookupTestRepository").first;
+
+    const DotsC_TypeId bigClass=TypeUtilities::CalculateTypeId("DotsTest.BigClass");
+    const DotsC_TypeId bigSubClass=TypeUtilities::CalculateTypeId("DotsTest.BigSubClass");
+    const DotsC_TypeId bigEnum=TypeUtilities::CalculateTypeId("DotsTest.BigEnum");
+
+    bool ok=CheckClass(local->GetClass(bigClass), shm->GetClass(bigClass)) &&
+            CheckClass(local->GetClass(bigSubClass), shm->GetClass(bigSubClass));
+
+    const Safir::Dob::Typesystem::Internal::EnumDescriptionShm* ed=shm->GetEnum(bigEnum);
+    for (int i=0; i<NUM_ENUM_VALUES && ok; ++i)
+    {
+        const std::string value="Value" + std::to_string(i);
+        ok=ed->GetIndexOfValue(value)==i && ed->GetIndexOfValue("DotsTest.BigEnum." + value)==i;
+    }
+    ok=ok && ed->GetIndexOfValue("NoSuchValue")==-1;
+    if (!ok)
+    {
+        std::wcout<<"Lookups in the shared memory repository are wrong!"<<std::endl;
+        boost::interprocess::shared_memory_object::remove(shmName.c_str());
+        return 1;
+    }
+
+    //an object with all members set
+    std::ostringstream json;
+    json<<"{\"_DouType\": \"DotsTest.BigClass\"";
+    for (int i=0; i<NUM_MEMBERS; ++i)
+    {
+        json<<", \""<<MemberName(i)<<"\": ";
+        switch (i%4)
+        {
+        case 0: json<<i; break;
+        case 1: json<<i<<".5"; break;
+        case 2: json<<"\"string "<<i<<"\""; break;
+        default: json<<"\"Value"<<i%NUM_ENUM_VALUES<<"\""; break;
+        }
+    }
+    json<<"}";
+    const std::string jsonString=json.str();
+
+    const int iterations=2000;
+    std::vector<char> binary;
+    const auto start=std::chrono::steady_clock::now();
+    for (int i=0; i<iterations; ++i)
+    {
+        Safir::Dob::Typesystem::ToolSupport::JsonToBinary(shm, jsonString.c_str(), binary);
+    }
+    const std::chrono::duration<double, std::micro> elapsed=std::chrono::steady_clock::now()-start;
+
+    std::wcout<<"JsonToBinary of a "<<NUM_MEMBERS<<" member object: "<<elapsed.count()/iterations<<" us, "
+              <<iterations/elapsed.count()*1e6<<" objects/s"<<std::endl;
+
+    boost::interprocess::shared_memory_object::remove(shmName.c_str());
+    return 0;
+}
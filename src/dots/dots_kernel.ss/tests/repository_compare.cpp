@@ -7,6 +7,7 @@
 *******************************************************************************/
 #include <iostream>
 #include <algorithm>
+#include <chrono>
 #include <set>
 #include <Safir/Utilities/Internal/ConfigReader.h>
 #include <Safir/Dob/Typesystem/ToolSupport/Serialization.h>
@@ -67,6 +68,72 @@ int main(int argc, char* argv[])
         std::wcout<<"Passed!"<<std::endl;
     }
 
+    //GetClass of the shared repository uses a hash table, IsOfType over it must agree with the local repository
+    std::set<DotsC_TypeId> classIds;
+    local->GetAllClassTypeIds(classIds);
+    std::vector<DotsC_TypeId> classes(classIds.begin(), classIds.end());
+    for (DotsC_TypeId type : classes)
+    {
+        if (shm->GetClass(type)==NULL || shm->GetClass(type)->GetTypeId()!=type)
+        {
+            std::wcout<<"GetClass failed for "<<local->GetClass(type)->GetName()<<std::endl;
+            return 1;
+        }
+
+        for (DotsC_TypeId ofType : classes)
+        {
+            if (Safir::Dob::Typesystem::ToolSupport::TypeUtilities::IsOfType(shm, type, ofType)!=
+                Safir::Dob::Typesystem::ToolSupport::TypeUtilities::IsOfType(local.get(), type, ofType))
+            {
+                std::wcout<<"IsOfType differs for "<<local->GetClass(type)->GetName()<<" and "<<local->GetClass(ofType)->GetName()<<std::endl;
+                return 1;
+            }
+        }
+    }
+    if (shm->GetClass(4711)!=NULL ||
+        Safir::Dob::Typesystem::ToolSupport::TypeUtilities::IsOfType(shm, 4711, classes[0]) ||
+        Safir::Dob::Typesystem::ToolSupport::TypeUtilities::IsOfType(shm, classes[0], 4711))
+    {
+        std::wcout<<"Unknown type ids are not handled correctly"<<std::endl;
+        return 1;
+    }
+
+    //Benchmark of IsOfType on random pairs of classes, walking the base classes in the shared and in the local repository
+    std::vector<std::pair<DotsC_TypeId, DotsC_TypeId> > pairs;
+    unsigned int random=4711;
+    for (int i=0; i<1000000; ++i)
+    {
+        random=random*1664525+1013904223;
+        const size_t type=(random>>8)%classes.size();
+        random=random*1664525+1013904223;
+        const size_t ofType=(random>>8)%classes.size();
+        pairs.push_back(std::make_pair(classes[type], classes[ofType]));
+    }
+
+    int shmCount=0;
+    auto start=std::chrono::steady_clock::now();
+    for (const auto& p : pairs)
+    {
+        shmCount+=Safir::Dob::Typesystem::ToolSupport::TypeUtilities::IsOfType(shm, p.first, p.second) ? 1 : 0;
+    }
+    const std::chrono::duration<double, std::nano> shmTime=std::chrono::steady_clock::now()-start;
+
+    int localCount=0;
+    start=std::chrono::steady_clock::now();
+    for (const auto& p : pairs)
+    {
+        localCount+=Safir::Dob::Typesystem::ToolSupport::TypeUtilities::IsOfType(local.get(), p.first, p.second) ? 1 : 0;
+    }
+    const std::chrono::duration<double, std::nano> localTime=std::chrono::steady_clock::now()-start;
+
+    std::wcout<<classes.size()<<" classes, IsOfType in the shared repository: "<<shmTime.count()/pairs.size()
+              <<" ns, in the local repository: "<<localTime.count()/pairs.size()<<" ns"<<std::endl;
+    if (shmCount!=localCount)
+    {
+        std::wcout<<"IsOfType results differ!"<<std::endl;
+        return 1;
+    }
+
 
 
     return 0;
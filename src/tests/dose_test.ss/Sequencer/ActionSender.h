@@ -218,6 +218,7 @@ private:
         case DoseTest::ActionEnum::ServiceRequest:
         case DoseTest::ActionEnum::SetAll:
         case DoseTest::ActionEnum::SetChanges:
+        case DoseTest::ActionEnum::SetChangesBatch:
         case DoseTest::ActionEnum::UnregisterHandler:
         case DoseTest::ActionEnum::UpdateRequest:
         case DoseTest::ActionEnum::ResumePostponed:
@@ -55,6 +55,7 @@ bool CommandLine::Parse(int argc, char* argv[])
             ("num-instances,i", po::value<int>()->default_value(1),"Number of instances to use")
             ("sleep-time,t", po::value<int>()->default_value(0), "The time to sleep between each Set/Read \n(in milliseconds)")
             ("batch-size,b", po::value<int>()->default_value(1), "The number of entities to set between \neach sleep")
+            ("owners,O", po::value<int>()->default_value(1), "Number of concurrent owners, each with its own\nthread, connection, handler and instances")
             ("attach-payload,p","Put the DefaultPayload defined in the\nRootEntity dou file into the Payload member.");
             ;
 
@@ -71,6 +72,7 @@ bool CommandLine::Parse(int argc, char* argv[])
         m_sleepTime = m_variablesMap["sleep-time"].as<int>();
         m_batchSize = m_variablesMap["batch-size"].as<int>();
         m_numInstances = m_variablesMap["num-instances"].as<int>();
+        m_numOwners = m_variablesMap["owners"].as<int>();
         if (m_variablesMap.count("help"))
         {
             std::wcout << all << std::endl;
@@ -50,6 +50,7 @@ public:
     bool NoSleep() const {return m_noSleep;}
     int NumInstances() const {return m_numInstances;}
     int BatchSize() const {return m_batchSize;}
+    int NumOwners() const {return m_numOwners;}
 
     bool AttachPayload() const {return m_variablesMap.count("attach-payload") != 0;}
 
@@ -72,6 +73,7 @@ private:
     bool m_noSleep;
     int m_numInstances;
     int m_batchSize;
+    int m_numOwners;
 
     //subscriber options
     bool m_changeInfo;
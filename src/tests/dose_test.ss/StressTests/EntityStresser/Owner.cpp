@@ -32,8 +32,27 @@
 #include <DoseStressTest/EntityWithoutAckLarge.h>
 #include <boost/lexical_cast.hpp>
 
-Owner::Owner():
-    m_setStat(StatisticsCollection::Instance().AddHzCollector(L"Set Entity")),
+namespace
+{
+    HzCollector* AddSetCollector(const int ownerIndex)
+    {
+        if (CommandLine::Instance().NumOwners() <= 1)
+        {
+            return StatisticsCollection::Instance().AddHzCollector(L"Set Entity");
+        }
+
+        //the owners are started in parallel threads
+        static boost::mutex mutex;
+        boost::lock_guard<boost::mutex> lock(mutex);
+        return StatisticsCollection::Instance().AddHzCollector
+            (L"Set Entity (owner " + boost::lexical_cast<std::wstring>(ownerIndex) + L")");
+    }
+}
+
+Owner::Owner(const int ownerIndex):
+    m_setStat(AddSetCollector(ownerIndex)),
+    m_handlerId(ownerIndex == 0 ? Safir::Dob::Typesystem::HandlerId() : Safir::Dob::Typesystem::HandlerId(ownerIndex)),
+    m_firstInstance(ownerIndex * CommandLine::Instance().NumInstances()),
     m_nextInstance(0)
 {
     m_connection.Attach();
@@ -82,13 +101,14 @@ Owner::Owner():
     std::wcout << "Using an entity of size " << CalculateBlobSize(m_entity) << " bytes" << std::endl;
     if (CommandLine::Instance().NumInstances() != 0)
     {
-        std::wcout << "Using instances '0' .. '" << CommandLine::Instance().NumInstances() -1 << "'." << std::endl;
+        std::wcout << "Using instances '" << m_firstInstance << "' .. '"
+                   << m_firstInstance + CommandLine::Instance().NumInstances() -1 << "'." << std::endl;
     }
     else
     {
-        std::wcout << "Using instance '0'" << std::endl;
+        std::wcout << "Using instance '" << m_firstInstance << "'" << std::endl;
     }
-    m_connection.RegisterEntityHandlerInjection(m_entity->GetTypeId(),Safir::Dob::Typesystem::HandlerId(), Safir::Dob::InstanceIdPolicy::HandlerDecidesInstanceId,this);
+    m_connection.RegisterEntityHandlerInjection(m_entity->GetTypeId(),m_handlerId, Safir::Dob::InstanceIdPolicy::HandlerDecidesInstanceId,this);
 }
 
 void Owner::Set()
@@ -102,8 +122,8 @@ void Owner::Set()
     }
 
     m_connection.SetAll(m_entity,
-                        Safir::Dob::Typesystem::InstanceId(boost::lexical_cast<std::wstring>(m_nextInstance)),
-                        Safir::Dob::Typesystem::HandlerId());
+                        Safir::Dob::Typesystem::InstanceId(boost::lexical_cast<std::wstring>(m_firstInstance + m_nextInstance)),
+                        m_handlerId);
     m_setStat->Tick();
     /*
     try
@@ -34,7 +34,8 @@ class Owner :
     public Safir::Dob::EntityHandlerInjection
 {
 public:
-    Owner();
+    //Owners with different index use different handlers and instances
+    explicit Owner(const int ownerIndex = 0);
 
     void Set();
 
@@ -57,6 +58,8 @@ protected:
     HzCollector * m_setStat;
 
     DoseStressTest::RootEntityPtr m_entity;
+    const Safir::Dob::Typesystem::HandlerId m_handlerId;
+    const int m_firstInstance;
     int m_nextInstance;
 };
 
@@ -39,6 +39,67 @@
 
 #include <Safir/Dob/OverflowException.h>
 
+namespace
+{
+    void OpenConnection(Safir::Dob::Connection& connection, SimpleDispatcher& dispatcher, const std::wstring& name)
+    {
+        for(int instance = 0;;++instance)
+        {
+            try
+            {
+                connection.Open(name,
+                                boost::lexical_cast<std::wstring>(instance),
+                                0, // Context
+                                &dispatcher,
+                                &dispatcher);
+                break;
+            }
+            catch(const Safir::Dob::NotOpenException &)
+            {
+
+            }
+        }
+
+        std::wcout << "Started as " << Safir::Dob::ConnectionAspectMisc(connection).GetConnectionName() << std::endl;
+    }
+
+    void RunOwner(Safir::Dob::Connection& connection, SimpleDispatcher& dispatcher, const int ownerIndex)
+    {
+        Owner owner(ownerIndex);
+        for (;;)
+        {
+            if (!CommandLine::Instance().NoSleep())
+            {
+                const bool dispatch = dispatcher.Wait(CommandLine::Instance().SleepTime());
+                if (dispatch)
+                {
+                    connection.Dispatch();
+                }
+            }
+            for (int i = 0; i < CommandLine::Instance().BatchSize(); ++i)
+            {
+                owner.Set();
+            }
+        }
+    }
+
+    void OwnerThread(const int ownerIndex)
+    {
+        try
+        {
+            Safir::Dob::Connection connection;
+            SimpleDispatcher dispatcher(connection);
+            OpenConnection(connection, dispatcher, L"EntityOwner");
+            RunOwner(connection, dispatcher, ownerIndex);
+        }
+        catch(const std::exception & e)
+        {
+            std::wcout << "Owner " << ownerIndex << " caught std::exception! Contents of exception is:" << std::endl
+                << e.what()<<std::endl;
+        }
+    }
+}
+
 int main(int argc, char* argv[])
 {
     if(!CommandLine::Instance().Parse(argc,argv))
@@ -66,44 +127,19 @@ int main(int argc, char* argv[])
         }
 
 
-        for(int instance = 0;;++instance)
-        {
-            try
-            {
-                connection.Open(name,
-                                boost::lexical_cast<std::wstring>(instance),
-                                0, // Context
-                                &dispatcher,
-                                &dispatcher);
-                break;
-            }
-            catch(const Safir::Dob::NotOpenException &)
-            {
-
-            }
-        }
-
-        std::wcout << "Started as " << Safir::Dob::ConnectionAspectMisc(connection).GetConnectionName() << std::endl;
+        OpenConnection(connection, dispatcher, name);
 
         bool done = false;
         if (CommandLine::Instance().Owner())
         {
-            Owner owner;
-            while (!done)
+            //owner 0 uses this thread, the others get a thread and a connection each
+            boost::thread_group owners;
+            for (int ownerIndex = 1; ownerIndex < CommandLine::Instance().NumOwners(); ++ownerIndex)
             {
-                if (!CommandLine::Instance().NoSleep())
-                {
-                    const bool dispatch = dispatcher.Wait(CommandLine::Instance().SleepTime());
-                    if (dispatch)
-                    {
-                        connection.Dispatch();
-                    }
-                }
-                for (int i = 0; i < CommandLine::Instance().BatchSize(); ++i)
-                {
-                    owner.Set();
-                }
+                owners.create_thread([ownerIndex]{OwnerThread(ownerIndex);});
             }
+
+            RunOwner(connection, dispatcher, 0);
         }
         else if (CommandLine::Instance().Subscriber())
         {
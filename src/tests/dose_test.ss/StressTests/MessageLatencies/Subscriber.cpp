@@ -40,6 +40,8 @@ Subscriber::Subscriber():
     m_missedWithAckLargeStat(StatisticsCollection::Instance().AddPercentageCollector(L"Missed", m_receivedWithAckLargeStat)),
     m_receivedWithoutAckLargeStat(StatisticsCollection::Instance().AddHzCollector(L"Received Without Ack Large")),
     m_missedWithoutAckLargeStat(StatisticsCollection::Instance().AddPercentageCollector(L"Missed",m_receivedWithoutAckLargeStat)),
+    m_receiveGapStat(StatisticsCollection::Instance().AddLatencyCollector(L"Receive gap")),
+    m_receivedAny(false),
     m_lastSequenceNumberWithAck(-1),
     m_lastSequenceNumberWithoutAck(-1),
     m_lastSequenceNumberWithAckLarge(-1),
@@ -57,6 +59,13 @@ void Subscriber::OnMessage(Safir::Dob::MessageProxy messageProxy)
     DoseStressTest::RootMessagePtr rootMsg =
         std::static_pointer_cast<DoseStressTest::RootMessage>(messageProxy.GetMessage());
 
+    if (m_receivedAny)
+    {
+        m_receiveGapStat->End();
+    }
+    m_receiveGapStat->Begin();
+    m_receivedAny = true;
+
     switch (rootMsg->GetTypeId())
     {
     case DoseStressTest::MessageWithAckLarge::ClassTypeId:
@@ -53,6 +53,11 @@ private:
     HzCollector * m_receivedWithoutAckLargeStat;
     PercentageCollector * m_missedWithoutAckLargeStat;
 
+    //time between two consecutive messages, the tail shows how long it takes for the
+    //receiving side to resume after it has been overloaded.
+    LatencyCollector * m_receiveGapStat;
+    bool m_receivedAny;
+
     Safir::Dob::Typesystem::Int32 m_lastSequenceNumberWithAck;
     Safir::Dob::Typesystem::Int32 m_lastSequenceNumberWithoutAck;
     Safir::Dob::Typesystem::Int32 m_lastSequenceNumberWithAckLarge;
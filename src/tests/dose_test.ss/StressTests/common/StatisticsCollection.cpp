@@ -25,6 +25,7 @@
 
 #include "StatisticsCollection.h"
 #include <assert.h>
+#include <algorithm>
 #include <iostream>
 
 
@@ -44,6 +45,19 @@ double GetUtcTime()
 }
 
 
+Safir::Dob::Typesystem::Si64::Second LatencyCollector::Percentile(const double p) const
+{
+    if (m_samples.empty())
+    {
+        return 0;
+    }
+    std::vector<Safir::Dob::Typesystem::Si64::Second> sorted = m_samples;
+    const size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p / 100.0 * sorted.size()));
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+
 HzCollector::HzCollector():
     m_startTime(GetUtcTime()),
     m_count(0)
@@ -169,7 +183,9 @@ void StatisticsCollection::PrintStatistics() const
         LatencyCollector * collector = it->second;
         if (collector->m_count != 0)
         {
-            std::wcout << it->first << ":\t average = " << collector->m_totalDelay/collector->m_count << ", max = " << collector->m_maxDelay << ", min = " << collector->m_minDelay << std::endl;
+            std::wcout << it->first << ":\t average = " << collector->m_totalDelay/collector->m_count
+                       << ", p99 = " << collector->Percentile(99.0)
+                       << ", max = " << collector->m_maxDelay << ", min = " << collector->m_minDelay << std::endl;
         }
     }
 }
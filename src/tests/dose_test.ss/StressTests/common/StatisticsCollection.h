@@ -26,6 +26,7 @@
 #define __FREQ_CALC_H__
 
 #include <map>
+#include <vector>
 #include <Safir/Dob/Typesystem/Defs.h>
 #include <boost/noncopyable.hpp>
 
@@ -66,14 +67,19 @@ public:
         m_totalDelay += elapsed;
         m_maxDelay = std::max(m_maxDelay,elapsed);
         m_minDelay = std::min(m_minDelay,elapsed);
+        m_samples.push_back(elapsed);
         ++m_count;
     }
+
+    //Get the latency that p percent of the samples are below, e.g. Percentile(99.0)
+    Safir::Dob::Typesystem::Si64::Second Percentile(const double p) const;
 private:
     friend class StatisticsCollection;
     LatencyCollector():
         m_maxDelay(0),
         m_minDelay(99999999999999LL),
-        m_totalDelay(0)
+        m_totalDelay(0),
+        m_count(0)
     {}
     ~LatencyCollector(){}
 
@@ -83,12 +89,14 @@ private:
         m_minDelay = 99999999999999LL;
         m_totalDelay = 0;
         m_count = 0;
+        m_samples.clear();
     }
 
     Safir::Dob::Typesystem::Si64::Second m_beginTime;
     Safir::Dob::Typesystem::Si64::Second m_maxDelay;
     Safir::Dob::Typesystem::Si64::Second m_minDelay;
     Safir::Dob::Typesystem::Si64::Second m_totalDelay;
+    std::vector<Safir::Dob::Typesystem::Si64::Second> m_samples;
 
     long m_count;
 };
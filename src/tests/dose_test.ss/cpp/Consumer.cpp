@@ -929,6 +929,18 @@ void Consumer::ExecuteAction(DoseTest::ActionPtr action)
                                                 action->Handler());
                     }
                     break;
+                case DoseTest::ActionEnum::SetChangesBatch:
+                    {
+                        std::vector<std::pair<Safir::Dob::EntityPtr, Safir::Dob::Typesystem::InstanceId> > entities;
+                        for (size_t i = 0; i < action->Objects().size(); ++i)
+                        {
+                            entities.push_back(std::make_pair(std::static_pointer_cast<Safir::Dob::Entity>(action->Objects()[i]),
+                                                              action->Instances()[i]));
+                        }
+                        m_connection.SetChangesBatch(entities,
+                                                     action->Handler());
+                    }
+                    break;
                 case DoseTest::ActionEnum::InjectChanges:
                     {
                         Safir::Dob::ConnectionAspectInjector(m_connection).InjectChanges
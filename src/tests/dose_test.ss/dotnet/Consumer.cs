@@ -450,6 +450,17 @@ namespace dose_test_dotnet
                                 }
                                 break;
 
+                            case DoseTest.ActionEnum.Enumeration.SetChangesBatch:
+                                {
+                                    // There is no batch call in .NET, SetChanges in turn gives the same result.
+                                    for (int i = 0; i < action.Objects.Count; ++i)
+                                    {
+                                        m_connection.SetChanges(action.Objects[i] as Safir.Dob.Entity,
+                                            action.Instances[i], action.Handler.Val);
+                                    }
+                                }
+                                break;
+
                             case DoseTest.ActionEnum.Enumeration.InjectChanges:
                                 {
                                     new Safir.Dob.ConnectionAspectInjector(m_connection).InjectChanges
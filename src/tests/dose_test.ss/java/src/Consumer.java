@@ -452,6 +452,17 @@ class Consumer implements
                         }
                         break;
 
+                    case SET_CHANGES_BATCH:
+                        {
+                            // There is no batch call in Java, setChanges in turn gives the same result.
+                            for (int i = 0; i < action.objects().size(); ++i)
+                            {
+                                m_connection.setChanges((com.saabgroup.safir.dob.Entity)action.objects().get(i),
+                                                        action.instances().get(i), action.handler().getVal());
+                            }
+                        }
+                        break;
+
                     case INJECT_CHANGES:
                         {
                             new com.saabgroup.safir.dob.ConnectionAspectInjector(m_connection).injectChanges
@@ -0,0 +1,250 @@
+/******************************************************************************
+*
+* Copyright Saab AB, 2026 (http://safirsdkcore.com)
+*
+*******************************************************************************
+*
+* This file is part of Safir SDK Core.
+*
+* Safir SDK Core is free software: you can redistribute it and/or modify
+* it under the terms of version 3 of the GNU General Public License as
+* published by the Free Software Foundation.
+*
+* Safir SDK Core is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with Safir SDK Core.  If not, see <http://www.gnu.org/licenses/>.
+*
+******************************************************************************/
+#include <Safir/Dob/Internal/LockStatistics.h>
+#include <boost/exception/diagnostic_information.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <thread>
+
+//disable warnings in boost
+#if defined _MSC_VER
+  #pragma warning (push)
+  #pragma warning (disable : 4100)
+  #pragma warning (disable : 4267)
+#endif
+
+#include <boost/program_options.hpp>
+
+#if defined _MSC_VER
+  #pragma warning (pop)
+#endif
+
+using Safir::Dob::Internal::LockKind;
+using Safir::Dob::Internal::LockStatistics;
+
+std::wostream& operator<<(std::wostream& out, const boost::program_options::options_description& opt)
+{
+    std::ostringstream ostr;
+    ostr << opt;
+    return out << ostr.str().c_str();
+}
+
+class ProgramOptions
+{
+public:
+    ProgramOptions(int argc, char* argv[])
+        : parseOk(false)
+        , enable(false)
+        , disable(false)
+        , reset(false)
+        , interval(0)
+    {
+        using namespace boost::program_options;
+        options_description options("Options");
+        options.add_options()
+            ("help,h", "show help message")
+            ("enable,e",
+             "Start collecting lock statistics in all dob processes on this node.")
+            ("disable,d",
+             "Stop collecting lock statistics.")
+            ("reset,r",
+             "Set all lock statistics to zero.")
+            ("interval,i",
+             value<int>(&interval),
+             "Show the statistics every <arg> seconds, until the program is stopped, instead of once.");
+
+        variables_map vm;
+
+        try
+        {
+            store(command_line_parser(argc, argv).
+                  options(options).run(), vm);
+            notify(vm);
+        }
+        catch (const std::exception& exc)
+        {
+            std::wcerr << "Error parsing command line: " << exc.what() << "\n" << std::endl;
+            ShowHelp(options);
+            return;
+        }
+
+        if (vm.count("help"))
+        {
+            ShowHelp(options);
+            return;
+        }
+
+        enable = vm.count("enable") != 0;
+        disable = vm.count("disable") != 0;
+        reset = vm.count("reset") != 0;
+
+        if (enable && disable)
+        {
+            ShowHelp(options);
+            return;
+        }
+
+        parseOk = true;
+    }
+    bool parseOk;
+
+    bool enable;
+    bool disable;
+    bool reset;
+    int interval;
+private:
+    static void ShowHelp(const boost::program_options::options_description& desc)
+    {
+        std::wcout << std::boolalpha
+                   << "Usage: safir_lock_stats [OPTIONS]\n"
+                   << "Show contention statistics for the locks in the dob shared memory.\n"
+                   << desc
+                   << std::endl;
+    }
+};
+
+//The upper bound, in microseconds, of the bucket where the given fraction of the times is reached.
+double Percentile(const std::atomic<std::uint64_t>* histogram, const std::uint64_t count, const double fraction)
+{
+    std::uint64_t sum = 0;
+    for (int i = 0; i < LockStatistics::NumBuckets; ++i)
+    {
+        sum += histogram[i];
+        if (sum != 0 && sum >= fraction * count)
+        {
+            return static_cast<double>(std::uint64_t(1) << (i + 1)) / 1000.0;
+        }
+    }
+    return 0;
+}
+
+void Show(const LockStatistics& statistics)
+{
+    std::wcout << "Lock statistics are " << (statistics.Enabled() ? "enabled" : "disabled")
+               << ". Times are in microseconds, percentiles are rounded up to a power of two nanoseconds.\n"
+               << std::left << std::setw(24) << "Lock" << std::right
+               << std::setw(6) << "Level"
+               << std::setw(14) << "Acquisitions"
+               << std::setw(12) << "Contended"
+               << std::setw(9) << "Cont%"
+               << std::setw(12) << "AvgWait"
+               << std::setw(12) << "p99Wait"
+               << std::setw(12) << "AvgHold"
+               << std::setw(12) << "p99Hold" << "\n";
+
+    std::map<unsigned short, std::pair<std::uint64_t, std::uint64_t>, std::greater<unsigned short>> levels;
+
+    std::wcout << std::fixed << std::setprecision(2);
+    for (int i = 0; i < static_cast<int>(LockKind::NumKinds); ++i)
+    {
+        const LockKind kind = static_cast<LockKind>(i);
+        const LockStatistics::Counters& counters = statistics.GetCounters(kind);
+
+        const std::uint64_t acquisitions = counters.acquisitions;
+        if (acquisitions == 0)
+        {
+            continue;
+        }
+
+        const std::uint64_t contended = counters.contendedAcquisitions;
+        std::uint64_t holds = 0;
+        for (int bucket = 0; bucket < LockStatistics::NumBuckets; ++bucket)
+        {
+            holds += counters.holdHistogram[bucket];
+        }
+
+        auto& level = levels[counters.level];
+        level.first += acquisitions;
+        level.second += contended;
+
+        std::wcout << std::left << std::setw(24) << LockStatistics::GetName(kind) << std::right
+                   << std::setw(6) << counters.level
+                   << std::setw(14) << acquisitions
+                   << std::setw(12) << contended
+                   << std::setw(9) << 100.0 * contended / acquisitions
+                   << std::setw(12) << (contended == 0 ? 0.0 : counters.totalWaitTime / 1000.0 / contended)
+                   << std::setw(12) << Percentile(counters.waitHistogram, contended, 0.99)
+                   << std::setw(12) << (holds == 0 ? 0.0 : counters.totalHoldTime / 1000.0 / holds)
+                   << std::setw(12) << Percentile(counters.holdHistogram, holds, 0.99) << "\n";
+    }
+
+    std::wcout << "Per level:\n";
+    for (const auto& level : levels)
+    {
+        std::wcout << std::left << std::setw(24) << "" << std::right
+                   << std::setw(6) << level.first
+                   << std::setw(14) << level.second.first
+                   << std::setw(12) << level.second.second
+                   << std::setw(9) << 100.0 * level.second.second / level.second.first << "\n";
+    }
+    std::wcout << std::endl;
+}
+
+int main(int argc, char * argv[])
+{
+    try
+    {
+        const ProgramOptions options(argc, argv);
+        if (!options.parseOk)
+        {
+            return 1;
+        }
+
+        LockStatistics::Initialize();
+        LockStatistics& statistics = LockStatistics::Instance();
+
+        if (options.reset)
+        {
+            statistics.Reset();
+        }
+
+        if (options.enable || options.disable)
+        {
+            statistics.Enable(options.enable);
+            std::wcout << "Lock statistics " << (options.enable ? "enabled" : "disabled") << std::endl;
+            if (options.interval <= 0)
+            {
+                return 0;
+            }
+        }
+
+        for (;;)
+        {
+            Show(statistics);
+
+            if (options.interval <= 0)
+            {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::seconds(options.interval));
+        }
+    }
+    catch (...)
+    {
+        std::wcerr << "Caught exception: " << boost::current_exception_diagnostic_information().c_str() << std::endl;
+        std::wcerr << "Is dose_main running?" << std::endl;
+        return 1;
+    }
+    return 0;
+}
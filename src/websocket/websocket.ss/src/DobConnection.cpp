@@ -50,6 +50,15 @@ DobConnection::DobConnection(boost::asio::io_context::strand& strand, std::funct
 #pragma warning(pop)
 #endif
 
+template <class... Args>
+void DobConnection::SendNotification(const std::string& method, const Args&... args)
+{
+    JsonRpcNotification::Begin(method, m_notification);
+    m_proxyToJson.AppendJson(m_notification, args...);
+    JsonRpcNotification::End(m_notification);
+    m_wsSend(m_notification);
+}
+
 
 //------------------------------------------------------
 // DOB events
@@ -104,20 +113,17 @@ void DobConnection::OnCompletedRegistration(const sd::Typesystem::TypeId typeId,
 void DobConnection::OnInjectedNewEntity(const sd::InjectedEntityProxy injectedEntityProxy)
 {
     lllog(5)<<"WS: OnInjectedNewEntity"<<std::endl;
-    auto notification=JsonRpcNotification::Json(Methods::OnInjectedNewEntity, m_proxyToJson.ToJson(injectedEntityProxy));
-    m_wsSend(notification);
+    SendNotification(Methods::OnInjectedNewEntity, injectedEntityProxy);
 }
 void DobConnection::OnInjectedUpdatedEntity(const sd::InjectedEntityProxy injectedEntityProxy)
 {
     lllog(5)<<"WS: OnInjectedUpdatedEntity"<<std::endl;
-    auto notification=JsonRpcNotification::Json(Methods::OnInjectedUpdatedEntity, m_proxyToJson.ToJson(injectedEntityProxy));
-    m_wsSend(notification);
+    SendNotification(Methods::OnInjectedUpdatedEntity, injectedEntityProxy);
 }
 void DobConnection::OnInjectedDeletedEntity(const sd::InjectedEntityProxy injectedEntityProxy)
 {
     lllog(5)<<"WS: OnInjectedDeletedEntity"<<std::endl;
-    auto notification=JsonRpcNotification::Json(Methods::OnInjectedDeletedEntity, m_proxyToJson.ToJson(injectedEntityProxy));
-    m_wsSend(notification);
+    SendNotification(Methods::OnInjectedDeletedEntity, injectedEntityProxy);
 }
 void DobConnection::OnInitialInjectionsDone(const sd::Typesystem::TypeId typeId, const sd::Typesystem::HandlerId& handlerId)
 {
@@ -130,20 +136,17 @@ void DobConnection::OnInitialInjectionsDone(const sd::Typesystem::TypeId typeId,
 void DobConnection::OnNewEntity(const sd::EntityProxy entityProxy)
 {
     lllog(5)<<"WS: OnNewEntity"<<std::endl;
-    auto notification=JsonRpcNotification::Json(Methods::OnNewEntity, m_proxyToJson.ToJson(entityProxy));
-    m_wsSend(notification);
+    SendNotification(Methods::OnNewEntity, entityProxy);
 }
 void DobConnection::OnUpdatedEntity(const sd::EntityProxy entityProxy)
 {
     lllog(5)<<"WS: OnUpdatedEntity"<<std::endl;
-    auto notification=JsonRpcNotification::Json(Methods::OnUpdatedEntity, m_proxyToJson.ToJson(entityProxy));
-    m_wsSend(notification);
+    SendNotification(Methods::OnUpdatedEntity, entityProxy);
 }
 void DobConnection::OnDeletedEntity(const sd::EntityProxy entityProxy, const bool)
 {
     lllog(5)<<"WS: OnDeletedEntity"<<std::endl;
-    auto notification=JsonRpcNotification::Json(Methods::OnDeletedEntity, m_proxyToJson.ToJson(entityProxy, true));
-    m_wsSend(notification);
+    SendNotification(Methods::OnDeletedEntity, entityProxy, true);
 }
 
 //RegistrationSubscriber interface
@@ -190,6 +193,5 @@ void DobConnection::OnNotMessageOverflow()
 void DobConnection::OnMessage(const sd::MessageProxy messageProxy)
 {
     lllog(5)<<"WS: OnMessage"<<std::endl;
-    auto notification=JsonRpcNotification::Json(Methods::OnMessage, m_proxyToJson.ToJson(messageProxy));
-    m_wsSend(notification);
+    SendNotification(Methods::OnMessage, messageProxy);
 }
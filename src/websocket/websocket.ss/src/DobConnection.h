@@ -192,6 +192,11 @@ private:
     RequestIdMapper m_reqIdMapper;
     ResponseSenderStore m_responseSenderStore;
     ProxyToJson m_proxyToJson;
+    std::string m_notification; //reused for the entity, injection and message notifications
+
+    //Sends a notification whose params are the json of a proxy, built in m_notification.
+    template <class... Args>
+    void SendNotification(const std::string& method, const Args&... args);
 
     //DOB events
     //-----------------
@@ -26,10 +26,12 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <cstdio>
 #include <Safir/Dob/Connection.h>
 #include <Safir/Dob/Typesystem/HandlerId.h>
 #include <Safir/Dob/Typesystem/ChannelId.h>
 #include <Safir/Dob/Typesystem/InstanceId.h>
+#include <Safir/Dob/Typesystem/Internal/InternalOperations.h>
 
 namespace sd = Safir::Dob;
 namespace ts = Safir::Dob::Typesystem;
@@ -59,6 +61,24 @@ namespace JsonHelpers
         return os;
     }
 
+    //Same output as AddHashedVal but appended to a string.
+    template <class T>
+    void AppendHashedVal(std::string& json, const T& hash)
+    {
+        if (hash.Utf8StringLength()>0)
+        {
+            json+='"';
+            json+=hash.Utf8String();
+            json+='"';
+        }
+        else
+        {
+            char buf[24];
+            const int len=snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(hash.GetRawValue()));
+            json.append(buf, static_cast<size_t>(len));
+        }
+    }
+
     inline bool IsArray(const std::string& json)
     {
         return json[0]=='[' && json[json.length()-1]==']';
@@ -115,32 +135,47 @@ public:
     {
     }
 
-    std::string ToJson(const sd::EntityProxy& proxy, bool previousEntity=false) const
+    //The AppendJson functions are used for the notifications, which are by far the most frequent, and append
+    //to a string owned by the caller. The blob is serialized directly into that string.
+    void AppendJson(std::string& json, const sd::EntityProxy& proxy, bool previousEntity=false) const
     {
-        std::ostringstream os;
-        os<<"{"<<SAFIR_WS_OBJ("instanceId",proxy.GetInstanceId())<<","<<SAFIR_WS_OBJ("entity",ts::Internal::ToJson((previousEntity ? proxy.GetPrevious().GetBlob() : proxy.GetBlob())))<<"}";
-        return os.str();
+        json+="{\"instanceId\":";
+        JsonHelpers::AppendHashedVal(json, proxy.GetInstanceId());
+        json+=",\"entity\":";
+        ts::Internal::ToJson(previousEntity ? proxy.GetPrevious().GetBlob() : proxy.GetBlob(), json);
+        json+='}';
     }
 
-    std::string ToJson(const sd::MessageProxy& proxy) const
+    void AppendJson(std::string& json, const sd::MessageProxy& proxy) const
     {
-        std::ostringstream os;
-        os<<"{"<<SAFIR_WS_OBJ("channelId",proxy.GetChannelId())<<","<<SAFIR_WS_OBJ("message",ts::Internal::ToJson(proxy.GetBlob()))<<"}";
-        return os.str();
+        json+="{\"channelId\":";
+        JsonHelpers::AppendHashedVal(json, proxy.GetChannelId());
+        json+=",\"message\":";
+        ts::Internal::ToJson(proxy.GetBlob(), json);
+        json+='}';
+    }
+
+    void AppendJson(std::string& json, const Safir::Dob::InjectedEntityProxy &proxy) const
+    {
+        json+="{\"instanceId\":";
+        JsonHelpers::AppendHashedVal(json, proxy.GetInstanceId());
+        json+=",\"entity\":";
+        ts::Internal::ToJson(proxy.GetInjectionBlob(), json);
+        json+='}';
     }
 
     std::string ToJson(const sd::ResponseProxy& proxy) const
     {
         std::ostringstream os;
-        os<<"{"<<SAFIR_WS_BOOL("isSuccess",proxy.IsSuccess())<<","<<SAFIR_WS_OBJ("response", ts::Internal::ToJson(proxy.GetBlob()))<<"}";
-        return os.str();
+        os<<"{"<<SAFIR_WS_BOOL("isSuccess",proxy.IsSuccess())<<","<<SAFIR_WS_QUOTE("response")<<":";
+        return WithBlob(os, proxy.GetBlob());
     }
 
     std::string ToJson(const sd::ServiceRequestProxy& proxy) const
     {
         std::ostringstream os;
-        os<<"{"<<SAFIR_WS_OBJ("handlerId",proxy.GetReceivingHandlerId())<<","<<SAFIR_WS_OBJ("request",ts::Internal::ToJson(proxy.GetBlob()))<<"}";
-        return os.str();
+        os<<"{"<<SAFIR_WS_OBJ("handlerId",proxy.GetReceivingHandlerId())<<","<<SAFIR_WS_QUOTE("request")<<":";
+        return WithBlob(os, proxy.GetBlob());
     }
 
     std::string ToJson(const Safir::Dob::EntityRequestProxy &proxy, EntityRequestType reqType) const
@@ -156,16 +191,16 @@ public:
                 {
                     os<<SAFIR_WS_OBJ("instanceId",proxy.GetInstanceId())<<",";
                 }
-                os<<SAFIR_WS_OBJ("entity",ts::Internal::ToJson(proxy.GetBlob()))<<"}";
+                os<<SAFIR_WS_QUOTE("entity")<<":";
+                return WithBlob(os, proxy.GetBlob());
             }
-                break;
 
             case UpdateReqType:
             {
                 os<<SAFIR_WS_OBJ("instanceId",proxy.GetInstanceId())<<",";
-                os<<SAFIR_WS_OBJ("entity",ts::Internal::ToJson(proxy.GetBlob()))<<"}";
+                os<<SAFIR_WS_QUOTE("entity")<<":";
+                return WithBlob(os, proxy.GetBlob());
             }
-                break;
 
             case DeleteReqType:
             {
@@ -177,13 +212,6 @@ public:
         return os.str();
     }
 
-    std::string ToJson(const Safir::Dob::InjectedEntityProxy &proxy) const
-    {
-        std::ostringstream os;
-        os<<"{"<<SAFIR_WS_OBJ("instanceId",proxy.GetInstanceId())<<","<<SAFIR_WS_OBJ("entity",ts::Internal::ToJson(proxy.GetInjectionBlob()))<<"}";
-        return os.str();
-    }
-
     std::string ToJson(Safir::Dob::Typesystem::TypeId typeId, const Safir::Dob::Typesystem::HandlerId &handler) const
     {
         std::ostringstream os;
@@ -194,4 +222,14 @@ public:
 private:
     std::function< std::string(ts::TypeId) > m_typeIdToName;
     std::function< sd::InstanceIdPolicy::Enumeration(ts::TypeId, const ts::HandlerId&) > m_getInstIdPolicy;
+
+    //Completes the object started in os with the json of a blob. The blob, which is usually the
+    //by far biggest part, is serialized directly into the result instead of through the stream.
+    static std::string WithBlob(const std::ostringstream& os, const char* blob)
+    {
+        std::string json=os.str();
+        ts::Internal::ToJson(blob, json);
+        json+='}';
+        return json;
+    }
 };
@@ -40,9 +40,29 @@ public:
 
     static std::string Json(const std::string& method, const std::string& json)
     {
+        //params is often a big entity, append it instead of copying it through a stream
         std::ostringstream os;
-        os<<"{"<<SAFIR_WS_STR("jsonrpc","2.0")<<","<<SAFIR_WS_STR("method",method)<<","<<SAFIR_WS_OBJ("params", json)<<"}";
-        return os.str();
+        os<<"{"<<SAFIR_WS_STR("jsonrpc","2.0")<<","<<SAFIR_WS_STR("method",method)<<","<<SAFIR_WS_QUOTE("params")<<":";
+        std::string notification=os.str();
+        notification.reserve(notification.size()+json.size()+1);
+        notification+=json;
+        notification+='}';
+        return notification;
+    }
+
+    //Starts a notification in json, which is cleared first. The caller appends the params and then calls End.
+    //A string that is reused for many notifications makes this free from memory allocations.
+    static void Begin(const std::string& method, std::string& json)
+    {
+        json.clear();
+        json+="{\"jsonrpc\":\"2.0\",\"method\":\"";
+        json+=method;
+        json+="\",\"params\":";
+    }
+
+    static void End(std::string& json)
+    {
+        json+='}';
     }
 
 
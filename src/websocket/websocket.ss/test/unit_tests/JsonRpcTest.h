@@ -387,5 +387,11 @@ inline void JsonRpcTest()
 
         json=JsonRpcNotification::Empty("myMethod");
         CHECK(json=="{\"jsonrpc\":\"2.0\",\"method\":\"myMethod\"}");
+
+        json="old content";
+        JsonRpcNotification::Begin("myMethod", json);
+        json+="{\"myVar\":3}";
+        JsonRpcNotification::End(json);
+        CHECK(json==JsonRpcNotification::Json("myMethod", "{\"myVar\":3}"));
     }
 }